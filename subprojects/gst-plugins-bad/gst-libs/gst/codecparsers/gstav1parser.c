@@ -212,6 +212,11 @@ av1_helper_round_power_of_two_signed (gint64 value, guint16 n)
 static gint
 av1_helper_msb (guint n)
 {
+#if defined(__GNUC__) && __GNUC__ >= 4
+  g_assert (n != 0);
+
+  return 31 - __builtin_clz (n);
+#else
   int log = 0;
   guint value = n;
   int i;
@@ -227,6 +232,7 @@ av1_helper_msb (guint n)
     }
   }
   return log;
+#endif
 }
 
 static const guint16 div_lut[GST_AV1_DIV_LUT_NUM + 1] = {
@@ -329,6 +335,15 @@ av1_bitstreamfn_uvlc (GstBitReader * br, GstAV1ParserResult * retval)
   guint32 readv;
   guint32 value;
   gboolean done;
+  guint32 peek;
+
+  /* fast path: codes up to 31 bits long are decoded from a single peek
+   * by counting the leading zeros */
+  if (gst_bit_reader_peek_bits_uint32 (br, &peek, 32) && peek >= 0x10000) {
+    leadingZero = 31 - av1_helper_msb (peek);
+    gst_bit_reader_skip_unchecked (br, 2 * leadingZero + 1);
+    return (peek >> (31 - 2 * leadingZero)) - 1;
+  }
 
   while (1) {
     done = AV1_READ_BIT_CHECKED (br, retval);
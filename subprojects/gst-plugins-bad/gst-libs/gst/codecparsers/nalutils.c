@@ -49,43 +49,135 @@ nal_reader_init (NalReader * nr, const guint8 * data, guint size)
   nr->byte = 0;
   nr->bits_in_cache = 0;
   /* fill with something other than 0 to detect emulation prevention bytes */
-  nr->first_byte = 0xff;
   nr->epb_cache = 0xff;
-  nr->cache = 0xff;
+  nr->cache = 0;
 }
 
-gboolean
-nal_reader_read (NalReader * nr, guint nbits)
+/* Number of leading zero bits of a non-zero value */
+static inline guint
+nal_reader_clz64 (guint64 value)
 {
-  if (G_UNLIKELY (nr->byte * 8 + (nbits - nr->bits_in_cache) > nr->size * 8)) {
-    GST_DEBUG ("Can not read %u bits, bits in cache %u, Byte * 8 %u, size in "
-        "bits %u", nbits, nr->bits_in_cache, nr->byte * 8, nr->size * 8);
-    return FALSE;
+#if defined(__GNUC__) && __GNUC__ >= 4
+  return __builtin_clzll (value);
+#else
+  guint n = 0;
+
+  if (!(value & G_GUINT64_CONSTANT (0xffffffff00000000))) {
+    n += 32;
+    value <<= 32;
+  }
+  if (!(value & G_GUINT64_CONSTANT (0xffff000000000000))) {
+    n += 16;
+    value <<= 16;
+  }
+  if (!(value & G_GUINT64_CONSTANT (0xff00000000000000))) {
+    n += 8;
+    value <<= 8;
+  }
+  if (!(value & G_GUINT64_CONSTANT (0xf000000000000000))) {
+    n += 4;
+    value <<= 4;
   }
+  if (!(value & G_GUINT64_CONSTANT (0xc000000000000000))) {
+    n += 2;
+    value <<= 2;
+  }
+  if (!(value & G_GUINT64_CONSTANT (0x8000000000000000)))
+    n += 1;
 
-  while (nr->bits_in_cache < nbits) {
-    guint8 byte;
+  return n;
+#endif
+}
 
-  next_byte:
-    if (G_UNLIKELY (nr->byte >= nr->size))
-      return FALSE;
+/* Whether any of the bytes of @word is an 0x03, i.e. could be an
+ * emulation_prevention_three_byte */
+#define HAS_THREE_BYTE(word) \
+  ((((word) ^ G_GUINT64_CONSTANT (0x0303030303030303)) - \
+      G_GUINT64_CONSTANT (0x0101010101010101)) & \
+   ~((word) ^ G_GUINT64_CONSTANT (0x0303030303030303)) & \
+   G_GUINT64_CONSTANT (0x8080808080808080))
+
+/* Fills the cache with as many bytes as fit, 8 bytes at once when there
+ * is no emulation prevention byte among them. Emulation prevention bytes
+ * are only skipped while there are less than @nbits (up to 57) bits in the
+ * cache, so that the position and the number of emulation prevention bytes
+ * are the same as when reading the bytes one by one. */
+static void
+nal_reader_refill (NalReader * nr, guint nbits)
+{
+  if (G_LIKELY (nr->size >= 8 && nr->byte <= nr->size - 8)) {
+    guint64 word = GST_READ_UINT64_BE (nr->data + nr->byte);
+
+    if (G_LIKELY (!HAS_THREE_BYTE (word))) {
+      guint nbytes = (64 - nr->bits_in_cache) / 8;
+
+      word >>= 64 - nbytes * 8;
+      nr->cache |= word << (64 - nr->bits_in_cache - nbytes * 8);
+      nr->bits_in_cache += nbytes * 8;
+      nr->byte += nbytes;
+      if (nbytes >= 4)
+        nr->epb_cache = (guint32) word;
+      else
+        nr->epb_cache = (nr->epb_cache << (nbytes * 8)) | (guint32) word;
+
+      if (G_LIKELY (nr->bits_in_cache >= nbits))
+        return;
+    }
+  }
 
-    byte = nr->data[nr->byte++];
-    nr->epb_cache = (nr->epb_cache << 8) | byte;
+  while (nr->bits_in_cache <= 56 && nr->byte < nr->size) {
+    guint8 byte = nr->data[nr->byte];
 
     /* check if the byte is a emulation_prevention_three_byte */
-    if ((nr->epb_cache & 0xffffff) == 0x3) {
+    if (byte == 0x03 && (nr->epb_cache & 0xffff) == 0) {
+      if (nr->bits_in_cache >= nbits)
+        break;
       nr->n_epb++;
-      goto next_byte;
+    } else {
+      nr->cache |= (guint64) byte << (56 - nr->bits_in_cache);
+      nr->bits_in_cache += 8;
     }
-    nr->cache = (nr->cache << 8) | nr->first_byte;
-    nr->first_byte = byte;
-    nr->bits_in_cache += 8;
+    nr->epb_cache = (nr->epb_cache << 8) | byte;
+    nr->byte++;
+  }
+}
+
+/* Makes sure there are at least @nbits (up to 57) bits in the cache */
+static inline gboolean
+nal_reader_fill (NalReader * nr, guint nbits)
+{
+  if (G_LIKELY (nr->bits_in_cache >= nbits))
+    return TRUE;
+
+  nal_reader_refill (nr, nbits);
+
+  return nr->bits_in_cache >= nbits;
+}
+
+/* Reads at most 57 bits, the cache can't hold more bits than that
+ * after a refill. Larger reads have to be split */
+gboolean
+nal_reader_read (NalReader * nr, guint nbits)
+{
+  g_assert (nbits <= 57);
+
+  if (G_UNLIKELY (!nal_reader_fill (nr, nbits))) {
+    GST_DEBUG ("Can not read %u bits, bits in cache %u, Byte * 8 %u, size in "
+        "bits %u", nbits, nr->bits_in_cache, nr->byte * 8, nr->size * 8);
+    return FALSE;
   }
 
   return TRUE;
 }
 
+/* Drops @nbits (up to 32) bits that are known to be in the cache */
+static inline void
+nal_reader_consume (NalReader * nr, guint nbits)
+{
+  nr->cache <<= nbits;
+  nr->bits_in_cache -= nbits;
+}
+
 /* Skips the specified amount of bits. This is only suitable to a
    cacheable number of bits */
 gboolean
@@ -93,10 +185,17 @@ nal_reader_skip (NalReader * nr, guint nbits)
 {
   g_assert (nbits <= 8 * sizeof (nr->cache));
 
+  while (nbits > 32) {
+    if (G_UNLIKELY (!nal_reader_read (nr, 32)))
+      return FALSE;
+    nal_reader_consume (nr, 32);
+    nbits -= 32;
+  }
+
   if (G_UNLIKELY (!nal_reader_read (nr, nbits)))
     return FALSE;
 
-  nr->bits_in_cache -= nbits;
+  nal_reader_consume (nr, nbits);
 
   return TRUE;
 }
@@ -141,21 +240,14 @@ nal_reader_get_epb_count (const NalReader * nr)
 gboolean \
 nal_reader_get_bits_uint##bits (NalReader *nr, guint##bits *val, guint nbits) \
 { \
-  guint shift; \
+  g_assert (nbits <= bits); \
   \
   if (!nal_reader_read (nr, nbits)) \
     return FALSE; \
   \
-  /* bring the required bits down and truncate */ \
-  shift = nr->bits_in_cache - nbits; \
-  *val = nr->first_byte >> shift; \
-  \
-  *val |= nr->cache << (8 - shift); \
-  /* mask out required bits */ \
-  if (nbits < bits) \
-    *val &= ((guint##bits)1 << nbits) - 1; \
-  \
-  nr->bits_in_cache = shift; \
+  /* the required bits are at the top of the cache */ \
+  *val = nbits ? (guint##bits) (nr->cache >> (64 - nbits)) : 0; \
+  nal_reader_consume (nr, nbits); \
   \
   return TRUE; \
 } \
@@ -164,6 +256,27 @@ NAL_READER_READ_BITS (8);
 NAL_READER_READ_BITS (16);
 NAL_READER_READ_BITS (32);
 
+/* Too many bits for the cache, read in two parts like nal_reader_skip().
+ * Nothing is consumed when the read fails */
+gboolean
+nal_reader_get_bits_uint64 (NalReader * nr, guint64 * val, guint nbits)
+{
+  NalReader tmp = *nr;
+  guint32 high = 0, low;
+  guint nlow = MIN (nbits, 32);
+
+  g_assert (nbits <= 64);
+
+  if (!nal_reader_get_bits_uint32 (&tmp, &high, nbits - nlow)
+      || !nal_reader_get_bits_uint32 (&tmp, &low, nlow))
+    return FALSE;
+
+  *val = ((guint64) high << nlow) | low;
+  *nr = tmp;
+
+  return TRUE;
+}
+
 #define NAL_READER_PEEK_BITS(bits) \
 gboolean \
 nal_reader_peek_bits_uint##bits (const NalReader *nr, guint##bits *val, guint nbits) \
@@ -179,26 +292,38 @@ NAL_READER_PEEK_BITS (8);
 gboolean
 nal_reader_get_ue (NalReader * nr, guint32 * val)
 {
-  guint i = 0;
-  guint8 bit;
+  guint i = 0, zeros;
   guint32 value;
 
-  if (G_UNLIKELY (!nal_reader_get_bits_uint8 (nr, &bit, 1)))
-    return FALSE;
+  /* top up the cache so most codes can be decoded from it directly */
+  if (nr->bits_in_cache < 32)
+    nal_reader_refill (nr, 1);
 
-  while (bit == 0) {
-    i++;
-    if (G_UNLIKELY (!nal_reader_get_bits_uint8 (nr, &bit, 1)))
+  /* count the leading zeros, a whole cache at a time */
+  while (G_UNLIKELY (nr->cache == 0)) {
+    i += nr->bits_in_cache;
+    nr->bits_in_cache = 0;
+    if (G_UNLIKELY (i > 31 || !nal_reader_read (nr, 1)))
       return FALSE;
   }
 
+  zeros = nal_reader_clz64 (nr->cache);
+  i += zeros;
   if (G_UNLIKELY (i > 31))
     return FALSE;
 
+  /* fast path: the whole code is in the cache */
+  if (G_LIKELY (i == zeros && 2 * i + 1 <= nr->bits_in_cache)) {
+    *val = (guint32) (nr->cache >> (63 - 2 * i)) - 1;
+    nal_reader_consume (nr, 2 * i + 1);
+    return TRUE;
+  }
+
+  nal_reader_consume (nr, zeros + 1);
   if (G_UNLIKELY (!nal_reader_get_bits_uint32 (nr, &value, i)))
     return FALSE;
 
-  *val = (1 << i) - 1 + value;
+  *val = (1U << i) - 1 + value;
 
   return TRUE;
 }
@@ -222,7 +347,8 @@ nal_reader_get_se (NalReader * nr, gint32 * val)
 gboolean
 nal_reader_is_byte_aligned (NalReader * nr)
 {
-  if (nr->bits_in_cache != 0)
+  /* the cache only ever holds whole bytes */
+  if (nr->bits_in_cache % 8 != 0)
     return FALSE;
   return TRUE;
 }
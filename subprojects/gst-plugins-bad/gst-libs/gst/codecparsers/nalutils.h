@@ -46,10 +46,9 @@ typedef struct
 
   guint n_epb;                  /* Number of emulation prevention bytes */
   guint byte;                   /* Byte position */
-  guint bits_in_cache;          /* bitpos in the cache of next bit */
-  guint8 first_byte;
+  guint bits_in_cache;          /* number of unread bits in the cache */
   guint32 epb_cache;            /* cache 3 bytes to check emulation prevention bytes */
-  guint64 cache;                /* cached bytes */
+  guint64 cache;                /* unread bits, starting at the most significant one */
 } NalReader;
 
 typedef struct
@@ -94,6 +93,7 @@ gboolean nal_reader_get_bits_uint##bits (NalReader *nr, guint##bits *val, guint
 NAL_READER_READ_BITS_H (8);
 NAL_READER_READ_BITS_H (16);
 NAL_READER_READ_BITS_H (32);
+NAL_READER_READ_BITS_H (64);
 
 #define NAL_READER_PEEK_BITS_H(bits) \
 G_GNUC_INTERNAL \
@@ -150,7 +150,7 @@ gboolean nal_reader_get_se (NalReader * nr, gint32 * val);
 
 #define READ_UINT64(nr, val, nbits) { \
   if (!nal_reader_get_bits_uint64 (nr, &val, nbits)) { \
-    GST_WARNING ("failed to read uint32 for '" G_STRINGIFY (val) "', nbits: %d", nbits); \
+    GST_WARNING ("failed to read uint64 for '" G_STRINGIFY (val) "', nbits: %d", nbits); \
     goto error; \
   } \
 }
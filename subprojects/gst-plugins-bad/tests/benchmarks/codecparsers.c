@@ -0,0 +1,284 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures how fast the codec parsers go through the headers of a stream:
+ * parameter sets, SEI, picture and slice headers for H.264, H.265 and
+ * H.266 byte streams, and sequence, frame and tile group headers for AV1
+ * streams in the low overhead OBU format. The slice data itself is not
+ * looked at, so this is dominated by the bit reading.
+ *
+ *   codecparsers <h264|h265|h266|av1> FILE [ITERATIONS]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/codecparsers/gsth264parser.h>
+#include <gst/codecparsers/gsth265parser.h>
+#include <gst/codecparsers/gsth266parser.h>
+#include <gst/codecparsers/gstav1parser.h>
+
+#define DEFAULT_ITERATIONS 100
+
+typedef guint (*ParseFunc) (const guint8 * data, gsize size);
+
+static guint
+parse_h264 (const guint8 * data, gsize size)
+{
+  GstH264NalParser *parser = gst_h264_nal_parser_new ();
+  GstH264ParserResult res;
+  GstH264NalUnit nalu;
+  GstH264SliceHdr slice;
+  GArray *messages;
+  guint offset = 0, n_units = 0;
+
+  do {
+    res = gst_h264_parser_identify_nalu (parser, data, offset, size, &nalu);
+    if (res != GST_H264_PARSER_OK && res != GST_H264_PARSER_NO_NAL_END)
+      break;
+
+    switch (nalu.type) {
+      case GST_H264_NAL_SLICE:
+      case GST_H264_NAL_SLICE_IDR:
+        gst_h264_parser_parse_slice_hdr (parser, &nalu, &slice, TRUE, TRUE);
+        break;
+      case GST_H264_NAL_SEI:
+        messages = NULL;
+        gst_h264_parser_parse_sei (parser, &nalu, &messages);
+        if (messages)
+          g_array_unref (messages);
+        break;
+      default:
+        gst_h264_parser_parse_nal (parser, &nalu);
+        break;
+    }
+
+    offset = nalu.offset + nalu.size;
+    n_units++;
+  } while (res == GST_H264_PARSER_OK);
+
+  gst_h264_nal_parser_free (parser);
+
+  return n_units;
+}
+
+static guint
+parse_h265 (const guint8 * data, gsize size)
+{
+  GstH265Parser *parser = gst_h265_parser_new ();
+  GstH265ParserResult res;
+  GstH265NalUnit nalu;
+  GstH265SliceHdr slice;
+  GArray *messages;
+  guint offset = 0, n_units = 0;
+
+  do {
+    res = gst_h265_parser_identify_nalu (parser, data, offset, size, &nalu);
+    if (res != GST_H265_PARSER_OK && res != GST_H265_PARSER_NO_NAL_END)
+      break;
+
+    if (nalu.type <= GST_H265_NAL_SLICE_RASL_R ||
+        (nalu.type >= GST_H265_NAL_SLICE_BLA_W_LP &&
+            nalu.type <= GST_H265_NAL_SLICE_CRA_NUT)) {
+      if (gst_h265_parser_parse_slice_hdr (parser, &nalu, &slice) ==
+          GST_H265_PARSER_OK)
+        gst_h265_slice_hdr_free (&slice);
+    } else if (nalu.type == GST_H265_NAL_PREFIX_SEI ||
+        nalu.type == GST_H265_NAL_SUFFIX_SEI) {
+      messages = NULL;
+      gst_h265_parser_parse_sei (parser, &nalu, &messages);
+      if (messages)
+        g_array_unref (messages);
+    } else {
+      gst_h265_parser_parse_nal (parser, &nalu);
+    }
+
+    offset = nalu.offset + nalu.size;
+    n_units++;
+  } while (res == GST_H265_PARSER_OK);
+
+  gst_h265_parser_free (parser);
+
+  return n_units;
+}
+
+static guint
+parse_h266 (const guint8 * data, gsize size)
+{
+  GstH266Parser *parser = gst_h266_parser_new ();
+  GstH266ParserResult res;
+  GstH266NalUnit nalu;
+  GstH266PicHdr ph;
+  GstH266SliceHdr slice;
+  GArray *messages;
+  guint offset = 0, n_units = 0;
+
+  do {
+    res = gst_h266_parser_identify_nalu (parser, data, offset, size, &nalu);
+    if (res != GST_H266_PARSER_OK && res != GST_H266_PARSER_NO_NAL_END)
+      break;
+
+    if (nalu.type <= GST_H266_NAL_SLICE_GDR) {
+      gst_h266_parser_parse_slice_hdr (parser, &nalu, &slice);
+    } else if (nalu.type == GST_H266_NAL_PH) {
+      gst_h266_parser_parse_picture_hdr (parser, &nalu, &ph);
+    } else if (nalu.type == GST_H266_NAL_PREFIX_SEI ||
+        nalu.type == GST_H266_NAL_SUFFIX_SEI) {
+      messages = NULL;
+      gst_h266_parser_parse_sei (parser, &nalu, &messages);
+      if (messages)
+        g_array_unref (messages);
+    } else {
+      gst_h266_parser_parse_nal (parser, &nalu);
+    }
+
+    offset = nalu.offset + nalu.size;
+    n_units++;
+  } while (res == GST_H266_PARSER_OK);
+
+  gst_h266_parser_free (parser);
+
+  return n_units;
+}
+
+static guint
+parse_av1 (const guint8 * data, gsize size)
+{
+  GstAV1Parser *parser = gst_av1_parser_new ();
+  GstAV1ParserResult res;
+  GstAV1OBU obu;
+  GstAV1SequenceHeaderOBU seq_header;
+  GstAV1FrameHeaderOBU frame_header;
+  GstAV1FrameOBU frame;
+  GstAV1TileGroupOBU tile_group;
+  GstAV1MetadataOBU metadata;
+  GstAV1FrameHeaderOBU *fh;
+  guint32 consumed;
+  gsize offset = 0;
+  guint n_units = 0;
+
+  while (offset < size) {
+    res = gst_av1_parser_identify_one_obu (parser, data + offset,
+        MIN (size - offset, G_MAXUINT32), &obu, &consumed);
+    if (res != GST_AV1_PARSER_OK && res != GST_AV1_PARSER_DROP)
+      break;
+    if (consumed == 0)
+      break;
+    offset += consumed;
+    if (res == GST_AV1_PARSER_DROP)
+      continue;
+
+    fh = NULL;
+    switch (obu.obu_type) {
+      case GST_AV1_OBU_SEQUENCE_HEADER:
+        gst_av1_parser_parse_sequence_header_obu (parser, &obu, &seq_header);
+        break;
+      case GST_AV1_OBU_FRAME_HEADER:
+      case GST_AV1_OBU_REDUNDANT_FRAME_HEADER:
+        if (gst_av1_parser_parse_frame_header_obu (parser, &obu,
+                &frame_header) == GST_AV1_PARSER_OK)
+          fh = &frame_header;
+        break;
+      case GST_AV1_OBU_FRAME:
+        if (gst_av1_parser_parse_frame_obu (parser, &obu, &frame) ==
+            GST_AV1_PARSER_OK)
+          fh = &frame.frame_header;
+        break;
+      case GST_AV1_OBU_TILE_GROUP:
+        gst_av1_parser_parse_tile_group_obu (parser, &obu, &tile_group);
+        break;
+      case GST_AV1_OBU_METADATA:
+        gst_av1_parser_parse_metadata_obu (parser, &obu, &metadata);
+        break;
+      default:
+        break;
+    }
+
+    /* the next frame headers depend on the reference frame state */
+    if (fh && (!fh->show_existing_frame || fh->frame_type == GST_AV1_KEY_FRAME))
+      gst_av1_parser_reference_frame_update (parser, fh);
+
+    n_units++;
+  }
+
+  gst_av1_parser_free (parser);
+
+  return n_units;
+}
+
+static const struct
+{
+  const gchar *name;
+  ParseFunc func;
+} parsers[] = {
+  {"h264", parse_h264},
+  {"h265", parse_h265},
+  {"h266", parse_h266},
+  {"av1", parse_av1},
+};
+
+gint
+main (gint argc, gchar * argv[])
+{
+  ParseFunc func = NULL;
+  GstClockTime start, elapsed;
+  guint iterations = DEFAULT_ITERATIONS, n_units = 0, i;
+  gchar *contents;
+  gsize size;
+  gdouble secs;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1) {
+    for (i = 0; i < G_N_ELEMENTS (parsers); i++) {
+      if (strcmp (argv[1], parsers[i].name) == 0)
+        func = parsers[i].func;
+    }
+  }
+
+  if (argc < 3 || func == NULL) {
+    g_printerr ("usage: %s <h264|h265|h266|av1> FILE [ITERATIONS]\n",
+        argv[0]);
+    return 1;
+  }
+
+  if (argc > 3)
+    iterations = atoi (argv[3]);
+
+  if (!g_file_get_contents (argv[2], &contents, &size, NULL)) {
+    g_printerr ("could not read %s\n", argv[2]);
+    return 1;
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < iterations; i++)
+    n_units = func ((const guint8 *) contents, size);
+  elapsed = gst_util_get_timestamp () - start;
+
+  secs = (gdouble) MAX (elapsed, 1) / GST_SECOND;
+  g_print ("*** %s: %" G_GSIZE_FORMAT " bytes, %u units, %u iterations\n",
+      argv[1], size, n_units, iterations);
+  g_print ("%" GST_TIME_FORMAT " - %.1f MB/s, %.0f units/s\n",
+      GST_TIME_ARGS (elapsed),
+      (gdouble) size * iterations / (1024 * 1024) / secs,
+      (gdouble) n_units * iterations / secs);
+
+  g_free (contents);
+
+  return 0;
+}
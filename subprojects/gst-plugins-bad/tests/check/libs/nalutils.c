@@ -102,6 +102,102 @@ GST_START_TEST (test_nal_writer_emulation_preventation)
 
 GST_END_TEST;
 
+GST_START_TEST (test_nal_reader_exp_golomb)
+{
+  NalWriter nw;
+  NalReader nr;
+  guint8 *data;
+  guint32 size, val;
+  gint32 sval;
+  gint i;
+  static const guint32 values[] = {
+    0, 1, 2, 3, 6, 7, 8, 254, 255, 256, 65534, 65535, 0x12345,
+    G_MAXINT32, G_MAXUINT32 - 1
+  };
+  static const gint32 signed_values[] = {
+    0, 1, -1, 2, -2, 1000, -1000, G_MAXINT32, -G_MAXINT32
+  };
+
+  nal_writer_init (&nw, 4, FALSE);
+  /* nal unit header */
+  fail_unless (nal_writer_put_bits_uint8 (&nw, 0x1f, 8));
+
+  /* the zero bits in between produce plenty of emulation prevention
+   * bytes, so the codes end up crossing them at all bit positions */
+  for (i = 0; i < G_N_ELEMENTS (values); i++) {
+    fail_unless (nal_writer_put_ue (&nw, values[i]));
+    fail_unless (nal_writer_put_bits_uint32 (&nw, 0, 23));
+  }
+  for (i = 0; i < G_N_ELEMENTS (signed_values); i++) {
+    gint32 v = signed_values[i];
+
+    fail_unless (nal_writer_put_ue (&nw,
+            v > 0 ? 2 * (guint32) v - 1 : 2 * (guint32) - v));
+    fail_unless (nal_writer_put_bits_uint32 (&nw, 0, 17));
+  }
+  fail_unless (nal_writer_do_rbsp_trailing_bits (&nw));
+
+  data = nal_writer_reset_and_get_data (&nw, &size);
+  fail_unless (data != NULL);
+
+  /* skip the start code and the nal unit header */
+  nal_reader_init (&nr, data + 5, size - 5);
+  for (i = 0; i < G_N_ELEMENTS (values); i++) {
+    fail_unless (nal_reader_get_ue (&nr, &val));
+    fail_unless_equals_int64 (val, values[i]);
+    fail_unless (nal_reader_get_bits_uint32 (&nr, &val, 23));
+    fail_unless_equals_int (val, 0);
+  }
+  for (i = 0; i < G_N_ELEMENTS (signed_values); i++) {
+    fail_unless (nal_reader_get_se (&nr, &sval));
+    fail_unless_equals_int (sval, signed_values[i]);
+    fail_unless (nal_reader_skip (&nr, 17));
+  }
+
+  /* only the rbsp_stop_one_bit and its alignment bits are left */
+  fail_if (nal_reader_has_more_data (&nr));
+  fail_unless (nal_reader_get_epb_count (&nr) > 0);
+
+  /* 32 leading zeros are not a valid code */
+  nal_reader_init (&nr, (const guint8 *) "\x00\x00\x03\x00\x00\xff", 6);
+  fail_if (nal_reader_get_ue (&nr, &val));
+
+  g_free (data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_nal_reader_uint64)
+{
+  static const guint8 data[] = {
+    0x80, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf1, 0x23,
+    0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0xff
+  };
+  NalReader nr;
+  guint64 val;
+  guint8 bit;
+
+  nal_reader_init (&nr, data, sizeof (data));
+
+  /* more bits than the cache holds, at an unaligned position */
+  fail_unless (nal_reader_get_bits_uint8 (&nr, &bit, 1));
+  fail_unless (nal_reader_get_bits_uint64 (&nr, &val, 64));
+  fail_unless_equals_uint64 (val, G_GUINT64_CONSTANT (0x002468acf13579bd));
+  fail_unless_equals_int (nal_reader_get_pos (&nr), 65);
+
+  fail_unless (nal_reader_get_bits_uint64 (&nr, &val, 58));
+  fail_unless_equals_uint64 (val, G_GUINT64_CONSTANT (0x3891a2b3c4d5e6f));
+  fail_unless_equals_int (nal_reader_get_pos (&nr), 123);
+
+  /* not enough data left, nothing is consumed */
+  fail_if (nal_reader_get_bits_uint64 (&nr, &val, 64));
+  fail_unless_equals_int (nal_reader_get_pos (&nr), 123);
+  fail_unless (nal_reader_get_bits_uint64 (&nr, &val, 13));
+  fail_unless_equals_uint64 (val, 0xfff);
+}
+
+GST_END_TEST;
+
 static Suite *
 nalutils_suite (void)
 {
@@ -112,6 +208,8 @@ nalutils_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_nal_writer_init);
   tcase_add_test (tc_chain, test_nal_writer_emulation_preventation);
+  tcase_add_test (tc_chain, test_nal_reader_exp_golomb);
+  tcase_add_test (tc_chain, test_nal_reader_uint64);
 
   return s;
 }
@@ -6994,6 +6994,19 @@ av1_type_find (GstTypeFind * tf, gpointer unused)
 }
 
 /*Type find definition by functions */
+
+/* for functions that never suggest anything unless the data contains a
+ * fixed signature, which lets the typefind helpers skip them early */
+#define TYPE_FIND_REGISTER_SIGNATURE_DEFINE(t_f, t_f_n, r, func, extensions, possible_caps, offset, signature, signature_size) \
+G_BEGIN_DECLS \
+gboolean G_PASTE (gst_type_find_register_, t_f) (GstPlugin * plugin) \
+{ \
+  return gst_type_find_register_with_signature (plugin, t_f_n, r, func, \
+      extensions, possible_caps, offset, (const guint8 *) signature, \
+      signature_size, NULL, NULL); \
+} \
+G_END_DECLS
+
 GST_TYPE_FIND_REGISTER_DEFINE (musepack, "audio/x-musepack", GST_RANK_PRIMARY,
     musepack_type_find, "mpc,mpp,mp+", MUSEPACK_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (au, "audio/x-au", GST_RANK_MARGINAL,
@@ -7011,17 +7024,17 @@ GST_TYPE_FIND_REGISTER_DEFINE (mxmf, "audio/mobile-xmf", GST_RANK_PRIMARY,
     mxmf_type_find, "mxmf", MXMF_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (flx, "video/x-fli", GST_RANK_MARGINAL,
     flx_type_find, "flc,fli", FLX_CAPS, NULL, NULL);
-GST_TYPE_FIND_REGISTER_DEFINE (id3v2, "application/x-id3v2",
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (id3v2, "application/x-id3v2",
     GST_RANK_PRIMARY + 103, id3v2_type_find, "mp3,mp2,mp1,mpga,ogg,flac,tta",
-    ID3_CAPS, NULL, NULL);
+    ID3_CAPS, 0, "ID3", 3);
 GST_TYPE_FIND_REGISTER_DEFINE (id3v1, "application/x-id3v1",
     GST_RANK_PRIMARY + 101, id3v1_type_find, "mp3,mp2,mp1,mpga,ogg,flac,tta",
     ID3_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (apetag, "application/x-apetag",
     GST_RANK_PRIMARY + 102, apetag_type_find, "mp3,ape,mpc,wv", APETAG_CAPS,
     NULL, NULL);
-GST_TYPE_FIND_REGISTER_DEFINE (tta, "audio/x-ttafile", GST_RANK_PRIMARY,
-    tta_type_find, "tta", TTA_CAPS, NULL, NULL);
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (tta, "audio/x-ttafile",
+    GST_RANK_PRIMARY, tta_type_find, "tta", TTA_CAPS, 0, "TTA", 3);
 GST_TYPE_FIND_REGISTER_DEFINE (mod, "audio/x-mod", GST_RANK_SECONDARY,
     mod_type_find,
     "669,amf,ams,dbm,digi,dmf,dsm,gdm,far,imf,it,j2b,mdl,med,mod,mt2,mtm,"
@@ -7059,8 +7072,8 @@ GST_TYPE_FIND_REGISTER_DEFINE (h266_video, "video/x-h266", GST_RANK_PRIMARY,
 GST_TYPE_FIND_REGISTER_DEFINE (nuv, "video/x-nuv", GST_RANK_SECONDARY,
     nuv_type_find, "nuv", NUV_CAPS, NULL, NULL);
 /* ISO formats */
-GST_TYPE_FIND_REGISTER_DEFINE (m4a, "audio/x-m4a", GST_RANK_PRIMARY,
-    m4a_type_find, "m4a", M4A_CAPS, NULL, NULL);
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (m4a, "audio/x-m4a", GST_RANK_PRIMARY,
+    m4a_type_find, "m4a", M4A_CAPS, 4, "ftypM4A ", 8);
 GST_TYPE_FIND_REGISTER_DEFINE (q3gp, "application/x-3gp", GST_RANK_PRIMARY,
     q3gp_type_find, "3gp", Q3GP_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (qt, "video/quicktime", GST_RANK_PRIMARY,
@@ -7122,22 +7135,24 @@ GST_TYPE_FIND_REGISTER_DEFINE (sds, "audio/x-sds", GST_RANK_SECONDARY,
     sds_type_find, "sds", SDS_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (ircam, "audio/x-ircam", GST_RANK_SECONDARY,
     ircam_type_find, "sf", IRCAM_CAPS, NULL, NULL);
+/* no signature, the data can also be identified by its last bytes */
 GST_TYPE_FIND_REGISTER_DEFINE (shn, "audio/x-shorten", GST_RANK_SECONDARY,
     shn_type_find, "shn", SHN_CAPS, NULL, NULL);
-GST_TYPE_FIND_REGISTER_DEFINE (ape, "application/x-ape", GST_RANK_SECONDARY,
-    ape_type_find, "ape", APE_CAPS, NULL, NULL);
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (ape, "application/x-ape",
+    GST_RANK_SECONDARY, ape_type_find, "ape", APE_CAPS, 0, "MAC ", 4);
 GST_TYPE_FIND_REGISTER_DEFINE (jpeg, "image/jpeg", GST_RANK_PRIMARY + 15,
     jpeg_type_find, "jpg,jpe,jpeg", JPEG_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (bmp, "image/bmp", GST_RANK_PRIMARY,
     bmp_type_find, "bmp", BMP_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (tiff, "image/tiff", GST_RANK_PRIMARY,
     tiff_type_find, "tif,tiff", TIFF_CAPS, NULL, NULL);
-GST_TYPE_FIND_REGISTER_DEFINE (exr, "image/x-exr", GST_RANK_PRIMARY,
-    exr_type_find, "exr", EXR_CAPS, NULL, NULL);
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (exr, "image/x-exr", GST_RANK_PRIMARY,
+    exr_type_find, "exr", EXR_CAPS, 0, "\x76\x2f\x31\x01", 4);
 GST_TYPE_FIND_REGISTER_DEFINE (pnm, "image/x-portable-pixmap",
     GST_RANK_SECONDARY, pnm_type_find, "pnm,ppm,pgm,pbm", PNM_CAPS, NULL, NULL);
-GST_TYPE_FIND_REGISTER_DEFINE (matroska, "video/x-matroska", GST_RANK_PRIMARY,
-    matroska_type_find, "mkv,mka,mk3d,webm", MATROSKA_CAPS, NULL, NULL);
+TYPE_FIND_REGISTER_SIGNATURE_DEFINE (matroska, "video/x-matroska",
+    GST_RANK_PRIMARY, matroska_type_find, "mkv,mka,mk3d,webm", MATROSKA_CAPS,
+    0, "\x1a\x45\xdf\xa3", 4);
 GST_TYPE_FIND_REGISTER_DEFINE (mxf, "application/mxf", GST_RANK_PRIMARY,
     mxf_type_find, "mxf", MXF_CAPS, NULL, NULL);
 GST_TYPE_FIND_REGISTER_DEFINE (dv, "video/x-dv", GST_RANK_SECONDARY,
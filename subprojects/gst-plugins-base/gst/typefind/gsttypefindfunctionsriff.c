@@ -57,8 +57,9 @@ G_PASTE(_private_type_find_riff_, typefind_name) (GstPlugin * plugin) \
   sw_data->size = 4;                                                    \
   sw_data->probability = GST_TYPE_FIND_MAXIMUM;                         \
   sw_data->caps = gst_caps_new_empty_simple (name);                     \
-  if (!gst_type_find_register (plugin, name, rank, riff_type_find,      \
-                      ext, sw_data->caps, sw_data,                      \
+  if (!gst_type_find_register_with_signature (plugin, name, rank,      \
+                      riff_type_find, ext, sw_data->caps, 8,            \
+                      sw_data->data, sw_data->size, sw_data,            \
                       (GDestroyNotify) (sw_data_destroy))) {            \
     sw_data_destroy (sw_data);                                          \
     return FALSE;                                                       \
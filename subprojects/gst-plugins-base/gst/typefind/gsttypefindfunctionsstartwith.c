@@ -58,8 +58,9 @@ G_PASTE(_private_type_find_start_with_, typefind_name) (GstPlugin * plugin) \
   sw_data->size = _size;                                                \
   sw_data->probability = _probability;                                  \
   sw_data->caps = gst_caps_new_empty_simple (name);                     \
-  if (!gst_type_find_register (plugin, name, rank, start_with_type_find,\
-                     ext, sw_data->caps, sw_data,                       \
+  if (!gst_type_find_register_with_signature (plugin, name, rank,      \
+                     start_with_type_find, ext, sw_data->caps, 0,       \
+                     sw_data->data, sw_data->size, sw_data,             \
                      (GDestroyNotify) (sw_data_destroy))) {             \
     sw_data_destroy (sw_data);                                          \
     return FALSE; \
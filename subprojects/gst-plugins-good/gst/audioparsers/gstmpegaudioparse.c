@@ -128,7 +128,6 @@
 
 #include "gstaudioparserselements.h"
 #include "gstmpegaudioparse.h"
-#include <gst/base/gstbytereader.h>
 #include <gst/pbutils/pbutils.h>
 
 GST_DEBUG_CATEGORY_STATIC (mpeg_audio_parse_debug);
@@ -188,7 +187,7 @@ static GstCaps *gst_mpeg_audio_parse_get_sink_caps (GstBaseParse * parse,
 
 static gboolean
 gst_mpeg_audio_parse_check_if_is_xing_header_frame (GstMpegAudioParse *
-    mp3parse, GstBuffer * buf);
+    mp3parse, GstChunkByteReader * reader);
 
 static void gst_mpeg_audio_parse_handle_first_frame (GstMpegAudioParse *
     mp3parse, GstBuffer * buf);
@@ -331,6 +330,7 @@ gst_mpeg_audio_parse_reset (GstMpegAudioParse * mp3parse)
 static void
 gst_mpeg_audio_parse_init (GstMpegAudioParse * mp3parse)
 {
+  gst_chunk_map_init (&mp3parse->chunk_map);
   gst_mpeg_audio_parse_reset (mp3parse);
   GST_PAD_SET_ACCEPT_INTERSECT (GST_BASE_PARSE_SINK_PAD (mp3parse));
   GST_PAD_SET_ACCEPT_TEMPLATE (GST_BASE_PARSE_SINK_PAD (mp3parse));
@@ -339,6 +339,10 @@ gst_mpeg_audio_parse_init (GstMpegAudioParse * mp3parse)
 static void
 gst_mpeg_audio_parse_finalize (GObject * object)
 {
+  GstMpegAudioParse *mp3parse = GST_MPEG_AUDIO_PARSE (object);
+
+  gst_chunk_map_clear (&mp3parse->chunk_map);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -348,6 +352,7 @@ gst_mpeg_audio_parse_start (GstBaseParse * parse)
   GstMpegAudioParse *mp3parse = GST_MPEG_AUDIO_PARSE (parse);
 
   gst_base_parse_set_min_frame_size (GST_BASE_PARSE (mp3parse), MIN_FRAME_SIZE);
+  gst_base_parse_set_scatter_gather (GST_BASE_PARSE (mp3parse), TRUE);
   GST_DEBUG_OBJECT (parse, "starting");
 
   gst_mpeg_audio_parse_reset (mp3parse);
@@ -482,21 +487,19 @@ mp3_type_frame_length_from_header (GstMpegAudioParse * mp3parse, guint32 header,
  * If FALSE is returned, then *valid contains minimum needed data.
  */
 static gboolean
-gst_mp3parse_validate_extended (GstMpegAudioParse * mp3parse, GstBuffer * buf,
-    guint32 header, int bpf, gboolean at_eos, gint * valid)
+gst_mp3parse_validate_extended (GstMpegAudioParse * mp3parse,
+    GstChunkByteReader * reader, guint32 header, int bpf, gboolean at_eos,
+    gint * valid)
 {
   guint32 next_header;
-  GstMapInfo map;
   gboolean res = TRUE;
   int frames_found = 1;
   int offset = bpf;
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-
   while (frames_found < MIN_RESYNC_FRAMES) {
     /* Check if we have enough data for all these frames, plus the next
        frame header. */
-    if (map.size < offset + 4) {
+    if (gst_chunk_byte_reader_get_size (reader) < offset + 4) {
       if (at_eos) {
         /* Running out of data at EOS is fine; just accept it */
         *valid = TRUE;
@@ -508,7 +511,8 @@ gst_mp3parse_validate_extended (GstMpegAudioParse * mp3parse, GstBuffer * buf,
       }
     }
 
-    next_header = GST_READ_UINT32_BE (map.data + offset);
+    gst_chunk_byte_reader_set_pos (reader, offset);
+    gst_chunk_byte_reader_peek_uint32_be (reader, &next_header);
     GST_DEBUG_OBJECT (mp3parse, "At %d: header=%08X, header2=%08X, bpf=%d",
         offset, (unsigned int) header, (unsigned int) next_header, bpf);
 
@@ -551,7 +555,6 @@ gst_mp3parse_validate_extended (GstMpegAudioParse * mp3parse, GstBuffer * buf,
   *valid = TRUE;
 
 cleanup:
-  gst_buffer_unmap (buf, &map);
   return res;
 }
 
@@ -606,19 +609,18 @@ gst_mpeg_audio_parse_head_check (GstMpegAudioParse * mp3parse,
  * If not enough data, returns FALSE.
  */
 static gboolean
-gst_mp3parse_find_freerate (GstMpegAudioParse * mp3parse, GstMapInfo * map,
-    guint32 header, gboolean at_eos, gint * _rate)
+gst_mp3parse_find_freerate (GstMpegAudioParse * mp3parse,
+    GstChunkByteReader * reader, guint32 header, gboolean at_eos,
+    gint * _rate)
 {
   guint32 next_header;
-  const guint8 *data;
   guint available;
   int offset = 4;
   gulong samplerate, rate, layer, padding;
   gboolean valid;
   gint lsf, mpg25;
 
-  available = map->size;
-  data = map->data;
+  available = gst_chunk_byte_reader_get_size (reader);
 
   *_rate = 0;
 
@@ -648,7 +650,8 @@ gst_mp3parse_find_freerate (GstMpegAudioParse * mp3parse, GstMapInfo * map,
     }
 
     valid = FALSE;
-    next_header = GST_READ_UINT32_BE (data + offset);
+    gst_chunk_byte_reader_set_pos (reader, offset);
+    gst_chunk_byte_reader_peek_uint32_be (reader, &next_header);
     if ((next_header & 0xFFE00000) != 0xFFE00000)
       goto next;
 
@@ -712,30 +715,39 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
 {
   GstMpegAudioParse *mp3parse = GST_MPEG_AUDIO_PARSE (parse);
   GstBuffer *buf = frame->buffer;
-  GstByteReader reader;
+  GstChunkByteReader reader;
   gint off, bpf = 0;
   gboolean lost_sync, draining, valid, caps_change;
   guint32 header;
   guint bitrate, layer, rate, channels, version, mode, crc;
-  GstMapInfo map;
+  gsize size;
   gboolean res = FALSE;
 
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-  if (G_UNLIKELY (map.size < 6)) {
+  /* the frame may consist of several upstream memories, read them in
+   * place instead of merging them */
+  if (!gst_chunk_map_add_buffer (&mp3parse->chunk_map, buf, 0, -1)) {
+    GST_ELEMENT_ERROR (mp3parse, STREAM, DECODE, (NULL),
+        ("Failed to map input buffer"));
+    return GST_FLOW_ERROR;
+  }
+
+  size = mp3parse->chunk_map.size;
+  if (G_UNLIKELY (size < 6)) {
     *skipsize = 1;
     goto cleanup;
   }
 
-  gst_byte_reader_init (&reader, map.data, map.size);
+  gst_chunk_byte_reader_init (&reader, mp3parse->chunk_map.chunks,
+      mp3parse->chunk_map.n_chunks);
 
-  off = gst_byte_reader_masked_scan_uint32 (&reader, 0xffe00000, 0xffe00000,
-      0, map.size);
+  off = gst_chunk_byte_reader_masked_scan_uint32 (&reader, 0xffe00000,
+      0xffe00000, 0, size, NULL);
 
   GST_LOG_OBJECT (parse, "possible sync at buffer offset %d", off);
 
   /* didn't find anything that looks like a sync word, skip */
   if (off < 0) {
-    *skipsize = map.size - 3;
+    *skipsize = size - 3;
     goto cleanup;
   }
 
@@ -746,7 +758,7 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
   }
 
   /* make sure the values in the frame header look sane */
-  header = GST_READ_UINT32_BE (map.data);
+  gst_chunk_byte_reader_peek_uint32_be (&reader, &header);
   if (!gst_mpeg_audio_parse_head_check (mp3parse, header)) {
     *skipsize = 1;
     goto cleanup;
@@ -775,7 +787,7 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
     GST_LOG_OBJECT (mp3parse, "possibly free format");
     if (lost_sync || mp3parse->freerate == 0) {
       GST_DEBUG_OBJECT (mp3parse, "finding free format rate");
-      if (!gst_mp3parse_find_freerate (mp3parse, &map, header, draining,
+      if (!gst_mp3parse_find_freerate (mp3parse, &reader, header, draining,
               &valid)) {
         /* not enough data */
         gst_base_parse_set_min_frame_size (parse, valid);
@@ -797,8 +809,8 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
   }
 
   if (!draining && (lost_sync || caps_change)) {
-    if (!gst_mp3parse_validate_extended (mp3parse, buf, header, bpf, draining,
-            &valid)) {
+    if (!gst_mp3parse_validate_extended (mp3parse, &reader, header, bpf,
+            draining, &valid)) {
       /* not enough data */
       gst_base_parse_set_min_frame_size (parse, valid);
       *skipsize = 0;
@@ -819,7 +831,7 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
   gst_base_parse_set_min_frame_size (parse, MIN_FRAME_SIZE);
 
   /* output one frame if we have enough data */
-  res = bpf <= map.size;
+  res = bpf <= size;
 
   /* metadata handling */
   if (G_UNLIKELY (caps_change)) {
@@ -901,7 +913,7 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
    * (sent_codec_tag is TRUE after this Xing frame got parsed.) */
   if (G_LIKELY (mp3parse->sent_codec_tag)) {
     if (G_UNLIKELY (gst_mpeg_audio_parse_check_if_is_xing_header_frame
-            (mp3parse, buf))) {
+            (mp3parse, &reader))) {
       GST_DEBUG_OBJECT (mp3parse, "This is a Xing header frame, which "
           "contains no meaningful audio data, and can be safely dropped");
       mp3parse->outgoing_frame_is_xing_header = TRUE;
@@ -912,7 +924,7 @@ gst_mpeg_audio_parse_handle_frame (GstBaseParse * parse,
   gst_mpeg_audio_parse_handle_first_frame (mp3parse, buf);
 
 cleanup:
-  gst_buffer_unmap (buf, &map);
+  gst_chunk_map_unmap (&mp3parse->chunk_map);
 
   /* We don't actually drop the frame right here, but rather in
    * gst_mpeg_audio_parse_pre_push_frame (), since it is still important
@@ -934,7 +946,7 @@ cleanup:
 
 static gboolean
 gst_mpeg_audio_parse_check_if_is_xing_header_frame (GstMpegAudioParse *
-    mp3parse, GstBuffer * buf)
+    mp3parse, GstChunkByteReader * reader)
 {
   /* TODO: get rid of code duplication
    * (see gst_mpeg_audio_parse_handle_first_frame ()) */
@@ -943,9 +955,6 @@ gst_mpeg_audio_parse_check_if_is_xing_header_frame (GstMpegAudioParse *
   const guint32 info_id = 0x496e666f;   /* 'Info' in hex - found in LAME CBR files */
 
   gint offset_xing;
-  GstMapInfo map;
-  guint8 *data;
-  guint64 avail;
   guint32 read_id_xing = 0;
   gboolean ret = FALSE;
 
@@ -966,17 +975,11 @@ gst_mpeg_audio_parse_check_if_is_xing_header_frame (GstMpegAudioParse *
   offset_xing += 4;
 
   /* Check if we have enough data to read the Xing header */
-  gst_buffer_map (buf, &map, GST_MAP_READ);
-  data = map.data;
-  avail = map.size;
-
-  if (avail >= offset_xing + 4) {
-    read_id_xing = GST_READ_UINT32_BE (data + offset_xing);
+  if (gst_chunk_byte_reader_set_pos (reader, offset_xing) &&
+      gst_chunk_byte_reader_peek_uint32_be (reader, &read_id_xing)) {
     ret = (read_id_xing == xing_id || read_id_xing == info_id);
   }
 
-  gst_buffer_unmap (buf, &map);
-
   return ret;
 }
 
@@ -25,6 +25,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstbaseparse.h>
+#include <gst/base/gstchunkreader.h>
 
 G_BEGIN_DECLS
 
@@ -113,6 +114,9 @@ struct _GstMpegAudioParse {
   GstClockTime start_padding_time;
   GstClockTime end_padding_time;
   GstClockTime total_padding_time;
+
+  /* memories of the frame currently being parsed */
+  GstChunkMap  chunk_map;
 };
 
 /**
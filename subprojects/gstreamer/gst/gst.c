@@ -127,6 +127,7 @@ void gst_init_static_plugins ();
 #include <locale.h>             /* for LC_ALL */
 
 #include "gst.h"
+#include "gstmagazine-private.h"
 
 #define GST_CAT_DEFAULT GST_CAT_GST_INIT
 
@@ -662,6 +663,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   }
 
   _priv_gst_mini_object_initialize ();
+  _priv_gst_magazine_initialize ();
   _priv_gst_allocator_initialize ();
   _priv_gst_memory_initialize ();
   _priv_gst_format_initialize ();
@@ -1126,7 +1128,9 @@ gst_deinit (void)
   gst_object_unref (clock);
   gst_clear_object (&clock);
 
+  _priv_gst_element_factory_index_cleanup ();
   _priv_gst_registry_cleanup ();
+  priv_gst_registry_binary_cleanup ();
   _priv_gst_allocator_cleanup ();
 
   /* We want to destroy tracers as late as possible for the leaks tracer
@@ -1139,6 +1143,7 @@ gst_deinit (void)
   _priv_gst_caps_features_cleanup ();
   _priv_gst_caps_cleanup ();
   _priv_gst_meta_cleanup ();
+  _priv_gst_magazine_cleanup ();
 
   g_type_class_unref (g_type_class_peek (gst_object_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_pad_get_type ()));
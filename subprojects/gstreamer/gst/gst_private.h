@@ -142,6 +142,7 @@ G_GNUC_INTERNAL  void  _priv_gst_allocator_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_debug_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_element_factory_index_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_meta_cleanup (void);
 
 G_GNUC_INTERNAL  void  _priv_gst_object_call_async (GstObject * object,
@@ -214,6 +215,9 @@ gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const cha
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_write_cache	(GstRegistry * registry, GList * plugins, const char *location);
 
+G_GNUC_INTERNAL
+void			priv_gst_registry_binary_cleanup	(void);
+
 
 G_GNUC_INTERNAL
 void      __gst_element_factory_add_static_pad_template (GstElementFactory    * elementfactory,
@@ -430,10 +434,19 @@ struct _GstTypeFindFactory {
   GstTypeFindFunction           function;
   gchar **                      extensions;
   GstCaps *                     caps;
+  /* caps string in the mapped registry cache, parsed into caps on first
+   * use */
+  const gchar *                 caps_string;
 
   gpointer                      user_data;
   GDestroyNotify                user_data_notify;
 
+  /* bytes that must be present at signature_offset for the function to
+   * suggest anything, only known once the plugin is loaded */
+  guint8 *                      signature;
+  guint                         signature_size;
+  guint64                       signature_offset;
+
   gpointer _gst_reserved[GST_PADDING];
 };
 
@@ -471,6 +484,9 @@ struct _GstElementFactory {
   GType                 type;                   /* unique GType of element or 0 if not loaded */
 
   gpointer              metadata;
+  /* metadata string in the mapped registry cache, parsed into metadata on
+   * first use */
+  const gchar *         metadata_string;
 
   GList *               staticpadtemplates;     /* GstStaticPadTemplate list */
   guint                 numpadtemplates;
@@ -499,6 +515,8 @@ struct _GstDeviceProviderFactory {
 
   GstDeviceProvider         *provider;
   gpointer                   metadata;
+  /* metadata string in the mapped registry cache, see GstElementFactory */
+  const gchar *              metadata_string;
 
   gpointer _gst_reserved[GST_PADDING];
 };
@@ -47,8 +47,21 @@
 
 #include "gst_private.h"
 #include "glib-compat-private.h"
+#include "gstmagazine-private.h"
 #include "gstmemory.h"
 
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H)
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_MAPPED_SYSMEM 1
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
 
@@ -370,11 +383,36 @@ typedef struct
 
   gpointer user_data;
   GDestroyNotify notify;
+
+  /* size of the allocation holding this struct (and the data when allocated
+   * in one block) */
+  gsize slice_size;
+  /* allocated with mmap() instead of malloc() */
+  gboolean mapped;
 } GstMemorySystem;
 
+typedef enum
+{
+  SYSMEM_HUGE_PAGES_NONE,
+  SYSMEM_HUGE_PAGES_TRANSPARENT,
+  SYSMEM_HUGE_PAGES_EXPLICIT,
+} SysmemHugePages;
+
+#define SYSMEM_NUMA_NODE_NONE  -1
+#define SYSMEM_NUMA_NODE_LOCAL -2
+
+/* blocks of at least this size are mapped directly when huge pages or a
+ * NUMA node are configured, smaller ones can't use huge pages anyway */
+#define SYSMEM_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
 typedef struct
 {
   GstAllocator parent;
+
+  SysmemHugePages huge_pages;
+  /* node to prefer for mapped blocks, a node number or one of
+   * SYSMEM_NUMA_NODE_* */
+  gint numa_node;
 } GstAllocatorSysmem;
 
 typedef struct
@@ -387,41 +425,138 @@ G_DEFINE_TYPE (GstAllocatorSysmem, gst_allocator_sysmem, GST_TYPE_ALLOCATOR);
 
 /* initialize the fields */
 static inline void
-_sysmem_init (GstMemorySystem * mem, GstMemoryFlags flags,
-    GstMemory * parent,
+_sysmem_init (GstMemorySystem * mem, GstAllocator * allocator,
+    GstMemoryFlags flags, GstMemory * parent,
     gpointer data, gsize maxsize, gsize align, gsize offset, gsize size,
     gpointer user_data, GDestroyNotify notify)
 {
   gst_memory_init (GST_MEMORY_CAST (mem),
-      flags, _sysmem_allocator, parent, maxsize, align, offset, size);
+      flags, allocator, parent, maxsize, align, offset, size);
 
   mem->data = data;
   mem->user_data = user_data;
   mem->notify = notify;
+  mem->mapped = FALSE;
 }
 
 /* create a new memory block that manages the given memory */
 static inline GstMemorySystem *
-_sysmem_new (GstMemoryFlags flags,
+_sysmem_new (GstAllocator * allocator, GstMemoryFlags flags,
     GstMemory * parent, gpointer data, gsize maxsize, gsize align, gsize offset,
     gsize size, gpointer user_data, GDestroyNotify notify)
 {
   GstMemorySystem *mem;
 
-  mem = g_new (GstMemorySystem, 1);
-  _sysmem_init (mem, flags, parent,
+  mem = _priv_gst_magazine_alloc (sizeof (GstMemorySystem));
+  _sysmem_init (mem, allocator, flags, parent,
       data, maxsize, align, offset, size, user_data, notify);
+  mem->slice_size = sizeof (GstMemorySystem);
 
   return mem;
 }
 
+#ifdef HAVE_MAPPED_SYSMEM
+static void
+_sysmem_prefer_numa_node (gpointer data, gsize size, gint node)
+{
+#ifdef SYS_mbind
+  unsigned long nodemask;
+
+  if (node == SYSMEM_NUMA_NODE_LOCAL) {
+    unsigned int cpu, local_node;
+
+    if (syscall (SYS_getcpu, &cpu, &local_node, NULL) != 0)
+      return;
+    node = local_node;
+  }
+
+  if (node < 0 || (guint) node >= sizeof (nodemask) * 8)
+    return;
+
+  /* only a preference, the kernel falls back to other nodes when this one
+   * is out of memory. Must be done before the pages are first touched. */
+  nodemask = 1UL << node;
+  if (syscall (SYS_mbind, data, size, MPOL_PREFERRED, &nodemask,
+          sizeof (nodemask) * 8, 0) != 0) {
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "could not bind %p to NUMA node %d: %s",
+        data, node, g_strerror (errno));
+  }
+#endif
+}
+
+/* Maps @size bytes for a large block directly from the kernel, backed by
+ * huge pages and on the configured NUMA node where possible. Updates @size
+ * to the size of the mapping. Returns %NULL if the block is too small or
+ * nothing needs to be configured, the caller then uses the normal path. */
+static gpointer
+_sysmem_map_block (GstAllocatorSysmem * allocator, gsize * size)
+{
+  gsize map_size;
+  guint8 *data = MAP_FAILED;
+
+  if (allocator->huge_pages == SYSMEM_HUGE_PAGES_NONE &&
+      allocator->numa_node == SYSMEM_NUMA_NODE_NONE)
+    return NULL;
+
+  if (*size < SYSMEM_HUGE_PAGE_SIZE
+      || *size > G_MAXSIZE - 2 * SYSMEM_HUGE_PAGE_SIZE)
+    return NULL;
+
+  map_size = GST_ROUND_UP_N (*size, SYSMEM_HUGE_PAGE_SIZE);
+
+#ifdef MAP_HUGETLB
+  if (allocator->huge_pages == SYSMEM_HUGE_PAGES_EXPLICIT) {
+    data = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data == MAP_FAILED)
+      GST_CAT_DEBUG (GST_CAT_MEMORY, "no explicit huge pages available for "
+          "%" G_GSIZE_FORMAT " bytes: %s", map_size, g_strerror (errno));
+  }
+#endif
+
+  if (data == MAP_FAILED) {
+    gsize head;
+
+    /* transparent huge pages can only back huge page aligned ranges, so map
+     * one more and trim the unaligned head and tail */
+    data = mmap (NULL, map_size + SYSMEM_HUGE_PAGE_SIZE,
+        PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      GST_CAT_WARNING (GST_CAT_MEMORY, "could not map %" G_GSIZE_FORMAT
+          " bytes: %s", map_size, g_strerror (errno));
+      return NULL;
+    }
+
+    head = GST_ROUND_UP_N ((guintptr) data, SYSMEM_HUGE_PAGE_SIZE) -
+        (guintptr) data;
+    if (head)
+      munmap (data, head);
+    munmap (data + head + map_size, SYSMEM_HUGE_PAGE_SIZE - head);
+    data += head;
+
+#ifdef MADV_HUGEPAGE
+    if (allocator->huge_pages != SYSMEM_HUGE_PAGES_NONE)
+      madvise (data, map_size, MADV_HUGEPAGE);
+#endif
+  }
+
+  if (allocator->numa_node != SYSMEM_NUMA_NODE_NONE)
+    _sysmem_prefer_numa_node (data, map_size, allocator->numa_node);
+
+  *size = map_size;
+
+  return data;
+}
+#endif
+
 /* allocate the memory and structure in one block */
 static GstMemorySystem *
-_sysmem_new_block (GstMemoryFlags flags,
+_sysmem_new_block (GstAllocator * allocator, GstMemoryFlags flags,
     gsize maxsize, gsize align, gsize offset, gsize size)
 {
   GstMemorySystem *mem;
   gsize aoffset, slice_size, padding;
+  gboolean mapped = FALSE;
   guint8 *data;
 
   /* ensure configured alignment */
@@ -443,7 +578,13 @@ _sysmem_new_block (GstMemoryFlags flags,
   }
   slice_size = sizeof (GstMemorySystem) + maxsize;
 
-  mem = g_malloc (slice_size);
+#ifdef HAVE_MAPPED_SYSMEM
+  mem = _sysmem_map_block ((GstAllocatorSysmem *) allocator, &slice_size);
+  if (mem)
+    mapped = TRUE;
+  else
+#endif
+    mem = _priv_gst_magazine_alloc (slice_size);
   if (mem == NULL)
     return NULL;
 
@@ -463,8 +604,10 @@ _sysmem_new_block (GstMemoryFlags flags,
   if (padding && (flags & GST_MEMORY_FLAG_ZERO_PADDED))
     memset (data + offset + size, 0, padding);
 
-  _sysmem_init (mem, flags, NULL, data, maxsize,
+  _sysmem_init (mem, allocator, flags, NULL, data, maxsize,
       align, offset, size, NULL, NULL);
+  mem->slice_size = slice_size;
+  mem->mapped = mapped;
 
   return mem;
 }
@@ -489,7 +632,8 @@ _sysmem_copy (GstMemorySystem * mem, gssize offset, gsize size)
   if (size == -1)
     size = mem->mem.size > offset ? mem->mem.size - offset : 0;
 
-  copy = _sysmem_new_block (0, size, mem->mem.align, 0, size);
+  copy = _sysmem_new_block (mem->mem.allocator, 0, size, mem->mem.align, 0,
+      size);
   if (!copy)
     return NULL;
   GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
@@ -514,7 +658,7 @@ _sysmem_share (GstMemorySystem * mem, gssize offset, gsize size)
 
   /* the shared memory is always readonly */
   sub =
-      _sysmem_new (GST_MINI_OBJECT_FLAGS (parent) |
+      _sysmem_new (mem->mem.allocator, GST_MINI_OBJECT_FLAGS (parent) |
       GST_MINI_OBJECT_FLAG_LOCK_READONLY, parent, mem->data, mem->mem.maxsize,
       mem->mem.align, mem->mem.offset + offset, size, NULL, NULL);
 
@@ -544,7 +688,7 @@ default_alloc (GstAllocator * allocator, gsize size,
 {
   gsize maxsize = size + params->prefix + params->padding;
 
-  return (GstMemory *) _sysmem_new_block (params->flags,
+  return (GstMemory *) _sysmem_new_block (allocator, params->flags,
       maxsize, params->align, params->prefix, size);
 }
 
@@ -552,6 +696,8 @@ static void
 default_free (GstAllocator * allocator, GstMemory * mem)
 {
   GstMemorySystem *dmem = (GstMemorySystem *) mem;
+  gsize slice_size = dmem->slice_size;
+  gboolean mapped = dmem->mapped;
 
   if (dmem->notify)
     dmem->notify (dmem->user_data);
@@ -561,7 +707,14 @@ default_free (GstAllocator * allocator, GstMemory * mem)
   memset (mem, 0xff, sizeof (GstMemorySystem));
 #endif
 
-  g_free (mem);
+#ifdef HAVE_MAPPED_SYSMEM
+  if (mapped) {
+    munmap (mem, slice_size);
+    return;
+  }
+#endif
+
+  _priv_gst_magazine_free (mem, slice_size);
 }
 
 static void
@@ -602,11 +755,44 @@ gst_allocator_sysmem_init (GstAllocatorSysmem * allocator)
   alloc->mem_copy = (GstMemoryCopyFunction) _sysmem_copy;
   alloc->mem_share = (GstMemoryShareFunction) _sysmem_share;
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
+
+  allocator->huge_pages = SYSMEM_HUGE_PAGES_NONE;
+  allocator->numa_node = SYSMEM_NUMA_NODE_NONE;
+}
+
+/* Reads GST_SYSMEM_HUGE_PAGES and GST_SYSMEM_NUMA_NODE, leaves the values
+ * untouched if the variables are not set */
+static void
+_sysmem_read_env (SysmemHugePages * huge_pages, gint * numa_node)
+{
+  const gchar *env;
+
+  env = g_getenv ("GST_SYSMEM_HUGE_PAGES");
+  if (env) {
+    if (!strcmp (env, "explicit"))
+      *huge_pages = SYSMEM_HUGE_PAGES_EXPLICIT;
+    else if (!strcmp (env, "transparent") || !strcmp (env, "1"))
+      *huge_pages = SYSMEM_HUGE_PAGES_TRANSPARENT;
+    else
+      *huge_pages = SYSMEM_HUGE_PAGES_NONE;
+  }
+
+  env = g_getenv ("GST_SYSMEM_NUMA_NODE");
+  if (env) {
+    if (!strcmp (env, "local"))
+      *numa_node = SYSMEM_NUMA_NODE_LOCAL;
+    else if (g_ascii_isdigit (*env))
+      *numa_node = atoi (env);
+    else
+      *numa_node = SYSMEM_NUMA_NODE_NONE;
+  }
 }
 
 void
 _priv_gst_allocator_initialize (void)
 {
+  GstAllocatorSysmem *sysmem;
+
   g_rw_lock_init (&lock);
   allocators = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
       gst_object_unref);
@@ -625,9 +811,25 @@ _priv_gst_allocator_initialize (void)
   /* Clear floating flag */
   gst_object_ref_sink (_sysmem_allocator);
 
+  sysmem = (GstAllocatorSysmem *) _sysmem_allocator;
+  _sysmem_read_env (&sysmem->huge_pages, &sysmem->numa_node);
+
   gst_allocator_register (GST_ALLOCATOR_SYSMEM,
       gst_object_ref (_sysmem_allocator));
 
+  /* same memory, but large blocks always use huge pages and the node of
+   * the allocating thread unless configured otherwise */
+  sysmem = g_object_new (gst_allocator_sysmem_get_type (), NULL);
+  gst_object_ref_sink (sysmem);
+  sysmem->huge_pages = SYSMEM_HUGE_PAGES_TRANSPARENT;
+  sysmem->numa_node = SYSMEM_NUMA_NODE_LOCAL;
+  _sysmem_read_env (&sysmem->huge_pages, &sysmem->numa_node);
+  if (sysmem->huge_pages == SYSMEM_HUGE_PAGES_NONE)
+    sysmem->huge_pages = SYSMEM_HUGE_PAGES_TRANSPARENT;
+
+  gst_allocator_register (GST_ALLOCATOR_SYSMEM_HUGE_PAGES,
+      GST_ALLOCATOR_CAST (sysmem));
+
   _default_allocator = gst_object_ref (_sysmem_allocator);
 }
 
@@ -672,8 +874,8 @@ gst_memory_new_wrapped (GstMemoryFlags flags, gpointer data,
   g_return_val_if_fail (offset + size <= maxsize, NULL);
 
   mem =
-      _sysmem_new (flags, NULL, data, maxsize, 0, offset, size, user_data,
-      notify);
+      _sysmem_new (_sysmem_allocator, flags, NULL, data, maxsize, 0, offset,
+      size, user_data, notify);
 
   return (GstMemory *) mem;
 }
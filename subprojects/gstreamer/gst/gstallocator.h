@@ -62,6 +62,20 @@ GST_API gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_SYSMEM_HUGE_PAGES:
+ *
+ * The allocator name for a system memory allocator that backs large blocks
+ * with huge pages and prefers the NUMA node of the allocating thread. The
+ * memory it allocates is of type %GST_ALLOCATOR_SYSMEM.
+ *
+ * On systems without huge page or NUMA support it behaves like the default
+ * system memory allocator.
+ *
+ * Since: 1.30
+ */
+#define GST_ALLOCATOR_SYSMEM_HUGE_PAGES   "SystemMemoryHugePages"
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
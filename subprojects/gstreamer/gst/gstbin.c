@@ -172,6 +172,9 @@ struct _GstBinPrivate
   gboolean posted_eos;
   gboolean posted_playing;
   GstElementFlags suppressed_flags;
+
+  /* change the state of unlinked groups of children concurrently */
+  gboolean parallel_state_changes;
 };
 
 typedef struct
@@ -246,12 +249,18 @@ enum
 
 #define DEFAULT_ASYNC_HANDLING	FALSE
 #define DEFAULT_MESSAGE_FORWARD	FALSE
+#define DEFAULT_PARALLEL_STATE_CHANGES	FALSE
+
+/* maximum number of threads that are used in addition to the thread calling
+ * gst_element_set_state() to change the state of independent children */
+#define MAX_PARALLEL_STATE_CHANGE_THREADS 32
 
 enum
 {
   PROP_0,
   PROP_ASYNC_HANDLING,
   PROP_MESSAGE_FORWARD,
+  PROP_PARALLEL_STATE_CHANGES,
   PROP_LAST
 };
 
@@ -445,6 +454,26 @@ gst_bin_class_init (GstBinClass * klass)
           "Forwards all children messages",
           DEFAULT_MESSAGE_FORWARD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBin:parallel-state-changes:
+   *
+   * Change the state of independent groups of children concurrently.
+   *
+   * Children that are linked to each other, directly or through other
+   * children of the bin, form a group whose state is changed in the usual
+   * sink to source order. When the bin contains several groups that are not
+   * linked to each other, for example one branch per camera in a recording
+   * bin, the groups are handed to worker threads so that slow state changes
+   * in one branch do not delay the others.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_STATE_CHANGES,
+      g_param_spec_boolean ("parallel-state-changes", "Parallel State Changes",
+          "Change the state of unlinked groups of children concurrently",
+          DEFAULT_PARALLEL_STATE_CHANGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_bin_dispose;
 
   gst_element_class_set_static_metadata (gstelement_class, "Generic bin",
@@ -504,6 +533,7 @@ gst_bin_init (GstBin * bin)
   bin->priv->asynchandling = DEFAULT_ASYNC_HANDLING;
   bin->priv->structure_cookie = 0;
   bin->priv->message_forward = DEFAULT_MESSAGE_FORWARD;
+  bin->priv->parallel_state_changes = DEFAULT_PARALLEL_STATE_CHANGES;
 }
 
 static void
@@ -567,6 +597,11 @@ gst_bin_set_property (GObject * object, guint prop_id,
       gstbin->priv->message_forward = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_state_changes = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -592,6 +627,11 @@ gst_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, gstbin->priv->message_forward);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->parallel_state_changes);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2815,6 +2855,327 @@ reset_state (const GValue * data, gpointer user_data)
         gst_state_get_name (state));
 }
 
+/* children of a bin that are linked to each other, in state change order */
+typedef struct
+{
+  GPtrArray *children;
+  gboolean have_async;
+  gboolean have_no_preroll;
+} BinStateChangeGroup;
+
+typedef struct
+{
+  gint refcount;
+
+  GstBin *bin;
+  GstClockTime base_time;
+  GstClockTime start_time;
+  GstState current;
+  GstState next;
+
+  GMutex lock;
+  GCond cond;
+  /* protected by lock */
+  GPtrArray *groups;
+  guint next_group;
+  guint n_running;
+  gboolean failed;
+} BinParallelStateChange;
+
+static void
+bin_state_change_group_free (BinStateChangeGroup * group)
+{
+  g_ptr_array_unref (group->children);
+  g_free (group);
+}
+
+static void
+bin_parallel_state_change_unref (BinParallelStateChange * psc)
+{
+  if (!g_atomic_int_dec_and_test (&psc->refcount))
+    return;
+
+  g_ptr_array_unref (psc->groups);
+  g_mutex_clear (&psc->lock);
+  g_cond_clear (&psc->cond);
+  gst_object_unref (psc->bin);
+  g_free (psc);
+}
+
+/* change the state of all children of @group in order. Returns %FALSE when
+ * a child that is still in the bin failed to change state. */
+static gboolean
+bin_state_change_group (BinParallelStateChange * psc,
+    BinStateChangeGroup * group)
+{
+  guint i;
+
+  for (i = 0; i < group->children->len; i++) {
+    GstElement *child = g_ptr_array_index (group->children, i);
+    GstStateChangeReturn ret;
+
+    ret = gst_bin_element_set_state (psc->bin, child, psc->base_time,
+        psc->start_time, psc->current, psc->next);
+
+    switch (ret) {
+      case GST_STATE_CHANGE_SUCCESS:
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, psc->bin,
+            "child '%s' changed state to %d(%s) successfully",
+            GST_ELEMENT_NAME (child), psc->next, gst_state_get_name (psc->next));
+        break;
+      case GST_STATE_CHANGE_ASYNC:
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, psc->bin,
+            "child '%s' is changing state asynchronously to %s",
+            GST_ELEMENT_NAME (child), gst_state_get_name (psc->next));
+        group->have_async = TRUE;
+        break;
+      case GST_STATE_CHANGE_FAILURE:{
+        GstObject *parent;
+
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, psc->bin,
+            "child '%s' failed to go to state %d(%s)",
+            GST_ELEMENT_NAME (child), psc->next, gst_state_get_name (psc->next));
+
+        /* only fail if the child is still inside this bin, see
+         * gst_bin_change_state_func() */
+        parent = gst_object_get_parent (GST_OBJECT_CAST (child));
+        if (parent)
+          gst_object_unref (parent);
+        if (parent == GST_OBJECT_CAST (psc->bin))
+          return FALSE;
+        break;
+      }
+      case GST_STATE_CHANGE_NO_PREROLL:
+        GST_CAT_INFO_OBJECT (GST_CAT_STATES, psc->bin,
+            "child '%s' changed state to %d(%s) successfully without preroll",
+            GST_ELEMENT_NAME (child), psc->next, gst_state_get_name (psc->next));
+        group->have_no_preroll = TRUE;
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  }
+  return TRUE;
+}
+
+/* take groups from the list and change their state until all groups are
+ * handled or one of them failed */
+static void
+bin_parallel_state_change_run (BinParallelStateChange * psc)
+{
+  g_mutex_lock (&psc->lock);
+  while (!psc->failed && psc->next_group < psc->groups->len) {
+    BinStateChangeGroup *group;
+    gboolean res;
+
+    group = g_ptr_array_index (psc->groups, psc->next_group++);
+    psc->n_running++;
+    g_mutex_unlock (&psc->lock);
+
+    res = bin_state_change_group (psc, group);
+
+    g_mutex_lock (&psc->lock);
+    if (!res)
+      psc->failed = TRUE;
+    psc->n_running--;
+  }
+  g_cond_broadcast (&psc->cond);
+  g_mutex_unlock (&psc->lock);
+}
+
+static void
+bin_parallel_state_change_func (GstObject * object,
+    BinParallelStateChange * psc)
+{
+  bin_parallel_state_change_run (psc);
+  bin_parallel_state_change_unref (psc);
+}
+
+/* union-find over the children of a bin, the root of a child is the first
+ * child of its group found in state change order */
+static GstElement *
+bin_group_find_root (GHashTable * roots, GstElement * element)
+{
+  GstElement *root = element, *parent;
+
+  while ((parent = g_hash_table_lookup (roots, root)) != root)
+    root = parent;
+
+  /* point everything on the path directly to the root */
+  while (element != root) {
+    parent = g_hash_table_lookup (roots, element);
+    g_hash_table_insert (roots, element, root);
+    element = parent;
+  }
+  return root;
+}
+
+/* merge the group of @element with the groups of the children it is linked
+ * to on its sinkpads. Only elements in @roots are children of the bin. */
+static void
+bin_group_merge_peers (GstElement * element, GHashTable * roots)
+{
+  GList *pads;
+
+  GST_OBJECT_LOCK (element);
+  for (pads = element->sinkpads; pads; pads = g_list_next (pads)) {
+    GstPad *peer;
+    GstElement *peer_element;
+    GstElement *root, *peer_root;
+
+    if (!(peer = gst_pad_get_peer (GST_PAD_CAST (pads->data))))
+      continue;
+
+    peer_element = gst_pad_get_parent_element (peer);
+    gst_object_unref (peer);
+    if (!peer_element)
+      continue;
+
+    /* elements outside of the bin are not part of the state change */
+    if (g_hash_table_contains (roots, peer_element)) {
+      root = bin_group_find_root (roots, element);
+      peer_root = bin_group_find_root (roots, peer_element);
+      if (root != peer_root)
+        g_hash_table_insert (roots, peer_root, root);
+    }
+    gst_object_unref (peer_element);
+  }
+  GST_OBJECT_UNLOCK (element);
+}
+
+/* split the children returned by @it into groups of linked children, keeping
+ * the state change order of @it inside each group. */
+static GPtrArray *
+bin_make_state_change_groups (GstIterator * it)
+{
+  GPtrArray *children, *groups;
+  GHashTable *roots, *group_of;
+  GValue data = { 0, };
+  gboolean done = FALSE;
+  guint i;
+
+  children = g_ptr_array_new_with_free_func (gst_object_unref);
+  while (!done) {
+    switch (gst_iterator_next (it, &data)) {
+      case GST_ITERATOR_OK:
+        g_ptr_array_add (children, g_value_dup_object (&data));
+        g_value_reset (&data);
+        break;
+      case GST_ITERATOR_RESYNC:
+        g_ptr_array_set_size (children, 0);
+        gst_iterator_resync (it);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&data);
+
+  roots = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < children->len; i++) {
+    GstElement *child = g_ptr_array_index (children, i);
+
+    g_hash_table_insert (roots, child, child);
+  }
+
+  for (i = 0; i < children->len; i++)
+    bin_group_merge_peers (g_ptr_array_index (children, i), roots);
+
+  groups = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      bin_state_change_group_free);
+  group_of = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < children->len; i++) {
+    GstElement *child = g_ptr_array_index (children, i);
+    GstElement *root = bin_group_find_root (roots, child);
+    BinStateChangeGroup *group;
+
+    if (!(group = g_hash_table_lookup (group_of, root))) {
+      group = g_new0 (BinStateChangeGroup, 1);
+      group->children = g_ptr_array_new_with_free_func (gst_object_unref);
+      g_hash_table_insert (group_of, root, group);
+      g_ptr_array_add (groups, group);
+    }
+    g_ptr_array_add (group->children, gst_object_ref (child));
+  }
+  g_hash_table_destroy (group_of);
+  g_hash_table_destroy (roots);
+  g_ptr_array_unref (children);
+
+  return groups;
+}
+
+/* change the state of the children returned by @it, handling groups of
+ * children that are not linked to each other on separate threads.
+ *
+ * When there are less than two groups, @it is resynced and nothing is done so
+ * that the caller changes the state of the children sequentially. Otherwise
+ * @it is left exhausted, the caller will still see a RESYNC when the bin
+ * changed while we were busy. */
+static GstStateChangeReturn
+gst_bin_change_state_parallel (GstBin * bin, GstIterator * it,
+    GstClockTime base_time, GstClockTime start_time, GstState current,
+    GstState next, gboolean * have_async, gboolean * have_no_preroll)
+{
+  BinParallelStateChange *psc;
+  GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
+  GPtrArray *groups;
+  guint i, n_threads;
+
+  groups = bin_make_state_change_groups (it);
+  if (groups->len < 2) {
+    g_ptr_array_unref (groups);
+    gst_iterator_resync (it);
+    return GST_STATE_CHANGE_SUCCESS;
+  }
+
+  n_threads = MIN (groups->len - 1, MAX_PARALLEL_STATE_CHANGE_THREADS);
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, bin,
+      "changing state of %u groups of children using %u extra threads",
+      groups->len, n_threads);
+
+  psc = g_new0 (BinParallelStateChange, 1);
+  psc->refcount = 1 + n_threads;
+  psc->bin = gst_object_ref (bin);
+  psc->base_time = base_time;
+  psc->start_time = start_time;
+  psc->current = current;
+  psc->next = next;
+  g_mutex_init (&psc->lock);
+  g_cond_init (&psc->cond);
+  psc->groups = groups;
+
+  for (i = 0; i < n_threads; i++)
+    gst_object_call_async (GST_OBJECT_CAST (bin),
+        (GstObjectCallAsyncFunc) bin_parallel_state_change_func, psc);
+
+  /* help out ourselves so that we never wait for threads that did not get
+   * scheduled yet, then wait for the groups taken by the other threads */
+  bin_parallel_state_change_run (psc);
+
+  g_mutex_lock (&psc->lock);
+  while (psc->n_running > 0)
+    g_cond_wait (&psc->cond, &psc->lock);
+
+  if (psc->failed) {
+    ret = GST_STATE_CHANGE_FAILURE;
+  } else {
+    for (i = 0; i < groups->len; i++) {
+      BinStateChangeGroup *group = g_ptr_array_index (groups, i);
+
+      *have_async |= group->have_async;
+      *have_no_preroll |= group->have_no_preroll;
+    }
+  }
+  g_mutex_unlock (&psc->lock);
+
+  bin_parallel_state_change_unref (psc);
+
+  return ret;
+}
+
 static GstStateChangeReturn
 gst_bin_change_state_func (GstElement * element, GstStateChange transition)
 {
@@ -2825,7 +3186,7 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   gboolean have_no_preroll;
   GstClockTime base_time, start_time;
   GstIterator *it;
-  gboolean done;
+  gboolean done, parallel;
   GValue data = { 0, };
 
   /* we don't need to take the STATE_LOCK, it is already taken */
@@ -2901,6 +3262,7 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
    * don't want them to interfere with this state change */
   GST_OBJECT_LOCK (bin);
   bin->polling = TRUE;
+  parallel = bin->priv->parallel_state_changes;
   GST_OBJECT_UNLOCK (bin);
 
   /* iterate in state change order */
@@ -2919,6 +3281,16 @@ restart:
 
   have_no_preroll = FALSE;
 
+  if (parallel) {
+    /* when the bin changes during the parallel state change, the iterator
+     * makes us resync below and we continue sequentially */
+    parallel = FALSE;
+    ret = gst_bin_change_state_parallel (bin, it, base_time, start_time,
+        current, next, &have_async, &have_no_preroll);
+    if (ret == GST_STATE_CHANGE_FAILURE)
+      goto undo;
+  }
+
   done = FALSE;
   while (!done) {
     switch (gst_iterator_next (it, &data)) {
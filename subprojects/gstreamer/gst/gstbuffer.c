@@ -136,6 +136,7 @@
 
 /* For g_memdup2 */
 #include "glib-compat-private.h"
+#include "gstmagazine-private.h"
 
 GType _gst_buffer_type = 0;
 
@@ -834,13 +835,13 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_free (walk);
+    _priv_gst_magazine_free (walk, ITEM_SIZE (info));
   }
 
 #ifdef USE_POISONING
   memset (buffer, 0xff, sizeof (GstBufferImpl));
 #endif
-  g_free (buffer);
+  _priv_gst_magazine_free (buffer, sizeof (GstBufferImpl));
 }
 
 static void
@@ -874,7 +875,7 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_new (GstBufferImpl, 1);
+  newbuf = _priv_gst_magazine_alloc (sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf);
@@ -2340,10 +2341,9 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
    * init function but let's play safe here and prevent
    * uninitialized memory
    */
+  item = _priv_gst_magazine_alloc (size);
   if (!info->init_func)
-    item = g_malloc0 (size);
-  else
-    item = g_malloc (size);
+    memset (item, 0, size);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2371,7 +2371,7 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
 
 init_failed:
   {
-    g_free (item);
+    _priv_gst_magazine_free (item, size);
     return NULL;
   }
 }
@@ -2422,7 +2422,7 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_free (walk);
+      _priv_gst_magazine_free (walk, ITEM_SIZE (info));
       break;
     }
     prev = walk;
@@ -2570,7 +2570,7 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_free (walk);
+      _priv_gst_magazine_free (walk, ITEM_SIZE (info));
     } else {
       prev = walk;
     }
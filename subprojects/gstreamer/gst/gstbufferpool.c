@@ -70,6 +70,7 @@
 #endif
 #include <sys/types.h>
 
+#include "gstatomicqueue.h"
 #include "gstvecdeque.h"
 #include "gstinfo.h"
 #include "gstvalue.h"
@@ -88,6 +89,10 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+/* number of single-buffer cache slots used in scalable mode, threads are
+ * hashed onto the slots */
+#define SCALABLE_CACHE_SLOTS 16
+
 struct _GstBufferPoolPrivate
 {
   GMutex queue_lock;
@@ -109,6 +114,13 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* scalable mode: lock-free free list plus per-thread cache slots. The
+   * queue_lock is only taken when there are waiters */
+  gboolean scalable;
+  GstAtomicQueue *free_queue;
+  gpointer cache[SCALABLE_CACHE_SLOTS]; /* ATOMIC */
+  gint waiters;                         /* ATOMIC */
 };
 
 static void gst_buffer_pool_dispose (GObject * object);
@@ -159,6 +171,7 @@ gst_buffer_pool_init (GstBufferPool * pool)
   g_rec_mutex_init (&priv->rec_lock);
 
   priv->queue = gst_vec_deque_new (16);
+  priv->free_queue = gst_atomic_queue_new (16);
   g_mutex_init (&priv->queue_lock);
   g_cond_init (&priv->queue_cond);
 
@@ -205,6 +218,7 @@ gst_buffer_pool_finalize (GObject * object)
   GST_DEBUG_OBJECT (pool, "%p finalize", pool);
 
   gst_vec_deque_free (priv->queue);
+  gst_atomic_queue_unref (priv->free_queue);
   g_mutex_clear (&priv->queue_lock);
   g_cond_clear (&priv->queue_cond);
   gst_structure_free (priv->config);
@@ -234,6 +248,79 @@ gst_buffer_pool_new (void)
   return result;
 }
 
+static inline guint
+scalable_cache_slot (void)
+{
+  guintptr id = (guintptr) g_thread_self ();
+
+  return (((guint32) (id >> 4) * 2654435761u) >> 16) % SCALABLE_CACHE_SLOTS;
+}
+
+/* get a free buffer in scalable mode. First try the cache slot of the
+ * current thread, then the shared free list and finally steal from the slots
+ * of the other threads */
+static GstBuffer *
+scalable_pop (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer;
+  guint i, slot;
+
+  slot = scalable_cache_slot ();
+  for (i = 0; i < SCALABLE_CACHE_SLOTS; i++) {
+    gpointer *cache = &priv->cache[(slot + i) % SCALABLE_CACHE_SLOTS];
+
+    buffer = g_atomic_pointer_get (cache);
+    if (buffer && g_atomic_pointer_compare_and_exchange (cache, buffer, NULL))
+      return buffer;
+
+    if (i == 0 && (buffer = gst_atomic_queue_pop (priv->free_queue)))
+      return buffer;
+  }
+  return NULL;
+}
+
+static void
+scalable_push (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (!g_atomic_pointer_compare_and_exchange (&priv->cache[scalable_cache_slot
+              ()], NULL, buffer))
+    gst_atomic_queue_push (priv->free_queue, buffer);
+}
+
+static gboolean
+scalable_has_free (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i;
+
+  if (gst_atomic_queue_length (priv->free_queue) > 0)
+    return TRUE;
+
+  for (i = 0; i < SCALABLE_CACHE_SLOTS; i++) {
+    if (g_atomic_pointer_get (&priv->cache[i]))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+/* wake up a thread waiting for a free buffer. Only takes the lock when
+ * someone is actually waiting in scalable mode */
+static inline void
+wake_waiter (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (priv->scalable && g_atomic_int_get (&priv->waiters) == 0)
+    return;
+
+  g_mutex_lock (&priv->queue_lock);
+  g_cond_signal (&priv->queue_cond);
+  g_mutex_unlock (&priv->queue_lock);
+}
+
 static GstFlowReturn
 default_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -396,9 +483,7 @@ do_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (G_LIKELY (pclass->free_buffer))
     pclass->free_buffer (pool, buffer);
 
-  g_mutex_lock (&priv->queue_lock);
-  g_cond_signal (&priv->queue_cond);
-  g_mutex_unlock (&priv->queue_lock);
+  wake_waiter (pool);
 }
 
 /* must be called with the lock */
@@ -410,6 +495,11 @@ default_stop (GstBufferPool * pool)
   gboolean cleared;
 
   /* clear the pool */
+  while ((buffer = scalable_pop (pool))) {
+    GST_TRACER_POOL_BUFFER_DEQUEUED (pool, buffer);
+    do_free_buffer (pool, buffer);
+  }
+
   g_mutex_lock (&priv->queue_lock);
   while ((buffer = gst_vec_deque_pop_head (priv->queue))) {
     g_mutex_unlock (&priv->queue_lock);
@@ -614,6 +704,7 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   priv->min_buffers = min_buffers;
   priv->max_buffers = max_buffers;
   priv->cur_buffers = 0;
+  priv->scalable = gst_buffer_pool_config_get_scalable (config);
 
   if (priv->allocator)
     gst_object_unref (priv->allocator);
@@ -1092,6 +1183,109 @@ gst_buffer_pool_config_validate_params (GstStructure * config, GstCaps * caps,
   return ret;
 }
 
+/**
+ * gst_buffer_pool_config_set_scalable:
+ * @config: a #GstBufferPool configuration
+ * @scalable: whether to enable the scalable mode
+ *
+ * Configures the default acquire and release implementation to use a
+ * lock-free free list with per-thread cache slots instead of a single locked
+ * queue. In this mode releasing a buffer only takes a lock when another thread
+ * is waiting for a free buffer, which scales better when many threads release
+ * buffers into the same pool.
+ *
+ * Buffers are not handed out in FIFO order in this mode, the thread that
+ * released a buffer is likely to get the same buffer back.
+ *
+ * Since: 1.30
+ */
+void
+gst_buffer_pool_config_set_scalable (GstStructure * config, gboolean scalable)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_set (config, "scalable", G_TYPE_BOOLEAN, scalable, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_scalable:
+ * @config: a #GstBufferPool configuration
+ *
+ * Checks if the scalable mode was enabled in @config with
+ * gst_buffer_pool_config_set_scalable().
+ *
+ * Returns: %TRUE if the scalable mode is enabled.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_buffer_pool_config_get_scalable (GstStructure * config)
+{
+  gboolean scalable = FALSE;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  gst_structure_get_boolean (config, "scalable", &scalable);
+
+  return scalable;
+}
+
+static GstFlowReturn
+scalable_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
+    GstBufferPoolAcquireParams * params)
+{
+  GstFlowReturn result;
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  while (TRUE) {
+    if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
+      goto flushing;
+
+    if (G_LIKELY ((*buffer = scalable_pop (pool)))) {
+      GST_TRACER_POOL_BUFFER_DEQUEUED (pool, *buffer);
+      GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
+      return GST_FLOW_OK;
+    }
+
+    /* no buffer, try to allocate some more */
+    GST_LOG_OBJECT (pool, "no buffer, trying to allocate");
+    result = do_alloc_buffer (pool, buffer, params);
+    if (G_LIKELY (result == GST_FLOW_OK))
+      break;
+
+    if (G_UNLIKELY (result != GST_FLOW_EOS))
+      break;
+
+    if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT)) {
+      GST_LOG_OBJECT (pool, "no more buffers");
+      break;
+    }
+
+    /* announce ourselves before checking again so that releasers either see
+     * us waiting or we see their buffer */
+    g_atomic_int_inc (&priv->waiters);
+    g_mutex_lock (&priv->queue_lock);
+    while (!scalable_has_free (pool)
+        && !GST_BUFFER_POOL_IS_FLUSHING (pool)
+        && g_atomic_int_get (&priv->cur_buffers) >= priv->max_buffers) {
+      GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
+      g_cond_wait (&priv->queue_cond, &priv->queue_lock);
+      GST_LOG_OBJECT (pool, "waited for free buffers or flushing");
+    }
+    g_mutex_unlock (&priv->queue_lock);
+    g_atomic_int_add (&priv->waiters, -1);
+  }
+
+  return result;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (pool, "we are flushing");
+    return GST_FLOW_FLUSHING;
+  }
+}
+
 static GstFlowReturn
 default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
@@ -1099,6 +1293,9 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
 
+  if (priv->scalable)
+    return scalable_acquire_buffer (pool, buffer, params);
+
   g_mutex_lock (&priv->queue_lock);
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
@@ -1292,10 +1489,15 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
     goto not_writable;
 
   /* keep it around in our queue */
-  g_mutex_lock (&pool->priv->queue_lock);
-  gst_vec_deque_push_tail (pool->priv->queue, buffer);
-  g_cond_signal (&pool->priv->queue_cond);
-  g_mutex_unlock (&pool->priv->queue_lock);
+  if (pool->priv->scalable) {
+    scalable_push (pool, buffer);
+    wake_waiter (pool);
+  } else {
+    g_mutex_lock (&pool->priv->queue_lock);
+    gst_vec_deque_push_tail (pool->priv->queue, buffer);
+    g_cond_signal (&pool->priv->queue_cond);
+    g_mutex_unlock (&pool->priv->queue_lock);
+  }
 
   GST_TRACER_POOL_BUFFER_QUEUED (pool, buffer);
 
@@ -1323,10 +1525,7 @@ not_writable:
 discard:
   {
     do_free_buffer (pool, buffer);
-
-    g_mutex_lock (&pool->priv->queue_lock);
-    g_cond_signal (&pool->priv->queue_cond);
-    g_mutex_unlock (&pool->priv->queue_lock);
+    wake_waiter (pool);
     return;
   }
 }
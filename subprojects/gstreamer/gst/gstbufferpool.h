@@ -339,6 +339,12 @@ GST_API
 gboolean         gst_buffer_pool_config_validate_params (GstStructure *config, GstCaps *caps,
                                                          guint size, guint min_buffers, guint max_buffers);
 
+GST_API
+void             gst_buffer_pool_config_set_scalable (GstStructure *config, gboolean scalable);
+
+GST_API
+gboolean         gst_buffer_pool_config_get_scalable (GstStructure *config);
+
 /* buffer management */
 
 GST_API
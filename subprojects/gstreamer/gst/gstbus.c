@@ -54,6 +54,13 @@
  * a short while after they have been posted. Note that the main loop should
  * be running for the asynchronous callbacks.
  *
+ * Buses that receive many messages, for example from level or QoS reporting
+ * elements, can coalesce them with #GstBus:coalesce-types. A newly posted
+ * message of one of these types then replaces a message of the same type and
+ * source that is still queued, so that only the latest one is delivered.
+ * With #GstBus:dispatch-batch-size a bus watch handles several queued
+ * messages per main loop iteration instead of one.
+ *
  * It is also possible to get messages from the bus without any thread
  * marshalling with the gst_bus_set_sync_handler() method. This makes it
  * possible to react to a message in the same thread that posted the
@@ -97,12 +104,19 @@ enum
 };
 
 #define DEFAULT_ENABLE_ASYNC (TRUE)
+#define DEFAULT_COALESCE_TYPES 0
+#define DEFAULT_DISPATCH_BATCH_SIZE 1
 #define WARN_QUEUE_SIZE 1024
 
 enum
 {
   PROP_0,
-  PROP_ENABLE_ASYNC
+  PROP_ENABLE_ASYNC,
+  PROP_COALESCE_TYPES,
+  PROP_DISPATCH_BATCH_SIZE,
+  PROP_QUEUE_DEPTH,
+  PROP_MAX_QUEUE_DEPTH,
+  PROP_DROPPED
 };
 
 static void gst_bus_dispose (GObject * object);
@@ -141,6 +155,8 @@ sync_handler_unref (SyncHandler * handler)
 struct _GstBusPrivate
 {
   GMutex queue_lock;
+  /* pointers to the queued messages, NULL for messages that were replaced
+   * by a newer one */
   GstVecDeque *queue;
 
   SyncHandler *sync_handler;
@@ -153,11 +169,212 @@ struct _GstBusPrivate
   gboolean enable_async;
   GstPoll *poll;
   GPollFD pollfd;
+
+  /* protected by the queue lock */
+  GstMessageType coalesce_types;
+  guint max_queue_depth;
+  guint64 dropped;
+  /* NULL entries in the queue */
+  guint n_replaced;
+  /* sequence number of the head of the queue */
+  guint head_seq;
+  /* latest queued message of every kind that can be replaced -> its
+   * sequence number */
+  GHashTable *latest;
+
+  gint dispatch_batch_size;     /* atomic */
 };
 
 #define gst_bus_parent_class parent_class
 G_DEFINE_TYPE_WITH_PRIVATE (GstBus, gst_bus, GST_TYPE_OBJECT);
 
+/* checks if @queued can be replaced by @message */
+static gboolean
+gst_bus_message_coalesces (GstMessage * queued, GstMessage * message)
+{
+  const GstStructure *s1, *s2;
+
+  if (GST_MESSAGE_TYPE (queued) != GST_MESSAGE_TYPE (message)
+      || GST_MESSAGE_SRC (queued) != GST_MESSAGE_SRC (message))
+    return FALSE;
+
+  /* element and application messages of different kinds share the type */
+  s1 = gst_message_get_structure (queued);
+  s2 = gst_message_get_structure (message);
+  if (s1 == NULL || s2 == NULL)
+    return s1 == s2;
+
+  return gst_id_str_is_equal (gst_structure_get_name_id_str (s1),
+      gst_structure_get_name_id_str (s2));
+}
+
+static guint
+gst_bus_message_coalesce_hash (gconstpointer key)
+{
+  GstMessage *message = (GstMessage *) key;
+  const GstStructure *s = gst_message_get_structure (message);
+  guint hash;
+
+  hash = g_direct_hash (GST_MESSAGE_SRC (message)) ^
+      (guint) GST_MESSAGE_TYPE (message);
+  if (s)
+    hash ^= g_str_hash (gst_structure_get_name (s));
+
+  return hash;
+}
+
+static gboolean
+gst_bus_message_coalesce_equal (gconstpointer a, gconstpointer b)
+{
+  return gst_bus_message_coalesces ((GstMessage *) a, (GstMessage *) b);
+}
+
+/* Must be called with the queue lock */
+static gboolean
+gst_bus_message_can_coalesce (GstBus * bus, GstMessage * message)
+{
+  if (GST_MESSAGE_TYPE_IS_EXTENDED (message)
+      || (GST_MESSAGE_TYPE (message) & bus->priv->coalesce_types) == 0)
+    return FALSE;
+
+  /* somebody is blocked until this one is handled */
+  return !GST_MINI_OBJECT_FLAG_IS_SET (message,
+      GST_MESSAGE_FLAG_ASYNC_DELIVERY);
+}
+
+/* number of messages in the queue, must be called with the queue lock */
+static guint
+gst_bus_queue_length_unlocked (GstBus * bus)
+{
+  return gst_vec_deque_get_length (bus->priv->queue) - bus->priv->n_replaced;
+}
+
+/* Must be called with the queue lock */
+static void
+gst_bus_queue_push_unlocked (GstBus * bus, GstMessage * message)
+{
+  GstBusPrivate *priv = bus->priv;
+  guint seq = priv->head_seq + gst_vec_deque_get_length (priv->queue);
+
+  gst_vec_deque_push_tail_struct (priv->queue, &message);
+  if (gst_bus_message_can_coalesce (bus, message))
+    g_hash_table_replace (priv->latest, message, GUINT_TO_POINTER (seq));
+
+  priv->max_queue_depth = MAX (priv->max_queue_depth,
+      gst_bus_queue_length_unlocked (bus));
+}
+
+/* Must be called with the queue lock */
+static void
+gst_bus_queue_forget_unlocked (GstBus * bus, GstMessage * message)
+{
+  gpointer key;
+
+  if (g_hash_table_lookup_extended (bus->priv->latest, message, &key, NULL)
+      && key == message)
+    g_hash_table_remove (bus->priv->latest, message);
+}
+
+/* Must be called with the queue lock, skips replaced messages */
+static GstMessage *
+gst_bus_queue_pop_unlocked (GstBus * bus)
+{
+  GstBusPrivate *priv = bus->priv;
+  GstMessage **entry;
+
+  while ((entry = gst_vec_deque_pop_head_struct (priv->queue))) {
+    GstMessage *message = *entry;
+
+    priv->head_seq++;
+    if (message == NULL) {
+      priv->n_replaced--;
+      continue;
+    }
+
+    gst_bus_queue_forget_unlocked (bus, message);
+    return message;
+  }
+
+  return NULL;
+}
+
+/* Must be called with the queue lock, skips replaced messages */
+static GstMessage *
+gst_bus_queue_peek_unlocked (GstBus * bus)
+{
+  GstBusPrivate *priv = bus->priv;
+  GstMessage **entry;
+
+  while ((entry = gst_vec_deque_peek_head_struct (priv->queue))
+      && *entry == NULL) {
+    gst_vec_deque_pop_head_struct (priv->queue);
+    priv->head_seq++;
+    priv->n_replaced--;
+  }
+
+  return entry ? *entry : NULL;
+}
+
+/* Removes the entries of replaced messages when they are the majority of
+ * the queue, so that a bus that is not read from does not grow. Must be
+ * called with the queue lock */
+static void
+gst_bus_queue_compact_unlocked (GstBus * bus)
+{
+  GstBusPrivate *priv = bus->priv;
+  gsize i, len = gst_vec_deque_get_length (priv->queue);
+  guint seq = priv->head_seq;
+  gpointer key;
+
+  for (i = 0; i < len; i++) {
+    GstMessage *message =
+        *(GstMessage **) gst_vec_deque_pop_head_struct (priv->queue);
+
+    if (message == NULL)
+      continue;
+
+    if (g_hash_table_lookup_extended (priv->latest, message, &key, NULL)
+        && key == message)
+      g_hash_table_insert (priv->latest, message, GUINT_TO_POINTER (seq));
+    gst_vec_deque_push_tail_struct (priv->queue, &message);
+    seq++;
+  }
+
+  priv->n_replaced = 0;
+}
+
+/* Drops the most recent queued message that @message replaces. Must be
+ * called with the queue lock, returns the dropped message. The message is
+ * found with a hash table and its entry in the queue is cleared, so that
+ * this does not depend on the length of the queue */
+static GstMessage *
+gst_bus_coalesce_unlocked (GstBus * bus, GstMessage * message)
+{
+  GstBusPrivate *priv = bus->priv;
+  GstMessage *queued, **entry;
+  gpointer seq;
+
+  if (!gst_bus_message_can_coalesce (bus, message))
+    return NULL;
+
+  if (!g_hash_table_steal_extended (priv->latest, message,
+          (gpointer *) & queued, &seq))
+    return NULL;
+
+  entry = gst_vec_deque_peek_nth_struct (priv->queue,
+      GPOINTER_TO_UINT (seq) - priv->head_seq);
+  g_assert (*entry == queued);
+  *entry = NULL;
+  priv->n_replaced++;
+  priv->dropped++;
+
+  if (priv->n_replaced > 32
+      && priv->n_replaced > gst_bus_queue_length_unlocked (bus))
+    gst_bus_queue_compact_unlocked (bus);
+
+  return queued;
+}
+
 static void
 gst_bus_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec)
@@ -168,6 +385,52 @@ gst_bus_set_property (GObject * object,
     case PROP_ENABLE_ASYNC:
       bus->priv->enable_async = g_value_get_boolean (value);
       break;
+    case PROP_COALESCE_TYPES:
+      g_mutex_lock (&bus->priv->queue_lock);
+      bus->priv->coalesce_types = g_value_get_flags (value);
+      g_mutex_unlock (&bus->priv->queue_lock);
+      break;
+    case PROP_DISPATCH_BATCH_SIZE:
+      g_atomic_int_set (&bus->priv->dispatch_batch_size,
+          g_value_get_uint (value));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_bus_get_property (GObject * object,
+    guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstBus *bus = GST_BUS_CAST (object);
+
+  switch (prop_id) {
+    case PROP_COALESCE_TYPES:
+      g_mutex_lock (&bus->priv->queue_lock);
+      g_value_set_flags (value, bus->priv->coalesce_types);
+      g_mutex_unlock (&bus->priv->queue_lock);
+      break;
+    case PROP_DISPATCH_BATCH_SIZE:
+      g_value_set_uint (value,
+          g_atomic_int_get (&bus->priv->dispatch_batch_size));
+      break;
+    case PROP_QUEUE_DEPTH:
+      g_mutex_lock (&bus->priv->queue_lock);
+      g_value_set_uint (value, gst_bus_queue_length_unlocked (bus));
+      g_mutex_unlock (&bus->priv->queue_lock);
+      break;
+    case PROP_MAX_QUEUE_DEPTH:
+      g_mutex_lock (&bus->priv->queue_lock);
+      g_value_set_uint (value, bus->priv->max_queue_depth);
+      g_mutex_unlock (&bus->priv->queue_lock);
+      break;
+    case PROP_DROPPED:
+      g_mutex_lock (&bus->priv->queue_lock);
+      g_value_set_uint64 (value, bus->priv->dropped);
+      g_mutex_unlock (&bus->priv->queue_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -195,6 +458,7 @@ gst_bus_class_init (GstBusClass * klass)
   gobject_class->dispose = gst_bus_dispose;
   gobject_class->finalize = gst_bus_finalize;
   gobject_class->set_property = gst_bus_set_property;
+  gobject_class->get_property = gst_bus_get_property;
   gobject_class->constructed = gst_bus_constructed;
 
   /**
@@ -213,6 +477,83 @@ gst_bus_class_init (GstBusClass * klass)
           DEFAULT_ENABLE_ASYNC,
           G_PARAM_CONSTRUCT_ONLY | G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBus:coalesce-types:
+   *
+   * Message types that are coalesced on the bus. When a message of one of
+   * these types is posted while a message of the same type from the same
+   * source is still queued, the queued message is dropped and only the new
+   * one is delivered. The names of the message structures also have to
+   * match, so that different kinds of element messages are kept apart.
+   *
+   * This is useful for messages that are posted at a high rate and only
+   * report the latest state, like the ones of the level element or QoS
+   * messages. Messages delivered with %GST_BUS_ASYNC and extended message
+   * types are never coalesced.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_COALESCE_TYPES,
+      g_param_spec_flags ("coalesce-types", "Coalesce Types",
+          "Message types for which only the latest queued message per "
+          "source is kept", GST_TYPE_MESSAGE_TYPE, DEFAULT_COALESCE_TYPES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBus:dispatch-batch-size:
+   *
+   * Maximum number of queued messages a bus watch passes to its function
+   * per main loop iteration. The default of 1 lets other sources of the main
+   * loop run between every message, larger values reduce the overhead of
+   * dispatching when many messages are posted.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_DISPATCH_BATCH_SIZE,
+      g_param_spec_uint ("dispatch-batch-size", "Dispatch Batch Size",
+          "Maximum number of messages dispatched by a bus watch at once",
+          1, G_MAXINT, DEFAULT_DISPATCH_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBus:queue-depth:
+   *
+   * The number of messages currently queued on the bus.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_QUEUE_DEPTH,
+      g_param_spec_uint ("queue-depth", "Queue Depth",
+          "Number of messages currently queued", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBus:max-queue-depth:
+   *
+   * The highest number of messages that were queued on the bus at the same
+   * time.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_DEPTH,
+      g_param_spec_uint ("max-queue-depth", "Max Queue Depth",
+          "Highest number of messages queued at the same time", 0, G_MAXUINT,
+          0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBus:dropped:
+   *
+   * The number of messages that were dropped without being delivered,
+   * because a newer message replaced them (see #GstBus:coalesce-types) or
+   * because the bus was flushing.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_DROPPED,
+      g_param_spec_uint64 ("dropped", "Dropped",
+          "Number of messages dropped by coalescing or flushing", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstBus::sync-message:
    * @self: the object which received the signal
@@ -251,8 +592,12 @@ gst_bus_init (GstBus * bus)
 {
   bus->priv = gst_bus_get_instance_private (bus);
   bus->priv->enable_async = DEFAULT_ENABLE_ASYNC;
+  bus->priv->coalesce_types = DEFAULT_COALESCE_TYPES;
+  bus->priv->dispatch_batch_size = DEFAULT_DISPATCH_BATCH_SIZE;
   g_mutex_init (&bus->priv->queue_lock);
-  bus->priv->queue = gst_vec_deque_new (32);
+  bus->priv->queue = gst_vec_deque_new_for_struct (sizeof (GstMessage *), 32);
+  bus->priv->latest = g_hash_table_new (gst_bus_message_coalesce_hash,
+      gst_bus_message_coalesce_equal);
 
   GST_DEBUG_OBJECT (bus, "created");
 }
@@ -267,12 +612,14 @@ gst_bus_dispose (GObject * object)
 
     g_mutex_lock (&bus->priv->queue_lock);
     do {
-      message = gst_vec_deque_pop_head (bus->priv->queue);
+      message = gst_bus_queue_pop_unlocked (bus);
       if (message)
         gst_message_unref (message);
     } while (message != NULL);
     gst_vec_deque_free (bus->priv->queue);
     bus->priv->queue = NULL;
+    g_hash_table_unref (bus->priv->latest);
+    bus->priv->latest = NULL;
     g_mutex_unlock (&bus->priv->queue_lock);
     g_mutex_clear (&bus->priv->queue_lock);
 
@@ -381,22 +728,35 @@ gst_bus_post (GstBus * bus, GstMessage * message)
       GST_DEBUG_OBJECT (bus, "[msg %p] dropped", message);
       break;
     case GST_BUS_PASS:{
+      GstMessage *replaced;
+      guint length;
+
       g_mutex_lock (&bus->priv->queue_lock);
-      gsize length = gst_vec_deque_get_length (bus->priv->queue);
+      replaced = gst_bus_coalesce_unlocked (bus, message);
+      length = gst_bus_queue_length_unlocked (bus);
       if (G_UNLIKELY (length > 0 && length % WARN_QUEUE_SIZE == 0)) {
         GST_WARNING_OBJECT (bus,
-            "queue overflows with %" G_GSIZE_FORMAT " messages. "
+            "queue overflows with %u messages. "
             "Application is too slow or is not handling messages. "
             "Please add a message handler, otherwise the queue will grow "
             "infinitely.", length);
       }
       /* pass the message to the async queue, refcount passed in the queue */
       GST_DEBUG_OBJECT (bus, "[msg %p] pushing on async queue", message);
-      gst_vec_deque_push_tail (bus->priv->queue, message);
-      gst_poll_write_control (bus->priv->poll);
+      gst_bus_queue_push_unlocked (bus, message);
+      /* the replaced message already raised the control, there is still
+       * exactly one message for it in the queue */
+      if (!replaced)
+        gst_poll_write_control (bus->priv->poll);
       GST_DEBUG_OBJECT (bus, "[msg %p] pushed on async queue", message);
       g_mutex_unlock (&bus->priv->queue_lock);
 
+      if (replaced) {
+        GST_DEBUG_OBJECT (bus, "[msg %p] replaced queued message %p", message,
+            replaced);
+        gst_message_unref (replaced);
+      }
+
       break;
     }
     case GST_BUS_ASYNC:
@@ -419,7 +779,7 @@ gst_bus_post (GstBus * bus, GstMessage * message)
       g_mutex_lock (lock);
 
       g_mutex_lock (&bus->priv->queue_lock);
-      gst_vec_deque_push_tail (bus->priv->queue, message);
+      gst_bus_queue_push_unlocked (bus, message);
       gst_poll_write_control (bus->priv->poll);
       g_mutex_unlock (&bus->priv->queue_lock);
 
@@ -451,6 +811,9 @@ is_flushing:
   {
     GST_DEBUG_OBJECT (bus, "bus is flushing");
     GST_OBJECT_UNLOCK (bus);
+    g_mutex_lock (&bus->priv->queue_lock);
+    bus->priv->dropped++;
+    g_mutex_unlock (&bus->priv->queue_lock);
     gst_message_unref (message);
 
     return FALSE;
@@ -476,7 +839,7 @@ gst_bus_have_pending (GstBus * bus)
 
   /* see if there is a message on the bus */
   g_mutex_lock (&bus->priv->queue_lock);
-  result = gst_vec_deque_get_length (bus->priv->queue) != 0;
+  result = gst_bus_queue_length_unlocked (bus) != 0;
   g_mutex_unlock (&bus->priv->queue_lock);
 
   return result;
@@ -508,6 +871,10 @@ gst_bus_set_flushing (GstBus * bus, gboolean flushing)
 
     while ((message = gst_bus_pop (bus)))
       message_list = g_list_prepend (message_list, message);
+
+    g_mutex_lock (&bus->priv->queue_lock);
+    bus->priv->dropped += g_list_length (message_list);
+    g_mutex_unlock (&bus->priv->queue_lock);
   } else {
     GST_DEBUG_OBJECT (bus, "unset bus flushing");
     GST_OBJECT_FLAG_UNSET (bus, GST_BUS_FLUSHING);
@@ -554,10 +921,10 @@ gst_bus_timed_pop_filtered (GstBus * bus, GstClockTime timeout,
   while (TRUE) {
     gint ret;
 
-    GST_LOG_OBJECT (bus, "have %" G_GSIZE_FORMAT " messages",
-        gst_vec_deque_get_length (bus->priv->queue));
+    GST_LOG_OBJECT (bus, "have %u messages",
+        gst_bus_queue_length_unlocked (bus));
 
-    while ((message = gst_vec_deque_pop_head (bus->priv->queue))) {
+    while ((message = gst_bus_queue_pop_unlocked (bus))) {
       if (bus->priv->poll) {
         while (!gst_poll_read_control (bus->priv->poll)) {
           if (errno == EWOULDBLOCK) {
@@ -717,7 +1084,7 @@ gst_bus_peek (GstBus * bus)
   g_return_val_if_fail (GST_IS_BUS (bus), NULL);
 
   g_mutex_lock (&bus->priv->queue_lock);
-  message = gst_vec_deque_peek_head (bus->priv->queue);
+  message = gst_bus_queue_peek_unlocked (bus);
   if (message)
     gst_message_ref (message);
   g_mutex_unlock (&bus->priv->queue_lock);
@@ -816,8 +1183,9 @@ gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
   GstBusFunc handler = (GstBusFunc) callback;
   GstBusSource *bsource = (GstBusSource *) source;
   GstMessage *message;
-  gboolean keep;
+  gboolean keep = TRUE;
   GstBus *bus;
+  gint i, batch_size;
 
   g_return_val_if_fail (bsource != NULL, FALSE);
 
@@ -825,23 +1193,32 @@ gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
 
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
 
-  message = gst_bus_pop (bus);
+  batch_size = g_atomic_int_get (&bus->priv->dispatch_batch_size);
+
+  for (i = 0; i < batch_size && keep; i++) {
+    /* the handler might have removed the watch */
+    if (i > 0 && g_source_is_destroyed (source))
+      break;
+
+    message = gst_bus_pop (bus);
 
-  /* The message queue might be empty if some other thread or callback set
-   * the bus to flushing between check/prepare and dispatch */
-  if (G_UNLIKELY (message == NULL))
-    return TRUE;
+    /* The message queue might be empty if some other thread or callback set
+     * the bus to flushing between check/prepare and dispatch, or if we
+     * handled all messages of this batch */
+    if (G_UNLIKELY (message == NULL))
+      break;
 
-  if (!handler)
-    goto no_handler;
+    if (!handler)
+      goto no_handler;
 
-  GST_DEBUG_OBJECT (bus, "source %p calling dispatch with %" GST_PTR_FORMAT,
-      source, message);
+    GST_DEBUG_OBJECT (bus, "source %p calling dispatch with %" GST_PTR_FORMAT,
+        source, message);
 
-  keep = handler (bus, message, user_data);
-  gst_message_unref (message);
+    keep = handler (bus, message, user_data);
+    gst_message_unref (message);
 
-  GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+    GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+  }
 
   return keep;
 
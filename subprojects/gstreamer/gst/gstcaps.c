@@ -137,9 +137,348 @@ GstCaps *_gst_caps_none;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstCaps, gst_caps);
 
+/* Memo cache for the results of caps intersection and subset checks.
+ *
+ * The shared cache is a direct-mapped table of GST_CAPS_CACHE_SIZE entries,
+ * keyed on a hash of the contents of both caps and split into shards with
+ * their own lock. The cache only ever holds private copies of the inputs, so
+ * that it never changes the writability of caps owned by the caller or keeps
+ * them alive, and hash collisions are resolved with
+ * gst_caps_is_strictly_equal() against those copies.
+ *
+ * In front of that, every thread has a small cache with the same keys that
+ * shares the copies of the shared cache and needs no locking. The cache is
+ * disabled by default. */
+typedef enum
+{
+  CAPS_CACHE_OP_INTERSECT_ZIG_ZAG = 1,
+  CAPS_CACHE_OP_INTERSECT_FIRST,
+  CAPS_CACHE_OP_IS_SUBSET,
+  CAPS_CACHE_OP_CAN_INTERSECT,
+} GstCapsCacheOp;
+
+typedef struct
+{
+  guint hash;
+  GstCapsCacheOp op;            /* 0 when unused */
+  GstCaps *caps1;
+  GstCaps *caps2;
+  /* result of the intersection or NULL for the boolean operations */
+  GstCaps *result;
+  gboolean boolean;
+} GstCapsCacheEntry;
+
+#define CAPS_CACHE_N_SHARDS 16
+
+typedef struct
+{
+  GMutex lock;
+  guint64 hits;
+  guint64 misses;
+  /* keep the shards on separate cache lines */
+  gchar padding[64 - sizeof (GMutex) - 2 * sizeof (guint64)];
+} GstCapsCacheShard;
+
+#define CAPS_CACHE_THREAD_SIZE 32
+
+typedef struct
+{
+  GstCapsCacheEntry entries[CAPS_CACHE_THREAD_SIZE];
+  guint64 hits;
+} GstCapsThreadCache;
+
+static GstCapsCacheEntry *caps_cache;
+static guint caps_cache_mask;
+static GstCapsCacheShard caps_cache_shards[CAPS_CACHE_N_SHARDS];
+/* hits in the thread caches of threads that are gone */
+static GMutex caps_cache_thread_lock;
+static guint64 caps_cache_thread_hits;
+
+static void caps_thread_cache_free (gpointer data);
+static GPrivate caps_thread_cache = G_PRIVATE_INIT (caps_thread_cache_free);
+
+static guint caps_cache_hash_value (const GValue * value);
+
+static gboolean
+caps_cache_hash_field (const GstIdStr * fieldname, const GValue * value,
+    gpointer user_data)
+{
+  guint *hash = user_data;
+
+  *hash = (*hash * 31) ^ g_str_hash (gst_id_str_as_str (fieldname));
+  *hash = (*hash * 31) ^ caps_cache_hash_value (value);
+
+  return TRUE;
+}
+
+static guint
+caps_cache_hash_double (gdouble d)
+{
+  return g_double_hash (&d);
+}
+
+/* hash the contents of a value for the common caps value types. Values of
+ * other types only contribute their type, the equality check catches the
+ * resulting collisions */
+static guint
+caps_cache_hash_value (const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint hash = (guint) type;
+  guint i, len;
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_INT:
+      return hash ^ (guint) g_value_get_int (value);
+    case G_TYPE_UINT:
+      return hash ^ g_value_get_uint (value);
+    case G_TYPE_INT64:
+    {
+      gint64 v = g_value_get_int64 (value);
+      return hash ^ g_int64_hash (&v);
+    }
+    case G_TYPE_UINT64:
+    {
+      guint64 v = g_value_get_uint64 (value);
+      return hash ^ g_int64_hash (&v);
+    }
+    case G_TYPE_BOOLEAN:
+      return hash ^ (guint) g_value_get_boolean (value);
+    case G_TYPE_DOUBLE:
+      return hash ^ caps_cache_hash_double (g_value_get_double (value));
+    case G_TYPE_ENUM:
+      return hash ^ (guint) g_value_get_enum (value);
+    case G_TYPE_FLAGS:
+      return hash ^ g_value_get_flags (value);
+    case G_TYPE_STRING:
+    {
+      const gchar *str = g_value_get_string (value);
+      return str ? hash ^ g_str_hash (str) : hash;
+    }
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_LIST) {
+    len = gst_value_list_get_size (value);
+    for (i = 0; i < len; i++)
+      hash = (hash * 31) ^
+          caps_cache_hash_value (gst_value_list_get_value (value, i));
+  } else if (type == GST_TYPE_ARRAY) {
+    len = gst_value_array_get_size (value);
+    for (i = 0; i < len; i++)
+      hash = (hash * 31) ^
+          caps_cache_hash_value (gst_value_array_get_value (value, i));
+  } else if (type == GST_TYPE_FRACTION) {
+    hash ^= (guint) gst_value_get_fraction_numerator (value) * 31 +
+        (guint) gst_value_get_fraction_denominator (value);
+  } else if (type == GST_TYPE_INT_RANGE) {
+    hash ^= ((guint) gst_value_get_int_range_min (value) * 31 +
+        (guint) gst_value_get_int_range_max (value)) * 31 +
+        (guint) gst_value_get_int_range_step (value);
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    gint64 min = gst_value_get_int64_range_min (value);
+    gint64 max = gst_value_get_int64_range_max (value);
+
+    hash ^= g_int64_hash (&min) * 31 + g_int64_hash (&max);
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    hash ^= caps_cache_hash_double (gst_value_get_double_range_min (value)) *
+        31 + caps_cache_hash_double (gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    hash ^= caps_cache_hash_value (gst_value_get_fraction_range_min (value)) *
+        31 + caps_cache_hash_value (gst_value_get_fraction_range_max (value));
+  } else if (type == GST_TYPE_BITMASK) {
+    guint64 v = gst_value_get_bitmask (value);
+    hash ^= g_int64_hash (&v);
+  }
+
+  return hash;
+}
+
+static guint
+caps_cache_hash_caps (const GstCaps * caps)
+{
+  GstStructure *s;
+  GstCapsFeatures *f;
+  guint hash, i, j, len, n;
+
+  hash = GST_CAPS_FLAGS (caps);
+  len = GST_CAPS_LEN (caps);
+  for (i = 0; i < len; i++) {
+    s = gst_caps_get_structure_unchecked (caps, i);
+    f = gst_caps_get_features_unchecked (caps, i);
+
+    hash = (hash * 31) ^ g_str_hash (gst_structure_get_name (s));
+    gst_structure_foreach_id_str (s, caps_cache_hash_field, &hash);
+
+    if (f && !gst_caps_features_is_equal (f,
+            GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY)) {
+      n = gst_caps_features_get_size (f);
+      hash = (hash * 31) ^ (gst_caps_features_is_any (f) ? 1 : 2);
+      for (j = 0; j < n; j++)
+        hash = (hash * 31) ^ g_str_hash (gst_caps_features_get_nth (f, j));
+    }
+  }
+
+  return hash;
+}
+
+static inline guint
+caps_cache_hash (const GstCaps * caps1, const GstCaps * caps2,
+    GstCapsCacheOp op)
+{
+  return (caps_cache_hash_caps (caps1) * 31 + caps_cache_hash_caps (caps2))
+      * 31 + op;
+}
+
+static void
+caps_cache_entry_clear (GstCapsCacheEntry * entry)
+{
+  gst_clear_caps (&entry->caps1);
+  gst_clear_caps (&entry->caps2);
+  gst_clear_caps (&entry->result);
+  entry->op = 0;
+}
+
+static inline gboolean
+caps_cache_entry_matches (const GstCapsCacheEntry * entry, guint hash,
+    GstCapsCacheOp op, const GstCaps * caps1, const GstCaps * caps2)
+{
+  return entry->hash == hash && entry->op == op
+      && gst_caps_is_strictly_equal (entry->caps1, caps1)
+      && gst_caps_is_strictly_equal (entry->caps2, caps2);
+}
+
+static void
+caps_thread_cache_free (gpointer data)
+{
+  GstCapsThreadCache *cache = data;
+  guint i;
+
+  for (i = 0; i < CAPS_CACHE_THREAD_SIZE; i++)
+    caps_cache_entry_clear (&cache->entries[i]);
+
+  g_mutex_lock (&caps_cache_thread_lock);
+  caps_cache_thread_hits += cache->hits;
+  g_mutex_unlock (&caps_cache_thread_lock);
+
+  g_free (cache);
+}
+
+static GstCapsCacheEntry *
+caps_thread_cache_get_entry (guint hash, GstCapsThreadCache ** cache)
+{
+  *cache = g_private_get (&caps_thread_cache);
+  if (*cache == NULL) {
+    *cache = g_new0 (GstCapsThreadCache, 1);
+    g_private_set (&caps_thread_cache, *cache);
+  }
+
+  return &(*cache)->entries[hash % CAPS_CACHE_THREAD_SIZE];
+}
+
+/* makes @entry share the copies of @src */
+static void
+caps_thread_cache_set (GstCapsCacheEntry * entry,
+    const GstCapsCacheEntry * src)
+{
+  caps_cache_entry_clear (entry);
+  entry->hash = src->hash;
+  entry->op = src->op;
+  entry->caps1 = gst_caps_ref (src->caps1);
+  entry->caps2 = gst_caps_ref (src->caps2);
+  entry->result = src->result ? gst_caps_ref (src->result) : NULL;
+  entry->boolean = src->boolean;
+}
+
+/* look up the result for @caps1 and @caps2. On a hit for an intersection
+ * a copy of the cached caps is returned in @result. On a miss, @hash is set
+ * for caps_cache_insert() */
+static gboolean
+caps_cache_lookup (GstCapsCacheOp op, const GstCaps * caps1,
+    const GstCaps * caps2, guint * hash, GstCaps ** result,
+    gboolean * boolean)
+{
+  GstCapsThreadCache *thread_cache;
+  GstCapsCacheEntry *entry, *thread_entry;
+  GstCapsCacheShard *shard;
+  guint idx;
+  gboolean found = FALSE;
+
+  *hash = caps_cache_hash (caps1, caps2, op);
+
+  thread_entry = caps_thread_cache_get_entry (*hash, &thread_cache);
+  if (caps_cache_entry_matches (thread_entry, *hash, op, caps1, caps2)) {
+    if (result)
+      *result = gst_caps_copy (thread_entry->result);
+    if (boolean)
+      *boolean = thread_entry->boolean;
+    thread_cache->hits++;
+    return TRUE;
+  }
+
+  idx = *hash & caps_cache_mask;
+  shard = &caps_cache_shards[idx % CAPS_CACHE_N_SHARDS];
+
+  g_mutex_lock (&shard->lock);
+  entry = &caps_cache[idx];
+  if (caps_cache_entry_matches (entry, *hash, op, caps1, caps2)) {
+    if (result)
+      *result = gst_caps_copy (entry->result);
+    if (boolean)
+      *boolean = entry->boolean;
+    /* remember the result in this thread */
+    caps_thread_cache_set (thread_entry, entry);
+    shard->hits++;
+    found = TRUE;
+  } else {
+    shard->misses++;
+  }
+  g_mutex_unlock (&shard->lock);
+
+  return found;
+}
+
+static void
+caps_cache_insert (guint hash, GstCapsCacheOp op, const GstCaps * caps1,
+    const GstCaps * caps2, const GstCaps * result, gboolean boolean)
+{
+  GstCapsThreadCache *thread_cache;
+  GstCapsCacheEntry new_entry, old_entry, *entry, *thread_entry;
+  GstCapsCacheShard *shard;
+  guint idx;
+
+  /* do the copies outside of the lock */
+  new_entry.hash = hash;
+  new_entry.op = op;
+  new_entry.caps1 = gst_caps_copy (caps1);
+  new_entry.caps2 = gst_caps_copy (caps2);
+  new_entry.result = result ? gst_caps_copy (result) : NULL;
+  new_entry.boolean = boolean;
+
+  thread_entry = caps_thread_cache_get_entry (hash, &thread_cache);
+  caps_thread_cache_set (thread_entry, &new_entry);
+
+  idx = hash & caps_cache_mask;
+  shard = &caps_cache_shards[idx % CAPS_CACHE_N_SHARDS];
+
+  g_mutex_lock (&shard->lock);
+  entry = &caps_cache[idx];
+  /* swap so that the old entry is released after unlocking */
+  old_entry = *entry;
+  *entry = new_entry;
+  g_mutex_unlock (&shard->lock);
+
+  caps_cache_entry_clear (&old_entry);
+}
+
+#define CAPS_CACHE_ENABLED() (G_UNLIKELY (caps_cache != NULL))
+
 void
 _priv_gst_caps_initialize (void)
 {
+  const gchar *env;
+
   _gst_caps_type = gst_caps_get_type ();
 
   _gst_caps_any = gst_caps_new_any ();
@@ -147,6 +486,24 @@ _priv_gst_caps_initialize (void)
 
   g_value_register_transform_func (_gst_caps_type,
       G_TYPE_STRING, gst_caps_transform_to_string);
+
+  env = g_getenv ("GST_CAPS_CACHE_SIZE");
+  if (env != NULL) {
+    guint64 size = g_ascii_strtoull (env, NULL, 10);
+
+    if (size > 0) {
+      size = MIN (size, 1 << 20);
+      /* round up to a power of two */
+      caps_cache_mask = 1;
+      while (caps_cache_mask < size)
+        caps_cache_mask <<= 1;
+      caps_cache = g_new0 (GstCapsCacheEntry, caps_cache_mask);
+      caps_cache_mask--;
+
+      GST_CAT_INFO (GST_CAT_CAPS, "caps cache with %u entries",
+          caps_cache_mask + 1);
+    }
+  }
 }
 
 void
@@ -156,6 +513,29 @@ _priv_gst_caps_cleanup (void)
   _gst_caps_any = NULL;
   gst_caps_unref (_gst_caps_none);
   _gst_caps_none = NULL;
+
+  if (caps_cache) {
+    guint i;
+    guint64 hits, misses = 0;
+
+    /* the caches of other threads are released when they exit */
+    g_private_replace (&caps_thread_cache, NULL);
+
+    hits = caps_cache_thread_hits;
+    for (i = 0; i < CAPS_CACHE_N_SHARDS; i++) {
+      hits += caps_cache_shards[i].hits;
+      misses += caps_cache_shards[i].misses;
+    }
+
+    GST_CAT_INFO (GST_CAT_CAPS, "caps cache: %" G_GUINT64_FORMAT " hits, %"
+        G_GUINT64_FORMAT " misses, hit rate %.1f%%", hits, misses,
+        hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0);
+
+    for (i = 0; i <= caps_cache_mask; i++)
+      caps_cache_entry_clear (&caps_cache[i]);
+    g_free (caps_cache);
+    caps_cache = NULL;
+  }
 }
 
 GstCapsFeatures *
@@ -1675,6 +2055,7 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   GstCapsFeatures *f1, *f2;
   gboolean ret = TRUE;
   gint i, j;
+  guint hash = 0;
 
   g_return_val_if_fail (subset != NULL, FALSE);
   g_return_val_if_fail (superset != NULL, FALSE);
@@ -1684,6 +2065,10 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  if (CAPS_CACHE_ENABLED () && caps_cache_lookup (CAPS_CACHE_OP_IS_SUBSET,
+          subset, superset, &hash, NULL, &ret))
+    return ret;
+
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     s1 = gst_caps_get_structure_unchecked (subset, i);
     f1 = gst_caps_get_features_unchecked (subset, i);
@@ -1712,6 +2097,10 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
     }
   }
 
+  if (CAPS_CACHE_ENABLED ())
+    caps_cache_insert (hash, CAPS_CACHE_OP_IS_SUBSET, subset, superset, NULL,
+        ret);
+
   return ret;
 }
 
@@ -1885,15 +2274,14 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
  *
  * Returns: %TRUE if intersection would be not empty
  */
+static gboolean gst_caps_can_intersect_zig_zag (const GstCaps * caps1,
+    const GstCaps * caps2);
+
 gboolean
 gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
 {
-  guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
-  guint j, k, len1, len2;
-  GstStructure *struct1;
-  GstStructure *struct2;
-  GstCapsFeatures *features1;
-  GstCapsFeatures *features2;
+  gboolean ret;
+  guint hash = 0;
 
   g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
   g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
@@ -1910,6 +2298,30 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
     return TRUE;
 
+  if (!CAPS_CACHE_ENABLED ())
+    return gst_caps_can_intersect_zig_zag (caps1, caps2);
+
+  if (caps_cache_lookup (CAPS_CACHE_OP_CAN_INTERSECT, caps1, caps2, &hash,
+          NULL, &ret))
+    return ret;
+
+  ret = gst_caps_can_intersect_zig_zag (caps1, caps2);
+  caps_cache_insert (hash, CAPS_CACHE_OP_CAN_INTERSECT, caps1, caps2, NULL,
+      ret);
+
+  return ret;
+}
+
+static gboolean
+gst_caps_can_intersect_zig_zag (const GstCaps * caps1, const GstCaps * caps2)
+{
+  guint64 i;                    /* index can be up to 2 * G_MAX_UINT */
+  guint j, k, len1, len2;
+  GstStructure *struct1;
+  GstStructure *struct2;
+  GstCapsFeatures *features1;
+  GstCapsFeatures *features2;
+
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -2089,6 +2501,21 @@ gst_caps_intersect_first (GstCaps * caps1, GstCaps * caps2)
   return dest;
 }
 
+static GstCaps *
+gst_caps_intersect_by_mode (GstCaps * caps1, GstCaps * caps2,
+    GstCapsIntersectMode mode)
+{
+  switch (mode) {
+    case GST_CAPS_INTERSECT_FIRST:
+      return gst_caps_intersect_first (caps1, caps2);
+    default:
+      g_warning ("Unknown caps intersect mode: %d", mode);
+      /* fallthrough */
+    case GST_CAPS_INTERSECT_ZIG_ZAG:
+      return gst_caps_intersect_zig_zag (caps1, caps2);
+  }
+}
+
 /**
  * gst_caps_intersect_full:
  * @caps1: a #GstCaps to intersect
@@ -2124,15 +2551,23 @@ gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
   if (G_UNLIKELY (CAPS_IS_ANY (caps2)))
     return gst_caps_ref (caps1);
 
-  switch (mode) {
-    case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
-    default:
-      g_warning ("Unknown caps intersect mode: %d", mode);
-      /* fallthrough */
-    case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+  if (CAPS_CACHE_ENABLED ()) {
+    GstCapsCacheOp op;
+    GstCaps *result;
+    guint hash = 0;
+
+    op = mode == GST_CAPS_INTERSECT_FIRST ? CAPS_CACHE_OP_INTERSECT_FIRST :
+        CAPS_CACHE_OP_INTERSECT_ZIG_ZAG;
+    if (caps_cache_lookup (op, caps1, caps2, &hash, &result, NULL))
+      return result;
+
+    result = gst_caps_intersect_by_mode (caps1, caps2, mode);
+    caps_cache_insert (hash, op, caps1, caps2, result, FALSE);
+
+    return result;
   }
+
+  return gst_caps_intersect_by_mode (caps1, caps2, mode);
 }
 
 /**
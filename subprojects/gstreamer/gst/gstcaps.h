@@ -569,6 +569,14 @@ gchar *           gst_caps_serialize               (const GstCaps *caps, GstSeri
 GST_API
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
 
+GST_API
+gboolean          gst_caps_serialize_binary        (const GstCaps *caps,
+                                                    GByteArray    *out);
+GST_API
+GstCaps *         gst_caps_deserialize_binary      (const guint8  *data,
+                                                    gsize          size,
+                                                    gsize         *consumed) G_GNUC_WARN_UNUSED_RESULT;
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstCaps, gst_caps_unref)
 
 G_END_DECLS
@@ -103,6 +103,15 @@ gchar *           gst_caps_features_to_string (const GstCapsFeatures * features)
 GST_API
 GstCapsFeatures * gst_caps_features_from_string (const gchar * features);
 
+GST_API
+gboolean          gst_caps_features_serialize_binary (const GstCapsFeatures * features,
+                                                      GByteArray * out);
+
+GST_API
+GstCapsFeatures * gst_caps_features_deserialize_binary (const guint8 * data,
+                                                        gsize size,
+                                                        gsize * consumed);
+
 GST_API
 guint             gst_caps_features_get_size (const GstCapsFeatures * features);
 
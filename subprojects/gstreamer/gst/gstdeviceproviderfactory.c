@@ -138,6 +138,8 @@ gst_device_provider_factory_cleanup (GstDeviceProviderFactory * factory)
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  /* points into the registry cache, see gst_element_factory_cleanup() */
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -403,6 +405,34 @@ gst_device_provider_factory_get_device_provider_type (GstDeviceProviderFactory *
   return factory->type;
 }
 
+/* Factories loaded from a mapped registry cache only keep the serialized
+ * metadata around until it is needed for the first time */
+static GstStructure *
+gst_device_provider_factory_ensure_metadata (GstDeviceProviderFactory * factory)
+{
+  GstStructure *metadata;
+
+  metadata = g_atomic_pointer_get (&factory->metadata);
+  if (G_LIKELY (metadata != NULL) || factory->metadata_string == NULL)
+    return metadata;
+
+  metadata = gst_structure_from_string (factory->metadata_string, NULL);
+  if (metadata == NULL) {
+    GST_WARNING_OBJECT (factory, "Error when trying to deserialize structure "
+        "for metadata '%s'", factory->metadata_string);
+    return NULL;
+  }
+
+  if (!g_atomic_pointer_compare_and_exchange (&factory->metadata, NULL,
+          metadata)) {
+    /* another thread was faster */
+    gst_structure_free (metadata);
+    metadata = g_atomic_pointer_get (&factory->metadata);
+  }
+
+  return metadata;
+}
+
 /**
  * gst_device_provider_factory_get_metadata:
  * @factory: a #GstDeviceProviderFactory
@@ -419,7 +449,9 @@ const gchar *
 gst_device_provider_factory_get_metadata (GstDeviceProviderFactory * factory,
     const gchar * key)
 {
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  return
+      gst_structure_get_string (gst_device_provider_factory_ensure_metadata
+      (factory), key);
 }
 
 /**
@@ -444,7 +476,7 @@ gst_device_provider_factory_get_metadata_keys (GstDeviceProviderFactory *
 
   g_return_val_if_fail (GST_IS_DEVICE_PROVIDER_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = gst_device_provider_factory_ensure_metadata (factory);
   if (metadata == NULL)
     return NULL;
 
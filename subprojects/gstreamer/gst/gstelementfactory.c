@@ -155,6 +155,9 @@ gst_element_factory_cleanup (GstElementFactory * factory)
     gst_structure_free ((GstStructure *) factory->metadata);
     factory->metadata = NULL;
   }
+  /* points into the registry cache, don't parse it again after the metadata
+   * was replaced */
+  factory->metadata_string = NULL;
   if (factory->type) {
     factory->type = G_TYPE_INVALID;
   }
@@ -857,6 +860,34 @@ gst_element_factory_get_element_type (GstElementFactory * factory)
   return factory->type;
 }
 
+/* Factories loaded from a mapped registry cache only keep the serialized
+ * metadata around until it is needed for the first time */
+static GstStructure *
+gst_element_factory_ensure_metadata (GstElementFactory * factory)
+{
+  GstStructure *metadata;
+
+  metadata = g_atomic_pointer_get (&factory->metadata);
+  if (G_LIKELY (metadata != NULL) || factory->metadata_string == NULL)
+    return metadata;
+
+  metadata = gst_structure_from_string (factory->metadata_string, NULL);
+  if (metadata == NULL) {
+    GST_WARNING_OBJECT (factory, "Error when trying to deserialize structure "
+        "for metadata '%s'", factory->metadata_string);
+    return NULL;
+  }
+
+  if (!g_atomic_pointer_compare_and_exchange (&factory->metadata, NULL,
+          metadata)) {
+    /* another thread was faster */
+    gst_structure_free (metadata);
+    metadata = g_atomic_pointer_get (&factory->metadata);
+  }
+
+  return metadata;
+}
+
 /**
  * gst_element_factory_get_metadata:
  * @factory: a #GstElementFactory
@@ -873,7 +904,8 @@ gst_element_factory_get_metadata (GstElementFactory * factory,
 {
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
-  return gst_structure_get_string ((GstStructure *) factory->metadata, key);
+  return gst_structure_get_string (gst_element_factory_ensure_metadata
+      (factory), key);
 }
 
 /**
@@ -895,7 +927,7 @@ gst_element_factory_get_metadata_keys (GstElementFactory * factory)
 
   g_return_val_if_fail (GST_IS_ELEMENT_FACTORY (factory), NULL);
 
-  metadata = (GstStructure *) factory->metadata;
+  metadata = gst_element_factory_ensure_metadata (factory);
   if (metadata == NULL)
     return NULL;
 
@@ -1145,6 +1177,181 @@ element_filter (GstPluginFeature * feature, FilterData * data)
   return res;
 }
 
+/* Index of the element factories of the default registry, used to speed up
+ * autoplugging lookups. It maps the structure names of the pad template caps
+ * to the factories that have a template with that name in each direction,
+ * and caches the result of gst_element_factory_list_get_elements() for each
+ * type/rank combination. The index is thrown away and rebuilt whenever the
+ * registry feature list cookie changes, which happens when features are
+ * added or removed and when a rank changes. */
+typedef struct
+{
+  guint32 cookie;
+
+  /* all factories in the index, owns a ref */
+  GHashTable *factories;
+  /* per pad direction, structure name -> set of factories */
+  GHashTable *by_name[2];
+  /* per pad direction, factories with ANY template caps */
+  GHashTable *any[2];
+
+  /* FilterData -> GList of factories, protected by the index lock */
+  GHashTable *lists;
+} ElementFactoryIndex;
+
+static GMutex index_lock;
+static ElementFactoryIndex *factory_index;
+
+#define INDEX_DIRECTION(dir) ((dir) == GST_PAD_SRC ? 0 : 1)
+
+static guint
+filter_data_hash (const FilterData * data)
+{
+  return g_int64_hash (&data->type) ^ g_int_hash (&data->minrank);
+}
+
+static gboolean
+filter_data_equal (const FilterData * a, const FilterData * b)
+{
+  return a->type == b->type && a->minrank == b->minrank;
+}
+
+static void
+element_factory_index_clear (ElementFactoryIndex * index)
+{
+  gint i;
+
+  g_hash_table_unref (index->lists);
+  for (i = 0; i < 2; i++) {
+    g_hash_table_unref (index->by_name[i]);
+    g_hash_table_unref (index->any[i]);
+  }
+  g_hash_table_unref (index->factories);
+}
+
+static void
+element_factory_index_unref (ElementFactoryIndex * index)
+{
+  g_atomic_rc_box_release_full (index,
+      (GDestroyNotify) element_factory_index_clear);
+}
+
+static ElementFactoryIndex *
+element_factory_index_new (GstRegistry * registry)
+{
+  ElementFactoryIndex *index;
+  GList *features, *l;
+  gint i;
+
+  index = g_atomic_rc_box_new0 (ElementFactoryIndex);
+  index->cookie = gst_registry_get_feature_list_cookie (registry);
+  index->factories = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      NULL);
+  for (i = 0; i < 2; i++) {
+    index->by_name[i] = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, (GDestroyNotify) g_hash_table_unref);
+    index->any[i] = g_hash_table_new (NULL, NULL);
+  }
+  index->lists = g_hash_table_new_full ((GHashFunc) filter_data_hash,
+      (GEqualFunc) filter_data_equal, g_free,
+      (GDestroyNotify) gst_plugin_feature_list_free);
+
+  features = gst_registry_get_feature_list (registry,
+      GST_TYPE_ELEMENT_FACTORY);
+
+  for (l = features; l; l = l->next) {
+    GstElementFactory *factory = l->data;
+    const GList *walk;
+
+    for (walk = factory->staticpadtemplates; walk; walk = walk->next) {
+      GstStaticPadTemplate *templ = walk->data;
+      GHashTable *by_name;
+      GstCaps *caps;
+      guint j, n;
+
+      if (templ->direction != GST_PAD_SRC && templ->direction != GST_PAD_SINK)
+        continue;
+
+      /* parses the caps once, they are kept around in the static caps */
+      caps = gst_static_caps_get (&templ->static_caps);
+      i = INDEX_DIRECTION (templ->direction);
+
+      if (gst_caps_is_any (caps)) {
+        g_hash_table_add (index->any[i], factory);
+        gst_caps_unref (caps);
+        continue;
+      }
+
+      by_name = index->by_name[i];
+      n = gst_caps_get_size (caps);
+      for (j = 0; j < n; j++) {
+        const gchar *name =
+            gst_structure_get_name (gst_caps_get_structure (caps, j));
+        GHashTable *set;
+
+        set = g_hash_table_lookup (by_name, name);
+        if (set == NULL) {
+          set = g_hash_table_new (NULL, NULL);
+          g_hash_table_insert (by_name, g_strdup (name), set);
+        }
+        g_hash_table_add (set, factory);
+      }
+      gst_caps_unref (caps);
+    }
+
+    /* transfer the ref of the feature list to the index */
+    g_hash_table_add (index->factories, factory);
+  }
+  g_list_free (features);
+
+  GST_DEBUG ("indexed %u element factories, cookie %u",
+      g_hash_table_size (index->factories), index->cookie);
+
+  return index;
+}
+
+/* Makes sure the index matches the current state of the default registry.
+ * Must be called with the index lock taken. */
+static ElementFactoryIndex *
+element_factory_index_update_unlocked (void)
+{
+  GstRegistry *registry = gst_registry_get ();
+
+  if (factory_index == NULL || factory_index->cookie !=
+      gst_registry_get_feature_list_cookie (registry)) {
+    if (factory_index)
+      element_factory_index_unref (factory_index);
+    factory_index = element_factory_index_new (registry);
+  }
+
+  return factory_index;
+}
+
+/* Returns a ref to the index, the name and factory tables are never modified
+ * after creation so they can be used without the lock */
+static ElementFactoryIndex *
+element_factory_index_get (void)
+{
+  ElementFactoryIndex *index;
+
+  g_mutex_lock (&index_lock);
+  index = g_atomic_rc_box_acquire (element_factory_index_update_unlocked ());
+  g_mutex_unlock (&index_lock);
+
+  return index;
+}
+
+void
+_priv_gst_element_factory_index_cleanup (void)
+{
+  g_mutex_lock (&index_lock);
+  if (factory_index) {
+    element_factory_index_unref (factory_index);
+    factory_index = NULL;
+  }
+  g_mutex_unlock (&index_lock);
+}
+
 /**
  * gst_element_factory_list_get_elements:
  * @type: a #GstElementFactoryListType
@@ -1162,6 +1369,7 @@ GList *
 gst_element_factory_list_get_elements (GstElementFactoryListType type,
     GstRank minrank)
 {
+  ElementFactoryIndex *index;
   GList *result;
   FilterData data;
 
@@ -1169,12 +1377,23 @@ gst_element_factory_list_get_elements (GstElementFactoryListType type,
   data.type = type;
   data.minrank = minrank;
 
-  /* get the feature list using the filter */
-  result = gst_registry_feature_filter (gst_registry_get (),
-      (GstPluginFeatureFilter) element_filter, FALSE, &data);
+  g_mutex_lock (&index_lock);
+  index = element_factory_index_update_unlocked ();
+
+  result = g_hash_table_lookup (index->lists, &data);
+  if (result == NULL && !g_hash_table_contains (index->lists, &data)) {
+    /* get the feature list using the filter */
+    result = gst_registry_feature_filter (gst_registry_get (),
+        (GstPluginFeatureFilter) element_filter, FALSE, &data);
 
-  /* sort on rank and name */
-  result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
+    /* sort on rank and name */
+    result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
+
+    g_hash_table_insert (index->lists, g_memdup2 (&data, sizeof (data)),
+        result);
+  }
+  result = gst_plugin_feature_list_copy (result);
+  g_mutex_unlock (&index_lock);
 
   return result;
 }
@@ -1203,9 +1422,36 @@ gst_element_factory_list_filter (GList * list,
     const GstCaps * caps, GstPadDirection direction, gboolean subsetonly)
 {
   GQueue results = G_QUEUE_INIT;
+  ElementFactoryIndex *index = NULL;
+  GHashTable **sets = NULL;
+  guint n_sets = 0;
 
   GST_DEBUG ("finding factories");
 
+  /* Template caps can only intersect with or contain @caps if they have a
+   * structure with the same name, so look up the factories that have one
+   * in the index and skip all others without touching their caps. ANY and
+   * EMPTY caps can match any template and go through the full check. */
+  if ((direction == GST_PAD_SRC || direction == GST_PAD_SINK) &&
+      !gst_caps_is_any (caps) && !gst_caps_is_empty (caps)) {
+    GHashTable *by_name;
+    guint i, n;
+
+    index = element_factory_index_get ();
+    by_name = index->by_name[INDEX_DIRECTION (direction)];
+
+    n = gst_caps_get_size (caps);
+    sets = g_newa (GHashTable *, n);
+    for (i = 0; i < n; i++) {
+      const gchar *name =
+          gst_structure_get_name (gst_caps_get_structure (caps, i));
+      GHashTable *set = g_hash_table_lookup (by_name, name);
+
+      if (set)
+        sets[n_sets++] = set;
+    }
+  }
+
   /* loop over all the factories */
   for (; list; list = list->next) {
     GstElementFactory *factory;
@@ -1214,6 +1460,21 @@ gst_element_factory_list_filter (GList * list,
 
     factory = (GstElementFactory *) list->data;
 
+    /* factories that are not in the index, e.g. from another registry,
+     * always get the full check */
+    if (index && g_hash_table_contains (index->factories, factory) &&
+        !g_hash_table_contains (index->any[INDEX_DIRECTION (direction)],
+            factory)) {
+      guint i;
+
+      for (i = 0; i < n_sets; i++) {
+        if (g_hash_table_contains (sets[i], factory))
+          break;
+      }
+      if (i == n_sets)
+        continue;
+    }
+
     GST_DEBUG ("Trying %s",
         gst_plugin_feature_get_name ((GstPluginFeature *) factory));
 
@@ -1244,5 +1505,9 @@ gst_element_factory_list_filter (GList * list,
       }
     }
   }
+
+  if (index)
+    element_factory_index_unref (index);
+
   return results.head;
 }
@@ -121,6 +121,11 @@ static char *gst_info_printf_pointer_extension_func (const char *format,
 #  include <unistd.h>           /* getpid on UNIX */
 #endif
 
+#ifdef HAVE_SIGACTION
+#  include <signal.h>
+#  include <fcntl.h>
+#endif
+
 #ifdef HAVE_STDINT_H
 #  include <stdint.h>           /* uintptr_t */
 #endif
@@ -408,6 +413,9 @@ static GSList *__log_functions = NULL;
 /* whether to add the default log function in gst_init() */
 static gboolean add_default_log_func = TRUE;
 
+static void gst_debug_binary_log_init (const gchar * file_name);
+static void gst_debug_binary_log_write_file (void);
+
 #define PRETTY_TAGS_DEFAULT  TRUE
 static gboolean pretty_tags = PRETTY_TAGS_DEFAULT;
 
@@ -451,6 +459,14 @@ _priv_gst_debug_init (void)
   const gchar *env;
   FILE *log_file;
 
+  /* the point of the binary log is to not format anything, so it replaces
+   * the default log function */
+  env = g_getenv ("GST_DEBUG_BINARY_LOG");
+  if (env != NULL && *env != '\0') {
+    gst_debug_binary_log_init (env);
+    add_default_log_func = FALSE;
+  }
+
   if (add_default_log_func) {
     env = g_getenv ("GST_DEBUG_FILE");
     if (env != NULL && *env != '\0') {
@@ -916,6 +932,7 @@ gst_debug_log_literal_full (GstDebugCategory * category, GstLogContext * ctx,
   g_return_if_fail (message_string != NULL);
 
   message.message = (gchar *) message_string;
+  message.format = NULL;
   message.object = object;
   message.object_id = (gchar *) id;
   message.free_object_id = FALSE;
@@ -3261,6 +3278,9 @@ _gst_log_context_cleanup (void)
 void
 _priv_gst_debug_cleanup (void)
 {
+  /* needs the category names */
+  gst_debug_binary_log_write_file ();
+
   /* Clean up our log contexts */
   _gst_log_context_cleanup ();
 
@@ -4568,6 +4588,1384 @@ gst_debug_remove_ring_buffer_logger (void)
   gst_debug_remove_log_function (gst_ring_buffer_logger_log);
 }
 
+/* Binary ring buffer logger
+ *
+ * Unlike the ring buffer logger above this one does not format anything at
+ * log time. Every thread writes fixed size records into its own ring without
+ * taking any lock: the category, file, function and format string are
+ * stored as pointers and the arguments are copied in binary form by walking
+ * the format string. Callers like bindings might free the file, function and
+ * format strings right after logging, so each thread looks up interned
+ * copies of them and only stores pointers to those. String arguments are
+ * copied, and the GStreamer pointer extensions (GST_PTR_FORMAT,
+ * GST_SEGMENT_FORMAT) are formatted right away as the objects they point to
+ * might be gone when the log is dumped.
+ *
+ * gst_debug_binary_ring_buffer_logger_dump() resolves the pointers into a
+ * string table and returns a self-contained blob that is only turned into
+ * text by gst_debug_binary_log_decode(), either in the same process or
+ * offline with gst-debug-decode-1.0.
+ *
+ * Records are 8 byte aligned so their size field never wraps around the end
+ * of the ring. @head and @tail count the bytes written in total and are
+ * only ever changed by the owning thread. Before overwriting old records the
+ * writer moves @tail past them, so a dumping thread that reads @tail again
+ * after copying the ring knows which part of its copy is still intact.
+ */
+#define BINARY_LOG_MAGIC "GSTBLOG"
+#define BINARY_LOG_VERSION 1
+
+#define BINARY_LOG_MIN_SIZE (4 * 1024)
+#define BINARY_LOG_MAX_SIZE (1024 * 1024 * 1024)
+#define BINARY_LOG_DEFAULT_SIZE (1024 * 1024)
+
+/* message is stored as string instead of format arguments */
+#define BINARY_LOG_FLAG_LITERAL (1 << 0)
+
+#define BINARY_LOG_ARG_INT 'i'
+#define BINARY_LOG_ARG_UINT 'u'
+#define BINARY_LOG_ARG_DOUBLE 'd'
+#define BINARY_LOG_ARG_POINTER 'p'
+#define BINARY_LOG_ARG_STRING 's'
+#define BINARY_LOG_ARG_TIME 'T'
+#define BINARY_LOG_ARG_STIME 'S'
+
+typedef struct
+{
+  guint32 size;
+  guint8 level;
+  guint8 flags;
+  guint16 id_len;
+  gint32 line;
+  guint32 args_len;
+  guint64 timestamp;
+  guint64 category;
+  guint64 file;
+  guint64 function;
+  guint64 format;
+  /* followed by id_len bytes of object id and args_len bytes of arguments */
+} GstBinaryLogRecord;
+
+typedef struct
+{
+  GstTid thread;
+  guint generation;
+  gboolean exited;
+  gint64 exit_time;
+
+  guint8 *data;
+  guint size;
+  gint head;
+  gint tail;
+  guint dropped;
+
+  /* record being built, NULL while in use */
+  GByteArray *scratch;
+  /* address of a logged string -> interned copy of it */
+  GHashTable *strings;
+} GstBinaryLogRing;
+
+typedef struct
+{
+  guint ring_size;
+  guint thread_timeout;
+  guint generation;
+} GstBinaryLogger;
+
+static GMutex binary_logger_lock;
+static GstBinaryLogger *binary_logger = NULL;
+static guint binary_logger_generation = 0;
+/* GstBinaryLogRing of the current logger */
+static GList *binary_log_rings = NULL;
+static gchar *binary_log_file = NULL;
+
+static void binary_log_ring_exit (gpointer data);
+static GPrivate binary_log_ring_key = G_PRIVATE_INIT (binary_log_ring_exit);
+
+static void
+binary_log_ring_free (GstBinaryLogRing * ring)
+{
+  g_free (ring->data);
+  if (ring->scratch)
+    g_byte_array_unref (ring->scratch);
+  if (ring->strings)
+    g_hash_table_unref (ring->strings);
+  g_free (ring);
+}
+
+static void
+binary_log_ring_exit (gpointer data)
+{
+  GstBinaryLogRing *ring = data;
+
+  g_mutex_lock (&binary_logger_lock);
+  if (binary_logger && ring->generation == binary_logger->generation) {
+    /* keep the log of the thread around until it times out */
+    ring->exited = TRUE;
+    ring->exit_time = g_get_monotonic_time ();
+    g_clear_pointer (&ring->scratch, g_byte_array_unref);
+  } else {
+    binary_log_ring_free (ring);
+  }
+  g_mutex_unlock (&binary_logger_lock);
+}
+
+static GstBinaryLogRing *
+binary_log_ring_setup (GstBinaryLogger * logger, GstBinaryLogRing * ring)
+{
+  g_mutex_lock (&binary_logger_lock);
+
+  if (logger->thread_timeout > 0) {
+    gint64 now = g_get_monotonic_time ();
+    GList *l, *next;
+
+    for (l = binary_log_rings; l; l = next) {
+      GstBinaryLogRing *r = l->data;
+
+      next = l->next;
+      if (r->exited
+          && r->exit_time + logger->thread_timeout * G_USEC_PER_SEC < now) {
+        binary_log_rings = g_list_delete_link (binary_log_rings, l);
+        binary_log_ring_free (r);
+      }
+    }
+  }
+
+  if (ring == NULL) {
+    ring = g_new0 (GstBinaryLogRing, 1);
+    ring->thread = _get_thread_id ();
+    ring->scratch = g_byte_array_new ();
+    ring->strings = g_hash_table_new (NULL, NULL);
+    g_private_set (&binary_log_ring_key, ring);
+  }
+
+  g_free (ring->data);
+  ring->size = logger->ring_size;
+  ring->data = g_malloc (ring->size);
+  ring->head = ring->tail = 0;
+  ring->dropped = 0;
+  ring->generation = logger->generation;
+  binary_log_rings = g_list_prepend (binary_log_rings, ring);
+
+  g_mutex_unlock (&binary_logger_lock);
+
+  return ring;
+}
+
+static void
+binary_log_ring_push (GstBinaryLogRing * ring, const guint8 * record,
+    guint len)
+{
+  guint mask = ring->size - 1;
+  guint head = (guint) ring->head;
+  guint tail = (guint) ring->tail;
+  guint offset, chunk;
+
+  if (len > ring->size) {
+    ring->dropped++;
+    return;
+  }
+
+  if (head + len - tail > ring->size) {
+    guint old_tail = tail;
+
+    while (head + len - tail > ring->size) {
+      guint32 size;
+
+      memcpy (&size, ring->data + (tail & mask), sizeof (size));
+      tail += size;
+    }
+    /* full barrier, the new tail must be visible before the old records are
+     * overwritten. We're the only writer so this always succeeds */
+    g_atomic_int_compare_and_exchange (&ring->tail, (gint) old_tail,
+        (gint) tail);
+  }
+
+  offset = head & mask;
+  chunk = MIN (len, ring->size - offset);
+  memcpy (ring->data + offset, record, chunk);
+  memcpy (ring->data, record + chunk, len - chunk);
+
+  g_atomic_int_set (&ring->head, (gint) (head + len));
+}
+
+/* Copies the complete records of @ring, must be called with the
+ * binary_logger_lock */
+static guint8 *
+binary_log_ring_snapshot (GstBinaryLogRing * ring, guint * len)
+{
+  guint mask = ring->size - 1;
+  guint tail, head, new_tail, n, offset, chunk;
+  guint8 *copy;
+
+  tail = (guint) g_atomic_int_get (&ring->tail);
+  head = (guint) g_atomic_int_get (&ring->head);
+  n = head - tail;
+
+  copy = g_malloc (MAX (n, 1));
+  offset = tail & mask;
+  chunk = MIN (n, ring->size - offset);
+  memcpy (copy, ring->data + offset, chunk);
+  memcpy (copy + chunk, ring->data, n - chunk);
+
+  /* full barrier, records from the new tail on were not overwritten while
+   * copying */
+  new_tail = (guint) g_atomic_int_add (&ring->tail, 0);
+  if (new_tail - tail >= n) {
+    *len = 0;
+  } else {
+    *len = n - (new_tail - tail);
+    memmove (copy, copy + (new_tail - tail), *len);
+  }
+
+  return copy;
+}
+
+static inline void
+binary_log_put (GByteArray * out, gchar tag, gconstpointer data, guint size)
+{
+  g_byte_array_append (out, (const guint8 *) &tag, 1);
+  g_byte_array_append (out, data, size);
+}
+
+static void
+binary_log_put_string (GByteArray * out, const gchar * s, gint precision)
+{
+  guint32 len = G_MAXUINT32;
+
+  if (s)
+    len = precision >= 0 ? strnlen (s, precision) : strlen (s);
+
+  binary_log_put (out, BINARY_LOG_ARG_STRING, &len, sizeof (len));
+  if (s)
+    g_byte_array_append (out, (const guint8 *) s, len);
+}
+
+enum
+{
+  LEN_NONE,
+  LEN_HH,
+  LEN_H,
+  LEN_L,
+  LEN_LL,
+  LEN_LONG_DOUBLE,
+  LEN_Z,
+  LEN_T
+};
+
+/* Copies the arguments of @format into @out. Returns FALSE for anything
+ * that can't be recorded without formatting, the message is then formatted
+ * right away */
+static gboolean
+binary_log_encode_args (GByteArray * out, const gchar * format, va_list args)
+{
+  const gchar *p = format;
+
+  while ((p = strchr (p, '%'))) {
+    gint precision = -1, len = LEN_NONE;
+    gint64 v;
+
+    p++;
+    if (*p == '%') {
+      p++;
+      continue;
+    }
+
+    while (*p != '\0' && strchr ("-+ #0'", *p))
+      p++;
+
+    if (*p == '*') {
+      v = va_arg (args, int);
+      binary_log_put (out, BINARY_LOG_ARG_INT, &v, sizeof (v));
+      p++;
+    } else {
+      while (g_ascii_isdigit (*p))
+        p++;
+      /* positional arguments */
+      if (*p == '$')
+        return FALSE;
+    }
+
+    if (*p == '.') {
+      p++;
+      if (*p == '*') {
+        v = precision = va_arg (args, int);
+        binary_log_put (out, BINARY_LOG_ARG_INT, &v, sizeof (v));
+        p++;
+      } else {
+        precision = 0;
+        while (g_ascii_isdigit (*p))
+          precision = precision * 10 + (*p++ - '0');
+      }
+    }
+
+    switch (*p) {
+      case 'h':
+        len = (*++p == 'h') ? (p++, LEN_HH) : LEN_H;
+        break;
+      case 'l':
+        len = (*++p == 'l') ? (p++, LEN_LL) : LEN_L;
+        break;
+      case 'q':
+        p++;
+        len = LEN_LL;
+        break;
+      case 'L':
+        p++;
+        len = LEN_LONG_DOUBLE;
+        break;
+      case 'z':
+        p++;
+        len = LEN_Z;
+        break;
+      case 't':
+        p++;
+        len = LEN_T;
+        break;
+      default:
+        break;
+    }
+
+    switch (*p) {
+      case 'd':
+      case 'i':{
+        switch (len) {
+          case LEN_HH:
+            v = (signed char) va_arg (args, int);
+            break;
+          case LEN_H:
+            v = (short) va_arg (args, int);
+            break;
+          case LEN_L:
+            v = va_arg (args, long);
+            break;
+          case LEN_LL:
+          case LEN_LONG_DOUBLE:
+            v = va_arg (args, long long);
+            break;
+          case LEN_Z:
+          case LEN_T:
+            v = va_arg (args, gssize);
+            break;
+          default:
+            v = va_arg (args, int);
+            break;
+        }
+        binary_log_put (out, BINARY_LOG_ARG_INT, &v, sizeof (v));
+        break;
+      }
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':{
+        guint64 u;
+
+        switch (len) {
+          case LEN_HH:
+            u = (unsigned char) va_arg (args, unsigned int);
+            break;
+          case LEN_H:
+            u = (unsigned short) va_arg (args, unsigned int);
+            break;
+          case LEN_L:
+            u = va_arg (args, unsigned long);
+            break;
+          case LEN_LL:
+          case LEN_LONG_DOUBLE:
+            u = va_arg (args, unsigned long long);
+            break;
+          case LEN_Z:
+          case LEN_T:
+            u = va_arg (args, gsize);
+            break;
+          default:
+            u = va_arg (args, unsigned int);
+            break;
+        }
+        binary_log_put (out, BINARY_LOG_ARG_UINT, &u, sizeof (u));
+        break;
+      }
+      case 'c':
+        if (len != LEN_NONE)
+          return FALSE;
+        v = va_arg (args, int);
+        binary_log_put (out, BINARY_LOG_ARG_INT, &v, sizeof (v));
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':{
+        gdouble d;
+
+        if (len == LEN_LONG_DOUBLE)
+          d = va_arg (args, long double);
+        else
+          d = va_arg (args, double);
+        binary_log_put (out, BINARY_LOG_ARG_DOUBLE, &d, sizeof (d));
+        break;
+      }
+      case 's':
+        if (len != LEN_NONE)
+          return FALSE;
+        binary_log_put_string (out, va_arg (args, const gchar *), precision);
+        break;
+      case 'p':{
+        gpointer ptr = va_arg (args, gpointer);
+
+        if (p[1] == '\a' && p[2] != '\0') {
+          if ((p[2] == 'T' || p[2] == 'S') && ptr != NULL) {
+            binary_log_put (out, p[2], ptr, sizeof (guint64));
+          } else {
+            gchar *s = gst_info_printf_pointer_extension_func (p, ptr);
+
+            binary_log_put_string (out, s, -1);
+            g_free (s);
+          }
+          p += 2;
+        } else {
+          guint64 u = (guintptr) ptr;
+
+          binary_log_put (out, BINARY_LOG_ARG_POINTER, &u, sizeof (u));
+        }
+        break;
+      }
+      default:
+        return FALSE;
+    }
+    p++;
+  }
+
+  return TRUE;
+}
+
+/* Returns a copy of @str that stays valid until the log is dumped. Strings
+ * are almost always literals that stay at the same address, so a hit on the
+ * address is trusted after checking the first character, which catches most
+ * strings that were freed and replaced by another one at the same address
+ * without comparing the whole string on every call. */
+static guint64
+binary_log_ring_intern (GstBinaryLogRing * ring, const gchar * str)
+{
+  const gchar *interned;
+
+  if (str == NULL)
+    return 0;
+
+  interned = g_hash_table_lookup (ring->strings, str);
+  if (G_UNLIKELY (interned == NULL || interned[0] != str[0])) {
+    interned = g_intern_string (str);
+    g_hash_table_insert (ring->strings, (gpointer) str, (gpointer) interned);
+  }
+
+  return (guintptr) interned;
+}
+
+static void
+gst_binary_ring_buffer_logger_log (GstDebugCategory * category,
+    GstDebugLevel level, const gchar * file, const gchar * function,
+    gint line, GObject * object, GstDebugMessage * message, gpointer user_data)
+{
+  GstBinaryLogger *logger = user_data;
+  GstBinaryLogRing *ring;
+  GstBinaryLogRecord record;
+  GByteArray *buf;
+  const gchar *object_id;
+  gboolean encoded = FALSE;
+  guint len;
+
+  ring = g_private_get (&binary_log_ring_key);
+  if (G_UNLIKELY (ring == NULL || ring->generation != logger->generation))
+    ring = binary_log_ring_setup (logger, ring);
+
+  /* formatting a pointer extension might log again from this thread */
+  buf = ring->scratch;
+  ring->scratch = NULL;
+  if (G_UNLIKELY (buf == NULL))
+    buf = g_byte_array_new ();
+
+  g_byte_array_set_size (buf, sizeof (record));
+
+  record.id_len = 0;
+  object_id = gst_debug_message_get_id (message);
+  if (object_id) {
+    record.id_len = MIN (strlen (object_id), G_MAXUINT16);
+    g_byte_array_append (buf, (const guint8 *) object_id, record.id_len);
+  }
+
+  /* The arguments can't be used anymore once another log function formatted
+   * the message */
+  if (message->format != NULL && message->message == NULL) {
+    va_list arguments;
+
+    G_VA_COPY (arguments, message->arguments);
+    encoded = binary_log_encode_args (buf, message->format, arguments);
+    va_end (arguments);
+  }
+
+  if (encoded) {
+    record.flags = 0;
+    record.format = binary_log_ring_intern (ring, message->format);
+  } else {
+    const gchar *message_str = gst_debug_message_get (message);
+
+    g_byte_array_set_size (buf, sizeof (record) + record.id_len);
+    if (message_str)
+      g_byte_array_append (buf, (const guint8 *) message_str,
+          strlen (message_str));
+    record.flags = BINARY_LOG_FLAG_LITERAL;
+    record.format = 0;
+  }
+
+  len = buf->len;
+  g_byte_array_set_size (buf, GST_ROUND_UP_8 (len));
+
+  record.size = buf->len;
+  record.level = level;
+  record.line = line;
+  record.args_len = len - sizeof (record) - record.id_len;
+  record.timestamp =
+      GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ());
+  record.category = (guintptr) category;
+  record.file = binary_log_ring_intern (ring, file);
+  record.function = binary_log_ring_intern (ring, function);
+  memcpy (buf->data, &record, sizeof (record));
+
+  binary_log_ring_push (ring, buf->data, buf->len);
+
+  if (ring->scratch == NULL)
+    ring->scratch = buf;
+  else
+    g_byte_array_unref (buf);
+}
+
+static void
+gst_binary_ring_buffer_logger_free (GstBinaryLogger * logger)
+{
+  g_mutex_lock (&binary_logger_lock);
+  if (binary_logger == logger) {
+    GstBinaryLogRing *ring;
+
+    /* rings of running threads are owned by their thread again and only
+     * lose their data */
+    while (binary_log_rings) {
+      ring = binary_log_rings->data;
+      if (ring->exited) {
+        binary_log_ring_free (ring);
+      } else {
+        g_clear_pointer (&ring->data, g_free);
+        ring->generation = 0;
+      }
+      binary_log_rings =
+          g_list_delete_link (binary_log_rings, binary_log_rings);
+    }
+
+    g_free (logger);
+    binary_logger = NULL;
+  }
+  g_mutex_unlock (&binary_logger_lock);
+}
+
+/**
+ * gst_debug_add_binary_ring_buffer_logger:
+ * @max_size_per_thread: Maximum size of log per thread in bytes
+ * @thread_timeout: Timeout for exited threads in seconds
+ *
+ * Adds a memory ringbuffer based debug logger like
+ * gst_debug_add_ring_buffer_logger(), but stores the messages in binary form
+ * without formatting them. This makes logging at high debug levels a lot
+ * cheaper, formatting only happens when the logs are decoded.
+ *
+ * Each thread writes to its own ring buffer of @max_size_per_thread bytes,
+ * rounded up to a power of two, without taking any locks. The logs of
+ * threads that exited are dropped after @thread_timeout seconds, or kept
+ * until the logger is removed if @thread_timeout is 0.
+ *
+ * String arguments are copied and arguments printed with the GStreamer
+ * printf extensions like %GST_PTR_FORMAT are still formatted when logging.
+ * The format strings, file and function names themselves are only
+ * referenced, which is fine as plugins are never unloaded.
+ *
+ * Logs can be fetched with gst_debug_binary_ring_buffer_logger_dump() and
+ * the logger can be removed again with
+ * gst_debug_remove_binary_ring_buffer_logger(). Only one logger at a time is
+ * possible.
+ *
+ * Since: 1.30
+ */
+void
+gst_debug_add_binary_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+  GstBinaryLogger *logger;
+
+  g_mutex_lock (&binary_logger_lock);
+
+  if (binary_logger) {
+    g_warn_if_reached ();
+    g_mutex_unlock (&binary_logger_lock);
+    return;
+  }
+
+  logger = binary_logger = g_new0 (GstBinaryLogger, 1);
+
+  max_size_per_thread = CLAMP (max_size_per_thread, BINARY_LOG_MIN_SIZE,
+      BINARY_LOG_MAX_SIZE);
+  logger->ring_size = 1U << g_bit_storage (max_size_per_thread - 1);
+  logger->thread_timeout = thread_timeout;
+  /* 0 is never used so that a cleared ring never matches */
+  if (++binary_logger_generation == 0)
+    ++binary_logger_generation;
+  logger->generation = binary_logger_generation;
+
+  gst_debug_add_log_function (gst_binary_ring_buffer_logger_log, logger,
+      (GDestroyNotify) gst_binary_ring_buffer_logger_free);
+  g_mutex_unlock (&binary_logger_lock);
+}
+
+/**
+ * gst_debug_remove_binary_ring_buffer_logger:
+ *
+ * Removes any previously added binary ring buffer logger with
+ * gst_debug_add_binary_ring_buffer_logger().
+ *
+ * Since: 1.30
+ */
+void
+gst_debug_remove_binary_ring_buffer_logger (void)
+{
+  gst_debug_remove_log_function (gst_binary_ring_buffer_logger_log);
+}
+
+typedef struct
+{
+  guint64 thread;
+  guint8 *data;
+  guint len;
+} GstBinaryLogSnapshot;
+
+static inline void
+binary_log_write (GByteArray * out, gconstpointer data, guint size)
+{
+  g_byte_array_append (out, data, size);
+}
+
+static void
+binary_log_add_string (GHashTable * strings, guint64 key, const gchar * str)
+{
+  if (key != 0 && str != NULL)
+    g_hash_table_insert (strings, (gpointer) (guintptr) key, (gpointer) str);
+}
+
+/* When @crashing the locks are only tried, the thread that crashed might
+ * hold them */
+static GBytes *
+binary_log_dump (gboolean crashing)
+{
+  GstBinaryLogSnapshot *snapshots;
+  GHashTable *strings, *categories;
+  GHashTableIter iter;
+  gpointer key, value;
+  GByteArray *out;
+  guint32 n_threads, n_strings, u32;
+  guint i;
+  GList *l;
+
+  if (crashing) {
+    if (!g_mutex_trylock (&binary_logger_lock))
+      return NULL;
+  } else {
+    g_mutex_lock (&binary_logger_lock);
+  }
+  if (binary_logger == NULL) {
+    g_mutex_unlock (&binary_logger_lock);
+    return NULL;
+  }
+
+  n_threads = g_list_length (binary_log_rings);
+  snapshots = g_new0 (GstBinaryLogSnapshot, n_threads);
+  for (i = 0, l = binary_log_rings; l; l = l->next, i++) {
+    GstBinaryLogRing *ring = l->data;
+
+    snapshots[i].thread = (guint64) (guintptr) ring->thread;
+    snapshots[i].data = binary_log_ring_snapshot (ring, &snapshots[i].len);
+    if (ring->dropped > 0 && !crashing)
+      GST_WARNING ("dropped %u records of thread %" G_GUINT64_FORMAT
+          " that were bigger than the ring", ring->dropped,
+          snapshots[i].thread);
+  }
+  g_mutex_unlock (&binary_logger_lock);
+
+  /* the category names must stay around until everything is written */
+  if (crashing) {
+    if (!g_mutex_trylock (&__cat_mutex)) {
+      for (i = 0; i < n_threads; i++)
+        g_free (snapshots[i].data);
+      g_free (snapshots);
+      return NULL;
+    }
+  } else {
+    g_mutex_lock (&__cat_mutex);
+  }
+
+  categories = g_hash_table_new (NULL, NULL);
+  for (GSList * c = __categories; c; c = c->next) {
+    GstDebugCategory *cat = c->data;
+
+    g_hash_table_insert (categories, cat, (gpointer) cat->name);
+  }
+
+  strings = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < n_threads; i++) {
+    guint pos = 0;
+
+    while (pos + sizeof (GstBinaryLogRecord) <= snapshots[i].len) {
+      GstBinaryLogRecord record;
+
+      memcpy (&record, snapshots[i].data + pos, sizeof (record));
+      if (record.size < sizeof (record) || record.size > snapshots[i].len - pos)
+        break;
+
+      binary_log_add_string (strings, record.category,
+          g_hash_table_lookup (categories,
+              (gpointer) (guintptr) record.category));
+      binary_log_add_string (strings, record.file,
+          (const gchar *) (guintptr) record.file);
+      binary_log_add_string (strings, record.function,
+          (const gchar *) (guintptr) record.function);
+      binary_log_add_string (strings, record.format,
+          (const gchar *) (guintptr) record.format);
+
+      pos += record.size;
+    }
+  }
+
+  out = g_byte_array_new ();
+  binary_log_write (out, BINARY_LOG_MAGIC, sizeof (BINARY_LOG_MAGIC));
+  u32 = BINARY_LOG_VERSION;
+  binary_log_write (out, &u32, sizeof (u32));
+  u32 = _gst_getpid ();
+  binary_log_write (out, &u32, sizeof (u32));
+  n_strings = g_hash_table_size (strings);
+  binary_log_write (out, &n_strings, sizeof (n_strings));
+  binary_log_write (out, &n_threads, sizeof (n_threads));
+
+  g_hash_table_iter_init (&iter, strings);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    guint64 k = (guintptr) key;
+
+    u32 = strlen (value);
+    binary_log_write (out, &k, sizeof (k));
+    binary_log_write (out, &u32, sizeof (u32));
+    binary_log_write (out, value, u32);
+  }
+
+  g_mutex_unlock (&__cat_mutex);
+
+  for (i = 0; i < n_threads; i++) {
+    binary_log_write (out, &snapshots[i].thread, sizeof (guint64));
+    binary_log_write (out, &snapshots[i].len, sizeof (guint32));
+    binary_log_write (out, snapshots[i].data, snapshots[i].len);
+    g_free (snapshots[i].data);
+  }
+
+  g_free (snapshots);
+  g_hash_table_unref (strings);
+  g_hash_table_unref (categories);
+
+  return g_byte_array_free_to_bytes (out);
+}
+
+/**
+ * gst_debug_binary_ring_buffer_logger_dump:
+ *
+ * Fetches the current logs of all threads from the binary ring buffer
+ * logger. See gst_debug_add_binary_ring_buffer_logger() for details.
+ *
+ * The returned data is self-contained and can be converted to text with
+ * gst_debug_binary_log_decode(), or stored in a file to be decoded later
+ * with the gst-debug-decode-1.0 tool on a machine with the same
+ * architecture.
+ *
+ * Returns: (transfer full) (nullable): the binary logs, or %NULL if no
+ * binary ring buffer logger was added
+ *
+ * Since: 1.30
+ */
+GBytes *
+gst_debug_binary_ring_buffer_logger_dump (void)
+{
+  return binary_log_dump (FALSE);
+}
+
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  gsize pos;
+} GstBinaryLogReader;
+
+static gboolean
+binary_log_read (GstBinaryLogReader * reader, gpointer dest, gsize size)
+{
+  if (reader->size - reader->pos < size)
+    return FALSE;
+  memcpy (dest, reader->data + reader->pos, size);
+  reader->pos += size;
+  return TRUE;
+}
+
+static gboolean
+binary_log_read_arg (GstBinaryLogReader * reader, gchar tag, gpointer dest)
+{
+  if (reader->pos >= reader->size || reader->data[reader->pos] != tag)
+    return FALSE;
+  reader->pos++;
+  return binary_log_read (reader, dest, 8);
+}
+
+static gboolean
+binary_log_read_string (GstBinaryLogReader * reader, gchar ** dest)
+{
+  guint32 len;
+
+  if (reader->pos >= reader->size
+      || reader->data[reader->pos] != BINARY_LOG_ARG_STRING)
+    return FALSE;
+  reader->pos++;
+  if (!binary_log_read (reader, &len, sizeof (len)))
+    return FALSE;
+
+  if (len == G_MAXUINT32) {
+    *dest = NULL;
+    return TRUE;
+  }
+  if (reader->size - reader->pos < len)
+    return FALSE;
+
+  *dest = g_strndup ((const gchar *) reader->data + reader->pos, len);
+  reader->pos += len;
+  return TRUE;
+}
+
+static void
+binary_log_append_printf (GString * str, const gchar * spec, ...)
+{
+  va_list args;
+
+  va_start (args, spec);
+  GST_DISABLE_FORMAT_NONLITERAL_WARNING;
+  g_string_append_vprintf (str, spec, args);
+  GST_ENABLE_FORMAT_NONLITERAL_WARNING;
+  va_end (args);
+}
+
+/* Formats one message the same way printf would have, taking the arguments
+ * from what binary_log_encode_args() recorded */
+static void
+binary_log_format_message (GString * str, const gchar * format,
+    GstBinaryLogReader * args)
+{
+  const gchar *p = format;
+  gchar spec[32];
+  guint n;
+
+#define SPEC_APPEND(c) G_STMT_START {           \
+  if (n + 1 >= sizeof (spec) - 4) goto corrupt; \
+  spec[n++] = (c);                              \
+} G_STMT_END
+
+  while (*p) {
+    const gchar *pct = strchr (p, '%');
+
+    if (pct == NULL) {
+      g_string_append (str, p);
+      break;
+    }
+    g_string_append_len (str, p, pct - p);
+    p = pct + 1;
+
+    if (*p == '%') {
+      g_string_append_c (str, '%');
+      p++;
+      continue;
+    }
+
+    n = 0;
+    SPEC_APPEND ('%');
+    while (*p != '\0' && strchr ("-+ #0'", *p))
+      SPEC_APPEND (*p++);
+
+    if (*p == '*') {
+      gint64 width;
+
+      if (!binary_log_read_arg (args, BINARY_LOG_ARG_INT, &width))
+        goto corrupt;
+      if (width < 0) {
+        SPEC_APPEND ('-');
+        width = -width;
+      }
+      n += g_snprintf (spec + n, sizeof (spec) - n, "%d", (gint) width);
+      p++;
+    } else {
+      while (g_ascii_isdigit (*p))
+        SPEC_APPEND (*p++);
+    }
+
+    if (*p == '.') {
+      p++;
+      if (*p == '*') {
+        gint64 precision;
+
+        if (!binary_log_read_arg (args, BINARY_LOG_ARG_INT, &precision))
+          goto corrupt;
+        /* a negative precision is taken as if it was omitted */
+        if (precision >= 0)
+          n += g_snprintf (spec + n, sizeof (spec) - n, ".%d",
+              (gint) precision);
+        p++;
+      } else {
+        SPEC_APPEND ('.');
+        while (g_ascii_isdigit (*p))
+          SPEC_APPEND (*p++);
+      }
+    }
+    if (n >= sizeof (spec) - 4)
+      goto corrupt;
+
+    while (*p != '\0' && strchr ("hlLqzt", *p))
+      p++;
+
+    switch (*p) {
+      case 'd':
+      case 'i':
+      case 'c':{
+        gint64 v;
+
+        if (!binary_log_read_arg (args, BINARY_LOG_ARG_INT, &v))
+          goto corrupt;
+        if (*p == 'c') {
+          spec[n++] = 'c';
+          spec[n] = '\0';
+          binary_log_append_printf (str, spec, (gint) v);
+        } else {
+          g_strlcpy (spec + n, G_GINT64_MODIFIER "d", sizeof (spec) - n);
+          binary_log_append_printf (str, spec, v);
+        }
+        break;
+      }
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':{
+        guint64 v;
+
+        if (!binary_log_read_arg (args, BINARY_LOG_ARG_UINT, &v))
+          goto corrupt;
+        n += g_strlcpy (spec + n, G_GINT64_MODIFIER, sizeof (spec) - n);
+        spec[n++] = *p;
+        spec[n] = '\0';
+        binary_log_append_printf (str, spec, v);
+        break;
+      }
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':{
+        gdouble v;
+
+        if (!binary_log_read_arg (args, BINARY_LOG_ARG_DOUBLE, &v))
+          goto corrupt;
+        spec[n++] = *p;
+        spec[n] = '\0';
+        binary_log_append_printf (str, spec, v);
+        break;
+      }
+      case 's':{
+        gchar *s;
+
+        if (!binary_log_read_string (args, &s))
+          goto corrupt;
+        spec[n++] = 's';
+        spec[n] = '\0';
+        binary_log_append_printf (str, spec, s ? s : "(NULL)");
+        g_free (s);
+        break;
+      }
+      case 'p':{
+        guint64 v;
+        gchar *s;
+
+        if (p[1] == '\a' && p[2] != '\0') {
+          if (binary_log_read_arg (args, BINARY_LOG_ARG_TIME, &v)) {
+            g_string_append_printf (str, "%" GST_TIME_FORMAT,
+                GST_TIME_ARGS (v));
+          } else if (binary_log_read_arg (args, BINARY_LOG_ARG_STIME, &v)) {
+            g_string_append_printf (str, "%" GST_STIME_FORMAT,
+                GST_STIME_ARGS ((gint64) v));
+          } else if (binary_log_read_string (args, &s)) {
+            g_string_append (str, s ? s : "(NULL)");
+            g_free (s);
+          } else {
+            goto corrupt;
+          }
+          p += 2;
+        } else {
+          if (!binary_log_read_arg (args, BINARY_LOG_ARG_POINTER, &v))
+            goto corrupt;
+          spec[n++] = 'p';
+          spec[n] = '\0';
+          binary_log_append_printf (str, spec, (gpointer) (guintptr) v);
+        }
+        break;
+      }
+      default:
+        goto corrupt;
+    }
+    p++;
+  }
+
+#undef SPEC_APPEND
+
+  return;
+
+corrupt:
+  g_string_append (str, "<corrupt arguments>");
+}
+
+typedef struct
+{
+  guint64 timestamp;
+  guint64 thread;
+  guint seqnum;
+  const guint8 *data;
+} GstBinaryLogEntry;
+
+static gint
+binary_log_entry_compare (gconstpointer a, gconstpointer b)
+{
+  const GstBinaryLogEntry *ea = a, *eb = b;
+
+  if (ea->timestamp != eb->timestamp)
+    return ea->timestamp < eb->timestamp ? -1 : 1;
+  return ea->seqnum < eb->seqnum ? -1 : (ea->seqnum > eb->seqnum);
+}
+
+static const gchar *
+binary_log_lookup_string (GHashTable * strings, guint64 key,
+    const gchar * fallback)
+{
+  const gchar *s = g_hash_table_lookup (strings, &key);
+
+  return s ? s : fallback;
+}
+
+/**
+ * gst_debug_binary_log_decode:
+ * @log: binary logs as returned by gst_debug_binary_ring_buffer_logger_dump()
+ *
+ * Formats binary logs the same way the default log function prints them
+ * without colors, with the messages of all threads ordered by time.
+ *
+ * Returns: (transfer full) (nullable): the formatted logs, or %NULL if @log
+ * is not valid
+ *
+ * Since: 1.30
+ */
+gchar *
+gst_debug_binary_log_decode (GBytes * log)
+{
+  GstBinaryLogReader reader = { NULL, };
+  gchar magic[sizeof (BINARY_LOG_MAGIC)];
+  guint32 version, pid, n_strings, n_threads, i;
+  GHashTable *strings = NULL;
+  guint64 *keys = NULL;
+  GArray *entries = NULL;
+  GString *str = NULL;
+
+  g_return_val_if_fail (log != NULL, NULL);
+
+  reader.data = g_bytes_get_data (log, &reader.size);
+
+  if (!binary_log_read (&reader, magic, sizeof (magic))
+      || memcmp (magic, BINARY_LOG_MAGIC, sizeof (magic)) != 0
+      || !binary_log_read (&reader, &version, sizeof (version))
+      || version != BINARY_LOG_VERSION
+      || !binary_log_read (&reader, &pid, sizeof (pid))
+      || !binary_log_read (&reader, &n_strings, sizeof (n_strings))
+      || !binary_log_read (&reader, &n_threads, sizeof (n_threads)))
+    goto invalid;
+
+  if (n_strings > reader.size / 12)
+    goto invalid;
+
+  keys = g_new (guint64, n_strings);
+  strings = g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL, g_free);
+  for (i = 0; i < n_strings; i++) {
+    guint32 len;
+
+    if (!binary_log_read (&reader, &keys[i], sizeof (guint64))
+        || !binary_log_read (&reader, &len, sizeof (len))
+        || reader.size - reader.pos < len)
+      goto invalid;
+
+    g_hash_table_insert (strings, &keys[i],
+        g_strndup ((const gchar *) reader.data + reader.pos, len));
+    reader.pos += len;
+  }
+
+  entries = g_array_new (FALSE, FALSE, sizeof (GstBinaryLogEntry));
+  for (i = 0; i < n_threads; i++) {
+    guint64 thread;
+    guint32 len;
+    gsize end;
+
+    if (!binary_log_read (&reader, &thread, sizeof (thread))
+        || !binary_log_read (&reader, &len, sizeof (len))
+        || reader.size - reader.pos < len)
+      goto invalid;
+
+    end = reader.pos + len;
+    while (end - reader.pos >= sizeof (GstBinaryLogRecord)) {
+      GstBinaryLogRecord record;
+      GstBinaryLogEntry entry;
+
+      memcpy (&record, reader.data + reader.pos, sizeof (record));
+      if (record.size < sizeof (record) || record.size > end - reader.pos
+          || record.id_len + record.args_len > record.size - sizeof (record)
+          || record.level >= GST_LEVEL_COUNT)
+        goto invalid;
+
+      entry.timestamp = record.timestamp;
+      entry.thread = thread;
+      entry.seqnum = entries->len;
+      entry.data = reader.data + reader.pos;
+      g_array_append_val (entries, entry);
+
+      reader.pos += record.size;
+    }
+    reader.pos = end;
+  }
+
+  g_array_sort (entries, binary_log_entry_compare);
+
+  str = g_string_new (NULL);
+  for (i = 0; i < entries->len; i++) {
+    GstBinaryLogEntry *entry = &g_array_index (entries, GstBinaryLogEntry, i);
+    GstBinaryLogRecord record;
+    GstBinaryLogReader args;
+    GString *message = g_string_new (NULL);
+    const gchar *file;
+    gchar *object_id = NULL;
+    gchar c;
+
+    memcpy (&record, entry->data, sizeof (record));
+    if (record.id_len > 0)
+      object_id = g_strndup ((const gchar *) entry->data + sizeof (record),
+          record.id_len);
+
+    args.data = entry->data + sizeof (record) + record.id_len;
+    args.size = record.args_len;
+    args.pos = 0;
+
+    if (record.flags & BINARY_LOG_FLAG_LITERAL) {
+      g_string_append_len (message, (const gchar *) args.data, args.size);
+    } else {
+      const gchar *format =
+          binary_log_lookup_string (strings, record.format, NULL);
+
+      if (format)
+        binary_log_format_message (message, format, &args);
+      else
+        g_string_append (message, "<unknown format>");
+    }
+
+    /* same shortening as the default log function */
+    file = binary_log_lookup_string (strings, record.file, "?");
+    c = file[0];
+    if (c == '.' || c == '/' || c == '\\' || (c != '\0' && file[1] == ':'))
+      file = gst_path_basename (file);
+
+    if (object_id) {
+      g_string_append_printf (str, "%" GST_TIME_FORMAT NOCOLOR_PRINT_FMT_ID,
+          GST_TIME_ARGS (record.timestamp), (GstPid) pid,
+          (GstTid) (guintptr) entry->thread,
+          gst_debug_level_get_name (record.level),
+          binary_log_lookup_string (strings, record.category, "?"), file,
+          record.line, binary_log_lookup_string (strings, record.function,
+              "?"), object_id, message->str);
+    } else {
+      g_string_append_printf (str, "%" GST_TIME_FORMAT NOCOLOR_PRINT_FMT,
+          GST_TIME_ARGS (record.timestamp), (GstPid) pid,
+          (GstTid) (guintptr) entry->thread,
+          gst_debug_level_get_name (record.level),
+          binary_log_lookup_string (strings, record.category, "?"), file,
+          record.line, binary_log_lookup_string (strings, record.function,
+              "?"), "", message->str);
+    }
+
+    g_free (object_id);
+    g_string_free (message, TRUE);
+  }
+
+  g_array_unref (entries);
+  g_hash_table_unref (strings);
+  g_free (keys);
+
+  return g_string_free (str, FALSE);
+
+invalid:
+  GST_WARNING ("invalid binary log");
+  if (entries)
+    g_array_unref (entries);
+  if (strings)
+    g_hash_table_unref (strings);
+  g_free (keys);
+
+  return NULL;
+}
+
+#ifdef HAVE_SIGACTION
+/* The log is most interesting when the process crashes, so it is also
+ * written from a handler for the fatal signals. This is best effort: the
+ * handler allocates and gives up if the crashing thread holds one of the
+ * logging locks. */
+static const gint binary_log_crash_signals[] = {
+  SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT
+};
+
+static struct sigaction
+    binary_log_old_actions[G_N_ELEMENTS (binary_log_crash_signals)];
+static gboolean binary_log_crash_handler_is_setup = FALSE;
+static gint binary_log_crashed = 0;
+
+static void
+binary_log_crash_handler_restore (void)
+{
+  guint i;
+
+  if (!binary_log_crash_handler_is_setup)
+    return;
+
+  binary_log_crash_handler_is_setup = FALSE;
+  for (i = 0; i < G_N_ELEMENTS (binary_log_crash_signals); i++)
+    sigaction (binary_log_crash_signals[i], &binary_log_old_actions[i], NULL);
+}
+
+static void
+binary_log_crash_handler (int signum)
+{
+  /* only the first thread that crashes writes the log */
+  if (g_atomic_int_compare_and_exchange (&binary_log_crashed, 0, 1)
+      && binary_log_file != NULL) {
+    GBytes *dump = binary_log_dump (TRUE);
+
+    if (dump) {
+      gsize size;
+      const guint8 *data = g_bytes_get_data (dump, &size);
+      gint fd;
+
+      fd = g_open (binary_log_file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd >= 0) {
+        while (size > 0) {
+          gssize ret = write (fd, data, size);
+
+          if (ret < 0 && errno == EINTR)
+            continue;
+          if (ret <= 0)
+            break;
+          data += ret;
+          size -= ret;
+        }
+        close (fd);
+      }
+    }
+  }
+
+  /* the signal is blocked while we're running, so it is delivered again to
+   * the previous handler when we return */
+  binary_log_crash_handler_restore ();
+  raise (signum);
+}
+
+static void
+binary_log_crash_handler_setup (void)
+{
+  struct sigaction action;
+  guint i;
+
+  if (binary_log_crash_handler_is_setup)
+    return;
+
+  binary_log_crash_handler_is_setup = TRUE;
+
+  memset (&action, 0, sizeof (action));
+  action.sa_handler = binary_log_crash_handler;
+  for (i = 0; i < G_N_ELEMENTS (binary_log_crash_signals); i++)
+    sigaction (binary_log_crash_signals[i], &action,
+        &binary_log_old_actions[i]);
+}
+#else /* !HAVE_SIGACTION */
+static void
+binary_log_crash_handler_restore (void)
+{
+}
+
+static void
+binary_log_crash_handler_setup (void)
+{
+}
+#endif /* HAVE_SIGACTION */
+
+static void
+gst_debug_binary_log_init (const gchar * file_name)
+{
+  const gchar *env;
+  guint size = BINARY_LOG_DEFAULT_SIZE;
+
+  env = g_getenv ("GST_DEBUG_BINARY_LOG_SIZE");
+  if (env != NULL && *env != '\0')
+    size = MIN (g_ascii_strtoull (env, NULL, 10), BINARY_LOG_MAX_SIZE);
+
+  binary_log_file = _priv_gst_debug_file_name (file_name);
+  gst_debug_add_binary_ring_buffer_logger (size, 0);
+  binary_log_crash_handler_setup ();
+}
+
+static void
+gst_debug_binary_log_write_file (void)
+{
+  GError *err = NULL;
+  GBytes *dump;
+
+  if (binary_log_file == NULL)
+    return;
+
+  binary_log_crash_handler_restore ();
+
+  dump = gst_debug_binary_ring_buffer_logger_dump ();
+  if (dump) {
+    gsize size;
+    const gchar *data = g_bytes_get_data (dump, &size);
+
+    if (!g_file_set_contents (binary_log_file, data, size, &err)) {
+      g_printerr ("Could not write binary log file '%s': %s\n",
+          binary_log_file, err->message);
+      g_clear_error (&err);
+    }
+    g_bytes_unref (dump);
+  }
+
+  g_clear_pointer (&binary_log_file, g_free);
+}
+
 #else /* GST_DISABLE_GST_DEBUG */
 #ifndef GST_REMOVE_DISABLED
 
@@ -4588,5 +5986,28 @@ gst_debug_remove_ring_buffer_logger (void)
 {
 }
 
+void
+gst_debug_add_binary_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+}
+
+void
+gst_debug_remove_binary_ring_buffer_logger (void)
+{
+}
+
+GBytes *
+gst_debug_binary_ring_buffer_logger_dump (void)
+{
+  return NULL;
+}
+
+gchar *
+gst_debug_binary_log_decode (GBytes * log)
+{
+  return NULL;
+}
+
 #endif /* GST_REMOVE_DISABLED */
 #endif /* GST_DISABLE_GST_DEBUG */
@@ -1725,6 +1725,15 @@ void                  gst_debug_remove_ring_buffer_logger   (void);
 GST_API
 gchar **              gst_debug_ring_buffer_logger_get_logs (void);
 
+GST_API
+void                  gst_debug_add_binary_ring_buffer_logger    (guint max_size_per_thread, guint thread_timeout);
+GST_API
+void                  gst_debug_remove_binary_ring_buffer_logger (void);
+GST_API
+GBytes *              gst_debug_binary_ring_buffer_logger_dump   (void);
+GST_API
+gchar *               gst_debug_binary_log_decode                (GBytes * log);
+
 /**
  * GstLogContextHashFlags:
  * @GST_LOG_CONTEXT_DEFAULT: Default behavior for logging context
@@ -0,0 +1,64 @@
+/* GStreamer
+ *
+ * gstmagazine-private.h: per-thread magazine cache for small allocations
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_MAGAZINE_PRIVATE_H__
+#define __GST_MAGAZINE_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* largest allocation that is served from the magazine caches, anything
+ * bigger always goes straight to g_malloc() / g_free() */
+#define GST_MAGAZINE_MAX_SIZE 4096
+
+G_GNUC_INTERNAL extern gboolean _priv_gst_magazine_enabled;
+
+G_GNUC_INTERNAL void      _priv_gst_magazine_initialize (void);
+G_GNUC_INTERNAL void      _priv_gst_magazine_cleanup    (void);
+
+G_GNUC_INTERNAL gpointer  _priv_gst_magazine_alloc_cached (gsize size);
+G_GNUC_INTERNAL void      _priv_gst_magazine_free_cached  (gpointer mem, gsize size);
+
+/* Allocates @size bytes. The block must be released with
+ * _priv_gst_magazine_free() with the same @size. The memory is not cleared. */
+static inline gpointer
+_priv_gst_magazine_alloc (gsize size)
+{
+  if (G_LIKELY (!_priv_gst_magazine_enabled) || size > GST_MAGAZINE_MAX_SIZE)
+    return g_malloc (size);
+
+  return _priv_gst_magazine_alloc_cached (size);
+}
+
+static inline void
+_priv_gst_magazine_free (gpointer mem, gsize size)
+{
+  if (G_LIKELY (!_priv_gst_magazine_enabled) || size > GST_MAGAZINE_MAX_SIZE) {
+    g_free (mem);
+    return;
+  }
+
+  _priv_gst_magazine_free_cached (mem, size);
+}
+
+G_END_DECLS
+
+#endif /* __GST_MAGAZINE_PRIVATE_H__ */
@@ -0,0 +1,359 @@
+/* GStreamer
+ *
+ * gstmagazine.c: per-thread magazine cache for small allocations
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The magazine cache keeps freed GstBuffer structs, meta items and small
+ * system memory blocks around per thread so that they can be handed out again
+ * without going through malloc.
+ *
+ * Every thread owns two magazines (a loaded and a previous one) per size
+ * class. Allocations pop from the loaded magazine and frees push onto it.
+ * Only when both magazines are empty (on alloc) or full (on free) the thread
+ * takes the depot lock and exchanges a whole magazine with the global depot.
+ *
+ * This also batches the common cross-thread pattern where one streaming
+ * thread allocates and another one frees: the freeing thread fills up its
+ * magazines and hands them to the depot as a whole, where the allocating
+ * thread picks them up again, so the depot lock is taken at most once every
+ * MAGAZINE_SIZE operations.
+ *
+ * The cache is opt-in with the GST_MAGAZINE_ALLOCATOR environment variable
+ * and decided once in gst_init(), allocations and frees must never mix the
+ * two modes.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst_private.h"
+#include "gstmagazine-private.h"
+
+#define MAGAZINE_SIZE       32
+/* maximum number of magazines kept in a depot, anything above this is
+ * returned to the system */
+#define DEPOT_MAX_FULL      64
+#define DEPOT_MAX_EMPTY     16
+
+#define CLASS_GRANULE       64
+
+typedef struct _GstMagazine GstMagazine;
+
+struct _GstMagazine
+{
+  GstMagazine *next;
+  guint n_objects;
+  gpointer objects[MAGAZINE_SIZE];
+};
+
+typedef struct
+{
+  GMutex lock;
+  GstMagazine *full;
+  guint n_full;
+  GstMagazine *empty;
+  guint n_empty;
+} GstMagazineDepot;
+
+typedef struct
+{
+  GstMagazine *loaded;
+  GstMagazine *previous;
+} GstMagazineSlot;
+
+static const gsize class_sizes[] = {
+  64, 128, 192, 256, 320, 384, 512, 768, 1024, 1536, 2048, 3072,
+  GST_MAGAZINE_MAX_SIZE
+};
+
+#define N_CLASSES G_N_ELEMENTS (class_sizes)
+
+typedef struct
+{
+  GstMagazineSlot slots[N_CLASSES];
+} GstMagazineThreadCache;
+
+gboolean _priv_gst_magazine_enabled = FALSE;
+
+/* maps (size + CLASS_GRANULE - 1) / CLASS_GRANULE to a size class */
+static guint8 class_index[GST_MAGAZINE_MAX_SIZE / CLASS_GRANULE + 1];
+static GstMagazineDepot depots[N_CLASSES];
+
+static void thread_cache_free (gpointer data);
+static GPrivate thread_cache_key = G_PRIVATE_INIT (thread_cache_free);
+
+static inline guint
+size_to_class (gsize size)
+{
+  return class_index[(size + CLASS_GRANULE - 1) / CLASS_GRANULE];
+}
+
+static void
+magazine_release_objects (GstMagazine * mag)
+{
+  guint i;
+
+  for (i = 0; i < mag->n_objects; i++)
+    g_free (mag->objects[i]);
+  mag->n_objects = 0;
+}
+
+/* takes ownership of @mag, which may be partially filled */
+static void
+depot_put_full (GstMagazineDepot * depot, GstMagazine * mag)
+{
+  g_mutex_lock (&depot->lock);
+  if (depot->n_full < DEPOT_MAX_FULL) {
+    mag->next = depot->full;
+    depot->full = mag;
+    depot->n_full++;
+    mag = NULL;
+  }
+  g_mutex_unlock (&depot->lock);
+
+  if (mag) {
+    magazine_release_objects (mag);
+    g_free (mag);
+  }
+}
+
+static void
+depot_put_empty (GstMagazineDepot * depot, GstMagazine * mag)
+{
+  g_mutex_lock (&depot->lock);
+  if (depot->n_empty < DEPOT_MAX_EMPTY) {
+    mag->next = depot->empty;
+    depot->empty = mag;
+    depot->n_empty++;
+    mag = NULL;
+  }
+  g_mutex_unlock (&depot->lock);
+
+  g_free (mag);
+}
+
+static void
+thread_cache_free (gpointer data)
+{
+  GstMagazineThreadCache *cache = data;
+  guint i;
+
+  /* hand everything we still hold to the depots so that other threads can
+   * pick it up */
+  for (i = 0; i < N_CLASSES; i++) {
+    GstMagazineSlot *slot = &cache->slots[i];
+    GstMagazine *mags[2] = { slot->loaded, slot->previous };
+    guint j;
+
+    for (j = 0; j < 2; j++) {
+      if (mags[j] == NULL)
+        continue;
+      if (mags[j]->n_objects > 0)
+        depot_put_full (&depots[i], mags[j]);
+      else
+        depot_put_empty (&depots[i], mags[j]);
+    }
+  }
+  g_free (cache);
+}
+
+static inline GstMagazineSlot *
+get_slot (guint cls)
+{
+  GstMagazineThreadCache *cache;
+
+  cache = g_private_get (&thread_cache_key);
+  if (G_UNLIKELY (cache == NULL)) {
+    guint i;
+
+    cache = g_new0 (GstMagazineThreadCache, 1);
+    for (i = 0; i < N_CLASSES; i++) {
+      cache->slots[i].loaded = g_new0 (GstMagazine, 1);
+      cache->slots[i].previous = g_new0 (GstMagazine, 1);
+    }
+    g_private_set (&thread_cache_key, cache);
+  }
+  return &cache->slots[cls];
+}
+
+gpointer
+_priv_gst_magazine_alloc_cached (gsize size)
+{
+  GstMagazineDepot *depot;
+  GstMagazineSlot *slot;
+  GstMagazine *tmp;
+  guint cls;
+
+  cls = size_to_class (size);
+  slot = get_slot (cls);
+
+  if (G_LIKELY (slot->loaded->n_objects > 0))
+    return slot->loaded->objects[--slot->loaded->n_objects];
+
+  if (slot->previous->n_objects > 0) {
+    tmp = slot->loaded;
+    slot->loaded = slot->previous;
+    slot->previous = tmp;
+    return slot->loaded->objects[--slot->loaded->n_objects];
+  }
+
+  /* both magazines are empty, try to get a filled one from the depot */
+  depot = &depots[cls];
+  g_mutex_lock (&depot->lock);
+  if (depot->full) {
+    tmp = depot->full;
+    depot->full = tmp->next;
+    depot->n_full--;
+
+    /* return our empty previous magazine to the depot */
+    if (depot->n_empty < DEPOT_MAX_EMPTY) {
+      slot->previous->next = depot->empty;
+      depot->empty = slot->previous;
+      depot->n_empty++;
+      slot->previous = NULL;
+    }
+    g_mutex_unlock (&depot->lock);
+
+    g_free (slot->previous);
+    slot->previous = slot->loaded;
+    slot->loaded = tmp;
+    return slot->loaded->objects[--slot->loaded->n_objects];
+  }
+  g_mutex_unlock (&depot->lock);
+
+  return g_malloc (class_sizes[cls]);
+}
+
+void
+_priv_gst_magazine_free_cached (gpointer mem, gsize size)
+{
+  GstMagazineDepot *depot;
+  GstMagazineSlot *slot;
+  GstMagazine *tmp;
+  guint cls;
+
+  if (mem == NULL)
+    return;
+
+  cls = size_to_class (size);
+  slot = get_slot (cls);
+
+  if (G_LIKELY (slot->loaded->n_objects < MAGAZINE_SIZE)) {
+    slot->loaded->objects[slot->loaded->n_objects++] = mem;
+    return;
+  }
+
+  if (slot->previous->n_objects < MAGAZINE_SIZE) {
+    tmp = slot->loaded;
+    slot->loaded = slot->previous;
+    slot->previous = tmp;
+    slot->loaded->objects[slot->loaded->n_objects++] = mem;
+    return;
+  }
+
+  /* both magazines are full, pass the previous one to the depot and start
+   * filling an empty one */
+  depot = &depots[cls];
+  g_mutex_lock (&depot->lock);
+  tmp = depot->empty;
+  if (tmp) {
+    depot->empty = tmp->next;
+    depot->n_empty--;
+  }
+  if (depot->n_full < DEPOT_MAX_FULL) {
+    slot->previous->next = depot->full;
+    depot->full = slot->previous;
+    depot->n_full++;
+    slot->previous = NULL;
+  }
+  g_mutex_unlock (&depot->lock);
+
+  if (slot->previous) {
+    /* depot is saturated, give the memory back */
+    magazine_release_objects (slot->previous);
+    if (tmp == NULL)
+      tmp = slot->previous;
+    else
+      g_free (slot->previous);
+  } else if (tmp == NULL) {
+    tmp = g_new (GstMagazine, 1);
+    tmp->n_objects = 0;
+  }
+  tmp->next = NULL;
+
+  slot->previous = slot->loaded;
+  slot->loaded = tmp;
+  slot->loaded->objects[slot->loaded->n_objects++] = mem;
+}
+
+void
+_priv_gst_magazine_initialize (void)
+{
+  const gchar *env;
+  guint i, cls;
+
+  cls = 0;
+  for (i = 0; i < G_N_ELEMENTS (class_index); i++) {
+    while (class_sizes[cls] < i * CLASS_GRANULE)
+      cls++;
+    class_index[i] = cls;
+  }
+
+  env = g_getenv ("GST_MAGAZINE_ALLOCATOR");
+  _priv_gst_magazine_enabled = env != NULL && env[0] != '\0'
+      && strcmp (env, "0") != 0 && g_ascii_strcasecmp (env, "no") != 0;
+
+  GST_CAT_INFO (GST_CAT_MEMORY, "magazine allocator %s",
+      _priv_gst_magazine_enabled ? "enabled" : "disabled");
+}
+
+void
+_priv_gst_magazine_cleanup (void)
+{
+  guint i;
+
+  if (!_priv_gst_magazine_enabled)
+    return;
+
+  /* flush the cache of the calling thread, the caches of other threads are
+   * flushed to the depots when they exit */
+  g_private_replace (&thread_cache_key, NULL);
+
+  for (i = 0; i < N_CLASSES; i++) {
+    GstMagazineDepot *depot = &depots[i];
+    GstMagazine *mag, *next;
+
+    g_mutex_lock (&depot->lock);
+    for (mag = depot->full; mag; mag = next) {
+      next = mag->next;
+      magazine_release_objects (mag);
+      g_free (mag);
+    }
+    for (mag = depot->empty; mag; mag = next) {
+      next = mag->next;
+      g_free (mag);
+    }
+    depot->full = depot->empty = NULL;
+    depot->n_full = depot->n_empty = 0;
+    g_mutex_unlock (&depot->lock);
+  }
+
+  /* anything still alive after this goes back to the system directly */
+  _priv_gst_magazine_enabled = FALSE;
+}
@@ -49,6 +49,10 @@ G_DEFINE_BOXED_TYPE (GstParseContext, gst_parse_context,
     (GBoxedCopyFunc) gst_parse_context_copy,
     (GBoxedFreeFunc) gst_parse_context_free);
 
+G_DEFINE_BOXED_TYPE (GstParseTemplate, gst_parse_template,
+    (GBoxedCopyFunc) gst_parse_template_ref,
+    (GBoxedFreeFunc) gst_parse_template_unref);
+
 /**
  * gst_parse_error_quark:
  *
@@ -371,3 +375,144 @@ gst_parse_launch_full (const gchar * pipeline_description,
   return NULL;
 #endif
 }
+
+/**
+ * gst_parse_template_new:
+ * @pipeline_description: the command line describing the pipeline
+ * @flags: parsing options, or #GST_PARSE_FLAG_NONE
+ * @error: the error message in case of an erroneous pipeline.
+ *
+ * Compiles @pipeline_description once into a template from which identical
+ * pipelines can be created with gst_parse_template_instantiate().
+ *
+ * The template keeps the element factories, the deserialized property values
+ * and the resolved links, so that creating a new pipeline from it does not
+ * need to parse the description, look up factories or resolve element names
+ * again. This is useful when the same description is used many times.
+ *
+ * Unlike gst_parse_launch_full(), any error, including a missing element, is
+ * fatal here and no template is returned.
+ *
+ * Returns: (transfer full) (nullable): a new #GstParseTemplate, or %NULL on
+ *     failure.
+ *
+ * Since: 1.30
+ */
+GstParseTemplate *
+gst_parse_template_new (const gchar * pipeline_description,
+    GstParseFlags flags, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  GstParseTemplate *tmpl;
+
+  g_return_val_if_fail (pipeline_description != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  GST_CAT_INFO (GST_CAT_PIPELINE, "compiling pipeline description '%s'",
+      pipeline_description);
+
+  tmpl = g_atomic_rc_box_new0 (GstParseTemplate);
+  tmpl->flags = flags;
+
+  if (!priv_gst_parse_template_compile (tmpl, pipeline_description, error)) {
+    gst_parse_template_unref (tmpl);
+    return NULL;
+  }
+
+  return tmpl;
+#else
+  gchar *msg;
+
+  GST_WARNING ("Disabled API called");
+
+  msg = gst_error_get_message (GST_CORE_ERROR, GST_CORE_ERROR_DISABLED);
+  g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_DISABLED, "%s", msg);
+  g_free (msg);
+
+  return NULL;
+#endif
+}
+
+/**
+ * gst_parse_template_ref:
+ * @tmpl: a #GstParseTemplate
+ *
+ * Increases the refcount of @tmpl.
+ *
+ * Returns: (transfer full): @tmpl
+ *
+ * Since: 1.30
+ */
+GstParseTemplate *
+gst_parse_template_ref (GstParseTemplate * tmpl)
+{
+  g_return_val_if_fail (tmpl != NULL, NULL);
+
+  return g_atomic_rc_box_acquire (tmpl);
+}
+
+/**
+ * gst_parse_template_unref:
+ * @tmpl: (transfer full): a #GstParseTemplate
+ *
+ * Decreases the refcount of @tmpl, freeing it when it reaches 0.
+ *
+ * Since: 1.30
+ */
+void
+gst_parse_template_unref (GstParseTemplate * tmpl)
+{
+  g_return_if_fail (tmpl != NULL);
+
+#ifndef GST_DISABLE_PARSE
+  g_atomic_rc_box_release_full (tmpl,
+      (GDestroyNotify) priv_gst_parse_template_clear);
+#else
+  g_atomic_rc_box_release (tmpl);
+#endif
+}
+
+/**
+ * gst_parse_template_instantiate:
+ * @tmpl: a #GstParseTemplate
+ * @error: the error message in case the pipeline could not be created.
+ *
+ * Creates a new pipeline from @tmpl, equivalent to calling
+ * gst_parse_launch_full() with the description and flags @tmpl was created
+ * with.
+ *
+ * This function can be called from multiple threads at the same time.
+ *
+ * Returns: (transfer floating) (nullable): a new element on success, %NULL on
+ *     failure.
+ *
+ * Since: 1.30
+ */
+GstElement *
+gst_parse_template_instantiate (GstParseTemplate * tmpl, GError ** error)
+{
+#ifndef GST_DISABLE_PARSE
+  GstElement *element;
+  GError *myerror = NULL;
+
+  g_return_val_if_fail (tmpl != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  element = priv_gst_parse_template_instantiate (tmpl, &myerror);
+
+  /* don't return partially constructed pipeline if FATAL_ERRORS was given */
+  if (G_UNLIKELY (myerror != NULL && element != NULL)) {
+    if ((tmpl->flags & GST_PARSE_FLAG_FATAL_ERRORS)) {
+      gst_object_unref (element);
+      element = NULL;
+    }
+  }
+
+  if (myerror)
+    g_propagate_error (error, myerror);
+
+  return element;
+#else
+  return NULL;
+#endif
+}
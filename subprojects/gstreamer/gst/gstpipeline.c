@@ -106,7 +106,8 @@ enum
   PROP_0,
   PROP_DELAY,
   PROP_AUTO_FLUSH_BUS,
-  PROP_LATENCY
+  PROP_LATENCY,
+  PROP_TASK_POOL
 };
 
 struct _GstPipelinePrivate
@@ -128,6 +129,9 @@ struct _GstPipelinePrivate
   gdouble active_instant_rate;
   GstClockTime instant_rate_upstream_anchor;
   GstClockTime instant_rate_clock_anchor;
+
+  /* pool for the streaming threads of the children, with LOCK */
+  GstTaskPool *task_pool;
 };
 
 
@@ -206,6 +210,25 @@ gst_pipeline_class_init (GstPipelineClass * klass)
           "Latency to configure on the pipeline", 0, G_MAXUINT64,
           DEFAULT_LATENCY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPipeline:task-pool:
+   *
+   * The #GstTaskPool used for the streaming threads of the elements in the
+   * pipeline, or %NULL to use the default pool. The pool has to be prepared
+   * with gst_task_pool_prepare(). It is set on every #GstTask created after
+   * setting this property, the tasks of elements that are already streaming
+   * are not affected.
+   *
+   * Together with a #GstWorkStealingTaskPool this allows to run the streaming
+   * loops of many pipelines on a shared, fixed set of threads.
+   *
+   * Since: 1.30
+   **/
+  g_object_class_install_property (gobject_class, PROP_TASK_POOL,
+      g_param_spec_object ("task-pool", "Task Pool",
+          "Task pool for the streaming threads of the pipeline",
+          GST_TYPE_TASK_POOL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_pipeline_dispose;
 
   gst_element_class_set_static_metadata (gstelement_class, "Pipeline object",
@@ -261,6 +284,7 @@ gst_pipeline_dispose (GObject * object)
 
   /* clear and unref any fixed clock */
   gst_object_replace ((GstObject **) clock_p, NULL);
+  gst_object_replace ((GstObject **) & pipeline->priv->task_pool, NULL);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -281,6 +305,12 @@ gst_pipeline_set_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       gst_pipeline_set_latency (pipeline, g_value_get_uint64 (value));
       break;
+    case PROP_TASK_POOL:
+      GST_OBJECT_LOCK (pipeline);
+      gst_object_replace ((GstObject **) & pipeline->priv->task_pool,
+          g_value_get_object (value));
+      GST_OBJECT_UNLOCK (pipeline);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -303,6 +333,11 @@ gst_pipeline_get_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       g_value_set_uint64 (value, gst_pipeline_get_latency (pipeline));
       break;
+    case PROP_TASK_POOL:
+      GST_OBJECT_LOCK (pipeline);
+      g_value_set_object (value, pipeline->priv->task_pool);
+      GST_OBJECT_UNLOCK (pipeline);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -665,6 +700,34 @@ gst_pipeline_handle_message (GstBin * bin, GstMessage * message)
 
       break;
     }
+    case GST_MESSAGE_STREAM_STATUS:{
+      GstStreamStatusType type;
+      GstElement *owner;
+      const GValue *val;
+      GstTaskPool *pool;
+
+      gst_message_parse_stream_status (message, &type, &owner);
+      if (type != GST_STREAM_STATUS_TYPE_CREATE)
+        break;
+
+      GST_OBJECT_LOCK (pipeline);
+      pool = pipeline->priv->task_pool ?
+          gst_object_ref (pipeline->priv->task_pool) : NULL;
+      GST_OBJECT_UNLOCK (pipeline);
+
+      if (pool) {
+        val = gst_message_get_stream_status_object (message);
+        if (val && G_VALUE_HOLDS (val, GST_TYPE_TASK)) {
+          GstTask *task = g_value_get_object (val);
+
+          GST_DEBUG_OBJECT (pipeline, "using %" GST_PTR_FORMAT " for task %"
+              GST_PTR_FORMAT, pool, task);
+          gst_task_set_pool (task, pool);
+        }
+        gst_object_unref (pool);
+      }
+      break;
+    }
     default:
       break;
   }
@@ -47,6 +47,9 @@
 #include <gst/gstregistrychunks.h>
 #include <gst/gstregistrybinary.h>
 
+/* For g_memdup2 */
+#include "glib-compat-private.h"
+
 /* IMPORTANT: Bump the version number if the plugin loader packet protocol
  * changes. Changes in the binary registry format itself are handled by
  * bumping the GST_MAGIC_BINARY_VERSION_STR
@@ -69,6 +72,8 @@ typedef struct _PendingPluginEntry
 {
   /* sequence number */
   guint32 tag;
+  /* submission order across all helpers of a pool */
+  guint32 seqnum;
   gchar *filename;
   off_t file_size;
   time_t file_mtime;
@@ -105,8 +110,32 @@ struct _GstPluginLoader
      PendingPluginEntry structs */
   GList *pending_plugins;
   GList *pending_plugins_tail;
+
+  /* Parallel scanning: a pool loader has no child of its own but dispatches
+   * to @workers, which hand their results back to the @pool they belong to
+   * instead of adding them to the registry directly */
+  GstPluginLoader **workers;
+  guint n_workers;
+  GstPluginLoader *pool;
+  guint32 next_seqnum;
+  /* PluginLoaderResult, merged into the registry when the pool is freed */
+  GPtrArray *results;
 };
 
+/* Result of scanning one file in a pool worker. @details holds the complete
+ * PLUGIN_DETAILS packet including its header so that the alignment of the
+ * registry chunks is the same as in the receive buffer, or NULL if the file
+ * is to be blacklisted */
+typedef struct
+{
+  PendingPluginEntry entry;
+  guint8 *details;
+  guint details_len;
+} PluginLoaderResult;
+
+/* Upper bound for GST_REGISTRY_SCAN_JOBS, on top of the number of CPUs */
+#define MAX_SCAN_JOBS 32
+
 #define PACKET_EXIT 1
 #define PACKET_LOAD_PLUGIN 2
 #define PACKET_SYNC 3
@@ -126,6 +155,7 @@ static gboolean gst_plugin_loader_spawn (GstPluginLoader * loader);
 static void put_packet (GstPluginLoader * loader, guint type, guint32 tag,
     const guint8 * payload, guint32 payload_len);
 static gboolean exchange_packets (GstPluginLoader * l);
+static gboolean read_one (GstPluginLoader * l);
 static gboolean plugin_loader_replay_pending (GstPluginLoader * l);
 static gboolean plugin_loader_load_and_sync (GstPluginLoader * l,
     PendingPluginEntry * entry);
@@ -133,9 +163,37 @@ static void plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
     PendingPluginEntry * entry);
 static void plugin_loader_cleanup_child (GstPluginLoader * loader);
 static gboolean plugin_loader_sync_with_child (GstPluginLoader * l);
+static gboolean plugin_loader_add_plugin_details (GstPluginLoader * l,
+    guint32 tag, guint8 * payload, guint payload_len);
+static GstPluginLoader *plugin_loader_pool_new (GstRegistry * registry,
+    guint n_workers);
+static gboolean plugin_loader_pool_free (GstPluginLoader * pool);
+static gboolean plugin_loader_pool_load (GstPluginLoader * pool,
+    const gchar * filename, off_t file_size, time_t file_mtime);
+
+/* Number of plugin scanner helpers to run in parallel, as requested with
+ * GST_REGISTRY_SCAN_JOBS and bounded by the number of CPUs */
+static guint
+plugin_loader_get_n_jobs (void)
+{
+  const gchar *env;
+  guint n_cpus, n_jobs;
+
+  env = g_getenv ("GST_REGISTRY_SCAN_JOBS");
+  if (env == NULL || *env == '\0')
+    return 1;
+
+  n_cpus = MAX (g_get_num_processors (), 1);
+  if (g_ascii_strcasecmp (env, "auto") == 0)
+    n_jobs = n_cpus;
+  else
+    n_jobs = MIN (g_ascii_strtoull (env, NULL, 10), n_cpus);
+
+  return CLAMP (n_jobs, 1, MAX_SCAN_JOBS);
+}
 
 static GstPluginLoader *
-plugin_loader_new (GstRegistry * registry)
+plugin_loader_new_single (GstRegistry * registry)
 {
   GstPluginLoader *l = g_new0 (GstPluginLoader, 1);
 
@@ -156,6 +214,18 @@ plugin_loader_new (GstRegistry * registry)
   return l;
 }
 
+static GstPluginLoader *
+plugin_loader_new (GstRegistry * registry)
+{
+  guint n_jobs;
+
+  /* the child side of the protocol never scans in parallel */
+  if (registry != NULL && (n_jobs = plugin_loader_get_n_jobs ()) > 1)
+    return plugin_loader_pool_new (registry, n_jobs);
+
+  return plugin_loader_new_single (registry);
+}
+
 static gboolean
 plugin_loader_free (GstPluginLoader * loader)
 {
@@ -163,6 +233,9 @@ plugin_loader_free (GstPluginLoader * loader)
   gboolean got_plugin_details;
   gint fsync_ret;
 
+  if (loader->workers)
+    return plugin_loader_pool_free (loader);
+
   do {
     fsync_ret = fsync (loader->fd_w.fd);
   } while (fsync_ret < 0 && errno == EINTR);
@@ -218,6 +291,9 @@ plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
   gint len;
   PendingPluginEntry *entry;
 
+  if (loader->workers)
+    return plugin_loader_pool_load (loader, filename, file_size, file_mtime);
+
   if (!gst_plugin_loader_spawn (loader))
     return FALSE;
 
@@ -227,6 +303,7 @@ plugin_loader_load (GstPluginLoader * loader, const gchar * filename,
 
   entry = g_new (PendingPluginEntry, 1);
   entry->tag = loader->next_tag++;
+  entry->seqnum = loader->pool ? loader->pool->next_seqnum++ : 0;
   entry->filename = g_strdup (filename);
   entry->file_size = file_size;
   entry->file_mtime = file_mtime;
@@ -333,11 +410,198 @@ plugin_loader_load_and_sync (GstPluginLoader * l, PendingPluginEntry * entry)
   return plugin_loader_sync_with_child (l);
 }
 
+static void
+plugin_loader_pool_add_result (GstPluginLoader * pool,
+    const PendingPluginEntry * entry, const guint8 * details,
+    guint details_len)
+{
+  PluginLoaderResult *result = g_new0 (PluginLoaderResult, 1);
+
+  result->entry = *entry;
+  result->entry.filename = g_strdup (entry->filename);
+  if (details) {
+    result->details = g_memdup2 (details, details_len);
+    result->details_len = details_len;
+  }
+  g_ptr_array_add (pool->results, result);
+}
+
+static void
+plugin_loader_result_free (PluginLoaderResult * result)
+{
+  g_free (result->entry.filename);
+  g_free (result->details);
+  g_free (result);
+}
+
+static gint
+plugin_loader_result_compare (gconstpointer a, gconstpointer b)
+{
+  const PluginLoaderResult *ra = *(const PluginLoaderResult **) a;
+  const PluginLoaderResult *rb = *(const PluginLoaderResult **) b;
+
+  if (ra->entry.seqnum < rb->entry.seqnum)
+    return -1;
+  return ra->entry.seqnum > rb->entry.seqnum;
+}
+
+static GstPluginLoader *
+plugin_loader_pool_new (GstRegistry * registry, guint n_workers)
+{
+  GstPluginLoader *pool = g_new0 (GstPluginLoader, 1);
+  guint i;
+
+  GST_INFO_OBJECT (registry, "scanning plugins with %u helpers", n_workers);
+
+  pool->registry = gst_object_ref (registry);
+  pool->workers = g_new0 (GstPluginLoader *, n_workers);
+  pool->n_workers = n_workers;
+  pool->results =
+      g_ptr_array_new_with_free_func ((GDestroyNotify)
+      plugin_loader_result_free);
+
+  for (i = 0; i < n_workers; i++) {
+    pool->workers[i] = plugin_loader_new_single (registry);
+    pool->workers[i]->pool = pool;
+  }
+
+  return pool;
+}
+
+/* Reads whatever replies a worker has ready without blocking, so that its
+ * child does not stall on a full pipe while other workers are being fed */
+static gboolean
+plugin_loader_poll_replies (GstPluginLoader * l)
+{
+  gint res;
+
+  while (l->child_running && !l->rx_done) {
+    do {
+      res = gst_poll_wait (l->fdset, 0);
+    } while (res == -1 && errno == EINTR);
+
+    if (res <= 0)
+      return res == 0 || errno == EAGAIN;
+
+    if (gst_poll_fd_has_error (l->fdset, &l->fd_r))
+      goto fail_and_cleanup;
+
+    if (!gst_poll_fd_can_read (l->fdset, &l->fd_r)) {
+      if (gst_poll_fd_has_closed (l->fdset, &l->fd_r))
+        goto fail_and_cleanup;
+      break;
+    }
+
+    if (!read_one (l))
+      goto fail_and_cleanup;
+  }
+
+  return TRUE;
+
+fail_and_cleanup:
+  plugin_loader_cleanup_child (l);
+  return FALSE;
+}
+
+static gboolean
+plugin_loader_pool_load (GstPluginLoader * pool, const gchar * filename,
+    off_t file_size, time_t file_mtime)
+{
+  GstPluginLoader *worker = NULL;
+  guint i, n_pending, min_pending = G_MAXUINT;
+
+  /* hand the file to the least busy helper */
+  for (i = 0; i < pool->n_workers; i++) {
+    n_pending = g_list_length (pool->workers[i]->pending_plugins);
+    if (n_pending < min_pending) {
+      worker = pool->workers[i];
+      min_pending = n_pending;
+    }
+  }
+
+  if (!plugin_loader_load (worker, filename, file_size, file_mtime))
+    return FALSE;
+
+  /* and keep the others going */
+  for (i = 0; i < pool->n_workers; i++) {
+    GstPluginLoader *w = pool->workers[i];
+
+    if (w == worker || w->pending_plugins == NULL)
+      continue;
+
+    if (!plugin_loader_poll_replies (w) && !plugin_loader_replay_pending (w))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+plugin_loader_pool_free (GstPluginLoader * pool)
+{
+  GstPluginLoader *rescan = NULL;
+  gboolean got_plugin_details = FALSE;
+  guint i;
+
+  /* waits for every helper to finish its queue, crashing files are
+   * blacklisted by the worker that ran into them */
+  for (i = 0; i < pool->n_workers; i++)
+    plugin_loader_free (pool->workers[i]);
+  g_free (pool->workers);
+
+  /* Merge in the order the files were submitted, which is the order a single
+   * helper would have added them to the registry in, independent of which
+   * helper finished first. That matters when several files provide a plugin
+   * with the same basename. */
+  g_ptr_array_sort (pool->results, plugin_loader_result_compare);
+
+  for (i = 0; i < pool->results->len; i++) {
+    PluginLoaderResult *result = g_ptr_array_index (pool->results, i);
+
+    if (result->details == NULL) {
+      plugin_loader_create_blacklist_plugin (pool, &result->entry);
+      got_plugin_details = TRUE;
+    } else if (plugin_loader_add_plugin_details (pool, result->entry.tag,
+            result->details + HEADER_SIZE, result->details_len - HEADER_SIZE)) {
+      got_plugin_details = TRUE;
+    } else {
+      /* Details are only parsed here, so garbage from a helper is handled
+       * like a serial loader would on receipt: scan the file again with a
+       * fresh helper and blacklist it if that fails as well */
+      if (rescan == NULL)
+        rescan = plugin_loader_new_single (pool->registry);
+      if (!plugin_loader_load (rescan, result->entry.filename,
+              result->entry.file_size, result->entry.file_mtime)) {
+        GST_ERROR ("Plugin file %s failed to load. Blacklisting",
+            result->entry.filename);
+        plugin_loader_create_blacklist_plugin (pool, &result->entry);
+      }
+      got_plugin_details = TRUE;
+    }
+  }
+
+  if (rescan)
+    plugin_loader_free (rescan);
+
+  g_ptr_array_unref (pool->results);
+  gst_object_unref (pool->registry);
+  g_free (pool);
+
+  return got_plugin_details;
+}
+
 static void
 plugin_loader_create_blacklist_plugin (GstPluginLoader * l,
     PendingPluginEntry * entry)
 {
-  GstPlugin *plugin = g_object_new (GST_TYPE_PLUGIN, NULL);
+  GstPlugin *plugin;
+
+  if (l->pool) {
+    plugin_loader_pool_add_result (l->pool, entry, NULL, 0);
+    return;
+  }
+
+  plugin = g_object_new (GST_TYPE_PLUGIN, NULL);
 
   plugin->filename = g_strdup (entry->filename);
   plugin->file_mtime = entry->file_mtime;
@@ -856,7 +1120,6 @@ handle_rx_packet (GstPluginLoader * l,
       break;
     }
     case PACKET_PLUGIN_DETAILS:{
-      gchar *tmp = (gchar *) payload;
       PendingPluginEntry *entry = NULL;
       GList *cur;
 
@@ -888,21 +1151,16 @@ handle_rx_packet (GstPluginLoader * l,
       if (cur == NULL)
         l->pending_plugins_tail = NULL;
 
-      if (payload_len > 0) {
-        GstPlugin *newplugin = NULL;
-        if (!_priv_gst_registry_chunks_load_plugin (l->registry, &tmp,
-                tmp + payload_len, &newplugin)) {
-          /* Got garbage from the child, so fail and trigger replay of plugins */
-          GST_ERROR_OBJECT (l->registry,
-              "Problems loading plugin details with tag %u from scanner", tag);
+      if (payload_len > 0 && l->pool) {
+        /* Keep the whole packet for merging it later */
+        if (entry != NULL)
+          plugin_loader_pool_add_result (l->pool, entry, l->rx_buf,
+              payload_len + HEADER_SIZE);
+        l->got_plugin_details = TRUE;
+      } else if (payload_len > 0) {
+        /* Got garbage from the child, so fail and trigger replay of plugins */
+        if (!plugin_loader_add_plugin_details (l, tag, payload, payload_len))
           return FALSE;
-        }
-
-        GST_OBJECT_FLAG_UNSET (newplugin, GST_PLUGIN_FLAG_CACHED);
-        GST_LOG_OBJECT (l->registry,
-            "marking plugin %p as registered as %s", newplugin,
-            newplugin->filename);
-        newplugin->registered = TRUE;
 
         /* We got a set of plugin details - remember it for later */
         l->got_plugin_details = TRUE;
@@ -958,6 +1216,28 @@ handle_rx_packet (GstPluginLoader * l,
   return res;
 }
 
+static gboolean
+plugin_loader_add_plugin_details (GstPluginLoader * l, guint32 tag,
+    guint8 * payload, guint payload_len)
+{
+  gchar *tmp = (gchar *) payload;
+  GstPlugin *newplugin = NULL;
+
+  if (!_priv_gst_registry_chunks_load_plugin (l->registry, &tmp,
+          tmp + payload_len, FALSE, &newplugin)) {
+    GST_ERROR_OBJECT (l->registry,
+        "Problems loading plugin details with tag %u from scanner", tag);
+    return FALSE;
+  }
+
+  GST_OBJECT_FLAG_UNSET (newplugin, GST_PLUGIN_FLAG_CACHED);
+  GST_LOG_OBJECT (l->registry,
+      "marking plugin %p as registered as %s", newplugin, newplugin->filename);
+  newplugin->registered = TRUE;
+
+  return TRUE;
+}
+
 static gboolean
 read_one (GstPluginLoader * l)
 {
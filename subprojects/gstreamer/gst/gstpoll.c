@@ -51,6 +51,13 @@
  * descriptor, and gst_poll_fd_can_write() to see if it is possible to
  * write to it.
  *
+ * On Linux, sets with many file descriptors are waited on with epoll instead
+ * of poll() so that the cost of a wait does not grow with the number of file
+ * descriptors in the set. epoll forgets about file descriptors that are
+ * closed, so unlike with poll() a file descriptor that is closed while it is
+ * in the set is only reported as invalid by gst_poll_fd_has_error() after it
+ * was added or changed with one of the gst_poll_fd_ctl functions.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -83,6 +90,9 @@
 #endif
 #include <sys/time.h>
 #include <sys/socket.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #endif
 
 #ifdef G_OS_WIN32
@@ -124,9 +134,21 @@ typedef enum
   GST_POLL_MODE_PSELECT,
   GST_POLL_MODE_POLL,
   GST_POLL_MODE_PPOLL,
+  GST_POLL_MODE_EPOLL,
   GST_POLL_MODE_WINDOWS
 } GstPollMode;
 
+#ifdef HAVE_SYS_EPOLL_H
+/* switch to epoll once a set has this many fds, for smaller sets poll() is
+ * cheaper as it does not need a syscall for every change of the set */
+#define EPOLL_MIN_FDS 16
+
+/* epoll and poll use the same flag values on Linux, we rely on this to pass
+ * the events and revents around unmodified */
+G_STATIC_ASSERT (EPOLLIN == POLLIN && EPOLLOUT == POLLOUT
+    && EPOLLPRI == POLLPRI && EPOLLERR == POLLERR && EPOLLHUP == POLLHUP);
+#endif
+
 struct _GstPoll
 {
   GstPollMode mode;
@@ -142,6 +164,27 @@ struct _GstPoll
 #ifndef G_OS_WIN32
   GstPollFD control_read_fd;
   GstPollFD control_write_fd;
+#ifdef HAVE_SYS_EPOLL_H
+  /* epoll instance, only created and destroyed by the waiting thread with
+   * the lock. When it is used the results are stored in the revents of fds
+   * instead of active_fds */
+  gint epoll_fd;
+  gboolean epoll_failed;
+#ifdef HAVE_EPOLL_PWAIT2
+  /* the running kernel is older than the headers, only used by the waiting
+   * thread */
+  gboolean no_epoll_pwait2;
+#endif
+  /* maps fd numbers to their index in fds */
+  GArray *fd_index;
+  /* only used by the waiting thread */
+  GArray *epoll_events;
+  /* fds that got revents in the last wait */
+  GArray *ready_fds;
+  /* fds that were closed before epoll could watch them, reported with
+   * POLLNVAL in every wait like poll() does */
+  GArray *invalid_fds;
+#endif
 #else
   GArray *active_fds_ignored;
   GArray *events;
@@ -172,6 +215,13 @@ static gboolean gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd);
 #define TEST_REBUILD(s)     (g_atomic_int_compare_and_exchange(&(s)->rebuild, 1, 0))
 #define MARK_REBUILD(s)     (g_atomic_int_set(&(s)->rebuild, 1))
 
+#ifdef HAVE_SYS_EPOLL_H
+#define USE_EPOLL(s)        ((s)->epoll_fd >= 0)
+#define RESULT_FDS(s)       (USE_EPOLL (s) ? (s)->fds : (s)->active_fds)
+#else
+#define RESULT_FDS(s)       ((s)->active_fds)
+#endif
+
 #ifndef G_OS_WIN32
 
 static gboolean
@@ -392,6 +442,218 @@ find_index (GArray * array, GstPollFD * fd)
   return fd->idx;
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+static inline gint
+lookup_fd_index (const GstPoll * set, gint fd)
+{
+  if (fd < 0 || (guint) fd >= set->fd_index->len)
+    return -1;
+
+  return g_array_index (set->fd_index, gint, fd);
+}
+
+static void
+update_fd_index (GstPoll * set, gint fd, gint idx)
+{
+  if ((guint) fd >= set->fd_index->len) {
+    guint i, old_len = set->fd_index->len;
+
+    g_array_set_size (set->fd_index, MAX ((guint) fd + 1, 2 * old_len));
+    for (i = old_len; i < set->fd_index->len; i++)
+      g_array_index (set->fd_index, gint, i) = -1;
+  }
+  g_array_index (set->fd_index, gint, fd) = idx;
+}
+#endif
+
+/* find the index of @fd in the fds of @set, in constant time if possible */
+static gint
+find_fd_index (const GstPoll * set, GstPollFD * fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  fd->idx = lookup_fd_index (set, fd->fd);
+  return fd->idx;
+#else
+  return find_index (set->fds, fd);
+#endif
+}
+
+/* find the index of @fd in the results of the last wait */
+static gint
+find_result_index (const GstPoll * set, GstPollFD * fd)
+{
+#ifdef HAVE_SYS_EPOLL_H
+  if (USE_EPOLL (set))
+    return find_fd_index (set, fd);
+#endif
+  return find_index (set->active_fds, fd);
+}
+
+#ifdef HAVE_SYS_EPOLL_H
+/* Must be called with the lock */
+static void
+epoll_set_invalid (GstPoll * set, gint fd, gboolean invalid)
+{
+  guint i;
+
+  for (i = 0; i < set->invalid_fds->len; i++) {
+    if (g_array_index (set->invalid_fds, gint, i) == fd) {
+      if (!invalid)
+        g_array_remove_index_fast (set->invalid_fds, i);
+      return;
+    }
+  }
+
+  if (invalid)
+    g_array_append_val (set->invalid_fds, fd);
+}
+
+/* Must be called with the lock */
+static void
+epoll_update_fd (GstPoll * set, gint op, struct pollfd *pfd)
+{
+  struct epoll_event ev = { 0, };
+
+  if (op == EPOLL_CTL_DEL)
+    epoll_set_invalid (set, pfd->fd, FALSE);
+
+  if (!USE_EPOLL (set))
+    return;
+
+  /* level triggered, like poll(). Errors and hangups are always reported */
+  ev.events = pfd->events & (EPOLLIN | EPOLLOUT | EPOLLPRI);
+  ev.data.fd = pfd->fd;
+
+  if (epoll_ctl (set->epoll_fd, op, pfd->fd, &ev) < 0) {
+    if (op == EPOLL_CTL_DEL) {
+      /* the fd was closed before it was removed, epoll already forgot it */
+    } else if (errno == EBADF || (op == EPOLL_CTL_MOD && errno == ENOENT)) {
+      /* the fd was closed, or closed and its number reused, after it was
+       * added. poll() reports POLLNVAL for it, do the same */
+      GST_DEBUG ("%p: fd %d was closed", set, pfd->fd);
+      epoll_set_invalid (set, pfd->fd, TRUE);
+    } else if (errno == EPERM) {
+      /* regular files and some devices can't be used with epoll, fall back
+       * to poll() for the whole set in the next wait */
+      GST_INFO ("%p: fd %d does not support epoll, falling back to poll",
+          set, pfd->fd);
+      set->epoll_failed = TRUE;
+      MARK_REBUILD (set);
+    } else {
+      GST_WARNING ("%p: epoll_ctl %d for fd %d failed: %s", set, op, pfd->fd,
+          g_strerror (errno));
+    }
+  }
+}
+
+/* Decides if the next wait uses epoll and prepares for it. Only called from
+ * the waiting thread, with the lock */
+static gboolean
+gst_poll_prepare_epoll (GstPoll * set)
+{
+  guint i;
+
+  if (set->epoll_failed) {
+    if (set->epoll_fd >= 0) {
+      close (set->epoll_fd);
+      set->epoll_fd = -1;
+    }
+    return FALSE;
+  }
+
+  if (set->epoll_fd < 0) {
+    if (set->timer || set->fds->len < EPOLL_MIN_FDS)
+      return FALSE;
+
+    set->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (set->epoll_fd < 0) {
+      GST_WARNING ("%p: can't create epoll instance: %s", set,
+          g_strerror (errno));
+      set->epoll_failed = TRUE;
+      return FALSE;
+    }
+
+    GST_DEBUG ("%p: switching to epoll with %u fds", set, set->fds->len);
+
+    g_array_set_size (set->ready_fds, 0);
+    for (i = 0; i < set->fds->len; i++) {
+      struct pollfd *pfd = &g_array_index (set->fds, struct pollfd, i);
+
+      pfd->revents = 0;
+      epoll_update_fd (set, EPOLL_CTL_ADD, pfd);
+    }
+
+    if (set->epoll_failed)
+      return gst_poll_prepare_epoll (set);
+  }
+
+  g_array_set_size (set->epoll_events, MAX (set->fds->len, 1));
+
+  return TRUE;
+}
+
+/* TRUE when the next wait has to return right away for invalid fds */
+static gboolean
+gst_poll_has_invalid_fds (GstPoll * set)
+{
+  gboolean res;
+
+  g_mutex_lock (&set->lock);
+  res = set->invalid_fds->len > 0;
+  g_mutex_unlock (&set->lock);
+
+  return res;
+}
+
+/* store the results of epoll_wait() in the revents of the fds, returns the
+ * number of ready fds */
+static gint
+gst_poll_collect_epoll_events (GstPoll * set, gint n_events)
+{
+  struct epoll_event *events = (struct epoll_event *) set->epoll_events->data;
+  guint i;
+  gint idx, res = 0;
+
+  g_mutex_lock (&set->lock);
+
+  /* only the fds of the previous wait can have revents set */
+  for (i = 0; i < set->ready_fds->len; i++) {
+    idx = lookup_fd_index (set, g_array_index (set->ready_fds, gint, i));
+    if (idx >= 0)
+      g_array_index (set->fds, struct pollfd, idx).revents = 0;
+  }
+  g_array_set_size (set->ready_fds, 0);
+
+  for (i = 0; i < (guint) n_events; i++) {
+    idx = lookup_fd_index (set, events[i].data.fd);
+    /* removed while we were waiting */
+    if (idx < 0)
+      continue;
+
+    g_array_index (set->fds, struct pollfd, idx).revents = events[i].events;
+    g_array_append_val (set->ready_fds, events[i].data.fd);
+    res++;
+  }
+
+  /* epoll can't report these, they are not in the epoll set */
+  for (i = 0; i < set->invalid_fds->len; i++) {
+    gint fd = g_array_index (set->invalid_fds, gint, i);
+
+    idx = lookup_fd_index (set, fd);
+    if (idx < 0)
+      continue;
+
+    g_array_index (set->fds, struct pollfd, idx).revents = POLLNVAL;
+    g_array_append_val (set->ready_fds, fd);
+    res++;
+  }
+
+  g_mutex_unlock (&set->lock);
+
+  return res;
+}
+#endif
+
 #if !defined(HAVE_PPOLL) && defined(HAVE_POLL)
 /* check if all file descriptors will fit in an fd_set */
 static gboolean
@@ -686,6 +948,19 @@ gst_poll_new (gboolean controllable)
   nset->active_fds = g_array_new (FALSE, FALSE, sizeof (struct pollfd));
   nset->control_read_fd.fd = -1;
   nset->control_write_fd.fd = -1;
+#ifdef HAVE_SYS_EPOLL_H
+  nset->epoll_fd = -1;
+  nset->fd_index = g_array_new (FALSE, FALSE, sizeof (gint));
+  nset->epoll_events = g_array_new (FALSE, FALSE, sizeof (struct epoll_event));
+  nset->ready_fds = g_array_new (FALSE, FALSE, sizeof (gint));
+  nset->invalid_fds = g_array_new (FALSE, FALSE, sizeof (gint));
+  {
+    const gchar *env = g_getenv ("GST_POLL_EPOLL");
+
+    nset->epoll_failed = env != NULL && (strcmp (env, "0") == 0
+        || g_ascii_strcasecmp (env, "no") == 0);
+  }
+#endif
   {
     gint control_sock[2];
 
@@ -776,6 +1051,14 @@ gst_poll_free (GstPoll * set)
     close (set->control_write_fd.fd);
   if (set->control_read_fd.fd >= 0)
     close (set->control_read_fd.fd);
+#ifdef HAVE_SYS_EPOLL_H
+  if (set->epoll_fd >= 0)
+    close (set->epoll_fd);
+  g_array_free (set->ready_fds, TRUE);
+  g_array_free (set->invalid_fds, TRUE);
+  g_array_free (set->epoll_events, TRUE);
+  g_array_free (set->fd_index, TRUE);
+#endif
 #else
   CloseHandle (set->wakeup_event);
 
@@ -847,7 +1130,7 @@ gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd)
 
   GST_DEBUG ("%p: fd (fd:%d, idx:%d)", set, fd->fd, fd->idx);
 
-  idx = find_index (set->fds, fd);
+  idx = find_fd_index (set, fd);
   if (idx < 0) {
 #ifndef G_OS_WIN32
     struct pollfd nfd;
@@ -859,6 +1142,10 @@ gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd)
     g_array_append_val (set->fds, nfd);
 
     fd->idx = set->fds->len - 1;
+#ifdef HAVE_SYS_EPOLL_H
+    update_fd_index (set, fd->fd, fd->idx);
+    epoll_update_fd (set, EPOLL_CTL_ADD, &nfd);
+#endif
 #else
     WinsockFd wfd;
     HANDLE event;
@@ -933,16 +1220,26 @@ gst_poll_remove_fd (GstPoll * set, GstPollFD * fd)
   g_mutex_lock (&set->lock);
 
   /* get the index, -1 is an fd that is not added */
-  idx = find_index (set->fds, fd);
+  idx = find_fd_index (set, fd);
   if (idx >= 0) {
 #ifdef G_OS_WIN32
     gst_poll_free_winsock_event (set, idx);
     g_array_remove_index_fast (set->events, idx);
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_update_fd (set, EPOLL_CTL_DEL,
+        &g_array_index (set->fds, struct pollfd, idx));
+#endif
 
     /* remove the fd at index, we use _remove_index_fast, which copies the last
      * element of the array to the freed index */
     g_array_remove_index_fast (set->fds, idx);
+#ifdef HAVE_SYS_EPOLL_H
+    update_fd_index (set, fd->fd, -1);
+    if ((guint) idx < set->fds->len)
+      update_fd_index (set, g_array_index (set->fds, struct pollfd, idx).fd,
+          idx);
+#endif
 
     /* mark fd as removed by setting the index to -1 */
     fd->idx = -1;
@@ -981,7 +1278,7 @@ gst_poll_fd_ctl_write (GstPoll * set, GstPollFD * fd, gboolean active)
 
   g_mutex_lock (&set->lock);
 
-  idx = find_index (set->fds, fd);
+  idx = find_fd_index (set, fd);
   if (idx >= 0) {
 #ifndef G_OS_WIN32
     struct pollfd *pfd = &g_array_index (set->fds, struct pollfd, idx);
@@ -992,6 +1289,9 @@ gst_poll_fd_ctl_write (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events &= ~POLLOUT;
 
     GST_LOG ("%p: pfd->events now %d (POLLOUT:%d)", set, pfd->events, POLLOUT);
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_update_fd (set, EPOLL_CTL_MOD, pfd);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_WRITE | FD_CONNECT,
         active);
@@ -1014,7 +1314,7 @@ gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd, gboolean active)
   GST_DEBUG ("%p: fd (fd:%d, idx:%d), active : %d", set,
       fd->fd, fd->idx, active);
 
-  idx = find_index (set->fds, fd);
+  idx = find_fd_index (set, fd);
 
   if (idx >= 0) {
 #ifndef G_OS_WIN32
@@ -1024,6 +1324,9 @@ gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events |= POLLIN;
     else
       pfd->events &= ~POLLIN;
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_update_fd (set, EPOLL_CTL_MOD, pfd);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_READ | FD_ACCEPT, active);
 #endif
@@ -1096,7 +1399,7 @@ gst_poll_fd_ctl_pri (GstPoll * set, GstPollFD * fd, gboolean active)
 
   g_mutex_lock (&set->lock);
 
-  idx = find_index (set->fds, fd);
+  idx = find_fd_index (set, fd);
   if (idx >= 0) {
     struct pollfd *pfd = &g_array_index (set->fds, struct pollfd, idx);
 
@@ -1106,6 +1409,9 @@ gst_poll_fd_ctl_pri (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events &= ~POLLPRI;
 
     GST_LOG ("%p: pfd->events now %d (POLLPRI:%d)", set, pfd->events, POLLOUT);
+#ifdef HAVE_SYS_EPOLL_H
+    epoll_update_fd (set, EPOLL_CTL_MOD, pfd);
+#endif
     MARK_REBUILD (set);
   } else {
     GST_WARNING ("%p: couldn't find fd !", set);
@@ -1176,10 +1482,11 @@ gst_poll_fd_has_closed (const GstPoll * set, GstPollFD * fd)
 
   g_mutex_lock (&((GstPoll *) set)->lock);
 
-  idx = find_index (set->active_fds, fd);
+  idx = find_result_index (set, fd);
   if (idx >= 0) {
 #ifndef G_OS_WIN32
-    struct pollfd *pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    struct pollfd *pfd =
+        &g_array_index (RESULT_FDS (set), struct pollfd, idx);
 
     res = (pfd->revents & POLLHUP) != 0;
 #else
@@ -1218,10 +1525,11 @@ gst_poll_fd_has_error (const GstPoll * set, GstPollFD * fd)
 
   g_mutex_lock (&((GstPoll *) set)->lock);
 
-  idx = find_index (set->active_fds, fd);
+  idx = find_result_index (set, fd);
   if (idx >= 0) {
 #ifndef G_OS_WIN32
-    struct pollfd *pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    struct pollfd *pfd =
+        &g_array_index (RESULT_FDS (set), struct pollfd, idx);
 
     res = (pfd->revents & (POLLERR | POLLNVAL)) != 0;
 #else
@@ -1249,10 +1557,11 @@ gst_poll_fd_can_read_unlocked (const GstPoll * set, GstPollFD * fd)
   gboolean res = FALSE;
   gint idx;
 
-  idx = find_index (set->active_fds, fd);
+  idx = find_result_index (set, fd);
   if (idx >= 0) {
 #ifndef G_OS_WIN32
-    struct pollfd *pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    struct pollfd *pfd =
+        &g_array_index (RESULT_FDS (set), struct pollfd, idx);
 
     res = (pfd->revents & POLLIN) != 0;
 #else
@@ -1316,10 +1625,11 @@ gst_poll_fd_can_write (const GstPoll * set, GstPollFD * fd)
 
   g_mutex_lock (&((GstPoll *) set)->lock);
 
-  idx = find_index (set->active_fds, fd);
+  idx = find_result_index (set, fd);
   if (idx >= 0) {
 #ifndef G_OS_WIN32
-    struct pollfd *pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    struct pollfd *pfd =
+        &g_array_index (RESULT_FDS (set), struct pollfd, idx);
 
     res = (pfd->revents & POLLOUT) != 0;
 #else
@@ -1365,9 +1675,10 @@ gst_poll_fd_has_pri (const GstPoll * set, GstPollFD * fd)
 
   g_mutex_lock (&((GstPoll *) set)->lock);
 
-  idx = find_index (set->active_fds, fd);
+  idx = find_result_index (set, fd);
   if (idx >= 0) {
-    struct pollfd *pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+    struct pollfd *pfd =
+        &g_array_index (RESULT_FDS (set), struct pollfd, idx);
 
     res = (pfd->revents & POLLPRI) != 0;
   } else {
@@ -1437,6 +1748,13 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
     if (TEST_REBUILD (set)) {
       g_mutex_lock (&set->lock);
 #ifndef G_OS_WIN32
+#ifdef HAVE_SYS_EPOLL_H
+      /* with epoll the kernel keeps track of the set, nothing to copy */
+      if (gst_poll_prepare_epoll (set)) {
+        g_mutex_unlock (&set->lock);
+        goto rebuilt;
+      }
+#endif
       g_array_set_size (set->active_fds, set->fds->len);
       memcpy (set->active_fds->data, set->fds->data,
           set->fds->len * sizeof (struct pollfd));
@@ -1446,11 +1764,73 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
 #endif
       g_mutex_unlock (&set->lock);
     }
+#ifdef HAVE_SYS_EPOLL_H
+  rebuilt:
+    /* only changed by the waiting thread */
+    if (USE_EPOLL (set))
+      mode = GST_POLL_MODE_EPOLL;
+#endif
 
     switch (mode) {
       case GST_POLL_MODE_AUTO:
         g_assert_not_reached ();
         break;
+      case GST_POLL_MODE_EPOLL:
+      {
+#ifdef HAVE_SYS_EPOLL_H
+        struct epoll_event *events =
+            (struct epoll_event *) set->epoll_events->data;
+        gint max_events = set->epoll_events->len;
+        GstClockTime epoll_timeout = timeout;
+
+        /* invalid fds are ready right away */
+        if (gst_poll_has_invalid_fds (set))
+          epoll_timeout = 0;
+
+#ifdef HAVE_EPOLL_PWAIT2
+        if (G_LIKELY (!set->no_epoll_pwait2)) {
+          struct timespec ts;
+          struct timespec *tsptr;
+
+          if (epoll_timeout != GST_CLOCK_TIME_NONE) {
+            GST_TIME_TO_TIMESPEC (epoll_timeout, ts);
+            tsptr = &ts;
+          } else {
+            tsptr = NULL;
+          }
+
+          res = epoll_pwait2 (set->epoll_fd, events, max_events, tsptr, NULL);
+
+          /* built with newer headers than the running kernel */
+          if (G_UNLIKELY (res < 0 && errno == ENOSYS)) {
+            GST_INFO ("%p: epoll_pwait2 not available, using epoll_wait", set);
+            set->no_epoll_pwait2 = TRUE;
+          }
+        }
+
+        if (G_UNLIKELY (set->no_epoll_pwait2))
+#endif
+        {
+          gint t;
+
+          /* round up so that we never return before the timeout */
+          if (epoll_timeout != GST_CLOCK_TIME_NONE) {
+            t = MIN (GST_TIME_AS_MSECONDS (epoll_timeout + GST_MSECOND - 1),
+                G_MAXINT);
+          } else {
+            t = -1;
+          }
+
+          res = epoll_wait (set->epoll_fd, events, max_events, t);
+        }
+        if (res >= 0)
+          res = gst_poll_collect_epoll_events (set, res);
+#else
+        g_assert_not_reached ();
+        errno = ENOSYS;
+#endif
+        break;
+      }
       case GST_POLL_MODE_PPOLL:
       {
 #ifdef HAVE_PPOLL
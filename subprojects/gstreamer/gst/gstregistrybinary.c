@@ -519,6 +519,23 @@ fail:
 
 /* Registry loading */
 
+/* The registry cache file stays mapped once it was loaded so that features
+ * can reference their strings in it and parse metadata and caps lazily. The
+ * cache is replaced by renaming a new file over it, which leaves the mapping
+ * of the old file intact. On Windows a mapped file can't be replaced, so the
+ * contents are always copied there. */
+#ifndef G_OS_WIN32
+static GMappedFile *registry_mapping = NULL;
+#endif
+
+void
+priv_gst_registry_binary_cleanup (void)
+{
+#ifndef G_OS_WIN32
+  g_clear_pointer (&registry_mapping, g_mapped_file_unref);
+#endif
+}
+
 /*
  * gst_registry_binary_check_magic:
  *
@@ -582,6 +599,7 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   gboolean res = FALSE;
   guint32 filter_env_hash = 0;
   gint check_magic_result;
+  gboolean persistent = FALSE;
 #ifndef GST_DISABLE_GST_DEBUG
   GTimer *timer = NULL;
   gdouble seconds;
@@ -621,6 +639,10 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
     /* This can't fail if g_mapped_file_new() succeeded */
     contents = g_mapped_file_get_contents (mapped);
     size = g_mapped_file_get_length (mapped);
+#ifndef G_OS_WIN32
+    persistent = (registry_mapping == NULL)
+        && g_strcmp0 (g_getenv ("GST_REGISTRY_MAPPED"), "no") != 0;
+#endif
   }
 
   /* in is a cursor pointer, we initialize it with the begin of registry and is updated on each read */
@@ -668,7 +690,8 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
       GST_DEBUG ("reading binary registry %" G_GSIZE_FORMAT "(%x)/%"
           G_GSIZE_FORMAT, (gsize) in - (gsize) contents,
           (guint) ((gsize) in - (gsize) contents), size);
-      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, NULL)) {
+      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end,
+              persistent, NULL)) {
         GST_ERROR ("Problem while reading binary registry %s", location);
         goto Error;
       }
@@ -682,14 +705,23 @@ done:
   seconds = g_timer_elapsed (timer, NULL);
 #endif
 
-  GST_INFO ("loaded %s in %lf seconds", location, seconds);
+  GST_INFO ("loaded %s in %lf seconds%s", location, seconds,
+      persistent ? " (mapped)" : "");
 
   res = TRUE;
-  /* TODO: once we re-use the pointers to registry contents, return here */
 
 Error:
 #ifndef GST_DISABLE_GST_DEBUG
   g_timer_destroy (timer);
+#endif
+#ifndef G_OS_WIN32
+  if (persistent) {
+    /* features might reference the contents, even if loading failed half
+     * way through */
+    registry_mapping = mapped;
+    mapped = NULL;
+    contents = NULL;
+  }
 #endif
   if (mapped) {
     g_mapped_file_unref (mapped);
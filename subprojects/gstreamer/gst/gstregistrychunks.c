@@ -298,9 +298,14 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
       }
     }
 
-    /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    /* pack element metadata strings, unless they were never parsed from the
+     * mapped registry cache */
+    if (factory->metadata)
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
+    else
+      gst_registry_chunks_save_const_string (list,
+          factory->metadata_string ? factory->metadata_string : "");
   } else if (GST_IS_TYPE_FIND_FACTORY (feature)) {
     GstRegistryChunkTypeFindFactory *tff;
     GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (feature);
@@ -333,6 +338,9 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
       gst_caps_unref (fcaps);
 
       gst_registry_chunks_save_string (list, str);
+    } else if (factory->caps_string) {
+      /* already simplified when it was saved before */
+      gst_registry_chunks_save_const_string (list, factory->caps_string);
     } else {
       gst_registry_chunks_save_const_string (list, "");
     }
@@ -351,8 +359,12 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
 
 
     /* pack element metadata strings */
-    gst_registry_chunks_save_string (list,
-        gst_structure_to_string (factory->metadata));
+    if (factory->metadata)
+      gst_registry_chunks_save_string (list,
+          gst_structure_to_string (factory->metadata));
+    else
+      gst_registry_chunks_save_const_string (list,
+          factory->metadata_string ? factory->metadata_string : "");
   } else if (GST_IS_TRACER_FACTORY (feature)) {
     /* Initialize with zeroes because of struct padding and
      * valgrind complaining about copying uninitialized memory
@@ -522,13 +534,14 @@ fail:
  * gst_registry_chunks_load_pad_template:
  *
  * Make a new GstStaticPadTemplate from current GstRegistryChunkPadTemplate
- * structure.
+ * structure. If @persistent is set the strings are used directly from the
+ * registry data.
  *
  * Returns: new GstStaticPadTemplate
  */
 static gboolean
 gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
-    gchar * end)
+    gchar * end, gboolean persistent)
 {
   GstRegistryChunkPadTemplate *pt;
   GstStaticPadTemplate *template = NULL;
@@ -544,8 +557,13 @@ gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
   template->static_caps.caps = NULL;
 
   /* unpack pad template strings */
-  unpack_const_string (*in, template->name_template, end, fail);
-  unpack_const_string (*in, template->static_caps.string, end, fail);
+  if (persistent) {
+    unpack_string_nocopy (*in, template->name_template, end, fail);
+    unpack_string_nocopy (*in, template->static_caps.string, end, fail);
+  } else {
+    unpack_const_string (*in, template->name_template, end, fail);
+    unpack_const_string (*in, template->static_caps.string, end, fail);
+  }
 
   __gst_element_factory_add_static_pad_template (factory, template);
   GST_DEBUG ("Added pad_template %s", template->name_template);
@@ -561,13 +579,15 @@ fail:
 /*
  * gst_registry_chunks_load_feature:
  *
- * Make a new GstPluginFeature from current binary plugin feature structure
+ * Make a new GstPluginFeature from current binary plugin feature structure.
+ * If @persistent is set the registry data stays valid for the lifetime of
+ * the process and metadata and caps strings are only parsed on first use.
  *
  * Returns: new GstPluginFeature
  */
 static gboolean
 gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin * plugin)
+    gchar * end, GstPlugin * plugin, gboolean persistent)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
@@ -626,12 +646,16 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
     if (meta_data_str && *meta_data_str) {
-      factory->metadata = gst_structure_from_string (meta_data_str, NULL);
-      if (!factory->metadata) {
-        GST_ERROR
-            ("Error when trying to deserialize structure for metadata '%s'",
-            meta_data_str);
-        goto fail;
+      if (persistent) {
+        factory->metadata_string = meta_data_str;
+      } else {
+        factory->metadata = gst_structure_from_string (meta_data_str, NULL);
+        if (!factory->metadata) {
+          GST_ERROR
+              ("Error when trying to deserialize structure for metadata '%s'",
+              meta_data_str);
+          goto fail;
+        }
       }
     }
     n = ef->npadtemplates;
@@ -640,7 +664,7 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     /* load pad templates */
     for (i = 0; i < n; i++) {
       if (G_UNLIKELY (!gst_registry_chunks_load_pad_template (factory, in,
-                  end))) {
+                  end, persistent))) {
         GST_ERROR ("Error while loading binary pad template");
         goto fail;
       }
@@ -682,10 +706,12 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
 
     /* load typefinder caps */
     unpack_string_nocopy (*in, const_str, end, fail);
-    if (const_str != NULL && *const_str != '\0')
-      factory->caps = gst_caps_from_string (const_str);
-    else
+    if (const_str == NULL || *const_str == '\0')
       factory->caps = NULL;
+    else if (persistent)
+      factory->caps_string = const_str;
+    else
+      factory->caps = gst_caps_from_string (const_str);
 
     /* load extensions */
     if (tff->nextensions) {
@@ -715,12 +741,16 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     /* unpack element factory strings */
     unpack_string_nocopy (*in, meta_data_str, end, fail);
     if (meta_data_str && *meta_data_str) {
-      factory->metadata = gst_structure_from_string (meta_data_str, NULL);
-      if (!factory->metadata) {
-        GST_ERROR
-            ("Error when trying to deserialize structure for metadata '%s'",
-            meta_data_str);
-        goto fail;
+      if (persistent) {
+        factory->metadata_string = meta_data_str;
+      } else {
+        factory->metadata = gst_structure_from_string (meta_data_str, NULL);
+        if (!factory->metadata) {
+          GST_ERROR
+              ("Error when trying to deserialize structure for metadata '%s'",
+              meta_data_str);
+          goto fail;
+        }
       }
     }
   } else if (GST_IS_TRACER_FACTORY (feature)) {
@@ -834,10 +864,16 @@ fail:
  * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
  * and add it to the GstRegistry. Return an offset to the next
  * GstRegistryChunkPluginElement structure.
+ *
+ * @persistent must only be set if the data pointed to by @in stays valid as
+ * long as the features created from it, i.e. for a registry file that stays
+ * mapped for the lifetime of the process. In that case strings are used
+ * directly from the data and element metadata and typefind caps are parsed
+ * lazily on first use.
  */
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+    gchar * end, gboolean persistent, GstPlugin ** out_plugin)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -910,7 +946,7 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
   /* Load plugin features */
   for (i = 0; i < n; i++) {
     if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin))) {
+                plugin, persistent))) {
       GST_ERROR ("Error while loading binary feature for plugin '%s'",
           GST_STR_NULL (plugin->desc.name));
       gst_registry_remove_plugin (registry, plugin);
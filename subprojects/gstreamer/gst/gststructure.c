@@ -177,6 +177,12 @@ typedef struct
    *  else it's a pointer to the arr field. */
   GstStructureField *fields;
 
+  /* Open addressing hash table mapping field names to their position + 1 in
+   * fields, only maintained for structures with at least
+   * STRUCTURE_INDEX_THRESHOLD fields. */
+  guint *index;
+  guint index_mask;
+
   GstStructureField arr[1];
 } GstStructureImpl;
 
@@ -190,6 +196,11 @@ typedef struct
 #define GST_STRUCTURE_FIELD(structure, index) \
   (&((GstStructureImpl*)(structure))->fields[(index)])
 
+/* Number of fields from which on lookups go through the hash index instead
+ * of a linear scan. Below this the linear scan is faster than hashing the
+ * field name. */
+#define STRUCTURE_INDEX_THRESHOLD 16
+
 #define IS_MUTABLE(structure) \
     (!GST_STRUCTURE_REFCOUNT(structure) || \
      g_atomic_int_get (GST_STRUCTURE_REFCOUNT(structure)) == 1)
@@ -198,6 +209,52 @@ typedef struct
     (((const GstIdStrPrivate *) GST_STRUCTURE_NAME (structure))->s.string_type.t == 0 && \
      (memcmp (((const GstIdStrPrivate *) GST_STRUCTURE_NAME (structure))->s.short_string.s, "taglist", sizeof ("taglist")) == 0))
 
+static inline guint
+_structure_index_hash (const GstIdStr * name)
+{
+  return g_str_hash (gst_id_str_as_str (name));
+}
+
+static void
+_structure_index_insert (GstStructureImpl * impl, guint idx)
+{
+  guint h;
+
+  h = _structure_index_hash (&impl->fields[idx].name) & impl->index_mask;
+  while (impl->index[h] != 0)
+    h = (h + 1) & impl->index_mask;
+  impl->index[h] = idx + 1;
+}
+
+static void
+_structure_index_clear (GstStructureImpl * impl)
+{
+  g_free (impl->index);
+  impl->index = NULL;
+  impl->index_mask = 0;
+}
+
+/* (Re)builds the hash index for all fields, keeping the load factor of the
+ * table below 1/2 */
+static void
+_structure_index_build (GstStructureImpl * impl)
+{
+  guint i, size = 32;
+
+  while (size < impl->fields_len * 2)
+    size <<= 1;
+
+  g_free (impl->index);
+  impl->index = g_new0 (guint, size);
+  impl->index_mask = size - 1;
+
+  for (i = 0; i < impl->fields_len; i++)
+    _structure_index_insert (impl, i);
+
+  GST_CAT_LOG (GST_CAT_PERFORMANCE, "Built field index with %u slots for %u "
+      "fields", size, impl->fields_len);
+}
+
 /* Replacement for g_array_append_val */
 static void
 _structure_append_val (GstStructure * s, GstStructureField * val)
@@ -226,6 +283,13 @@ _structure_append_val (GstStructure * s, GstStructureField * val)
 
   /* Finally set value */
   impl->fields[impl->fields_len++] = *val;
+
+  if (G_UNLIKELY (impl->fields_len >= STRUCTURE_INDEX_THRESHOLD)) {
+    if (impl->index == NULL || impl->fields_len * 2 > impl->index_mask + 1)
+      _structure_index_build (impl);
+    else
+      _structure_index_insert (impl, impl->fields_len - 1);
+  }
 }
 
 /* Replacement for g_array_remove_index */
@@ -244,6 +308,14 @@ _structure_remove_index (GstStructure * s, guint idx)
         &impl->fields[idx + 1],
         (impl->fields_len - idx - 1) * sizeof (GstStructureField));
   impl->fields_len--;
+
+  /* positions after idx have changed, the index has to be rebuilt */
+  if (impl->index) {
+    if (impl->fields_len >= STRUCTURE_INDEX_THRESHOLD)
+      _structure_index_build (impl);
+    else
+      _structure_index_clear (impl);
+  }
 }
 
 static void gst_structure_set_field (GstStructure * structure,
@@ -762,6 +834,7 @@ gst_structure_free (GstStructure * structure)
   }
   if (GST_STRUCTURE_IS_USING_DYNAMIC_ARRAY (structure))
     g_free (((GstStructureImpl *) structure)->fields);
+  g_free (((GstStructureImpl *) structure)->index);
 
   gst_id_str_clear (GST_STRUCTURE_NAME (structure));
 
@@ -1674,7 +1747,6 @@ static void
 gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
-  guint i, len;
 
   if (!gst_structure_validate_field_value (structure,
           gst_id_str_as_str (&field->name), &field->value)) {
@@ -1682,16 +1754,12 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     return;
   }
 
-  len = GST_STRUCTURE_LEN (structure);
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (gst_id_str_is_equal (&f->name, &field->name))) {
-      g_value_unset (&f->value);
-      f->value = field->value;
-      gst_id_str_clear (&field->name);
-      return;
-    }
+  f = gst_structure_id_str_get_field (structure, &field->name);
+  if (f) {
+    g_value_unset (&f->value);
+    f->value = field->value;
+    gst_id_str_clear (&field->name);
+    return;
   }
 
   _structure_append_val (structure, field);
@@ -1703,9 +1771,21 @@ static GstStructureField *
 gst_structure_id_str_get_field (const GstStructure * structure,
     const GstIdStr * fieldname)
 {
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
   GstStructureField *field;
   guint i, len;
 
+  if (impl->index) {
+    i = _structure_index_hash (fieldname) & impl->index_mask;
+    while (impl->index[i] != 0) {
+      field = &impl->fields[impl->index[i] - 1];
+      if (gst_id_str_is_equal (&field->name, fieldname))
+        return field;
+      i = (i + 1) & impl->index_mask;
+    }
+    return NULL;
+  }
+
   len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
@@ -2007,6 +2087,8 @@ gst_structure_remove_all_fields (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
+  _structure_index_clear ((GstStructureImpl *) structure);
+
   for (i = GST_STRUCTURE_LEN (structure) - 1; i >= 0; i--) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
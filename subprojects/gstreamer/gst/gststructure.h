@@ -543,6 +543,14 @@ gchar *               gst_structure_serialize_full       (const GstStructure * s
 GST_API
 GstStructure *        gst_structure_from_string  (const gchar * string,
                                                   gchar      ** end) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
+
+GST_API
+gboolean              gst_structure_serialize_binary     (const GstStructure * structure,
+                                                          GByteArray         * out);
+GST_API
+GstStructure *        gst_structure_deserialize_binary   (const guint8       * data,
+                                                          gsize                size,
+                                                          gsize              * consumed) G_GNUC_MALLOC G_GNUC_WARN_UNUSED_RESULT;
 GST_API
 gboolean              gst_structure_fixate_field_nearest_int      (GstStructure * structure,
                                                                    const char   * field_name,
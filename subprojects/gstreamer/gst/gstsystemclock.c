@@ -229,6 +229,15 @@ struct _GstClockEntryFutex
 
   GMutex lock;
   guint cond_val;
+
+  /* timer wheel, protected by the clock lock */
+  GstClockEntryImpl *wheel_next;
+  GstClockEntryImpl *wheel_prev;
+  guint64 wheel_tick;
+  GstClockTime wheel_time;
+  gboolean in_wheel;
+  /* a sync waiter that the wheel thread has to wake up */
+  gboolean wheel_sync;
 };
 
 static void
@@ -403,6 +412,15 @@ struct _GstClockEntryPThread
 
   pthread_cond_t cond;
   pthread_mutex_t lock;
+
+  /* timer wheel, protected by the clock lock */
+  GstClockEntryImpl *wheel_next;
+  GstClockEntryImpl *wheel_prev;
+  guint64 wheel_tick;
+  GstClockTime wheel_time;
+  gboolean in_wheel;
+  /* a sync waiter that the wheel thread has to wake up */
+  gboolean wheel_sync;
 };
 
 static gboolean
@@ -535,6 +553,15 @@ struct _GstClockEntryGLib
 
   GMutex lock;
   GCond cond;
+
+  /* timer wheel, protected by the clock lock */
+  GstClockEntryImpl *wheel_next;
+  GstClockEntryImpl *wheel_prev;
+  guint64 wheel_tick;
+  GstClockTime wheel_time;
+  gboolean in_wheel;
+  /* a sync waiter that the wheel thread has to wake up */
+  gboolean wheel_sync;
 };
 
 static void
@@ -578,8 +605,36 @@ struct _GstSystemClockPrivate
   GCond entries_changed;
 
   GstClockType clock_type;
+
+  /* timer wheel for async entries, protected by the clock lock */
+  gboolean use_wheel;
+  GstClockEntryImpl **wheel;
+  gulong *wheel_bitmap;
+  guint64 wheel_tick;           /* all ticks before this one are processed */
+  guint wheel_n_entries;
+  GstClockTime wheel_next_time; /* time the wheel thread sleeps until */
 };
 
+/* The timer wheel hashes async entries into WHEEL_SIZE slots by their time
+ * in units of 2^WHEEL_TICK_SHIFT nanoseconds, so that adding and removing an
+ * entry takes constant time. Entries more than one revolution in the future
+ * stay in their slot until the wheel comes around again. A bitmap of the
+ * non-empty slots makes it cheap to find the next entry when the wheel is
+ * sparse.
+ *
+ * Sync waits longer than WHEEL_SYNC_MARGIN are put on the wheel as well, to
+ * be woken up by the wheel thread that much before their time. Only the rest
+ * of the wait is done on the entry itself, so that waiting threads don't arm
+ * a timer each. */
+#define WHEEL_TICK_SHIFT        16      /* ~65.5µs per slot */
+#define WHEEL_SIZE              4096    /* ~268ms per revolution */
+#define WHEEL_MASK              (WHEEL_SIZE - 1)
+#define WHEEL_BITS              (GLIB_SIZEOF_LONG * 8)
+#define WHEEL_WORDS             (WHEEL_SIZE / WHEEL_BITS)
+#define WHEEL_SYNC_MARGIN       (2 * GST_MSECOND)
+
+#define DEFAULT_TIMER_WHEEL     FALSE
+
 #ifdef HAVE_POSIX_TIMERS
 # ifdef HAVE_MONOTONIC_CLOCK
 #  define DEFAULT_CLOCK_TYPE GST_CLOCK_TYPE_MONOTONIC
@@ -594,6 +649,7 @@ enum
 {
   PROP_0,
   PROP_CLOCK_TYPE,
+  PROP_TIMER_WHEEL,
   /* FILL ME */
 };
 
@@ -621,7 +677,14 @@ static void gst_system_clock_id_unschedule (GstClock * clock,
 static gpointer gst_system_clock_async_thread (GstClock * clock);
 static gboolean gst_system_clock_start_async (GstSystemClock * clock);
 
+static gpointer gst_system_clock_wheel_thread (GstClock * clock);
+static void wheel_insert (GstSystemClockPrivate * priv,
+    GstClockEntryImpl * entry, GstClockTime time);
+static void wheel_remove (GstSystemClockPrivate * priv,
+    GstClockEntryImpl * entry);
+
 static GMutex _gst_sysclock_mutex;
+static gboolean default_timer_wheel = DEFAULT_TIMER_WHEEL;
 
 /* static guint gst_system_clock_signals[LAST_SIGNAL] = { 0 }; */
 
@@ -647,6 +710,37 @@ gst_system_clock_class_init (GstSystemClockClass * klass)
           GST_TYPE_CLOCK_TYPE, DEFAULT_CLOCK_TYPE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSystemClock:timer-wheel:
+   *
+   * Schedule async clock entries on a timer wheel instead of a sorted list.
+   * Adding and unscheduling entries then takes constant time and all entries
+   * that expire together are dispatched in one wakeup of the async thread,
+   * which scales better with many thousands of pending async entries.
+   *
+   * Long sync waits are scheduled on the wheel too. The async thread wakes
+   * them up shortly before their time, and only the last few milliseconds
+   * are waited for individually.
+   *
+   * The default value can be changed with the GST_SYSTEM_CLOCK_TIMER_WHEEL
+   * environment variable.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_TIMER_WHEEL,
+      g_param_spec_boolean ("timer-wheel", "Timer wheel",
+          "Schedule async clock entries on a timer wheel",
+          DEFAULT_TIMER_WHEEL,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+          G_PARAM_STATIC_STRINGS));
+
+  {
+    const gchar *env = g_getenv ("GST_SYSTEM_CLOCK_TIMER_WHEEL");
+
+    default_timer_wheel = env != NULL && env[0] != '\0'
+        && strcmp (env, "0") != 0 && g_ascii_strcasecmp (env, "no") != 0;
+  }
+
   gstclock_class->get_internal_time = gst_system_clock_get_internal_time;
   gstclock_class->get_resolution = gst_system_clock_get_resolution;
   gstclock_class->wait = gst_system_clock_id_wait_jitter;
@@ -668,6 +762,8 @@ gst_system_clock_init (GstSystemClock * clock)
   clock->priv = priv = gst_system_clock_get_instance_private (clock);
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
+  priv->use_wheel = default_timer_wheel;
+  priv->wheel_next_time = GST_CLOCK_TIME_NONE;
 
   priv->entries = NULL;
   g_cond_init (&priv->entries_changed);
@@ -730,6 +826,27 @@ gst_system_clock_dispose (GObject * object)
   g_list_free (priv->entries);
   priv->entries = NULL;
 
+  if (priv->wheel) {
+    guint i;
+
+    for (i = 0; i < WHEEL_SIZE; i++) {
+      while (priv->wheel[i]) {
+        GstClockEntryImpl *entry = priv->wheel[i];
+
+        wheel_remove (priv, entry);
+        GST_SYSTEM_CLOCK_ENTRY_LOCK (entry);
+        GST_CLOCK_ENTRY_STATUS ((GstClockEntry *) entry) =
+            GST_CLOCK_UNSCHEDULED;
+        entry->wheel_sync = FALSE;
+        GST_SYSTEM_CLOCK_ENTRY_BROADCAST (entry);
+        GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry);
+        gst_clock_id_unref ((GstClockID) entry);
+      }
+    }
+    g_clear_pointer (&priv->wheel, g_free);
+    g_clear_pointer (&priv->wheel_bitmap, g_free);
+  }
+
   g_cond_clear (&priv->entries_changed);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -752,6 +869,9 @@ gst_system_clock_set_property (GObject * object, guint prop_id,
       GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, sysclock, "clock-type set to %d",
           sysclock->priv->clock_type);
       break;
+    case PROP_TIMER_WHEEL:
+      sysclock->priv->use_wheel = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -768,6 +888,9 @@ gst_system_clock_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CLOCK_TYPE:
       g_value_set_enum (value, sysclock->priv->clock_type);
       break;
+    case PROP_TIMER_WHEEL:
+      g_value_set_boolean (value, sysclock->priv->use_wheel);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1014,6 +1137,300 @@ exit:
   return NULL;
 }
 
+/* Add @entry to the timer wheel to be due at @time, the caller has to
+ * transfer a reference.
+ * Must be called with the clock lock */
+static void
+wheel_insert (GstSystemClockPrivate * priv, GstClockEntryImpl * entry,
+    GstClockTime time)
+{
+  guint slot;
+
+  /* entries in the past are due in the next tick that gets processed */
+  entry->wheel_tick = MAX (time >> WHEEL_TICK_SHIFT, priv->wheel_tick);
+  slot = entry->wheel_tick & WHEEL_MASK;
+  entry->wheel_time = time;
+
+  entry->wheel_prev = NULL;
+  entry->wheel_next = priv->wheel[slot];
+  if (entry->wheel_next)
+    entry->wheel_next->wheel_prev = entry;
+  priv->wheel[slot] = entry;
+  priv->wheel_bitmap[slot / WHEEL_BITS] |= 1UL << (slot % WHEEL_BITS);
+
+  entry->in_wheel = TRUE;
+  priv->wheel_n_entries++;
+}
+
+/* Remove @entry from the timer wheel, the reference is not released.
+ * Must be called with the clock lock */
+static void
+wheel_remove (GstSystemClockPrivate * priv, GstClockEntryImpl * entry)
+{
+  guint slot = entry->wheel_tick & WHEEL_MASK;
+
+  if (entry->wheel_prev)
+    entry->wheel_prev->wheel_next = entry->wheel_next;
+  else
+    priv->wheel[slot] = entry->wheel_next;
+  if (entry->wheel_next)
+    entry->wheel_next->wheel_prev = entry->wheel_prev;
+
+  if (priv->wheel[slot] == NULL)
+    priv->wheel_bitmap[slot / WHEEL_BITS] &= ~(1UL << (slot % WHEEL_BITS));
+
+  entry->wheel_next = entry->wheel_prev = NULL;
+  entry->in_wheel = FALSE;
+  priv->wheel_n_entries--;
+}
+
+/* Returns the distance from @start to the next non-empty slot, going around
+ * the wheel once, or -1 if the wheel is empty */
+static gint
+wheel_find_slot (GstSystemClockPrivate * priv, guint start)
+{
+  guint word0 = start / WHEEL_BITS, bit0 = start % WHEEL_BITS;
+  guint i;
+
+  for (i = 0; i <= WHEEL_WORDS; i++) {
+    guint word = (word0 + i) % WHEEL_WORDS;
+    gulong bits = priv->wheel_bitmap[word];
+
+    if (i == 0)
+      bits &= ~0UL << bit0;
+    else if (i == WHEEL_WORDS)
+      bits &= bit0 ? ~(~0UL << bit0) : 0;
+
+    if (bits) {
+      guint slot = word * WHEEL_BITS + g_bit_nth_lsf (bits, -1);
+
+      return (slot - start) & WHEEL_MASK;
+    }
+  }
+  return -1;
+}
+
+/* Unlink all entries that are due at @now and return them as a list linked
+ * with wheel_next, their reference is passed to the caller.
+ * Must be called with the clock lock */
+static GstClockEntryImpl *
+wheel_collect_due (GstSystemClockPrivate * priv, GstClockTime now)
+{
+  GstClockEntryImpl *due = NULL;
+  guint64 now_tick = now >> WHEEL_TICK_SHIFT;
+  guint64 n_ticks, i;
+
+  /* after a long sleep every slot has to be visited at most once */
+  if (now_tick >= priv->wheel_tick)
+    n_ticks = MIN (now_tick - priv->wheel_tick + 1, WHEEL_SIZE);
+  else
+    n_ticks = 1;
+
+  for (i = 0; i < n_ticks && priv->wheel_n_entries > 0; i++) {
+    guint slot = (priv->wheel_tick + i) & WHEEL_MASK;
+    GstClockEntryImpl *entry, *next;
+
+    for (entry = priv->wheel[slot]; entry; entry = next) {
+      next = entry->wheel_next;
+
+      if (entry->wheel_time > now)
+        continue;
+
+      wheel_remove (priv, entry);
+      entry->wheel_next = due;
+      due = entry;
+    }
+  }
+
+  if (now_tick > priv->wheel_tick)
+    priv->wheel_tick = now_tick;
+
+  return due;
+}
+
+/* Returns the time of the earliest entry in the current revolution of the
+ * wheel, or the end of the revolution if there is none.
+ * Must be called with the clock lock */
+static GstClockTime
+wheel_get_next_time (GstSystemClockPrivate * priv)
+{
+  guint64 tick = priv->wheel_tick;
+  guint64 end = priv->wheel_tick + WHEEL_SIZE;
+  gint distance;
+
+  while (tick < end
+      && (distance = wheel_find_slot (priv, tick & WHEEL_MASK)) >= 0) {
+    GstClockTime next_time = GST_CLOCK_TIME_NONE;
+    GstClockEntryImpl *entry;
+
+    tick += distance;
+    if (tick >= end)
+      break;
+
+    /* entries of later revolutions share the slot, skip them */
+    for (entry = priv->wheel[tick & WHEEL_MASK]; entry;
+        entry = entry->wheel_next) {
+      if (entry->wheel_tick <= tick)
+        next_time = MIN (next_time, entry->wheel_time);
+    }
+    if (next_time != GST_CLOCK_TIME_NONE)
+      return next_time;
+
+    tick++;
+  }
+
+  return end << WHEEL_TICK_SHIFT;
+}
+
+/* Wake up the sync waiters in @due, fire the callbacks of all other entries
+ * and reschedule the periodic ones. Must be called without the clock lock */
+static void
+wheel_dispatch (GstClock * clock, GstClockEntryImpl * due)
+{
+  GstSystemClockPrivate *priv = GST_SYSTEM_CLOCK_CAST (clock)->priv;
+  GstClockEntryImpl *entry_impl, *next, **link;
+
+  /* the waiters first, they don't have to wait for the callbacks */
+  for (link = &due; (entry_impl = *link);) {
+    GST_SYSTEM_CLOCK_ENTRY_LOCK (entry_impl);
+    if (!entry_impl->wheel_sync) {
+      GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+      link = &entry_impl->wheel_next;
+      continue;
+    }
+    *link = entry_impl->wheel_next;
+    entry_impl->wheel_next = NULL;
+
+    GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "waking up sync entry %p",
+        entry_impl);
+    entry_impl->wheel_sync = FALSE;
+    GST_SYSTEM_CLOCK_ENTRY_BROADCAST (entry_impl);
+    GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+    gst_clock_id_unref ((GstClockID) entry_impl);
+  }
+
+  for (entry_impl = due; entry_impl; entry_impl = next) {
+    GstClockEntry *entry = (GstClockEntry *) entry_impl;
+    GstClockTime requested;
+
+    next = entry_impl->wheel_next;
+    entry_impl->wheel_next = NULL;
+
+    GST_SYSTEM_CLOCK_ENTRY_LOCK (entry_impl);
+    if (G_UNLIKELY (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)) {
+      GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+      GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
+          "async entry %p unscheduled", entry);
+      gst_clock_id_unref ((GstClockID) entry);
+      continue;
+    }
+    GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_OK;
+    GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+
+    requested = entry->time;
+
+    GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "async entry %p timed out",
+        entry);
+    if (entry->func)
+      entry->func (clock, entry->time, (GstClockID) entry, entry->user_data);
+
+    if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
+      gboolean reinserted = FALSE;
+
+      GST_SYSTEM_CLOCK_LOCK (clock);
+      GST_SYSTEM_CLOCK_ENTRY_LOCK (entry_impl);
+      if (GST_CLOCK_ENTRY_STATUS (entry) != GST_CLOCK_UNSCHEDULED
+          && !priv->stopping && !entry_impl->in_wheel) {
+        GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
+            "updating periodic entry %p", entry);
+        entry->time = requested + entry->interval;
+        /* keeps our reference */
+        wheel_insert (priv, entry_impl, entry->time);
+        reinserted = TRUE;
+      }
+      GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+      GST_SYSTEM_CLOCK_UNLOCK (clock);
+
+      if (reinserted)
+        continue;
+    }
+    gst_clock_id_unref ((GstClockID) entry);
+  }
+}
+
+/* The timer wheel variant of the async thread. Instead of waiting for the
+ * head entry of a sorted list, it sleeps until the earliest entry of the
+ * wheel is due and then dispatches all entries that expired in one go.
+ *
+ * MT safe.
+ */
+static gpointer
+gst_system_clock_wheel_thread (GstClock * clock)
+{
+  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+  GstSystemClockPrivate *priv = sysclock->priv;
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "enter timer wheel thread");
+  GST_SYSTEM_CLOCK_LOCK (clock);
+  /* signal spinup */
+  priv->starting = FALSE;
+  GST_SYSTEM_CLOCK_BROADCAST (clock);
+
+  while (!priv->stopping) {
+    GstClockEntryImpl *due;
+    GstClockTime now, next_time;
+    GstClockTimeDiff diff;
+    gint64 mono_now;
+
+    if (priv->wheel_n_entries == 0) {
+      GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
+          "no clock entries, waiting..");
+      priv->wheel_next_time = GST_CLOCK_TIME_NONE;
+      GST_SYSTEM_CLOCK_WAIT (clock);
+      continue;
+    }
+
+    /* getting the time might take the object lock */
+    GST_SYSTEM_CLOCK_UNLOCK (clock);
+    now = gst_clock_get_time (clock);
+    mono_now = g_get_monotonic_time ();
+    GST_SYSTEM_CLOCK_LOCK (clock);
+
+    if (G_UNLIKELY (priv->stopping))
+      break;
+
+    due = wheel_collect_due (priv, now);
+    if (due) {
+      /* nobody has to wake us up while dispatching, we check the wheel again
+       * afterwards anyway */
+      priv->wheel_next_time = 0;
+      GST_SYSTEM_CLOCK_UNLOCK (clock);
+      wheel_dispatch (clock, due);
+      GST_SYSTEM_CLOCK_LOCK (clock);
+      continue;
+    }
+
+    next_time = wheel_get_next_time (priv);
+    priv->wheel_next_time = next_time;
+
+    diff = GST_CLOCK_DIFF (now, next_time);
+    if (diff > 0) {
+      GST_CAT_LOG_OBJECT (GST_CAT_CLOCK, clock, "waiting for %"
+          GST_STIME_FORMAT, GST_STIME_ARGS (diff));
+      /* round up so that we never wake up before the entry is due */
+      g_cond_wait_until (GST_SYSTEM_CLOCK_GET_COND (clock),
+          GST_SYSTEM_CLOCK_GET_LOCK (clock), mono_now + (diff + 999) / 1000);
+    }
+  }
+
+  /* signal exit */
+  GST_SYSTEM_CLOCK_BROADCAST (clock);
+  GST_SYSTEM_CLOCK_UNLOCK (clock);
+  GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "exit timer wheel thread");
+
+  return NULL;
+}
+
 #ifdef HAVE_POSIX_TIMERS
 static inline clockid_t
 clock_type_to_posix_id (GstClockType clock_type)
@@ -1288,12 +1705,106 @@ done:
   return status;
 }
 
+/* Waits on the timer wheel until WHEEL_SYNC_MARGIN before the time of
+ * @entry. Returns GST_CLOCK_BUSY if the caller has to wait for the rest of the
+ * time. @waited is set to TRUE if the entry was on the wheel, @jitter is set
+ * already then.
+ *
+ * This is called with the ENTRY_LOCK but not SYSTEM_CLOCK_LOCK!
+ */
+static GstClockReturn
+gst_system_clock_id_wait_wheel_unlocked (GstClock * clock,
+    GstClockEntry * entry, GstClockTimeDiff * jitter, gboolean * waited)
+{
+  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+  GstSystemClockPrivate *priv = sysclock->priv;
+  GstClockEntryImpl *entry_impl = (GstClockEntryImpl *) entry;
+  GstClockTime now, entryt;
+  GstClockTimeDiff diff;
+  gint64 deadline;
+  gboolean release = FALSE;
+
+  GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+
+  now = gst_clock_get_time (clock);
+  deadline = g_get_monotonic_time () * 1000;
+
+  GST_SYSTEM_CLOCK_LOCK (clock);
+  GST_SYSTEM_CLOCK_ENTRY_LOCK (entry_impl);
+  if (G_UNLIKELY (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)) {
+    GST_SYSTEM_CLOCK_UNLOCK (clock);
+    return GST_CLOCK_UNSCHEDULED;
+  }
+
+  entryt = GST_CLOCK_ENTRY_TIME (entry);
+  diff = GST_CLOCK_DIFF (now, entryt);
+
+  /* short waits are done on the entry right away */
+  if (diff <= WHEEL_SYNC_MARGIN || entry_impl->in_wheel
+      || G_UNLIKELY (!gst_system_clock_start_async (sysclock))) {
+    GST_SYSTEM_CLOCK_UNLOCK (clock);
+    return GST_CLOCK_BUSY;
+  }
+
+  GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
+      "waiting for entry %p on the timer wheel", entry);
+
+  *waited = TRUE;
+  if (G_LIKELY (jitter))
+    *jitter = -diff;
+
+  /* the wheel thread releases this reference when it wakes us up */
+  gst_clock_id_ref ((GstClockID) entry);
+  entry_impl->wheel_sync = TRUE;
+  wheel_insert (priv, entry_impl, entryt - WHEEL_SYNC_MARGIN);
+  if (entryt - WHEEL_SYNC_MARGIN < priv->wheel_next_time)
+    GST_SYSTEM_CLOCK_BROADCAST (clock);
+  GST_SYSTEM_CLOCK_UNLOCK (clock);
+
+  /* don't rely on the wheel thread being on time, it might be busy with the
+   * callbacks of async entries */
+  deadline += diff;
+  while (entry_impl->wheel_sync
+      && GST_CLOCK_ENTRY_STATUS (entry) != GST_CLOCK_UNSCHEDULED) {
+    if (!GST_SYSTEM_CLOCK_ENTRY_WAIT_UNTIL (entry_impl, deadline))
+      break;
+  }
+
+  if (G_UNLIKELY (entry_impl->wheel_sync)) {
+    GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+    GST_SYSTEM_CLOCK_LOCK (clock);
+    GST_SYSTEM_CLOCK_ENTRY_LOCK (entry_impl);
+    if (entry_impl->in_wheel) {
+      wheel_remove (priv, entry_impl);
+      entry_impl->wheel_sync = FALSE;
+      release = TRUE;
+    }
+    GST_SYSTEM_CLOCK_UNLOCK (clock);
+
+    /* the wheel thread collected the entry already and is about to wake us
+     * up, it must not find it reused */
+    while (entry_impl->wheel_sync)
+      GST_SYSTEM_CLOCK_ENTRY_WAIT_UNTIL (entry_impl,
+          g_get_monotonic_time () * 1000 + GST_MSECOND);
+
+    /* the caller still has a reference */
+    if (release)
+      gst_clock_id_unref ((GstClockID) entry);
+  }
+
+  if (GST_CLOCK_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)
+    return GST_CLOCK_UNSCHEDULED;
+
+  return GST_CLOCK_BUSY;
+}
+
 static GstClockReturn
 gst_system_clock_id_wait_jitter (GstClock * clock, GstClockEntry * entry,
     GstClockTimeDiff * jitter)
 {
   GstClockReturn status;
   GstClockEntryImpl *entry_impl = (GstClockEntryImpl *) entry;
+  gboolean waited = FALSE;
 
   GST_SYSTEM_CLOCK_LOCK (clock);
   ensure_entry_initialized (entry_impl);
@@ -1317,8 +1828,26 @@ gst_system_clock_id_wait_jitter (GstClock * clock, GstClockEntry * entry,
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "waiting on entry %p", entry);
 
-  status =
-      gst_system_clock_id_wait_jitter_unlocked (clock, entry, jitter, TRUE);
+  if (GST_SYSTEM_CLOCK_CAST (clock)->priv->use_wheel) {
+    status = gst_system_clock_id_wait_wheel_unlocked (clock, entry, jitter,
+        &waited);
+    if (G_UNLIKELY (status != GST_CLOCK_BUSY)) {
+      GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
+      return status;
+    }
+  }
+
+  if (waited) {
+    /* the jitter was reported already and the wait started in time, so a
+     * late wakeup is not EARLY */
+    status =
+        gst_system_clock_id_wait_jitter_unlocked (clock, entry, NULL, TRUE);
+    if (status == GST_CLOCK_EARLY)
+      GST_CLOCK_ENTRY_STATUS (entry) = status = GST_CLOCK_OK;
+  } else {
+    status =
+        gst_system_clock_id_wait_jitter_unlocked (clock, entry, jitter, TRUE);
+  }
 
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
 
@@ -1336,8 +1865,14 @@ gst_system_clock_start_async (GstSystemClock * clock)
   if (G_LIKELY (priv->thread != NULL))
     return TRUE;                /* Thread already running. Nothing to do */
 
+  if (priv->use_wheel && priv->wheel == NULL) {
+    priv->wheel = g_new0 (GstClockEntryImpl *, WHEEL_SIZE);
+    priv->wheel_bitmap = g_new0 (gulong, WHEEL_WORDS);
+  }
+
   priv->starting = TRUE;
   priv->thread = g_thread_try_new ("GstSystemClock",
+      priv->use_wheel ? (GThreadFunc) gst_system_clock_wheel_thread :
       (GThreadFunc) gst_system_clock_async_thread, clock, &error);
 
   if (G_UNLIKELY (error))
@@ -1389,6 +1924,26 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
     goto was_unscheduled;
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
 
+  if (priv->use_wheel) {
+    GstClockEntryImpl *entry_impl = (GstClockEntryImpl *) entry;
+
+    if (G_LIKELY (!entry_impl->in_wheel)) {
+      /* need to take a ref */
+      gst_clock_id_ref ((GstClockID) entry);
+      wheel_insert (priv, entry_impl, GST_CLOCK_ENTRY_TIME (entry));
+
+      /* only wake up the thread if it sleeps past the new entry */
+      if (GST_CLOCK_ENTRY_TIME (entry) < priv->wheel_next_time) {
+        GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
+            "async entry is earliest, sending signal");
+        GST_SYSTEM_CLOCK_BROADCAST (clock);
+      }
+    }
+    GST_SYSTEM_CLOCK_UNLOCK (clock);
+
+    return GST_CLOCK_OK;
+  }
+
   if (priv->entries)
     head = priv->entries->data;
   else
@@ -1463,7 +2018,10 @@ was_unscheduled:
 static void
 gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
 {
+  GstSystemClockPrivate *priv = GST_SYSTEM_CLOCK_CAST (clock)->priv;
+  GstClockEntryImpl *entry_impl = (GstClockEntryImpl *) entry;
   GstClockReturn status;
+  gboolean release = FALSE;
 
   GST_SYSTEM_CLOCK_LOCK (clock);
 
@@ -1482,8 +2040,18 @@ gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
     GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "entry was BUSY, doing wakeup");
     GST_SYSTEM_CLOCK_ENTRY_BROADCAST ((GstClockEntryImpl *) entry);
   }
+
+  /* entries on the timer wheel can be removed right away */
+  if (entry_impl->in_wheel) {
+    wheel_remove (priv, entry_impl);
+    entry_impl->wheel_sync = FALSE;
+    release = TRUE;
+  }
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
   GST_SYSTEM_CLOCK_UNLOCK (clock);
+
+  if (release)
+    gst_clock_id_unref ((GstClockID) entry);
 }
 
 /**
@@ -121,6 +121,16 @@ struct _GstTaskPrivate
   /* remember the pool and id that is currently running. */
   gpointer id;
   GstTaskPool *pool_id;
+
+  /* the task runs as a series of jobs on a GstWorkStealingTaskPool */
+  gboolean cooperative;
+  /* cooperative task that is paused and not scheduled on the pool */
+  gboolean parked;
+  /* enter_func was called for a cooperative task, leave_func is still due */
+  gboolean entered;
+  /* the task function blocked before, the task starts in a thread of its
+   * own the next time */
+  gboolean blocks;
 };
 
 #ifdef _MSC_VER
@@ -213,6 +223,7 @@ gst_task_win32_set_thread_name (const gchar * name)
 static void gst_task_finalize (GObject * object);
 
 static void gst_task_func (GstTask * task);
+static void gst_task_step (GstTask * task);
 
 static GMutex pool_lock;
 
@@ -365,8 +376,9 @@ gst_task_func (GstTask * task)
   task->thread = tself;
   GST_OBJECT_UNLOCK (task);
 
-  /* fire the enter_func callback when we need to */
-  if (priv->enter_func)
+  /* fire the enter_func callback when we need to, a cooperative task that
+   * was moved to this thread already did */
+  if (priv->enter_func && !priv->entered)
     priv->enter_func (task, tself, priv->enter_user_data);
 
   /* locking order is TASK_LOCK, LOCK */
@@ -405,6 +417,7 @@ gst_task_func (GstTask * task)
   task->thread = NULL;
 
 exit:
+  priv->entered = FALSE;
   if (priv->leave_func) {
     /* fire the leave_func callback when we need to. We need to do this before
      * we signal the task and with the task lock released. */
@@ -435,6 +448,164 @@ no_lock:
   }
 }
 
+/* maximum time a cooperative task keeps its worker before it yields to the
+ * other tasks on the pool */
+#define TASK_SLICE_TIME (2 * G_TIME_SPAN_MILLISECOND)
+/* a single call of the task function that takes longer than this blocks, for
+ * example while waiting for data, and the task is moved to its own thread */
+#define TASK_BLOCKING_TIME (50 * G_TIME_SPAN_MILLISECOND)
+
+/* Moves a cooperative task whose function blocks to a thread of its own,
+ * where it runs like a task on a threaded pool until it is stopped. Returns
+ * FALSE when no thread could be started. */
+static gboolean
+gst_task_move_to_thread (GstTask * task)
+{
+  GError *error = NULL;
+
+  if (!gst_work_stealing_task_pool_push_blocking (GST_WORK_STEALING_TASK_POOL
+          (task->priv->pool_id), (GstTaskPoolFunction) gst_task_func, task,
+          &error)) {
+    GST_WARNING_OBJECT (task, "failed to start a thread: %s", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* schedule the next slice of a cooperative task on its pool. Returns FALSE
+ * when it could not be scheduled. */
+static gboolean
+gst_task_schedule (GstTask * task)
+{
+  GError *error = NULL;
+
+  gst_task_pool_push (task->priv->pool_id, (GstTaskPoolFunction) gst_task_step,
+      task, &error);
+
+  if (error != NULL) {
+    g_warning ("failed to schedule task: %s", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* Runs one slice of a task on a GstWorkStealingTaskPool. Instead of looping
+ * in its own thread, the task function is called until the task is paused or
+ * stopped or the slice time is used up, after which the task is scheduled
+ * again on the pool. Paused tasks are parked and rescheduled when their state
+ * changes.
+ *
+ * Like for a threaded task, enter_func is only called before the first slice
+ * and leave_func after the last one, so that pads do not post a pair of
+ * STREAM_STATUS messages for every slice. They might be called on different
+ * workers.
+ *
+ * A task function that blocks would keep its worker from running the other
+ * tasks, so such a task continues in a thread of its own instead. */
+static void
+gst_task_step (GstTask * task)
+{
+  GRecMutex *lock;
+  GThread *tself;
+  GstTaskPrivate *priv;
+  GstTaskState state;
+  gint64 now, start, deadline;
+  gboolean blocking = FALSE;
+
+  priv = task->priv;
+  tself = g_thread_self ();
+
+  GST_OBJECT_LOCK (task);
+  state = GET_TASK_STATE (task);
+  if (state == GST_TASK_STOPPED)
+    goto done;
+  if (state == GST_TASK_PAUSED)
+    goto park;
+  lock = GST_TASK_GET_LOCK (task);
+  if (G_UNLIKELY (lock == NULL))
+    goto no_lock;
+  task->thread = tself;
+  GST_OBJECT_UNLOCK (task);
+
+  if (G_UNLIKELY (!priv->entered)) {
+    priv->entered = TRUE;
+    if (priv->enter_func)
+      priv->enter_func (task, tself, priv->enter_user_data);
+  }
+
+  g_rec_mutex_lock (lock);
+  now = g_get_monotonic_time ();
+  deadline = now + TASK_SLICE_TIME;
+  do {
+    start = now;
+    task->func (task->user_data);
+    now = g_get_monotonic_time ();
+    blocking = now - start > TASK_BLOCKING_TIME;
+  } while (G_LIKELY (!blocking && GET_TASK_STATE (task) == GST_TASK_STARTED)
+      && now < deadline);
+  g_rec_mutex_unlock (lock);
+
+  GST_OBJECT_LOCK (task);
+  task->thread = NULL;
+  if (G_UNLIKELY (blocking))
+    priv->blocks = TRUE;
+  state = GET_TASK_STATE (task);
+  if (state == GST_TASK_STOPPED)
+    goto done;
+  if (state == GST_TASK_PAUSED)
+    goto park;
+  GST_OBJECT_UNLOCK (task);
+
+  if (G_UNLIKELY (blocking)) {
+    GST_INFO_OBJECT (task, "task function blocks, moving it to its own "
+        "thread");
+    if (gst_task_move_to_thread (task))
+      return;
+  }
+
+  if (G_UNLIKELY (!gst_task_schedule (task))) {
+    GST_OBJECT_LOCK (task);
+    goto done;
+  }
+  return;
+
+park:
+  {
+    GST_INFO_OBJECT (task, "Task going to paused");
+    priv->parked = TRUE;
+    GST_TASK_SIGNAL (task);
+    GST_OBJECT_UNLOCK (task);
+    return;
+  }
+no_lock:
+  {
+    g_warning ("starting task without a lock");
+    goto done;
+  }
+done:
+  {
+    if (priv->entered) {
+      /* with the task lock released, like in gst_task_func() */
+      priv->entered = FALSE;
+      if (priv->leave_func) {
+        GST_OBJECT_UNLOCK (task);
+        priv->leave_func (task, tself, priv->leave_user_data);
+        GST_OBJECT_LOCK (task);
+      }
+    }
+    task->running = FALSE;
+    GST_TASK_SIGNAL (task);
+    GST_OBJECT_UNLOCK (task);
+
+    GST_DEBUG ("Exit task %p, thread %p", task, tself);
+
+    gst_object_unref (task);
+  }
+}
+
 /**
  * gst_task_cleanup_all:
  *
@@ -723,9 +894,25 @@ start_task (GstTask * task)
   /* push on the thread pool, we remember the original pool because the user
    * could change it later on and then we join to the wrong pool. */
   priv->pool_id = gst_object_ref (priv->pool);
-  priv->id =
-      gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
-      task, &error);
+  priv->cooperative = GST_IS_WORK_STEALING_TASK_POOL (priv->pool_id);
+  priv->parked = FALSE;
+  priv->entered = FALSE;
+  if (priv->cooperative) {
+    priv->id = NULL;
+    /* don't occupy a worker until the function blocks again */
+    if (priv->blocks) {
+      GST_INFO_OBJECT (task, "task function blocked before, starting it in "
+          "its own thread");
+      if (gst_task_move_to_thread (task))
+        return TRUE;
+    }
+    gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_step,
+        task, &error);
+  } else {
+    priv->id =
+        gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
+        task, &error);
+  }
 
   if (error != NULL) {
     g_warning ("failed to create thread: %s", error->message);
@@ -762,6 +949,11 @@ gst_task_set_state_unlocked (GstTask * task, GstTaskState state)
       case GST_TASK_PAUSED:
         /* when we are paused, signal to go to the new state */
         GST_TASK_SIGNAL (task);
+        /* a parked cooperative task needs to be scheduled again */
+        if (task->priv->parked) {
+          task->priv->parked = FALSE;
+          res = gst_task_schedule (task);
+        }
         break;
       case GST_TASK_STARTED:
         /* if we were started, we'll go to the new state after the next
@@ -934,6 +1126,14 @@ gst_task_join (GstTask * task)
   SET_TASK_STATE (task, GST_TASK_STOPPED);
   /* signal the state change for when it was blocked in PAUSED. */
   GST_TASK_SIGNAL (task);
+  /* a parked cooperative task has to run once more to finish */
+  if (priv->parked) {
+    priv->parked = FALSE;
+    if (!gst_task_schedule (task)) {
+      task->running = FALSE;
+      gst_object_unref (task);
+    }
+  }
   /* we set the running flag when pushing the task on the thread pool.
    * This means that the task function might not be called when we try
    * to join it here. */
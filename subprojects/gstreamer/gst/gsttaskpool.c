@@ -607,3 +607,702 @@ gst_shared_task_pool_new (void)
 
   return pool;
 }
+
+/* Work stealing task pool
+ *
+ * Every worker thread owns a queue of jobs. Jobs pushed from a worker thread
+ * go to the queue of that worker, jobs pushed from other threads are spread
+ * over the workers round-robin. A worker takes jobs from the head of its own
+ * queue and when that is empty steals from the tail of the other queues.
+ *
+ * A job that blocks keeps its worker busy. When jobs are pending, no worker is
+ * idle and no job completed for a while, the monitor thread starts an extra
+ * worker, up to max_threads. Extra workers exit again when they stay idle.
+ *
+ * Once max_threads is reached, the monitor detaches the worker that is stuck
+ * in its current job for the longest time instead: its thread only finishes
+ * that job and then exits, and a new thread takes over its queue. Blocking
+ * jobs can then never starve the others, whatever max_threads is.
+ *
+ * Jobs that are known to block don't have to wait for any of this, they are
+ * pushed with gst_work_stealing_task_pool_push_blocking() and get a thread of
+ * their own right away. */
+
+#define WORK_STEALING_MONITOR_INTERVAL (10 * G_TIME_SPAN_MILLISECOND)
+#define WORK_STEALING_IDLE_TIMEOUT     (G_TIME_SPAN_SECOND)
+#define WORK_STEALING_THREADS_FACTOR   8
+/* monitor intervals a worker has to be stuck in a job to be detached */
+#define WORK_STEALING_DETACH_TICKS     10
+
+/* WorkStealingWorker.state is the generation of the thread running the
+ * worker, shifted by one, with this bit set while it runs a job */
+#define WORK_STEALING_BUSY 1
+
+typedef struct
+{
+  GstWorkStealingTaskPool *pool;
+  guint index;
+
+  GMutex lock;
+  GQueue jobs;
+
+  GThread *thread;
+  /* extra workers are started by the monitor and exit when idle */
+  gboolean extra;
+  /* with the pool lock */
+  gboolean retired;
+
+  gint state;
+  gint n_jobs;
+  /* only used by the monitor */
+  gint seen_jobs;
+  guint stuck_ticks;
+} WorkStealingWorker;
+
+struct _GstWorkStealingTaskPoolPrivate
+{
+  guint n_workers;
+  guint max_threads;
+
+  /* array of max_threads workers, the first n_slots are initialized */
+  WorkStealingWorker *workers;
+  gint n_slots;
+
+  /* protects the fields below and is used to wait for jobs */
+  GMutex lock;
+  GCond cond;
+  GCond monitor_cond;
+  GThread *monitor;
+  gboolean shutdown;
+  guint n_threads;
+  /* threads of detached workers, finishing their last job */
+  GList *detached;
+  /* jobs pushed with gst_work_stealing_task_pool_push_blocking() that are
+   * still running */
+  guint n_blocking;
+  GCond blocking_cond;
+
+  gint n_pending;
+  gint n_idle;
+  gint n_completed;
+  gint next_worker;
+};
+
+typedef struct
+{
+  GstWorkStealingTaskPool *pool;
+  GstTaskPoolFunction func;
+  gpointer user_data;
+} WorkStealingBlockingJob;
+
+static GPrivate work_stealing_worker_key;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GstWorkStealingTaskPool,
+    gst_work_stealing_task_pool, GST_TYPE_TASK_POOL);
+
+static TaskData *
+work_stealing_pop (WorkStealingWorker * worker)
+{
+  GstWorkStealingTaskPoolPrivate *priv = worker->pool->priv;
+  TaskData *tdata;
+  gint i, n_slots;
+
+  g_mutex_lock (&worker->lock);
+  tdata = g_queue_pop_head (&worker->jobs);
+  g_mutex_unlock (&worker->lock);
+
+  if (tdata)
+    return tdata;
+
+  /* nothing left locally, steal from the others */
+  n_slots = g_atomic_int_get (&priv->n_slots);
+  for (i = 1; i < n_slots && tdata == NULL; i++) {
+    WorkStealingWorker *victim = &priv->workers[(worker->index + i) % n_slots];
+
+    g_mutex_lock (&victim->lock);
+    tdata = g_queue_pop_tail (&victim->jobs);
+    g_mutex_unlock (&victim->lock);
+  }
+
+  return tdata;
+}
+
+static gpointer
+work_stealing_worker_func (WorkStealingWorker * worker)
+{
+  GstWorkStealingTaskPoolPrivate *priv = worker->pool->priv;
+  gint state = g_atomic_int_get (&worker->state) & ~WORK_STEALING_BUSY;
+  TaskData *tdata;
+
+  g_private_set (&work_stealing_worker_key, worker);
+
+  while (TRUE) {
+    if ((tdata = work_stealing_pop (worker))) {
+      GstTaskPoolFunction func = tdata->func;
+      gpointer user_data = tdata->user_data;
+
+      g_atomic_int_add (&priv->n_pending, -1);
+      g_free (tdata);
+
+      g_atomic_int_set (&worker->state, state | WORK_STEALING_BUSY);
+      g_atomic_int_inc (&worker->n_jobs);
+
+      func (user_data);
+
+      g_atomic_int_inc (&priv->n_completed);
+
+      /* the worker was handed to a new thread while the job blocked, this
+       * one only had to finish it */
+      if (!g_atomic_int_compare_and_exchange (&worker->state,
+              state | WORK_STEALING_BUSY, state))
+        break;
+      continue;
+    }
+
+    g_mutex_lock (&priv->lock);
+    if (priv->shutdown) {
+      g_mutex_unlock (&priv->lock);
+      break;
+    }
+
+    g_atomic_int_inc (&priv->n_idle);
+    if (g_atomic_int_get (&priv->n_pending) == 0) {
+      if (worker->extra) {
+        gint64 end_time = g_get_monotonic_time () + WORK_STEALING_IDLE_TIMEOUT;
+
+        if (!g_cond_wait_until (&priv->cond, &priv->lock, end_time)
+            && g_atomic_int_get (&priv->n_pending) == 0 && !priv->shutdown) {
+          GST_DEBUG_OBJECT (worker->pool, "retiring idle worker %u",
+              worker->index);
+          g_atomic_int_add (&priv->n_idle, -1);
+          worker->retired = TRUE;
+          priv->n_threads--;
+          g_mutex_unlock (&priv->lock);
+          break;
+        }
+      } else {
+        g_cond_wait (&priv->cond, &priv->lock);
+      }
+    }
+    g_atomic_int_add (&priv->n_idle, -1);
+    g_mutex_unlock (&priv->lock);
+  }
+
+  g_private_set (&work_stealing_worker_key, NULL);
+
+  return NULL;
+}
+
+static gpointer
+work_stealing_blocking_func (WorkStealingBlockingJob * job)
+{
+  GstWorkStealingTaskPoolPrivate *priv = job->pool->priv;
+
+  job->func (job->user_data);
+
+  g_mutex_lock (&priv->lock);
+  priv->n_blocking--;
+  g_cond_broadcast (&priv->blocking_cond);
+  g_mutex_unlock (&priv->lock);
+
+  /* @func might have released the last reference the caller had */
+  gst_object_unref (job->pool);
+  g_free (job);
+
+  return NULL;
+}
+
+/* with the pool lock */
+static gboolean
+work_stealing_spawn_worker (GstWorkStealingTaskPool * pool,
+    WorkStealingWorker * worker, GError ** error)
+{
+  gchar *name;
+
+  worker->retired = FALSE;
+  worker->stuck_ticks = 0;
+
+  name = g_strdup_printf ("gstws-%u", worker->index);
+  worker->thread = g_thread_try_new (name,
+      (GThreadFunc) work_stealing_worker_func, worker, error);
+  g_free (name);
+
+  if (worker->thread == NULL) {
+    worker->retired = TRUE;
+    return FALSE;
+  }
+  pool->priv->n_threads++;
+
+  return TRUE;
+}
+
+/* with the pool lock */
+static gboolean
+work_stealing_start_worker (GstWorkStealingTaskPool * pool, gboolean extra,
+    GError ** error)
+{
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  WorkStealingWorker *worker = NULL;
+  gint i, n_slots;
+
+  /* reuse the slot of a retired extra worker if there is one */
+  n_slots = g_atomic_int_get (&priv->n_slots);
+  for (i = 0; i < n_slots; i++) {
+    if (priv->workers[i].retired) {
+      worker = &priv->workers[i];
+      if (worker->thread) {
+        g_thread_join (worker->thread);
+        worker->thread = NULL;
+      }
+      break;
+    }
+  }
+
+  if (worker == NULL) {
+    if ((guint) n_slots >= priv->max_threads)
+      return FALSE;
+
+    worker = &priv->workers[n_slots];
+    worker->pool = pool;
+    worker->index = n_slots;
+    g_mutex_init (&worker->lock);
+    g_queue_init (&worker->jobs);
+    g_atomic_int_set (&priv->n_slots, n_slots + 1);
+  }
+
+  worker->extra = extra;
+
+  return work_stealing_spawn_worker (pool, worker, error);
+}
+
+/* Detaches the worker that is stuck in a job for the longest time from its
+ * thread and starts a new thread for it. With the pool lock. */
+static void
+work_stealing_detach_worker (GstWorkStealingTaskPool * pool)
+{
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  WorkStealingWorker *worker = NULL;
+  gint i, n_slots, state;
+
+  n_slots = g_atomic_int_get (&priv->n_slots);
+  for (i = 0; i < n_slots; i++) {
+    WorkStealingWorker *w = &priv->workers[i];
+
+    if (w->thread && w->stuck_ticks >= WORK_STEALING_DETACH_TICKS
+        && (worker == NULL || w->stuck_ticks > worker->stuck_ticks))
+      worker = w;
+  }
+  if (worker == NULL)
+    return;
+
+  /* moving to the next generation fails if the job just finished */
+  state = g_atomic_int_get (&worker->state);
+  if (!(state & WORK_STEALING_BUSY)
+      || !g_atomic_int_compare_and_exchange (&worker->state, state,
+          (state & ~WORK_STEALING_BUSY) + 2))
+    return;
+
+  GST_INFO_OBJECT (pool, "worker %u is blocked, moving its job to a thread "
+      "of its own", worker->index);
+
+  priv->detached = g_list_prepend (priv->detached, worker->thread);
+  worker->thread = NULL;
+  priv->n_threads--;
+
+  work_stealing_spawn_worker (pool, worker, NULL);
+}
+
+static gpointer
+work_stealing_monitor_func (GstWorkStealingTaskPool * pool)
+{
+  GstWorkStealingTaskPoolPrivate *priv = pool->priv;
+  gint last_completed = -1;
+
+  g_mutex_lock (&priv->lock);
+  while (!priv->shutdown) {
+    gint64 end_time = g_get_monotonic_time () + WORK_STEALING_MONITOR_INTERVAL;
+    gint i, n_slots, completed;
+
+    g_cond_wait_until (&priv->monitor_cond, &priv->lock, end_time);
+    if (priv->shutdown)
+      break;
+
+    /* count for how long every worker is in the same job */
+    n_slots = g_atomic_int_get (&priv->n_slots);
+    for (i = 0; i < n_slots; i++) {
+      WorkStealingWorker *w = &priv->workers[i];
+      gint n_jobs = g_atomic_int_get (&w->n_jobs);
+
+      if ((g_atomic_int_get (&w->state) & WORK_STEALING_BUSY)
+          && n_jobs == w->seen_jobs) {
+        w->stuck_ticks++;
+      } else {
+        w->seen_jobs = n_jobs;
+        w->stuck_ticks = 0;
+      }
+    }
+
+    /* all workers are stuck in jobs that don't make progress while others
+     * are waiting, add a worker so that they don't starve */
+    completed = g_atomic_int_get (&priv->n_completed);
+    if (g_atomic_int_get (&priv->n_pending) > 0
+        && g_atomic_int_get (&priv->n_idle) == 0
+        && completed == last_completed) {
+      if (priv->n_threads < priv->max_threads) {
+        GST_DEBUG_OBJECT (pool, "workers are blocked, starting an extra one");
+        work_stealing_start_worker (pool, TRUE, NULL);
+      } else {
+        work_stealing_detach_worker (pool);
+      }
+    }
+    last_completed = completed;
+  }
+  g_mutex_unlock (&priv->lock);
+
+  return NULL;
+}
+
+static void
+work_stealing_prepare (GstTaskPool * pool, GError ** error)
+{
+  GstWorkStealingTaskPool *ws_pool = GST_WORK_STEALING_TASK_POOL (pool);
+  GstWorkStealingTaskPoolPrivate *priv = ws_pool->priv;
+  guint i;
+
+  g_mutex_lock (&priv->lock);
+  if (priv->workers) {
+    g_mutex_unlock (&priv->lock);
+    return;
+  }
+
+  GST_OBJECT_LOCK (pool);
+  priv->max_threads = MAX (priv->max_threads, priv->n_workers);
+  GST_OBJECT_UNLOCK (pool);
+
+  priv->workers = g_new0 (WorkStealingWorker, priv->max_threads);
+  priv->shutdown = FALSE;
+
+  GST_DEBUG_OBJECT (pool, "starting %u workers, at most %u threads",
+      priv->n_workers, priv->max_threads);
+
+  for (i = 0; i < priv->n_workers; i++) {
+    if (!work_stealing_start_worker (ws_pool, FALSE, error))
+      break;
+  }
+
+  priv->monitor = g_thread_try_new ("gstws-monitor",
+      (GThreadFunc) work_stealing_monitor_func, ws_pool,
+      error && *error ? NULL : error);
+  g_mutex_unlock (&priv->lock);
+}
+
+static void
+work_stealing_cleanup (GstTaskPool * pool)
+{
+  GstWorkStealingTaskPoolPrivate *priv =
+      GST_WORK_STEALING_TASK_POOL (pool)->priv;
+  gint i, n_slots;
+
+  g_mutex_lock (&priv->lock);
+  if (priv->workers == NULL) {
+    g_mutex_unlock (&priv->lock);
+    return;
+  }
+  priv->shutdown = TRUE;
+  g_cond_broadcast (&priv->cond);
+  g_cond_signal (&priv->monitor_cond);
+  g_mutex_unlock (&priv->lock);
+
+  if (priv->monitor)
+    g_thread_join (priv->monitor);
+  priv->monitor = NULL;
+
+  /* while the workers are still around to run the jobs these might wait for */
+  while (priv->detached) {
+    g_thread_join (priv->detached->data);
+    priv->detached = g_list_delete_link (priv->detached, priv->detached);
+  }
+  g_mutex_lock (&priv->lock);
+  while (priv->n_blocking > 0)
+    g_cond_wait (&priv->blocking_cond, &priv->lock);
+  g_mutex_unlock (&priv->lock);
+
+  /* the workers finish all queued jobs before they exit */
+  n_slots = g_atomic_int_get (&priv->n_slots);
+  for (i = 0; i < n_slots; i++) {
+    WorkStealingWorker *worker = &priv->workers[i];
+
+    if (worker->thread)
+      g_thread_join (worker->thread);
+    g_mutex_clear (&worker->lock);
+  }
+
+  g_free (priv->workers);
+  priv->workers = NULL;
+  g_atomic_int_set (&priv->n_slots, 0);
+  priv->n_threads = 0;
+}
+
+static gpointer
+work_stealing_push (GstTaskPool * pool, GstTaskPoolFunction func,
+    gpointer user_data, GError ** error)
+{
+  GstWorkStealingTaskPool *ws_pool = GST_WORK_STEALING_TASK_POOL (pool);
+  GstWorkStealingTaskPoolPrivate *priv = ws_pool->priv;
+  WorkStealingWorker *worker;
+  TaskData *tdata;
+
+  worker = g_private_get (&work_stealing_worker_key);
+  if (worker == NULL || worker->pool != ws_pool) {
+    guint n_workers;
+
+    n_workers = MIN (priv->n_workers, g_atomic_int_get (&priv->n_slots));
+    if (n_workers == 0) {
+      g_set_error_literal (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+          "No thread pool");
+      return NULL;
+    }
+    worker = &priv->workers[(guint) g_atomic_int_add (&priv->next_worker,
+            1) % n_workers];
+  }
+
+  tdata = g_new (TaskData, 1);
+  tdata->func = func;
+  tdata->user_data = user_data;
+
+  g_mutex_lock (&worker->lock);
+  g_queue_push_tail (&worker->jobs, tdata);
+  g_mutex_unlock (&worker->lock);
+
+  g_atomic_int_inc (&priv->n_pending);
+  if (g_atomic_int_get (&priv->n_idle) > 0) {
+    g_mutex_lock (&priv->lock);
+    g_cond_signal (&priv->cond);
+    g_mutex_unlock (&priv->lock);
+  }
+
+  return NULL;
+}
+
+static void
+gst_work_stealing_task_pool_finalize (GObject * object)
+{
+  GstWorkStealingTaskPoolPrivate *priv =
+      GST_WORK_STEALING_TASK_POOL (object)->priv;
+
+  work_stealing_cleanup (GST_TASK_POOL (object));
+
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+  g_cond_clear (&priv->monitor_cond);
+  g_cond_clear (&priv->blocking_cond);
+
+  G_OBJECT_CLASS (gst_work_stealing_task_pool_parent_class)->finalize (object);
+}
+
+static void
+gst_work_stealing_task_pool_class_init (GstWorkStealingTaskPoolClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTaskPoolClass *taskpoolclass = GST_TASK_POOL_CLASS (klass);
+
+  gobject_class->finalize = gst_work_stealing_task_pool_finalize;
+
+  taskpoolclass->prepare = work_stealing_prepare;
+  taskpoolclass->cleanup = work_stealing_cleanup;
+  taskpoolclass->push = work_stealing_push;
+}
+
+static void
+gst_work_stealing_task_pool_init (GstWorkStealingTaskPool * pool)
+{
+  GstWorkStealingTaskPoolPrivate *priv;
+
+  priv = pool->priv = gst_work_stealing_task_pool_get_instance_private (pool);
+  g_mutex_init (&priv->lock);
+  g_cond_init (&priv->cond);
+  g_cond_init (&priv->monitor_cond);
+  g_cond_init (&priv->blocking_cond);
+}
+
+/**
+ * gst_work_stealing_task_pool_new:
+ * @n_workers: the number of worker threads, or 0 to use one per CPU core
+ *
+ * Create a new work stealing task pool. The pool runs the pushed functions on
+ * a fixed set of @n_workers threads, every worker has its own queue of
+ * functions and steals from the others when that queue is empty.
+ *
+ * When #GstTask uses this pool, it does not keep a thread for itself but
+ * schedules every run of its task function as a job on the pool, so that the
+ * streaming loops of many pipelines share the workers. A task only occupies a
+ * worker while its function runs, a paused task does not occupy a worker at
+ * all. The enter and leave callbacks of the task are called once when the
+ * task starts and stops, like for a task with a thread of its own.
+ *
+ * Task functions that block, for example waiting for data, keep their worker
+ * busy. A task whose function blocks continues in a thread of its own until
+ * it is stopped. To avoid starving the other tasks in the meantime, the pool
+ * starts extra workers when all workers are blocked, up to the limit set with
+ * gst_work_stealing_task_pool_set_max_threads(). Beyond that, a blocked job
+ * keeps the thread it runs in and a new thread replaces it in the pool. A task
+ * that blocked once starts in a thread of its own right away when it is
+ * started again, and other jobs that are known to block can be pushed with
+ * gst_work_stealing_task_pool_push_blocking().
+ *
+ * The pool can be used for the streaming threads of a pipeline with the
+ * #GstPipeline:task-pool property, and the same pool can be shared by many
+ * pipelines.
+ *
+ * Returns: (transfer full): a new #GstWorkStealingTaskPool. gst_object_unref()
+ * after usage.
+ *
+ * Since: 1.30
+ */
+GstTaskPool *
+gst_work_stealing_task_pool_new (guint n_workers)
+{
+  GstWorkStealingTaskPool *pool;
+
+  pool = g_object_new (GST_TYPE_WORK_STEALING_TASK_POOL, NULL);
+
+  if (n_workers == 0)
+    n_workers = g_get_num_processors ();
+  pool->priv->n_workers = n_workers;
+  pool->priv->max_threads = n_workers * WORK_STEALING_THREADS_FACTOR;
+
+  /* clear floating flag */
+  gst_object_ref_sink (pool);
+
+  return GST_TASK_POOL_CAST (pool);
+}
+
+/**
+ * gst_work_stealing_task_pool_get_n_workers:
+ * @pool: a #GstWorkStealingTaskPool
+ *
+ * Returns: the number of workers @pool always keeps running
+ *
+ * Since: 1.30
+ */
+guint
+gst_work_stealing_task_pool_get_n_workers (GstWorkStealingTaskPool * pool)
+{
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), 0);
+
+  return pool->priv->n_workers;
+}
+
+/**
+ * gst_work_stealing_task_pool_set_max_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ * @max_threads: the maximum number of threads
+ *
+ * Set the maximum number of threads @pool may use for its workers, including
+ * the extra workers that are started when all workers are blocked. Jobs that
+ * stay blocked once this is reached are moved out of the pool to threads
+ * that are not counted. Values lower than the number of workers are raised
+ * to it. This has to be called before the pool is prepared.
+ *
+ * The default is 8 times the number of workers.
+ *
+ * Since: 1.30
+ */
+void
+gst_work_stealing_task_pool_set_max_threads (GstWorkStealingTaskPool * pool,
+    guint max_threads)
+{
+  g_return_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool));
+
+  g_mutex_lock (&pool->priv->lock);
+  if (pool->priv->workers == NULL) {
+    GST_OBJECT_LOCK (pool);
+    pool->priv->max_threads = max_threads;
+    GST_OBJECT_UNLOCK (pool);
+  } else {
+    g_warning ("can't change the maximum number of threads of a prepared "
+        "pool");
+  }
+  g_mutex_unlock (&pool->priv->lock);
+}
+
+/**
+ * gst_work_stealing_task_pool_get_max_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ *
+ * Returns: the maximum number of threads @pool may use
+ *
+ * Since: 1.30
+ */
+guint
+gst_work_stealing_task_pool_get_max_threads (GstWorkStealingTaskPool * pool)
+{
+  guint ret;
+
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), 0);
+
+  GST_OBJECT_LOCK (pool);
+  ret = pool->priv->max_threads;
+  GST_OBJECT_UNLOCK (pool);
+
+  return ret;
+}
+
+/**
+ * gst_work_stealing_task_pool_push_blocking:
+ * @pool: a #GstWorkStealingTaskPool
+ * @func: (scope async) (closure user_data): the function to call
+ * @user_data: data to pass to @func
+ * @error: return location for an error
+ *
+ * Runs @func in a thread of its own instead of on one of the workers of
+ * @pool. Use this for jobs that are known to block for a long time, so that
+ * they neither keep a worker from running the other jobs nor have to wait
+ * until the pool notices that they block. The thread is not counted against
+ * the maximum number of threads and gst_task_pool_cleanup() waits for it to
+ * finish.
+ *
+ * Returns: %TRUE if the thread was started
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_work_stealing_task_pool_push_blocking (GstWorkStealingTaskPool * pool,
+    GstTaskPoolFunction func, gpointer user_data, GError ** error)
+{
+  GstWorkStealingTaskPoolPrivate *priv;
+  WorkStealingBlockingJob *job;
+  GThread *thread;
+
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->lock);
+  if (priv->workers == NULL || priv->shutdown) {
+    g_mutex_unlock (&priv->lock);
+    g_set_error_literal (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "No thread pool");
+    return FALSE;
+  }
+
+  job = g_new (WorkStealingBlockingJob, 1);
+  job->pool = gst_object_ref (pool);
+  job->func = func;
+  job->user_data = user_data;
+
+  thread = g_thread_try_new ("gstws-blocking",
+      (GThreadFunc) work_stealing_blocking_func, job, error);
+  if (thread == NULL) {
+    g_mutex_unlock (&priv->lock);
+    gst_object_unref (job->pool);
+    g_free (job);
+    return FALSE;
+  }
+  g_thread_unref (thread);
+  priv->n_blocking++;
+  g_mutex_unlock (&priv->lock);
+
+  return TRUE;
+}
@@ -34,6 +34,8 @@
 #include "gstregistry.h"
 #include "gsttypefindfactory.h"
 
+#include "glib-compat-private.h"
+
 GST_DEBUG_CATEGORY_EXTERN (type_find_debug);
 #define GST_CAT_DEFAULT type_find_debug
 
@@ -64,10 +66,52 @@ gboolean
 gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
     GstTypeFindFunction func, const gchar * extensions,
     GstCaps * possible_caps, gpointer data, GDestroyNotify data_notify)
+{
+  return gst_type_find_register_with_signature (plugin, name, rank, func,
+      extensions, possible_caps, 0, NULL, 0, data, data_notify);
+}
+
+/**
+ * gst_type_find_register_with_signature:
+ * @plugin: (nullable): A #GstPlugin, or %NULL for a static typefind function
+ * @name: The name for registering
+ * @rank: The rank (or importance) of this typefind function
+ * @func: The #GstTypeFindFunction to use
+ * @extensions: (nullable): Optional comma-separated list of extensions
+ *     that could belong to this type
+ * @possible_caps: (nullable): Optionally the caps that could be returned when typefinding
+ *                 succeeds
+ * @offset: offset of @signature in the stream
+ * @signature: (nullable) (array length=signature_size): bytes that must be
+ *     present at @offset for @func to suggest any caps, or %NULL
+ * @signature_size: the size of @signature
+ * @data: Optional user data. This user data must be available until the plugin
+ *        is unloaded.
+ * @data_notify: a #GDestroyNotify that will be called on @data when the plugin
+ *        is unloaded.
+ *
+ * Same as gst_type_find_register() but additionally declares a fixed magic
+ * signature that the stream has to contain at @offset for @func to ever
+ * suggest caps. Typefinding helpers use the signatures to skip typefind
+ * functions that cannot match the data without calling them.
+ *
+ * Only declare a signature if @func never calls gst_type_find_suggest()
+ * when the signature does not match.
+ *
+ * Returns: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_type_find_register_with_signature (GstPlugin * plugin, const gchar * name,
+    guint rank, GstTypeFindFunction func, const gchar * extensions,
+    GstCaps * possible_caps, guint64 offset, const guint8 * signature,
+    guint signature_size, gpointer data, GDestroyNotify data_notify)
 {
   GstTypeFindFactory *factory;
 
   g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (signature == NULL || signature_size > 0, FALSE);
 
   GST_INFO ("registering typefind function for %s", name);
 
@@ -81,9 +125,16 @@ gst_type_find_register (GstPlugin * plugin, const gchar * name, guint rank,
     factory->extensions = g_strsplit (extensions, ",", -1);
 
   gst_caps_replace (&factory->caps, possible_caps);
+  /* only factories loaded from the registry cache parse their caps lazily */
+  factory->caps_string = NULL;
   factory->function = func;
   factory->user_data = data;
   factory->user_data_notify = data_notify;
+  if (signature) {
+    factory->signature = g_memdup2 (signature, signature_size);
+    factory->signature_size = signature_size;
+    factory->signature_offset = offset;
+  }
   if (plugin && plugin->desc.name) {
     GST_PLUGIN_FEATURE_CAST (factory)->plugin_name = plugin->desc.name; /* interned string */
     GST_PLUGIN_FEATURE_CAST (factory)->plugin = plugin;
@@ -216,6 +216,19 @@ gboolean  gst_type_find_register   (GstPlugin            * plugin,
                                     gpointer               data,
                                     GDestroyNotify         data_notify);
 
+GST_API
+gboolean  gst_type_find_register_with_signature (GstPlugin            * plugin,
+                                                 const gchar          * name,
+                                                 guint                  rank,
+                                                 GstTypeFindFunction    func,
+                                                 const gchar          * extensions,
+                                                 GstCaps              * possible_caps,
+                                                 guint64                offset,
+                                                 const guint8         * signature,
+                                                 guint                  signature_size,
+                                                 gpointer               data,
+                                                 GDestroyNotify         data_notify);
+
 G_END_DECLS
 
 #endif /* __GST_TYPE_FIND_H__ */
@@ -128,6 +128,7 @@ gst_type_find_factory_dispose (GObject * object)
     factory->user_data_notify (factory->user_data);
     factory->user_data = NULL;
   }
+  g_clear_pointer (&factory->signature, g_free);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
@@ -164,9 +165,25 @@ gst_type_find_factory_get_list (void)
 GstCaps *
 gst_type_find_factory_get_caps (GstTypeFindFactory * factory)
 {
+  GstCaps *caps;
+
   g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
 
-  return factory->caps;
+  caps = g_atomic_pointer_get (&factory->caps);
+  if (G_LIKELY (caps != NULL) || factory->caps_string == NULL)
+    return caps;
+
+  /* factories loaded from a mapped registry cache parse their caps on first
+   * use */
+  caps = gst_caps_from_string (factory->caps_string);
+  if (caps && !g_atomic_pointer_compare_and_exchange (&factory->caps, NULL,
+          caps)) {
+    /* another thread was faster */
+    gst_caps_unref (caps);
+    caps = g_atomic_pointer_get (&factory->caps);
+  }
+
+  return caps;
 }
 
 /**
@@ -189,6 +206,38 @@ gst_type_find_factory_get_extensions (GstTypeFindFactory * factory)
   return (const gchar * const *) factory->extensions;
 }
 
+/**
+ * gst_type_find_factory_get_signature:
+ * @factory: A #GstTypeFindFactory
+ * @offset: (out) (optional): location to store the offset of the signature
+ * @size: (out) (optional): location to store the size of the signature
+ *
+ * Gets the fixed signature registered with
+ * gst_type_find_register_with_signature() for @factory. The typefind
+ * function of @factory will only suggest caps for streams that contain the
+ * signature at @offset, so callers can skip it for any other data.
+ *
+ * Signatures are only known once the plugin providing @factory is loaded.
+ *
+ * Returns: (transfer none) (nullable) (array length=size): the signature,
+ *     or %NULL if @factory has none.
+ *
+ * Since: 1.30
+ */
+const guint8 *
+gst_type_find_factory_get_signature (GstTypeFindFactory * factory,
+    guint64 * offset, guint * size)
+{
+  g_return_val_if_fail (GST_IS_TYPE_FIND_FACTORY (factory), NULL);
+
+  if (offset)
+    *offset = factory->signature_offset;
+  if (size)
+    *size = factory->signature_size;
+
+  return factory->signature;
+}
+
 /**
  * gst_type_find_factory_call_function:
  * @factory: A #GstTypeFindFactory
@@ -61,6 +61,11 @@ GstCaps *       gst_type_find_factory_get_caps          (GstTypeFindFactory *fac
 GST_API
 gboolean        gst_type_find_factory_has_function      (GstTypeFindFactory *factory);
 
+GST_API
+const guint8 *  gst_type_find_factory_get_signature     (GstTypeFindFactory *factory,
+                                                         guint64            *offset,
+                                                         guint              *size);
+
 GST_API
 void            gst_type_find_factory_call_function     (GstTypeFindFactory *factory,
                                                          GstTypeFind *find);
@@ -625,6 +625,16 @@ gboolean        gst_value_deserialize_with_pspec (GValue               *dest,
                                                  const gchar           *src,
                                                  GParamSpec            *pspec);
 
+GST_API
+gboolean        gst_value_serialize_binary      (const GValue          *value,
+                                                 GByteArray            *out);
+
+GST_API
+gboolean        gst_value_deserialize_binary    (GValue                *dest,
+                                                 const guint8          *data,
+                                                 gsize                  size,
+                                                 gsize                 *consumed);
+
 GST_API
 gboolean        gst_value_hash                  (const GValue * value,
                                                  guint * res);
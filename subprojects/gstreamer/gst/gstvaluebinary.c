@@ -0,0 +1,1304 @@
+/* GStreamer
+ *
+ * gstvaluebinary.c: binary serialization of GValue, GstStructure,
+ *     GstCapsFeatures and GstCaps
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The binary format is meant for exchanging caps, structures and values
+ * between processes running the same or a newer GStreamer version, it is
+ * not meant for storage.
+ *
+ * Every serialized object starts with an 8 byte header:
+ *
+ *   'G' 'B' <version> <kind> <payload length: 32 bit little endian>
+ *
+ * followed by the payload. All integers are little endian, lengths and
+ * counts are encoded as unsigned LEB128 varints and strings as a varint
+ * length followed by the bytes without NUL terminator.
+ *
+ * A value is a tag byte followed by the tag specific data. A structure is its
+ * name followed by the number of fields and name/value pairs. Caps features
+ * are an ANY flag, the number of features and the feature names. Caps are
+ * a flags byte, the number of structures and for each structure an optional
+ * caps features and the structure. Values of types without a dedicated tag
+ * are stored with their type name and their gst_value_serialize() string.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gst_private.h"
+#include "gstcaps.h"
+#include "gstcapsfeatures.h"
+#include "gststructure.h"
+#include "gstutils.h"
+#include "gstvalue.h"
+
+#define BINARY_MAGIC_0 'G'
+#define BINARY_MAGIC_1 'B'
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 8
+
+/* nesting limit for lists, arrays, structures and caps when deserializing */
+#define MAX_DEPTH 64
+
+typedef enum
+{
+  KIND_VALUE = 'V',
+  KIND_STRUCTURE = 'S',
+  KIND_CAPS_FEATURES = 'F',
+  KIND_CAPS = 'C',
+} BinaryKind;
+
+typedef enum
+{
+  TAG_INT = 1,
+  TAG_UINT,
+  TAG_INT64,
+  TAG_UINT64,
+  TAG_BOOLEAN,
+  TAG_FLOAT,
+  TAG_DOUBLE,
+  TAG_STRING,
+  TAG_STRING_NULL,
+  TAG_ENUM,
+  TAG_FLAGS,
+  TAG_FRACTION,
+  TAG_INT_RANGE,
+  TAG_INT64_RANGE,
+  TAG_DOUBLE_RANGE,
+  TAG_FRACTION_RANGE,
+  TAG_LIST,
+  TAG_ARRAY,
+  TAG_UNIQUE_LIST,
+  TAG_BITMASK,
+  TAG_FLAG_SET,
+  TAG_STRUCTURE,
+  TAG_CAPS,
+  TAG_CAPS_FEATURES,
+  TAG_GENERIC,
+} BinaryTag;
+
+#define CAPS_FLAG_ANY (1 << 0)
+
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  gsize pos;
+} BinaryReader;
+
+static gboolean write_value (GByteArray * out, const GValue * value);
+static gboolean write_structure (GByteArray * out,
+    const GstStructure * structure);
+static gboolean read_value (BinaryReader * r, GValue * value, guint depth);
+static GstStructure *read_structure (BinaryReader * r, guint depth);
+
+/* writing */
+
+static inline guint8 *
+write_reserve (GByteArray * out, guint n)
+{
+  guint offset = out->len;
+
+  g_byte_array_set_size (out, offset + n);
+  return out->data + offset;
+}
+
+static inline void
+write_u8 (GByteArray * out, guint8 v)
+{
+  *write_reserve (out, 1) = v;
+}
+
+static inline void
+write_u32 (GByteArray * out, guint32 v)
+{
+  GST_WRITE_UINT32_LE (write_reserve (out, 4), v);
+}
+
+static inline void
+write_u64 (GByteArray * out, guint64 v)
+{
+  GST_WRITE_UINT64_LE (write_reserve (out, 8), v);
+}
+
+static inline void
+write_varint (GByteArray * out, guint64 v)
+{
+  guint8 buf[10];
+  guint n = 0;
+
+  do {
+    buf[n] = v & 0x7f;
+    v >>= 7;
+    if (v)
+      buf[n] |= 0x80;
+    n++;
+  } while (v);
+
+  memcpy (write_reserve (out, n), buf, n);
+}
+
+static inline void
+write_string_len (GByteArray * out, const gchar * str, gsize len)
+{
+  write_varint (out, len);
+  if (len)
+    memcpy (write_reserve (out, len), str, len);
+}
+
+static inline void
+write_string (GByteArray * out, const gchar * str)
+{
+  write_string_len (out, str, strlen (str));
+}
+
+static inline void
+write_double (GByteArray * out, gdouble d)
+{
+  guint64 bits;
+
+  memcpy (&bits, &d, sizeof (bits));
+  write_u64 (out, bits);
+}
+
+static guint
+write_header (GByteArray * out, BinaryKind kind)
+{
+  guint8 *header = write_reserve (out, BINARY_HEADER_SIZE);
+
+  header[0] = BINARY_MAGIC_0;
+  header[1] = BINARY_MAGIC_1;
+  header[2] = BINARY_VERSION;
+  header[3] = kind;
+
+  return out->len;
+}
+
+static gboolean
+finish_header (GByteArray * out, guint start, gboolean ret)
+{
+  gsize len = out->len - start;
+
+  if (!ret || len > G_MAXUINT32) {
+    g_byte_array_set_size (out, start - BINARY_HEADER_SIZE);
+    return FALSE;
+  }
+
+  GST_WRITE_UINT32_LE (out->data + start - 4, (guint32) len);
+  return TRUE;
+}
+
+static void
+write_caps_features (GByteArray * out, const GstCapsFeatures * features)
+{
+  guint i, n;
+
+  if (gst_caps_features_is_any (features)) {
+    write_u8 (out, 1);
+    return;
+  }
+
+  n = gst_caps_features_get_size (features);
+  write_u8 (out, 0);
+  write_varint (out, n);
+  for (i = 0; i < n; i++) {
+    const GstIdStr *feature = gst_caps_features_get_nth_id_str (features, i);
+
+    write_string_len (out, gst_id_str_as_str (feature),
+        gst_id_str_get_len (feature));
+  }
+}
+
+static gboolean
+write_caps (GByteArray * out, const GstCaps * caps)
+{
+  guint i, n;
+
+  write_u8 (out, gst_caps_is_any (caps) ? CAPS_FLAG_ANY : 0);
+
+  n = gst_caps_get_size (caps);
+  write_varint (out, n);
+  for (i = 0; i < n; i++) {
+    GstCapsFeatures *features = gst_caps_get_features (caps, i);
+
+    if (features) {
+      write_u8 (out, 1);
+      write_caps_features (out, features);
+    } else {
+      write_u8 (out, 0);
+    }
+
+    if (!write_structure (out, gst_caps_get_structure (caps, i)))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+write_field (const GstIdStr * fieldname, const GValue * value,
+    gpointer user_data)
+{
+  GByteArray *out = user_data;
+
+  write_string_len (out, gst_id_str_as_str (fieldname),
+      gst_id_str_get_len (fieldname));
+  return write_value (out, value);
+}
+
+static gboolean
+write_structure (GByteArray * out, const GstStructure * structure)
+{
+  const gchar *name = gst_structure_get_name (structure);
+
+  write_string (out, name);
+  write_varint (out, gst_structure_n_fields (structure));
+
+  return gst_structure_foreach_id_str (structure, write_field, out);
+}
+
+static gboolean
+write_value (GByteArray * out, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint i, n;
+
+  switch (type) {
+    case G_TYPE_INT:
+      write_u8 (out, TAG_INT);
+      write_u32 (out, (guint32) g_value_get_int (value));
+      return TRUE;
+    case G_TYPE_UINT:
+      write_u8 (out, TAG_UINT);
+      write_u32 (out, g_value_get_uint (value));
+      return TRUE;
+    case G_TYPE_INT64:
+      write_u8 (out, TAG_INT64);
+      write_u64 (out, (guint64) g_value_get_int64 (value));
+      return TRUE;
+    case G_TYPE_UINT64:
+      write_u8 (out, TAG_UINT64);
+      write_u64 (out, g_value_get_uint64 (value));
+      return TRUE;
+    case G_TYPE_BOOLEAN:
+      write_u8 (out, TAG_BOOLEAN);
+      write_u8 (out, g_value_get_boolean (value) ? 1 : 0);
+      return TRUE;
+    case G_TYPE_FLOAT:{
+      gfloat f = g_value_get_float (value);
+      guint32 bits;
+
+      memcpy (&bits, &f, sizeof (bits));
+      write_u8 (out, TAG_FLOAT);
+      write_u32 (out, bits);
+      return TRUE;
+    }
+    case G_TYPE_DOUBLE:
+      write_u8 (out, TAG_DOUBLE);
+      write_double (out, g_value_get_double (value));
+      return TRUE;
+    case G_TYPE_STRING:{
+      const gchar *str = g_value_get_string (value);
+
+      if (str) {
+        write_u8 (out, TAG_STRING);
+        write_string (out, str);
+      } else {
+        write_u8 (out, TAG_STRING_NULL);
+      }
+      return TRUE;
+    }
+    default:
+      break;
+  }
+
+  if (G_TYPE_FUNDAMENTAL (type) == G_TYPE_ENUM) {
+    write_u8 (out, TAG_ENUM);
+    write_string (out, g_type_name (type));
+    write_u32 (out, (guint32) g_value_get_enum (value));
+  } else if (G_TYPE_FUNDAMENTAL (type) == G_TYPE_FLAGS) {
+    write_u8 (out, TAG_FLAGS);
+    write_string (out, g_type_name (type));
+    write_u32 (out, g_value_get_flags (value));
+  } else if (type == GST_TYPE_FRACTION) {
+    write_u8 (out, TAG_FRACTION);
+    write_u32 (out, (guint32) gst_value_get_fraction_numerator (value));
+    write_u32 (out, (guint32) gst_value_get_fraction_denominator (value));
+  } else if (type == GST_TYPE_INT_RANGE) {
+    write_u8 (out, TAG_INT_RANGE);
+    write_u32 (out, (guint32) gst_value_get_int_range_min (value));
+    write_u32 (out, (guint32) gst_value_get_int_range_max (value));
+    write_u32 (out, (guint32) gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    write_u8 (out, TAG_INT64_RANGE);
+    write_u64 (out, (guint64) gst_value_get_int64_range_min (value));
+    write_u64 (out, (guint64) gst_value_get_int64_range_max (value));
+    write_u64 (out, (guint64) gst_value_get_int64_range_step (value));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    write_u8 (out, TAG_DOUBLE_RANGE);
+    write_double (out, gst_value_get_double_range_min (value));
+    write_double (out, gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    write_u8 (out, TAG_FRACTION_RANGE);
+    write_u32 (out, (guint32) gst_value_get_fraction_numerator (min));
+    write_u32 (out, (guint32) gst_value_get_fraction_denominator (min));
+    write_u32 (out, (guint32) gst_value_get_fraction_numerator (max));
+    write_u32 (out, (guint32) gst_value_get_fraction_denominator (max));
+  } else if (type == GST_TYPE_LIST) {
+    n = gst_value_list_get_size (value);
+    write_u8 (out, TAG_LIST);
+    write_varint (out, n);
+    for (i = 0; i < n; i++) {
+      if (!write_value (out, gst_value_list_get_value (value, i)))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_ARRAY) {
+    n = gst_value_array_get_size (value);
+    write_u8 (out, TAG_ARRAY);
+    write_varint (out, n);
+    for (i = 0; i < n; i++) {
+      if (!write_value (out, gst_value_array_get_value (value, i)))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_UNIQUE_LIST) {
+    n = gst_value_unique_list_get_size (value);
+    write_u8 (out, TAG_UNIQUE_LIST);
+    write_varint (out, n);
+    for (i = 0; i < n; i++) {
+      if (!write_value (out, gst_value_unique_list_get_value (value, i)))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_BITMASK) {
+    write_u8 (out, TAG_BITMASK);
+    write_u64 (out, gst_value_get_bitmask (value));
+  } else if (GST_VALUE_HOLDS_FLAG_SET (value)) {
+    write_u8 (out, TAG_FLAG_SET);
+    write_string (out, g_type_name (type));
+    write_u32 (out, gst_value_get_flagset_flags (value));
+    write_u32 (out, gst_value_get_flagset_mask (value));
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    write_u8 (out, TAG_STRUCTURE);
+    write_u8 (out, s != NULL);
+    if (s && !write_structure (out, s))
+      return FALSE;
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    write_u8 (out, TAG_CAPS);
+    write_u8 (out, caps != NULL);
+    if (caps && !write_caps (out, caps))
+      return FALSE;
+  } else if (type == GST_TYPE_CAPS_FEATURES) {
+    const GstCapsFeatures *features = gst_value_get_caps_features (value);
+
+    write_u8 (out, TAG_CAPS_FEATURES);
+    write_u8 (out, features != NULL);
+    if (features)
+      write_caps_features (out, features);
+  } else {
+    gchar *str = gst_value_serialize (value);
+
+    if (str == NULL) {
+      GST_WARNING ("Can't serialize value of type %s", g_type_name (type));
+      return FALSE;
+    }
+
+    write_u8 (out, TAG_GENERIC);
+    write_string (out, g_type_name (type));
+    write_string (out, str);
+    g_free (str);
+  }
+
+  return TRUE;
+}
+
+/* reading */
+
+static inline gboolean
+read_u8 (BinaryReader * r, guint8 * v)
+{
+  if (r->size - r->pos < 1)
+    return FALSE;
+  *v = r->data[r->pos++];
+  return TRUE;
+}
+
+static inline gboolean
+read_u32 (BinaryReader * r, guint32 * v)
+{
+  if (r->size - r->pos < 4)
+    return FALSE;
+  *v = GST_READ_UINT32_LE (r->data + r->pos);
+  r->pos += 4;
+  return TRUE;
+}
+
+static inline gboolean
+read_u64 (BinaryReader * r, guint64 * v)
+{
+  if (r->size - r->pos < 8)
+    return FALSE;
+  *v = GST_READ_UINT64_LE (r->data + r->pos);
+  r->pos += 8;
+  return TRUE;
+}
+
+static inline gboolean
+read_double (BinaryReader * r, gdouble * d)
+{
+  guint64 bits;
+
+  if (!read_u64 (r, &bits))
+    return FALSE;
+  memcpy (d, &bits, sizeof (bits));
+  return TRUE;
+}
+
+static gboolean
+read_varint (BinaryReader * r, guint64 * v)
+{
+  guint shift = 0;
+  guint8 b;
+
+  *v = 0;
+  do {
+    if (shift > 63 || !read_u8 (r, &b))
+      return FALSE;
+    *v |= ((guint64) (b & 0x7f)) << shift;
+    shift += 7;
+  } while (b & 0x80);
+
+  return TRUE;
+}
+
+/* returns a pointer into the data, the string is not NUL-terminated */
+static gboolean
+read_string (BinaryReader * r, const gchar ** str, gsize * len)
+{
+  guint64 l;
+
+  if (!read_varint (r, &l) || l > r->size - r->pos)
+    return FALSE;
+
+  *str = (const gchar *) r->data + r->pos;
+  *len = l;
+  r->pos += l;
+  return TRUE;
+}
+
+/* reads a count of items that each take at least one byte, which protects
+ * against huge preallocations from corrupted data */
+static gboolean
+read_count (BinaryReader * r, guint * count)
+{
+  guint64 n;
+
+  if (!read_varint (r, &n) || n > r->size - r->pos)
+    return FALSE;
+
+  *count = n;
+  return TRUE;
+}
+
+static GType
+read_type_name (BinaryReader * r)
+{
+  const gchar *str;
+  gchar name[128];
+  gsize len;
+
+  if (!read_string (r, &str, &len) || len == 0 || len >= sizeof (name))
+    return G_TYPE_INVALID;
+
+  memcpy (name, str, len);
+  name[len] = '\0';
+
+  return g_type_from_name (name);
+}
+
+static gboolean
+read_header (BinaryReader * r, BinaryKind kind)
+{
+  guint32 len;
+
+  if (r->size < BINARY_HEADER_SIZE)
+    return FALSE;
+
+  if (r->data[0] != BINARY_MAGIC_0 || r->data[1] != BINARY_MAGIC_1) {
+    GST_WARNING ("Not a binary serialized object");
+    return FALSE;
+  }
+  if (r->data[2] != BINARY_VERSION) {
+    GST_WARNING ("Unsupported binary serialization version %u", r->data[2]);
+    return FALSE;
+  }
+  if (r->data[3] != kind) {
+    GST_WARNING ("Expected binary serialized '%c' but got '%c'", kind,
+        r->data[3]);
+    return FALSE;
+  }
+
+  len = GST_READ_UINT32_LE (r->data + 4);
+  if (len > r->size - BINARY_HEADER_SIZE)
+    return FALSE;
+
+  /* limit the reader to this object */
+  r->pos = BINARY_HEADER_SIZE;
+  r->size = BINARY_HEADER_SIZE + len;
+
+  return TRUE;
+}
+
+static gboolean
+structure_name_is_valid (const gchar * name, gsize len)
+{
+  gsize i;
+
+  if (len == 0 || !g_ascii_isalpha (name[0]))
+    return FALSE;
+
+  for (i = 1; i < len; i++) {
+    if (!g_ascii_isalnum (name[i]) && strchr ("/-_.:+*", name[i]) == NULL)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* same rules as gst_caps_features_add() */
+static gboolean
+feature_name_is_valid (const gchar * name, gsize len)
+{
+  gsize i = 0;
+
+  while (i < len && g_ascii_isalpha (name[i]))
+    i++;
+  if (i == 0 || i + 1 >= len || name[i] != ':'
+      || !g_ascii_isalpha (name[i + 1]))
+    return FALSE;
+
+  for (i += 2; i < len; i++) {
+    if (!g_ascii_isalnum (name[i]))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GstCapsFeatures *
+read_caps_features (BinaryReader * r)
+{
+  GstCapsFeatures *features;
+  guint8 is_any;
+  guint i, n;
+
+  if (!read_u8 (r, &is_any))
+    return NULL;
+
+  if (is_any)
+    return gst_caps_features_new_any ();
+
+  if (!read_count (r, &n))
+    return NULL;
+
+  features = gst_caps_features_new_empty ();
+  for (i = 0; i < n; i++) {
+    GstIdStr feature = GST_ID_STR_INIT;
+    const gchar *str;
+    gsize len;
+
+    if (!read_string (r, &str, &len) || !feature_name_is_valid (str, len)) {
+      gst_caps_features_free (features);
+      return NULL;
+    }
+
+    gst_id_str_set_with_len (&feature, str, len);
+    gst_caps_features_add_id_str (features, &feature);
+    gst_id_str_clear (&feature);
+  }
+
+  return features;
+}
+
+static GstStructure *
+read_structure (BinaryReader * r, guint depth)
+{
+  GstIdStr name = GST_ID_STR_INIT;
+  GstStructure *structure;
+  const gchar *str;
+  gsize len;
+  guint i, n;
+
+  if (!read_string (r, &str, &len) || !structure_name_is_valid (str, len))
+    return NULL;
+
+  if (!read_count (r, &n))
+    return NULL;
+
+  gst_id_str_set_with_len (&name, str, len);
+  structure = gst_structure_new_id_str_empty (&name);
+
+  for (i = 0; i < n; i++) {
+    GValue value = G_VALUE_INIT;
+
+    if (!read_string (r, &str, &len) || len == 0)
+      goto error;
+    gst_id_str_set_with_len (&name, str, len);
+
+    if (!read_value (r, &value, depth + 1))
+      goto error;
+
+    gst_structure_id_str_take_value (structure, &name, &value);
+  }
+
+  gst_id_str_clear (&name);
+  return structure;
+
+error:
+  gst_id_str_clear (&name);
+  gst_structure_free (structure);
+  return NULL;
+}
+
+static GstCaps *
+read_caps (BinaryReader * r, guint depth)
+{
+  GstCaps *caps;
+  guint8 flags;
+  guint i, n;
+
+  if (!read_u8 (r, &flags) || !read_count (r, &n))
+    return NULL;
+
+  if (flags & CAPS_FLAG_ANY)
+    caps = gst_caps_new_any ();
+  else
+    caps = gst_caps_new_empty ();
+
+  for (i = 0; i < n; i++) {
+    GstCapsFeatures *features = NULL;
+    GstStructure *structure;
+    guint8 has_features;
+
+    if (!read_u8 (r, &has_features))
+      goto error;
+
+    if (has_features && !(features = read_caps_features (r)))
+      goto error;
+
+    if (!(structure = read_structure (r, depth + 1))) {
+      if (features)
+        gst_caps_features_free (features);
+      goto error;
+    }
+
+    gst_caps_append_structure_full (caps, structure, features);
+  }
+
+  return caps;
+
+error:
+  gst_caps_unref (caps);
+  return NULL;
+}
+
+/* same rules as gst_value_set_fraction() */
+static gboolean
+read_fraction (BinaryReader * r, gint * num, gint * denom)
+{
+  guint32 n, d;
+
+  if (!read_u32 (r, &n) || !read_u32 (r, &d) || d == 0
+      || (gint) n == G_MININT || (gint) d == G_MININT)
+    return FALSE;
+
+  *num = (gint) n;
+  *denom = (gint) d;
+  return TRUE;
+}
+
+/* only types that a GValue can be initialized with */
+static gboolean
+type_is_value_type (GType type)
+{
+  return type != G_TYPE_INVALID && G_TYPE_IS_VALUE_TYPE (type)
+      && !G_TYPE_IS_ABSTRACT (type) && !G_TYPE_IS_INTERFACE (type);
+}
+
+/* the type of the innermost first item of lists and arrays */
+static gboolean
+value_get_basic_type (const GValue * value, GType * type)
+{
+  if (GST_VALUE_HOLDS_LIST (value) || GST_VALUE_HOLDS_UNIQUE_LIST (value)) {
+    if (gst_value_list_get_size (value) == 0)
+      return FALSE;
+    return value_get_basic_type (gst_value_list_get_value (value, 0), type);
+  }
+  if (GST_VALUE_HOLDS_ARRAY (value)) {
+    if (gst_value_array_get_size (value) == 0)
+      return FALSE;
+    return value_get_basic_type (gst_value_array_get_value (value, 0), type);
+  }
+
+  *type = G_VALUE_TYPE (value);
+  return TRUE;
+}
+
+#define IS_RANGE_COMPAT(type1,type2,t1,t2) \
+  (((t1) == (type1) && (t2) == (type2)) || ((t2) == (type1) && (t1) == (type2)))
+
+/* same rules as gst_value_list_append_and_take_value(), lists and arrays
+ * can only hold one type and its range type */
+static gboolean
+value_can_append (const GValue * list, const GValue * item)
+{
+  GType t1, t2;
+
+  if (!value_get_basic_type (list, &t1) || !value_get_basic_type (item, &t2)
+      || t1 == t2)
+    return TRUE;
+
+  return IS_RANGE_COMPAT (G_TYPE_INT, GST_TYPE_INT_RANGE, t1, t2)
+      || IS_RANGE_COMPAT (G_TYPE_INT64, GST_TYPE_INT64_RANGE, t1, t2)
+      || IS_RANGE_COMPAT (G_TYPE_DOUBLE, GST_TYPE_DOUBLE_RANGE, t1, t2)
+      || IS_RANGE_COMPAT (GST_TYPE_FRACTION, GST_TYPE_FRACTION_RANGE, t1, t2);
+}
+
+/* the values are checked before setting them, so that corrupted data does
+ * not trigger the precondition checks of the setters */
+static gboolean
+read_value (BinaryReader * r, GValue * value, guint depth)
+{
+  guint8 tag;
+  guint32 u32, u32b, u32c;
+  guint64 u64, u64b, u64c;
+  gdouble d1, d2;
+  GType type;
+  guint i, n;
+
+  if (depth > MAX_DEPTH || !read_u8 (r, &tag))
+    return FALSE;
+
+  switch (tag) {
+    case TAG_INT:
+      if (!read_u32 (r, &u32))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, (gint32) u32);
+      break;
+    case TAG_UINT:
+      if (!read_u32 (r, &u32))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT);
+      g_value_set_uint (value, u32);
+      break;
+    case TAG_INT64:
+      if (!read_u64 (r, &u64))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT64);
+      g_value_set_int64 (value, (gint64) u64);
+      break;
+    case TAG_UINT64:
+      if (!read_u64 (r, &u64))
+        return FALSE;
+      g_value_init (value, G_TYPE_UINT64);
+      g_value_set_uint64 (value, u64);
+      break;
+    case TAG_BOOLEAN:{
+      guint8 b;
+
+      if (!read_u8 (r, &b))
+        return FALSE;
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, b != 0);
+      break;
+    }
+    case TAG_FLOAT:{
+      gfloat f;
+
+      if (!read_u32 (r, &u32))
+        return FALSE;
+      memcpy (&f, &u32, sizeof (f));
+      g_value_init (value, G_TYPE_FLOAT);
+      g_value_set_float (value, f);
+      break;
+    }
+    case TAG_DOUBLE:
+      if (!read_double (r, &d1))
+        return FALSE;
+      g_value_init (value, G_TYPE_DOUBLE);
+      g_value_set_double (value, d1);
+      break;
+    case TAG_STRING:{
+      const gchar *str;
+      gsize len;
+
+      if (!read_string (r, &str, &len))
+        return FALSE;
+      g_value_init (value, G_TYPE_STRING);
+      g_value_take_string (value, g_strndup (str, len));
+      break;
+    }
+    case TAG_STRING_NULL:
+      g_value_init (value, G_TYPE_STRING);
+      break;
+    case TAG_ENUM:
+      type = read_type_name (r);
+      if (!G_TYPE_IS_ENUM (type) || !type_is_value_type (type)
+          || !read_u32 (r, &u32))
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_enum (value, (gint) u32);
+      break;
+    case TAG_FLAGS:
+      type = read_type_name (r);
+      if (!G_TYPE_IS_FLAGS (type) || !type_is_value_type (type)
+          || !read_u32 (r, &u32))
+        return FALSE;
+      g_value_init (value, type);
+      g_value_set_flags (value, u32);
+      break;
+    case TAG_FRACTION:{
+      gint num, denom;
+
+      if (!read_fraction (r, &num, &denom))
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION);
+      gst_value_set_fraction (value, num, denom);
+      break;
+    }
+    case TAG_INT_RANGE:
+      if (!read_u32 (r, &u32) || !read_u32 (r, &u32b) || !read_u32 (r, &u32c))
+        return FALSE;
+      if ((gint) u32 >= (gint) u32b || (gint) u32c <= 0
+          || (gint) u32 % (gint) u32c != 0 || (gint) u32b % (gint) u32c != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (value, (gint) u32, (gint) u32b,
+          (gint) u32c);
+      break;
+    case TAG_INT64_RANGE:
+      if (!read_u64 (r, &u64) || !read_u64 (r, &u64b) || !read_u64 (r, &u64c))
+        return FALSE;
+      if ((gint64) u64 >= (gint64) u64b || (gint64) u64c <= 0
+          || (gint64) u64 % (gint64) u64c != 0
+          || (gint64) u64b % (gint64) u64c != 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT64_RANGE);
+      gst_value_set_int64_range_step (value, (gint64) u64, (gint64) u64b,
+          (gint64) u64c);
+      break;
+    case TAG_DOUBLE_RANGE:
+      if (!read_double (r, &d1) || !read_double (r, &d2) || !(d1 < d2))
+        return FALSE;
+      g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (value, d1, d2);
+      break;
+    case TAG_FRACTION_RANGE:{
+      gint n1, d1_, n2, d2_;
+
+      if (!read_fraction (r, &n1, &d1_) || !read_fraction (r, &n2, &d2_)
+          || gst_util_fraction_compare (n1, d1_, n2, d2_) >= 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION_RANGE);
+      gst_value_set_fraction_range_full (value, n1, d1_, n2, d2_);
+      break;
+    }
+    case TAG_LIST:
+    case TAG_ARRAY:
+    case TAG_UNIQUE_LIST:
+      if (!read_count (r, &n))
+        return FALSE;
+      if (tag == TAG_LIST)
+        gst_value_list_init (value, n);
+      else if (tag == TAG_ARRAY)
+        gst_value_array_init (value, n);
+      else
+        g_value_init (value, GST_TYPE_UNIQUE_LIST);
+
+      for (i = 0; i < n; i++) {
+        GValue item = G_VALUE_INIT;
+
+        if (!read_value (r, &item, depth + 1)) {
+          g_value_unset (value);
+          return FALSE;
+        }
+        if (!value_can_append (value, &item)) {
+          g_value_unset (&item);
+          g_value_unset (value);
+          return FALSE;
+        }
+
+        if (tag == TAG_LIST)
+          gst_value_list_append_and_take_value (value, &item);
+        else if (tag == TAG_ARRAY)
+          gst_value_array_append_and_take_value (value, &item);
+        else
+          gst_value_unique_list_append_and_take_value (value, &item);
+      }
+      break;
+    case TAG_BITMASK:
+      if (!read_u64 (r, &u64))
+        return FALSE;
+      g_value_init (value, GST_TYPE_BITMASK);
+      gst_value_set_bitmask (value, u64);
+      break;
+    case TAG_FLAG_SET:
+      type = read_type_name (r);
+      if (!type_is_value_type (type) || !g_type_is_a (type, GST_TYPE_FLAG_SET)
+          || !read_u32 (r, &u32) || !read_u32 (r, &u32b))
+        return FALSE;
+      g_value_init (value, type);
+      gst_value_set_flagset (value, u32, u32b);
+      break;
+    case TAG_STRUCTURE:{
+      GstStructure *s = NULL;
+      guint8 present;
+
+      if (!read_u8 (r, &present))
+        return FALSE;
+      if (present && !(s = read_structure (r, depth + 1)))
+        return FALSE;
+      g_value_init (value, GST_TYPE_STRUCTURE);
+      g_value_take_boxed (value, s);
+      break;
+    }
+    case TAG_CAPS:{
+      GstCaps *caps = NULL;
+      guint8 present;
+
+      if (!read_u8 (r, &present))
+        return FALSE;
+      if (present && !(caps = read_caps (r, depth + 1)))
+        return FALSE;
+      g_value_init (value, GST_TYPE_CAPS);
+      g_value_take_boxed (value, caps);
+      break;
+    }
+    case TAG_CAPS_FEATURES:{
+      GstCapsFeatures *features = NULL;
+      guint8 present;
+
+      if (!read_u8 (r, &present))
+        return FALSE;
+      if (present && !(features = read_caps_features (r)))
+        return FALSE;
+      g_value_init (value, GST_TYPE_CAPS_FEATURES);
+      g_value_take_boxed (value, features);
+      break;
+    }
+    case TAG_GENERIC:{
+      const gchar *str;
+      gchar *tmp;
+      gsize len;
+      gboolean ret;
+
+      type = read_type_name (r);
+      if (!type_is_value_type (type) || !read_string (r, &str, &len))
+        return FALSE;
+
+      tmp = g_strndup (str, len);
+      g_value_init (value, type);
+      ret = gst_value_deserialize (value, tmp);
+      g_free (tmp);
+      if (!ret) {
+        g_value_unset (value);
+        return FALSE;
+      }
+      break;
+    }
+    default:
+      GST_WARNING ("Unknown binary value tag %u", tag);
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+reader_finish (BinaryReader * r, gsize * consumed)
+{
+  if (r->pos != r->size)
+    return FALSE;
+
+  if (consumed)
+    *consumed = r->size;
+
+  return TRUE;
+}
+
+/**
+ * gst_value_serialize_binary:
+ * @value: a #GValue to serialize
+ * @out: a #GByteArray to append the serialized value to
+ *
+ * Appends a compact, versioned binary representation of @value to @out. The
+ * result can be converted back with gst_value_deserialize_binary(), also in
+ * another process with the same or a newer GStreamer version.
+ *
+ * All basic types, enums, flags and the GStreamer fundamental value types
+ * including lists, arrays, ranges, fractions, structures and caps are
+ * supported. Other types are serialized with gst_value_serialize().
+ *
+ * Returns: %TRUE on success, %FALSE if @value can't be serialized, in which
+ *   case @out is left unchanged.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_value_serialize_binary (const GValue * value, GByteArray * out)
+{
+  guint start;
+
+  g_return_val_if_fail (G_IS_VALUE (value), FALSE);
+  g_return_val_if_fail (out != NULL, FALSE);
+
+  start = write_header (out, KIND_VALUE);
+  return finish_header (out, start, write_value (out, value));
+}
+
+/**
+ * gst_value_deserialize_binary:
+ * @dest: (out caller-allocates): an uninitialized #GValue
+ * @data: (array length=size): data created by gst_value_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (optional): the number of bytes used from @data
+ *
+ * Initializes @dest with the value serialized in @data. @data may contain
+ * more data after the serialized value, the size of the serialized value
+ * is returned in @consumed.
+ *
+ * Returns: %TRUE on success, %FALSE if @data does not contain a valid
+ *   serialized value, in which case @dest is left uninitialized.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_value_deserialize_binary (GValue * dest, const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  BinaryReader r = { data, size, 0 };
+
+  g_return_val_if_fail (dest != NULL, FALSE);
+  g_return_val_if_fail (G_VALUE_TYPE (dest) == G_TYPE_INVALID, FALSE);
+  g_return_val_if_fail (data != NULL || size == 0, FALSE);
+
+  if (!read_header (&r, KIND_VALUE) || !read_value (&r, dest, 0))
+    return FALSE;
+
+  if (!reader_finish (&r, consumed)) {
+    g_value_unset (dest);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_structure_serialize_binary:
+ * @structure: a #GstStructure
+ * @out: a #GByteArray to append the serialized structure to
+ *
+ * Appends a compact, versioned binary representation of @structure to @out.
+ * This is considerably faster than gst_structure_serialize_full() and
+ * gst_structure_from_string() and does not need intermediate strings for
+ * the common field types. See gst_value_serialize_binary() for the
+ * supported field types.
+ *
+ * Returns: %TRUE on success, %FALSE if a field can't be serialized, in which
+ *   case @out is left unchanged.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_structure_serialize_binary (const GstStructure * structure,
+    GByteArray * out)
+{
+  guint start;
+
+  g_return_val_if_fail (structure != NULL, FALSE);
+  g_return_val_if_fail (out != NULL, FALSE);
+
+  start = write_header (out, KIND_STRUCTURE);
+  return finish_header (out, start, write_structure (out, structure));
+}
+
+/**
+ * gst_structure_deserialize_binary:
+ * @data: (array length=size): data created by
+ *   gst_structure_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (optional): the number of bytes used from @data
+ *
+ * Creates a #GstStructure from its binary representation in @data.
+ *
+ * Returns: (transfer full) (nullable): a new #GstStructure or %NULL if @data
+ *   does not contain a valid serialized structure.
+ *
+ * Since: 1.30
+ */
+GstStructure *
+gst_structure_deserialize_binary (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  BinaryReader r = { data, size, 0 };
+  GstStructure *structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!read_header (&r, KIND_STRUCTURE))
+    return NULL;
+
+  structure = read_structure (&r, 0);
+  if (structure && !reader_finish (&r, consumed)) {
+    gst_structure_free (structure);
+    structure = NULL;
+  }
+
+  return structure;
+}
+
+/**
+ * gst_caps_features_serialize_binary:
+ * @features: a #GstCapsFeatures
+ * @out: a #GByteArray to append the serialized caps features to
+ *
+ * Appends a compact, versioned binary representation of @features to @out.
+ *
+ * Returns: %TRUE on success.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_caps_features_serialize_binary (const GstCapsFeatures * features,
+    GByteArray * out)
+{
+  guint start;
+
+  g_return_val_if_fail (features != NULL, FALSE);
+  g_return_val_if_fail (out != NULL, FALSE);
+
+  start = write_header (out, KIND_CAPS_FEATURES);
+  write_caps_features (out, features);
+  return finish_header (out, start, TRUE);
+}
+
+/**
+ * gst_caps_features_deserialize_binary:
+ * @data: (array length=size): data created by
+ *   gst_caps_features_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (optional): the number of bytes used from @data
+ *
+ * Creates a #GstCapsFeatures from its binary representation in @data.
+ *
+ * Returns: (transfer full) (nullable): a new #GstCapsFeatures or %NULL if
+ *   @data does not contain valid serialized caps features.
+ *
+ * Since: 1.30
+ */
+GstCapsFeatures *
+gst_caps_features_deserialize_binary (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  BinaryReader r = { data, size, 0 };
+  GstCapsFeatures *features;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!read_header (&r, KIND_CAPS_FEATURES))
+    return NULL;
+
+  features = read_caps_features (&r);
+  if (features && !reader_finish (&r, consumed)) {
+    gst_caps_features_free (features);
+    features = NULL;
+  }
+
+  return features;
+}
+
+/**
+ * gst_caps_serialize_binary:
+ * @caps: a #GstCaps
+ * @out: a #GByteArray to append the serialized caps to
+ *
+ * Appends a compact, versioned binary representation of @caps to @out. This
+ * is considerably faster than gst_caps_serialize() and gst_caps_from_string()
+ * and meant for passing caps between processes. See
+ * gst_value_serialize_binary() for the supported field types.
+ *
+ * Returns: %TRUE on success, %FALSE if a field can't be serialized, in which
+ *   case @out is left unchanged.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_caps_serialize_binary (const GstCaps * caps, GByteArray * out)
+{
+  guint start;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), FALSE);
+  g_return_val_if_fail (out != NULL, FALSE);
+
+  start = write_header (out, KIND_CAPS);
+  return finish_header (out, start, write_caps (out, caps));
+}
+
+/**
+ * gst_caps_deserialize_binary:
+ * @data: (array length=size): data created by gst_caps_serialize_binary()
+ * @size: the size of @data
+ * @consumed: (out) (optional): the number of bytes used from @data
+ *
+ * Creates a #GstCaps from its binary representation in @data.
+ *
+ * Returns: (transfer full) (nullable): a new #GstCaps or %NULL if @data does
+ *   not contain valid serialized caps.
+ *
+ * Since: 1.30
+ */
+GstCaps *
+gst_caps_deserialize_binary (const guint8 * data, gsize size, gsize * consumed)
+{
+  BinaryReader r = { data, size, 0 };
+  GstCaps *caps;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!read_header (&r, KIND_CAPS))
+    return NULL;
+
+  caps = read_caps (&r, 0);
+  if (caps && !reader_finish (&r, consumed)) {
+    gst_caps_unref (caps);
+    caps = NULL;
+  }
+
+  return caps;
+}
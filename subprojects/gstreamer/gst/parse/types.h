@@ -40,6 +40,54 @@ typedef struct {
 } reason_receiver_t;
 
 
+/* A parsed and resolved pipeline description, see GstParseTemplate */
+typedef enum {
+  TEMPLATE_NODE_ELEMENT,
+  TEMPLATE_NODE_BIN,
+  TEMPLATE_NODE_URI
+} template_node_type_t;
+
+typedef struct {
+  gchar *name;
+  GParamSpec *pspec;
+  /* deserialized value, unset for object properties which need a new object
+   * for every instance and are deserialized from value_str instead */
+  GValue value;
+  gchar *value_str;
+} template_param_t;
+
+typedef struct {
+  template_node_type_t type;
+  GstElementFactory *factory;   /* loaded */
+
+  /* TEMPLATE_NODE_ELEMENT */
+  guint n_params;
+  template_param_t *params;
+  GSList *proxied;              /* childproxy "name=value" assignments */
+  GSList *presets;
+  /* TEMPLATE_NODE_BIN */
+  GSList *assignments;
+  GArray *children;             /* indices of the child nodes */
+  /* TEMPLATE_NODE_URI */
+  gchar *uri;
+} template_node_t;
+
+typedef struct {
+  gint src;
+  gint sink;
+  GSList *src_pads;
+  GSList *sink_pads;
+  GstCaps *caps;
+  gboolean all_pads;
+} template_link_t;
+
+struct _GstParseTemplate {
+  GstParseFlags flags;
+  GPtrArray *nodes;             /* template_node_t in creation order, the
+                                 * toplevel element is the last one */
+  GArray *links;                /* template_link_t */
+};
+
 typedef struct _graph_t graph_t;
 struct _graph_t {
   chain_t *chain; /* links are supposed to be done now */
@@ -48,6 +96,10 @@ struct _graph_t {
   reason_receiver_t *error_probable_reason_receiver;
   GstParseContext *ctx; /* may be NULL */
   GstParseFlags flags;
+  /* when compiling a template, the nodes are recorded here and the created
+   * elements map to their node index + 1 */
+  GstParseTemplate *tmpl;
+  GHashTable *tmpl_elements;
 };
 
 
@@ -129,4 +181,13 @@ G_GNUC_INTERNAL GstElement *priv_gst_parse_launch (const gchar      * str,
                                                    GstParseContext  * ctx,
                                                    GstParseFlags      flags);
 
+G_GNUC_INTERNAL gboolean priv_gst_parse_template_compile (GstParseTemplate * tmpl,
+                                                          const gchar      * str,
+                                                          GError          ** err);
+
+G_GNUC_INTERNAL GstElement *priv_gst_parse_template_instantiate (GstParseTemplate * tmpl,
+                                                                 GError          ** err);
+
+G_GNUC_INTERNAL void priv_gst_parse_template_clear (GstParseTemplate * tmpl);
+
 #endif /* __GST_PARSE_TYPES_H__ */
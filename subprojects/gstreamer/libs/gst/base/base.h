@@ -34,6 +34,7 @@
 #include <gst/base/gstbitwriter.h>
 #include <gst/base/gstbytereader.h>
 #include <gst/base/gstbytewriter.h>
+#include <gst/base/gstchunkreader.h>
 #include <gst/base/gstcollectpads.h>
 #include <gst/base/gstdataqueue.h>
 #include <gst/base/gstflowcombiner.h>
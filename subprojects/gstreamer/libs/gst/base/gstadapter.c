@@ -105,6 +105,11 @@
  * gst_adapter_offset_at_discont(). The number of bytes that were consumed
  * since then can be queried with gst_adapter_distance_from_discont().
  *
+ * Elements that only need to scan the data, e.g. to look for a sync word,
+ * can use gst_adapter_map_chunks() instead of gst_adapter_map(). It maps the
+ * requested range piecewise without ever copying it, and the resulting list
+ * of #GstByteChunk can be read with a #GstChunkByteReader.
+ *
  * A last thing to note is that while #GstAdapter is pretty optimized,
  * merging buffers still might be an operation that requires a `malloc()` and
  * `memcpy()` operation, and these operations are not the fastest. Because of
@@ -170,6 +175,9 @@ struct _GstAdapter
   guint64 distance_from_discont;
 
   GstMapInfo info;
+
+  /* memories mapped by gst_adapter_map_chunks() */
+  GstChunkMap chunk_map;
 };
 
 struct _GstAdapterClass
@@ -210,6 +218,7 @@ gst_adapter_init (GstAdapter * adapter)
   adapter->offset_at_discont = GST_BUFFER_OFFSET_NONE;
   adapter->distance_from_discont = 0;
   adapter->bufqueue = gst_vec_deque_new (10);
+  gst_chunk_map_init (&adapter->chunk_map);
 }
 
 static void
@@ -228,6 +237,7 @@ gst_adapter_finalize (GObject * object)
   GstAdapter *adapter = GST_ADAPTER (object);
 
   g_free (adapter->assembled_data);
+  gst_chunk_map_clear (&adapter->chunk_map);
 
   gst_vec_deque_free (adapter->bufqueue);
 
@@ -261,6 +271,7 @@ gst_adapter_clear (GstAdapter * adapter)
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  gst_chunk_map_unmap (&adapter->chunk_map);
 
   while ((obj = gst_vec_deque_pop_head (adapter->bufqueue)))
     gst_mini_object_unref (obj);
@@ -575,6 +586,92 @@ gst_adapter_unmap (GstAdapter * adapter)
   }
 }
 
+/**
+ * gst_adapter_map_chunks:
+ * @adapter: a #GstAdapter
+ * @offset: the bytes offset in the adapter to start from
+ * @size: the number of bytes to map
+ * @n_chunks: (out): the number of returned chunks
+ *
+ * Maps @size bytes of the @adapter starting at @offset without merging
+ * them. Unlike gst_adapter_map(), which has to copy the data into a scratch
+ * buffer whenever the range spans several buffers, this returns one
+ * #GstByteChunk per mapped #GstMemory. Use a #GstChunkByteReader or a
+ * #GstChunkBitReader to read from them across chunk boundaries.
+ *
+ * The returned chunks are valid until gst_adapter_unmap_chunks() is called,
+ * data is flushed from the @adapter or the @adapter is cleared.
+ *
+ * Returns %NULL if @offset + @size bytes are not available.
+ *
+ * Returns: (transfer none) (array length=n_chunks) (nullable): the mapped
+ *     chunks, or %NULL
+ *
+ * Since: 1.30
+ */
+const GstByteChunk *
+gst_adapter_map_chunks (GstAdapter * adapter, gsize offset, gsize size,
+    guint * n_chunks)
+{
+  gsize skip;
+  guint idx, len;
+
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
+  g_return_val_if_fail (size > 0, NULL);
+  g_return_val_if_fail (n_chunks != NULL, NULL);
+
+  gst_chunk_map_unmap (&adapter->chunk_map);
+  *n_chunks = 0;
+
+  if (G_UNLIKELY (offset + size > adapter->size))
+    return NULL;
+
+  skip = adapter->skip + offset;
+  len = gst_vec_deque_get_length (adapter->bufqueue);
+
+  for (idx = 0; idx < len && size > 0; idx++) {
+    GstBuffer *cur = gst_vec_deque_peek_nth (adapter->bufqueue, idx);
+    gsize bsize = gst_buffer_get_size (cur);
+    gsize tomap;
+
+    if (skip >= bsize) {
+      skip -= bsize;
+      continue;
+    }
+
+    tomap = MIN (bsize - skip, size);
+    if (!gst_chunk_map_add_buffer (&adapter->chunk_map, cur, skip, tomap)) {
+      GST_WARNING_OBJECT (adapter, "failed to map buffer %p", cur);
+      gst_chunk_map_unmap (&adapter->chunk_map);
+      return NULL;
+    }
+    skip = 0;
+    size -= tomap;
+  }
+
+  GST_LOG_OBJECT (adapter, "mapped %" G_GSIZE_FORMAT " bytes in %u chunks",
+      adapter->chunk_map.size, adapter->chunk_map.n_chunks);
+
+  *n_chunks = adapter->chunk_map.n_chunks;
+  return adapter->chunk_map.chunks;
+}
+
+/**
+ * gst_adapter_unmap_chunks:
+ * @adapter: a #GstAdapter
+ *
+ * Releases the memory obtained with the last gst_adapter_map_chunks().
+ *
+ * Since: 1.30
+ */
+void
+gst_adapter_unmap_chunks (GstAdapter * adapter)
+{
+  g_return_if_fail (GST_IS_ADAPTER (adapter));
+
+  gst_chunk_map_unmap (&adapter->chunk_map);
+}
+
 /**
  * gst_adapter_copy: (skip)
  * @adapter: a #GstAdapter
@@ -635,6 +732,7 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  gst_chunk_map_unmap (&adapter->chunk_map);
 
   /* clear state */
   adapter->size -= flush;
@@ -23,6 +23,7 @@
 #define __GST_ADAPTER_H__
 
 #include <gst/base/base-prelude.h>
+#include <gst/base/gstchunkreader.h>
 
 G_BEGIN_DECLS
 
@@ -66,6 +67,12 @@ gconstpointer           gst_adapter_map                 (GstAdapter *adapter, gs
 GST_BASE_API
 void                    gst_adapter_unmap               (GstAdapter *adapter);
 
+GST_BASE_API
+const GstByteChunk *    gst_adapter_map_chunks          (GstAdapter *adapter, gsize offset,
+                                                         gsize size, guint *n_chunks);
+GST_BASE_API
+void                    gst_adapter_unmap_chunks        (GstAdapter *adapter);
+
 GST_BASE_API
 void                    gst_adapter_copy                (GstAdapter *adapter, gpointer dest,
                                                          gsize offset, gsize size);
@@ -224,6 +224,7 @@ struct _GstBaseParsePrivate
   gboolean passthrough;
   gboolean pts_interpolate;
   gboolean infer_ts;
+  gboolean scatter_gather;
   gboolean syncable;
   gboolean has_timing_info;
   guint fps_num, fps_den;
@@ -891,6 +892,7 @@ gst_base_parse_reset (GstBaseParse * parse)
   parse->priv->passthrough = FALSE;
   parse->priv->pts_interpolate = TRUE;
   parse->priv->infer_ts = TRUE;
+  parse->priv->scatter_gather = FALSE;
   parse->priv->has_timing_info = FALSE;
   parse->priv->min_bitrate = G_MAXUINT;
   parse->priv->max_bitrate = 0;
@@ -3366,8 +3368,12 @@ gst_base_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       parse->priv->prev_dts_from_pts = TRUE;
     }
 
-    /* always pass all available data */
-    tmpbuf = gst_adapter_get_buffer (parse->priv->adapter, av);
+    /* always pass all available data, without merging it if the subclass
+     * can deal with multiple memories */
+    if (parse->priv->scatter_gather)
+      tmpbuf = gst_adapter_get_buffer_fast (parse->priv->adapter, av);
+    else
+      tmpbuf = gst_adapter_get_buffer (parse->priv->adapter, av);
 
     /* already inform subclass what timestamps we have planned,
      * at least if provided by time-based upstream */
@@ -4155,6 +4161,30 @@ gst_base_parse_set_infer_ts (GstBaseParse * parse, gboolean infer_ts)
   GST_INFO_OBJECT (parse, "TS inferring: %s", (infer_ts) ? "yes" : "no");
 }
 
+/**
+ * gst_base_parse_set_scatter_gather:
+ * @parse: a #GstBaseParse
+ * @scatter_gather: %TRUE if the subclass can handle input buffers made of
+ *     several memories
+ *
+ * By default, the base class merges the data it collected in push mode into
+ * a single memory before passing it to #GstBaseParseClass::handle_frame,
+ * which means copying it whenever it spans several upstream buffers.
+ * Sub-classes that read the frame with a #GstChunkMap, or that otherwise
+ * never map the whole input buffer at once, can enable scatter-gather to
+ * receive buffers that reference the upstream memories instead.
+ *
+ * Since: 1.30
+ */
+void
+gst_base_parse_set_scatter_gather (GstBaseParse * parse,
+    gboolean scatter_gather)
+{
+  parse->priv->scatter_gather = scatter_gather;
+  GST_INFO_OBJECT (parse, "scatter-gather: %s",
+      (scatter_gather) ? "yes" : "no");
+}
+
 /**
  * gst_base_parse_set_latency:
  * @parse: a #GstBaseParse
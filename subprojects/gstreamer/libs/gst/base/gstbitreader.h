@@ -145,6 +145,12 @@ gst_bit_reader_peek_bits_uint##bits##_unchecked (const GstBitReader *reader, gui
   byte = reader->byte; \
   bit = reader->bit; \
   \
+  /* load a whole word when it is within the data and holds all the bits */ \
+  if (nbits > 0 && nbits <= 64 - 7 && reader->size >= 8 && \
+      byte <= reader->size - 8) \
+    return (guint##bits) ((GST_READ_UINT64_BE (data + byte) << bit) >> \
+        (64 - nbits)); \
+  \
   while (nbits > 0) { \
     guint toread = MIN (nbits, 8 - bit); \
     \
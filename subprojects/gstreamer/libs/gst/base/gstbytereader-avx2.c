@@ -0,0 +1,62 @@
+/* GStreamer byte reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbytereader-simd.h"
+
+#include <immintrin.h>
+
+gint
+_gst_byte_reader_scan_for_start_code_avx2 (const guint8 * data, guint size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i one = _mm256_set1_epi8 (1);
+  guint i = 0;
+
+  /* same as the SSE2 version, with 32 start positions per iteration */
+  while (size >= 35 && i <= size - 35) {
+    __m256i b0 = _mm256_loadu_si256 ((const __m256i *) (data + i));
+    __m256i b1 = _mm256_loadu_si256 ((const __m256i *) (data + i + 1));
+    __m256i b2 = _mm256_loadu_si256 ((const __m256i *) (data + i + 2));
+    __m256i m;
+    guint32 mask;
+
+    m = _mm256_and_si256 (_mm256_cmpeq_epi8 (b0, zero),
+        _mm256_cmpeq_epi8 (b1, zero));
+    m = _mm256_and_si256 (m, _mm256_cmpeq_epi8 (b2, one));
+    mask = (guint32) _mm256_movemask_epi8 (m);
+    if (G_UNLIKELY (mask)) {
+      /* avoid AVX-SSE transition penalties in the caller */
+      _mm256_zeroupper ();
+      return i + g_bit_nth_lsf (mask, -1);
+    }
+
+    i += 32;
+  }
+  _mm256_zeroupper ();
+
+  for (; i + 4 <= size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+
+  return -1;
+}
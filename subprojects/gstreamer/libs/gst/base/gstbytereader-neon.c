@@ -0,0 +1,59 @@
+/* GStreamer byte reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbytereader-simd.h"
+
+#include <arm_neon.h>
+
+gint
+_gst_byte_reader_scan_for_start_code_neon (const guint8 * data, guint size)
+{
+  const uint8x16_t one = vdupq_n_u8 (1);
+  guint i = 0, k;
+
+  /* see the SSE2 version for the bounds */
+  while (size >= 19 && i <= size - 19) {
+    uint8x16_t b0 = vld1q_u8 (data + i);
+    uint8x16_t b1 = vld1q_u8 (data + i + 1);
+    uint8x16_t b2 = vld1q_u8 (data + i + 2);
+    uint8x16_t m;
+
+    m = vandq_u8 (vceqzq_u8 (b0), vceqzq_u8 (b1));
+    m = vandq_u8 (m, vceqq_u8 (b2, one));
+    if (G_UNLIKELY (vmaxvq_u8 (m))) {
+      /* there is no movemask, find the match among the 16 positions */
+      for (k = i; k < i + 16; k++) {
+        if (data[k] == 0 && data[k + 1] == 0 && data[k + 2] == 1)
+          return k;
+      }
+    }
+
+    i += 16;
+  }
+
+  for (; i + 4 <= size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+
+  return -1;
+}
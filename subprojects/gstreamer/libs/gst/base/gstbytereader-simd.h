@@ -0,0 +1,42 @@
+/* GStreamer byte reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BYTE_READER_SIMD_H__
+#define __GST_BYTE_READER_SIMD_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Start code scanners, each one built with the compiler flags needed for
+ * its instruction set and selected at runtime by gstbytereader.c. They
+ * return the offset of the first 0x00 0x00 0x01 sequence that is followed
+ * by at least one more byte in @data, or -1. */
+
+G_GNUC_INTERNAL
+gint _gst_byte_reader_scan_for_start_code_sse2 (const guint8 * data, guint size);
+
+G_GNUC_INTERNAL
+gint _gst_byte_reader_scan_for_start_code_avx2 (const guint8 * data, guint size);
+
+G_GNUC_INTERNAL
+gint _gst_byte_reader_scan_for_start_code_neon (const guint8 * data, guint size);
+
+G_END_DECLS
+
+#endif /* __GST_BYTE_READER_SIMD_H__ */
@@ -0,0 +1,59 @@
+/* GStreamer byte reader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstbytereader-simd.h"
+
+#include <emmintrin.h>
+
+gint
+_gst_byte_reader_scan_for_start_code_sse2 (const guint8 * data, guint size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi8 (1);
+  guint i = 0;
+
+  /* every iteration checks the 16 start positions i..i+15, which reads
+   * up to byte i+17 and must not go beyond the last valid position,
+   * size - 4 */
+  while (size >= 19 && i <= size - 19) {
+    __m128i b0 = _mm_loadu_si128 ((const __m128i *) (data + i));
+    __m128i b1 = _mm_loadu_si128 ((const __m128i *) (data + i + 1));
+    __m128i b2 = _mm_loadu_si128 ((const __m128i *) (data + i + 2));
+    __m128i m;
+    gint mask;
+
+    m = _mm_and_si128 (_mm_cmpeq_epi8 (b0, zero), _mm_cmpeq_epi8 (b1, zero));
+    m = _mm_and_si128 (m, _mm_cmpeq_epi8 (b2, one));
+    mask = _mm_movemask_epi8 (m);
+    if (G_UNLIKELY (mask))
+      return i + g_bit_nth_lsf (mask, -1);
+
+    i += 16;
+  }
+
+  for (; i + 4 <= size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+
+  return -1;
+}
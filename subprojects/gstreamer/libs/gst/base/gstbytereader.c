@@ -25,6 +25,7 @@
 
 #define GST_BYTE_READER_DISABLE_INLINES
 #include "gstbytereader.h"
+#include "gstbytereader-simd.h"
 
 #include "gst/glib-compat-private.h"
 #include <string.h>
@@ -863,8 +864,8 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
 }
 
 /* Special optimized scan for mask 0xffffff00 and pattern 0x00000100 */
-static inline gint
-_scan_for_start_code (const guint8 * data, guint size)
+static gint
+_scan_for_start_code_c (const guint8 * data, guint size)
 {
   guint8 *pdata = (guint8 *) data;
   guint8 *pend = (guint8 *) (data + size - 4);
@@ -885,6 +886,77 @@ _scan_for_start_code (const guint8 * data, guint size)
   return -1;
 }
 
+typedef gint (*ScanForStartCodeFunc) (const guint8 * data, guint size);
+
+/* picks the fastest start code scanner supported by the CPU, once */
+static ScanForStartCodeFunc
+_get_scan_for_start_code_func (void)
+{
+  static gsize func = 0;
+
+  if (g_once_init_enter (&func)) {
+    ScanForStartCodeFunc f = _scan_for_start_code_c;
+
+    /* from the least to the most preferred, the last supported one wins */
+#ifdef HAVE_SSE2
+    if (gst_cpuid_supports_x86_sse2 ())
+      f = _gst_byte_reader_scan_for_start_code_sse2;
+#endif
+#ifdef HAVE_AVX2
+    if (gst_cpuid_supports_x86_avx2 ())
+      f = _gst_byte_reader_scan_for_start_code_avx2;
+#endif
+#ifdef HAVE_NEON
+    if (gst_cpuid_supports_arm_neon64 ())
+      f = _gst_byte_reader_scan_for_start_code_neon;
+#endif
+
+    g_once_init_leave (&func, (gsize) f);
+  }
+
+  return (ScanForStartCodeFunc) func;
+}
+
+static inline gint
+_scan_for_start_code (const guint8 * data, guint size)
+{
+  /* the vector versions only pay off once they get to do a few iterations */
+  if (size < 64)
+    return _scan_for_start_code_c (data, size);
+
+  return _get_scan_for_start_code_func () (data, size);
+}
+
+/* Scan for patterns whose first byte is not masked: memchr() is vectorized
+ * by the C library, so let it find the candidates for the first byte */
+static inline gint
+_scan_for_first_byte (const guint8 * data, guint size, guint32 mask,
+    guint32 pattern, guint32 * value)
+{
+  const guint8 *pdata = data;
+  const guint8 *pend = data + size - 4;
+  guint8 first = pattern >> 24;
+
+  while (pdata <= pend) {
+    guint32 state;
+
+    pdata = memchr (pdata, first, pend - pdata + 1);
+    if (pdata == NULL)
+      break;
+
+    state = GST_READ_UINT32_BE (pdata);
+    if ((state & mask) == pattern) {
+      if (value)
+        *value = state;
+      return pdata - data;
+    }
+    pdata++;
+  }
+
+  /* nothing found */
+  return -1;
+}
+
 static inline guint
 _masked_scan_uint32_peek (const GstByteReader * reader,
     guint32 mask, guint32 pattern, guint offset, guint size, guint32 * value)
@@ -916,6 +988,15 @@ _masked_scan_uint32_peek (const GstByteReader * reader,
     return ret + offset;
   }
 
+  if ((mask & 0xff000000) == 0xff000000) {
+    gint ret = _scan_for_first_byte (data, size, mask, pattern, value);
+
+    if (ret == -1)
+      return ret;
+
+    return ret + offset;
+  }
+
   /* set the state to something that does not match */
   state = ~pattern;
 
@@ -0,0 +1,978 @@
+/* GStreamer chunked byte and bit readers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstchunkreader.h"
+#include "gstbytereader.h"
+
+#include <string.h>
+
+/**
+ * SECTION:gstchunkreader
+ * @title: GstChunkByteReader
+ * @short_description: Reads integers and bits from non-contiguous memory
+ *     without merging it first
+ *
+ * A #GstBuffer consisting of several #GstMemory, or a range of a
+ * #GstAdapter spanning several buffers, can only be accessed as a single
+ * contiguous region of memory after its content has been copied into a
+ * scratch buffer. Parsers that only look at a few bytes here and there, for
+ * example to find a sync word and check the following frame headers, can
+ * avoid that copy by mapping the memories one by one with #GstChunkMap or
+ * gst_adapter_map_chunks(), and by reading from the resulting list of
+ * #GstByteChunk with a #GstChunkByteReader or a #GstChunkBitReader.
+ *
+ * Both readers handle values that straddle the boundary between two chunks
+ * transparently. Reading a value that is completely contained in one chunk
+ * is as cheap as with #GstByteReader.
+ *
+ * Since: 1.30
+ */
+
+/**
+ * gst_chunk_map_init:
+ * @map: a #GstChunkMap
+ *
+ * Initializes an empty #GstChunkMap. Release the resources of @map with
+ * gst_chunk_map_clear() when no longer needed.
+ *
+ * Since: 1.30
+ */
+void
+gst_chunk_map_init (GstChunkMap * map)
+{
+  g_return_if_fail (map != NULL);
+
+  memset (map, 0, sizeof (GstChunkMap));
+}
+
+/**
+ * gst_chunk_map_add_buffer:
+ * @map: a #GstChunkMap
+ * @buffer: a #GstBuffer
+ * @offset: the offset in @buffer
+ * @size: the size to map, or -1 to map until the end of @buffer
+ *
+ * Maps @size bytes of @buffer starting at @offset for reading and appends
+ * one #GstByteChunk per #GstMemory to the chunks of @map. The memories are
+ * never merged.
+ *
+ * The memories stay mapped, and referenced, until gst_chunk_map_unmap() or
+ * gst_chunk_map_clear() is called.
+ *
+ * Returns: %TRUE if the range could be mapped. On failure, @map is left as
+ *     it was before the call.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_map_add_buffer (GstChunkMap * map, GstBuffer * buffer, gsize offset,
+    gssize size)
+{
+  guint idx, length, i, n_infos;
+  gsize bufsize, skip, left;
+
+  g_return_val_if_fail (map != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+
+  bufsize = gst_buffer_get_size (buffer);
+  g_return_val_if_fail (offset <= bufsize, FALSE);
+  if (size == -1)
+    size = bufsize - offset;
+  g_return_val_if_fail (size >= 0 && offset + (gsize) size <= bufsize, FALSE);
+
+  if (size == 0)
+    return TRUE;
+
+  if (!gst_buffer_find_memory (buffer, offset, size, &idx, &length, &skip))
+    return FALSE;
+
+  if (map->infos == NULL) {
+    map->infos = g_array_sized_new (FALSE, FALSE, sizeof (GstMapInfo), 4);
+    map->chunk_array =
+        g_array_sized_new (FALSE, FALSE, sizeof (GstByteChunk), 4);
+  }
+
+  n_infos = map->infos->len;
+  left = size;
+
+  for (i = idx; i < idx + length && left > 0; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+    GstMapInfo info;
+    GstByteChunk chunk;
+
+    if (!gst_memory_map (mem, &info, GST_MAP_READ))
+      goto map_failed;
+
+    chunk.data = info.data + skip;
+    chunk.size = MIN (info.size - skip, left);
+    skip = 0;
+
+    if (chunk.size == 0) {
+      gst_memory_unmap (mem, &info);
+      continue;
+    }
+
+    gst_memory_ref (mem);
+    g_array_append_val (map->infos, info);
+    g_array_append_val (map->chunk_array, chunk);
+    left -= chunk.size;
+  }
+
+  map->chunks = (const GstByteChunk *) map->chunk_array->data;
+  map->n_chunks = map->chunk_array->len;
+  map->size += size;
+
+  return TRUE;
+
+map_failed:
+  {
+    for (i = n_infos; i < map->infos->len; i++) {
+      GstMapInfo *info = &g_array_index (map->infos, GstMapInfo, i);
+      GstMemory *mem = info->memory;
+
+      gst_memory_unmap (mem, info);
+      gst_memory_unref (mem);
+    }
+    g_array_set_size (map->infos, n_infos);
+    g_array_set_size (map->chunk_array, n_infos);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_chunk_map_unmap:
+ * @map: a #GstChunkMap
+ *
+ * Unmaps and releases all memories mapped by @map and empties its list of
+ * chunks. The storage of @map is kept around so that @map can be reused
+ * without allocating again.
+ *
+ * Since: 1.30
+ */
+void
+gst_chunk_map_unmap (GstChunkMap * map)
+{
+  guint i;
+
+  g_return_if_fail (map != NULL);
+
+  if (map->infos == NULL || map->infos->len == 0)
+    return;
+
+  for (i = 0; i < map->infos->len; i++) {
+    GstMapInfo *info = &g_array_index (map->infos, GstMapInfo, i);
+    GstMemory *mem = info->memory;
+
+    gst_memory_unmap (mem, info);
+    gst_memory_unref (mem);
+  }
+  g_array_set_size (map->infos, 0);
+  g_array_set_size (map->chunk_array, 0);
+
+  map->n_chunks = 0;
+  map->size = 0;
+}
+
+/**
+ * gst_chunk_map_clear:
+ * @map: a #GstChunkMap
+ *
+ * Unmaps all memories mapped by @map and frees its storage.
+ *
+ * Since: 1.30
+ */
+void
+gst_chunk_map_clear (GstChunkMap * map)
+{
+  g_return_if_fail (map != NULL);
+
+  gst_chunk_map_unmap (map);
+
+  if (map->infos) {
+    g_array_free (map->infos, TRUE);
+    g_array_free (map->chunk_array, TRUE);
+  }
+  map->infos = NULL;
+  map->chunk_array = NULL;
+  map->chunks = NULL;
+}
+
+/* moves the reader to @pos, searching forward from the current chunk
+ * whenever possible. Empty chunks are skipped. */
+static void
+_chunk_byte_reader_seek (GstChunkByteReader * reader, gsize pos)
+{
+  guint i;
+  gsize start;
+
+  if (pos >= reader->chunk_start) {
+    i = reader->chunk;
+    start = reader->chunk_start;
+  } else {
+    i = 0;
+    start = 0;
+  }
+
+  while (i < reader->n_chunks && start + reader->chunks[i].size <= pos) {
+    start += reader->chunks[i].size;
+    i++;
+  }
+
+  reader->chunk = i;
+  reader->chunk_start = start;
+  reader->byte = pos;
+}
+
+/* copies @size bytes starting at @skip bytes into chunk @chunk */
+static void
+_chunk_copy (const GstByteChunk * chunks, guint chunk, gsize skip,
+    guint8 * dest, gsize size)
+{
+  while (size > 0) {
+    const GstByteChunk *c = &chunks[chunk++];
+    gsize n = MIN (c->size - skip, size);
+
+    memcpy (dest, c->data + skip, n);
+    dest += n;
+    size -= n;
+    skip = 0;
+  }
+}
+
+/* returns a pointer to @size bytes at the current position, which points
+ * either directly into the current chunk or into @tmp if the bytes
+ * straddle a chunk boundary */
+static inline const guint8 *
+_chunk_byte_reader_peek (const GstChunkByteReader * reader, gsize size,
+    guint8 * tmp)
+{
+  const GstByteChunk *c;
+  gsize skip;
+
+  if (reader->size - reader->byte < size)
+    return NULL;
+
+  c = &reader->chunks[reader->chunk];
+  skip = reader->byte - reader->chunk_start;
+  if (G_LIKELY (c->size - skip >= size))
+    return c->data + skip;
+
+  _chunk_copy (reader->chunks, reader->chunk, skip, tmp, size);
+  return tmp;
+}
+
+/**
+ * gst_chunk_byte_reader_init:
+ * @reader: a #GstChunkByteReader instance
+ * @chunks: (in) (transfer none) (array length=n_chunks): chunks from which
+ *     the #GstChunkByteReader should read
+ * @n_chunks: number of entries in @chunks
+ *
+ * Initializes a #GstChunkByteReader instance to read from @chunks as if they
+ * were one contiguous region of memory. This function can be called on
+ * already initialized instances.
+ *
+ * Since: 1.30
+ */
+void
+gst_chunk_byte_reader_init (GstChunkByteReader * reader,
+    const GstByteChunk * chunks, guint n_chunks)
+{
+  guint i;
+
+  g_return_if_fail (reader != NULL);
+  g_return_if_fail (chunks != NULL || n_chunks == 0);
+
+  reader->chunks = chunks;
+  reader->n_chunks = n_chunks;
+  reader->size = 0;
+  for (i = 0; i < n_chunks; i++)
+    reader->size += chunks[i].size;
+
+  reader->chunk = 0;
+  reader->chunk_start = 0;
+  _chunk_byte_reader_seek (reader, 0);
+}
+
+/**
+ * gst_chunk_byte_reader_get_pos:
+ * @reader: a #GstChunkByteReader instance
+ *
+ * Returns the current position of a #GstChunkByteReader instance in bytes.
+ *
+ * Returns: The current position of @reader in bytes.
+ *
+ * Since: 1.30
+ */
+gsize
+gst_chunk_byte_reader_get_pos (const GstChunkByteReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->byte;
+}
+
+/**
+ * gst_chunk_byte_reader_get_remaining:
+ * @reader: a #GstChunkByteReader instance
+ *
+ * Returns the remaining number of bytes of a #GstChunkByteReader instance.
+ *
+ * Returns: The remaining number of bytes of @reader instance.
+ *
+ * Since: 1.30
+ */
+gsize
+gst_chunk_byte_reader_get_remaining (const GstChunkByteReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->size - reader->byte;
+}
+
+/**
+ * gst_chunk_byte_reader_get_size:
+ * @reader: a #GstChunkByteReader instance
+ *
+ * Returns the total number of bytes of a #GstChunkByteReader instance.
+ *
+ * Returns: The total number of bytes of @reader instance.
+ *
+ * Since: 1.30
+ */
+gsize
+gst_chunk_byte_reader_get_size (const GstChunkByteReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return reader->size;
+}
+
+/**
+ * gst_chunk_byte_reader_set_pos:
+ * @reader: a #GstChunkByteReader instance
+ * @pos: The new position in bytes
+ *
+ * Sets the new position of a #GstChunkByteReader instance to @pos in bytes.
+ *
+ * Returns: %TRUE if the position could be set successfully, %FALSE
+ * otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_byte_reader_set_pos (GstChunkByteReader * reader, gsize pos)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (pos > reader->size)
+    return FALSE;
+
+  _chunk_byte_reader_seek (reader, pos);
+
+  return TRUE;
+}
+
+/**
+ * gst_chunk_byte_reader_skip:
+ * @reader: a #GstChunkByteReader instance
+ * @nbytes: the number of bytes to skip
+ *
+ * Skips @nbytes bytes of the #GstChunkByteReader instance.
+ *
+ * Returns: %TRUE if @nbytes bytes could be skipped, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_byte_reader_skip (GstChunkByteReader * reader, gsize nbytes)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->size - reader->byte < nbytes)
+    return FALSE;
+
+  _chunk_byte_reader_seek (reader, reader->byte + nbytes);
+
+  return TRUE;
+}
+
+#define GST_CHUNK_BYTE_READER_PEEK_GET(bits,type,name,read) \
+gboolean \
+gst_chunk_byte_reader_peek_##name (const GstChunkByteReader * reader, \
+    type * val) \
+{ \
+  guint8 tmp[bits / 8]; \
+  const guint8 *data; \
+  \
+  g_return_val_if_fail (reader != NULL, FALSE); \
+  g_return_val_if_fail (val != NULL, FALSE); \
+  \
+  data = _chunk_byte_reader_peek (reader, bits / 8, tmp); \
+  if (data == NULL) \
+    return FALSE; \
+  \
+  *val = read (data); \
+  return TRUE; \
+} \
+\
+gboolean \
+gst_chunk_byte_reader_get_##name (GstChunkByteReader * reader, type * val) \
+{ \
+  if (!gst_chunk_byte_reader_peek_##name (reader, val)) \
+    return FALSE; \
+  \
+  _chunk_byte_reader_seek (reader, reader->byte + bits / 8); \
+  return TRUE; \
+}
+
+/**
+ * gst_chunk_byte_reader_peek_uint8:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint8 to store the result
+ *
+ * Read an unsigned 8 bit integer into @val but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+/**
+ * gst_chunk_byte_reader_get_uint8:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint8 to store the result
+ *
+ * Read an unsigned 8 bit integer into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+GST_CHUNK_BYTE_READER_PEEK_GET (8, guint8, uint8, GST_READ_UINT8);
+
+/**
+ * gst_chunk_byte_reader_peek_uint16_be:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit big endian integer into @val but keep the current
+ * position, even if the two bytes are in different chunks.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+/**
+ * gst_chunk_byte_reader_get_uint16_be:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint16 to store the result
+ *
+ * Read an unsigned 16 bit big endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+GST_CHUNK_BYTE_READER_PEEK_GET (16, guint16, uint16_be, GST_READ_UINT16_BE);
+
+/**
+ * gst_chunk_byte_reader_peek_uint32_be:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit big endian integer into @val but keep the current
+ * position, even if the four bytes are spread over several chunks.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+/**
+ * gst_chunk_byte_reader_get_uint32_be:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit big endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+GST_CHUNK_BYTE_READER_PEEK_GET (32, guint32, uint32_be, GST_READ_UINT32_BE);
+
+/**
+ * gst_chunk_byte_reader_peek_uint32_le:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit little endian integer into @val but keep the
+ * current position, even if the four bytes are spread over several chunks.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+/**
+ * gst_chunk_byte_reader_get_uint32_le:
+ * @reader: a #GstChunkByteReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned 32 bit little endian integer into @val and update the
+ * current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+GST_CHUNK_BYTE_READER_PEEK_GET (32, guint32, uint32_le, GST_READ_UINT32_LE);
+
+/**
+ * gst_chunk_byte_reader_peek_data:
+ * @reader: a #GstChunkByteReader instance
+ * @size: Size in bytes
+ * @val: (out) (transfer none) (array length=size): address of a
+ *     #guint8 pointer variable in which to store the result
+ *
+ * Returns a constant pointer to the current data position if at least @size
+ * bytes are left and all of them are in the current chunk. The current
+ * position is not changed. Use gst_chunk_byte_reader_copy_data() for data
+ * that might straddle a chunk boundary.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_byte_reader_peek_data (const GstChunkByteReader * reader,
+    gsize size, const guint8 ** val)
+{
+  const GstByteChunk *c;
+  gsize skip;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  if (reader->size - reader->byte < size)
+    return FALSE;
+
+  if (size == 0) {
+    *val = NULL;
+    return TRUE;
+  }
+
+  c = &reader->chunks[reader->chunk];
+  skip = reader->byte - reader->chunk_start;
+  if (c->size - skip < size)
+    return FALSE;
+
+  *val = c->data + skip;
+  return TRUE;
+}
+
+/**
+ * gst_chunk_byte_reader_copy_data:
+ * @reader: a #GstChunkByteReader instance
+ * @dest: (out caller-allocates) (array length=size): the memory to copy into
+ * @size: Size in bytes
+ *
+ * Copies @size bytes starting at the current position into @dest, no
+ * matter how many chunks they are spread over. The current position is not
+ * changed.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_byte_reader_copy_data (const GstChunkByteReader * reader,
+    guint8 * dest, gsize size)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (dest != NULL || size == 0, FALSE);
+
+  if (reader->size - reader->byte < size)
+    return FALSE;
+
+  _chunk_copy (reader->chunks, reader->chunk,
+      reader->byte - reader->chunk_start, dest, size);
+
+  return TRUE;
+}
+
+/**
+ * gst_chunk_byte_reader_masked_scan_uint32:
+ * @reader: a #GstChunkByteReader
+ * @mask: mask to apply to data before matching against @pattern
+ * @pattern: pattern to match (after mask is applied)
+ * @offset: offset from which to start scanning, relative to the current
+ *     position
+ * @size: number of bytes to scan from offset
+ * @value: (out) (optional): pointer to uint32 to return matching data
+ *
+ * Scan for pattern @pattern with applied mask @mask in the chunks, starting
+ * from offset @offset relative to the current position. This behaves like
+ * gst_byte_reader_masked_scan_uint32_peek(), patterns spread over several
+ * chunks are found as well.
+ *
+ * It is an error to call this function without making sure that there is
+ * enough data (offset+size bytes) in the reader.
+ *
+ * Returns: offset of the first match relative to the current position, or
+ *     -1 if no match was found.
+ *
+ * Since: 1.30
+ */
+gssize
+gst_chunk_byte_reader_masked_scan_uint32 (const GstChunkByteReader * reader,
+    guint32 mask, guint32 pattern, gsize offset, gsize size, guint32 * value)
+{
+  guint32 state;
+  gsize pos, end, chunk_start, filled;
+  guint i;
+
+  g_return_val_if_fail (reader != NULL, -1);
+  g_return_val_if_fail (size > 0, -1);
+  g_return_val_if_fail (offset + size <= reader->size - reader->byte, -1);
+
+  /* we can't find the pattern with less than 4 bytes */
+  if (G_UNLIKELY (size < 4))
+    return -1;
+
+  pos = reader->byte + offset;
+  end = pos + size;
+
+  i = reader->chunk;
+  chunk_start = reader->chunk_start;
+  while (chunk_start + reader->chunks[i].size <= pos) {
+    chunk_start += reader->chunks[i].size;
+    i++;
+  }
+
+  /* set the state to something that does not match */
+  state = ~pattern;
+  filled = 0;
+
+  while (pos < end) {
+    const GstByteChunk *c = &reader->chunks[i];
+    gsize skip = pos - chunk_start;
+    gsize avail = MIN (c->size - skip, end - pos);
+    const guint8 *data = c->data + skip;
+    gsize head = MIN (avail, 3);
+    gsize k;
+
+    /* the first bytes of a chunk complete the patterns that started in
+     * the previous one */
+    for (k = 0; k < head; k++) {
+      state = (state << 8) | data[k];
+      if (++filled >= 4 && G_UNLIKELY ((state & mask) == pattern)) {
+        if (value)
+          *value = state;
+        return pos + k - 3 - reader->byte;
+      }
+    }
+
+    /* patterns that are completely inside the chunk */
+    while (avail >= 4) {
+      GstByteReader br;
+      guint scan = MIN (avail, G_MAXUINT);
+      gint ret;
+
+      gst_byte_reader_init (&br, data, scan);
+      ret = gst_byte_reader_masked_scan_uint32_peek (&br, mask, pattern, 0,
+          scan, value);
+      if (ret >= 0)
+        return pos + ret - reader->byte;
+
+      if (scan == avail) {
+        for (k = MAX (head, avail - 3); k < avail; k++)
+          state = (state << 8) | data[k];
+        filled += avail - head;
+        break;
+      }
+
+      /* only for chunks larger than G_MAXUINT */
+      data += scan - 3;
+      pos += scan - 3;
+      avail -= scan - 3;
+      head = 0;
+    }
+
+    pos += avail;
+    chunk_start += c->size;
+    i++;
+  }
+
+  /* nothing found */
+  return -1;
+}
+
+/**
+ * gst_chunk_bit_reader_init:
+ * @reader: a #GstChunkBitReader instance
+ * @chunks: (in) (transfer none) (array length=n_chunks): chunks from which
+ *     the #GstChunkBitReader should read
+ * @n_chunks: number of entries in @chunks
+ *
+ * Initializes a #GstChunkBitReader instance to read from @chunks as if they
+ * were one contiguous region of memory. This function can be called on
+ * already initialized instances.
+ *
+ * Since: 1.30
+ */
+void
+gst_chunk_bit_reader_init (GstChunkBitReader * reader,
+    const GstByteChunk * chunks, guint n_chunks)
+{
+  g_return_if_fail (reader != NULL);
+
+  gst_chunk_byte_reader_init (&reader->byte_reader, chunks, n_chunks);
+  reader->bit = 0;
+}
+
+/**
+ * gst_chunk_bit_reader_get_pos:
+ * @reader: a #GstChunkBitReader instance
+ *
+ * Returns the current position of a #GstChunkBitReader instance in bits.
+ *
+ * Returns: The current position of @reader in bits.
+ *
+ * Since: 1.30
+ */
+guint64
+gst_chunk_bit_reader_get_pos (const GstChunkBitReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return (guint64) reader->byte_reader.byte * 8 + reader->bit;
+}
+
+/**
+ * gst_chunk_bit_reader_get_remaining:
+ * @reader: a #GstChunkBitReader instance
+ *
+ * Returns the remaining number of bits of a #GstChunkBitReader instance.
+ *
+ * Returns: The remaining number of bits of @reader instance.
+ *
+ * Since: 1.30
+ */
+guint64
+gst_chunk_bit_reader_get_remaining (const GstChunkBitReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+
+  return (guint64) (reader->byte_reader.size - reader->byte_reader.byte) * 8 -
+      reader->bit;
+}
+
+/**
+ * gst_chunk_bit_reader_skip:
+ * @reader: a #GstChunkBitReader instance
+ * @nbits: the number of bits to skip
+ *
+ * Skips @nbits bits of the #GstChunkBitReader instance.
+ *
+ * Returns: %TRUE if @nbits bits could be skipped, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_skip (GstChunkBitReader * reader, guint64 nbits)
+{
+  guint64 bits;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (gst_chunk_bit_reader_get_remaining (reader) < nbits)
+    return FALSE;
+
+  bits = reader->bit + nbits;
+  _chunk_byte_reader_seek (&reader->byte_reader,
+      reader->byte_reader.byte + bits / 8);
+  reader->bit = bits % 8;
+
+  return TRUE;
+}
+
+/**
+ * gst_chunk_bit_reader_skip_to_byte:
+ * @reader: a #GstChunkBitReader instance
+ *
+ * Skips until the next byte.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_skip_to_byte (GstChunkBitReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->byte_reader.byte >= reader->byte_reader.size)
+    return FALSE;
+
+  if (reader->bit) {
+    _chunk_byte_reader_seek (&reader->byte_reader,
+        reader->byte_reader.byte + 1);
+    reader->bit = 0;
+  }
+
+  return TRUE;
+}
+
+static inline gboolean
+_chunk_bit_reader_peek (const GstChunkBitReader * reader, guint64 * val,
+    guint nbits)
+{
+  guint8 tmp[9];
+  const guint8 *data;
+  guint64 ret = 0;
+  guint bit = reader->bit;
+
+  if (gst_chunk_bit_reader_get_remaining (reader) < nbits)
+    return FALSE;
+
+  if (nbits == 0) {
+    *val = 0;
+    return TRUE;
+  }
+
+  data = _chunk_byte_reader_peek (&reader->byte_reader, (bit + nbits + 7) / 8,
+      tmp);
+
+  while (nbits > 0) {
+    guint toread = MIN (nbits, 8 - bit);
+
+    ret <<= toread;
+    ret |= (*data & (0xff >> bit)) >> (8 - toread - bit);
+
+    bit += toread;
+    if (bit >= 8) {
+      data++;
+      bit = 0;
+    }
+    nbits -= toread;
+  }
+
+  *val = ret;
+  return TRUE;
+}
+
+/**
+ * gst_chunk_bit_reader_peek_bits_uint32:
+ * @reader: a #GstChunkBitReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ * @nbits: number of bits to read
+ *
+ * Read @nbits bits into @val but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_peek_bits_uint32 (const GstChunkBitReader * reader,
+    guint32 * val, guint nbits)
+{
+  guint64 ret;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+  g_return_val_if_fail (nbits <= 32, FALSE);
+
+  if (!_chunk_bit_reader_peek (reader, &ret, nbits))
+    return FALSE;
+
+  *val = ret;
+  return TRUE;
+}
+
+/**
+ * gst_chunk_bit_reader_get_bits_uint32:
+ * @reader: a #GstChunkBitReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ * @nbits: number of bits to read
+ *
+ * Read @nbits bits into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_get_bits_uint32 (GstChunkBitReader * reader,
+    guint32 * val, guint nbits)
+{
+  if (!gst_chunk_bit_reader_peek_bits_uint32 (reader, val, nbits))
+    return FALSE;
+
+  return gst_chunk_bit_reader_skip (reader, nbits);
+}
+
+/**
+ * gst_chunk_bit_reader_peek_bits_uint64:
+ * @reader: a #GstChunkBitReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ * @nbits: number of bits to read
+ *
+ * Read @nbits bits into @val but keep the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_peek_bits_uint64 (const GstChunkBitReader * reader,
+    guint64 * val, guint nbits)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+  g_return_val_if_fail (nbits <= 64, FALSE);
+
+  return _chunk_bit_reader_peek (reader, val, nbits);
+}
+
+/**
+ * gst_chunk_bit_reader_get_bits_uint64:
+ * @reader: a #GstChunkBitReader instance
+ * @val: (out): Pointer to a #guint64 to store the result
+ * @nbits: number of bits to read
+ *
+ * Read @nbits bits into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.30
+ */
+gboolean
+gst_chunk_bit_reader_get_bits_uint64 (GstChunkBitReader * reader,
+    guint64 * val, guint nbits)
+{
+  if (!gst_chunk_bit_reader_peek_bits_uint64 (reader, val, nbits))
+    return FALSE;
+
+  return gst_chunk_bit_reader_skip (reader, nbits);
+}
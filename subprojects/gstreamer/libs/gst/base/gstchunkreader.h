@@ -0,0 +1,214 @@
+/* GStreamer chunked byte and bit readers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_CHUNK_READER_H__
+#define __GST_CHUNK_READER_H__
+
+#include <gst/gst.h>
+#include <gst/base/base-prelude.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstByteChunk:
+ * @data: (array length=size): start of the chunk
+ * @size: size of the chunk in bytes
+ *
+ * A contiguous piece of a larger, possibly non-contiguous, range of bytes.
+ *
+ * Since: 1.30
+ */
+typedef struct {
+  const guint8 *data;
+  gsize size;
+} GstByteChunk;
+
+/**
+ * GstChunkMap:
+ * @chunks: (array length=n_chunks): the currently mapped chunks
+ * @n_chunks: number of entries in @chunks
+ * @size: total size of all chunks in bytes
+ *
+ * Keeps the memories of one or more #GstBuffer mapped, one #GstByteChunk
+ * per #GstMemory, without merging them into a single contiguous region.
+ *
+ * Since: 1.30
+ */
+typedef struct {
+  const GstByteChunk *chunks;
+  guint n_chunks;
+  gsize size;
+
+  /* < private > */
+  GArray *infos;
+  GArray *chunk_array;
+
+  gpointer _gst_reserved[GST_PADDING];
+} GstChunkMap;
+
+GST_BASE_API
+void            gst_chunk_map_init              (GstChunkMap * map);
+
+GST_BASE_API
+gboolean        gst_chunk_map_add_buffer        (GstChunkMap * map,
+                                                 GstBuffer   * buffer,
+                                                 gsize         offset,
+                                                 gssize        size);
+GST_BASE_API
+void            gst_chunk_map_unmap             (GstChunkMap * map);
+
+GST_BASE_API
+void            gst_chunk_map_clear             (GstChunkMap * map);
+
+/**
+ * GstChunkByteReader:
+ * @chunks: (array length=n_chunks): the chunks from which the reader reads
+ * @n_chunks: number of entries in @chunks
+ * @size: total size of all chunks in bytes
+ * @byte: current byte position
+ *
+ * A byte reader reading across the boundaries of a list of #GstByteChunk.
+ *
+ * Since: 1.30
+ */
+typedef struct {
+  const GstByteChunk *chunks;
+  guint n_chunks;
+  gsize size;
+
+  gsize byte;
+
+  /* < private > */
+  guint chunk;          /* index of the chunk containing @byte */
+  gsize chunk_start;    /* position of the first byte of that chunk */
+
+  gpointer _gst_reserved[GST_PADDING];
+} GstChunkByteReader;
+
+GST_BASE_API
+void            gst_chunk_byte_reader_init          (GstChunkByteReader * reader,
+                                                     const GstByteChunk * chunks,
+                                                     guint                n_chunks);
+GST_BASE_API
+gsize           gst_chunk_byte_reader_get_pos       (const GstChunkByteReader * reader);
+
+GST_BASE_API
+gsize           gst_chunk_byte_reader_get_remaining (const GstChunkByteReader * reader);
+
+GST_BASE_API
+gsize           gst_chunk_byte_reader_get_size      (const GstChunkByteReader * reader);
+
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_set_pos       (GstChunkByteReader * reader,
+                                                     gsize                pos);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_skip          (GstChunkByteReader * reader,
+                                                     gsize                nbytes);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_peek_uint8    (const GstChunkByteReader * reader,
+                                                     guint8             * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_get_uint8     (GstChunkByteReader * reader,
+                                                     guint8             * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_peek_uint16_be (const GstChunkByteReader * reader,
+                                                      guint16            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_get_uint16_be (GstChunkByteReader * reader,
+                                                     guint16            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_peek_uint32_be (const GstChunkByteReader * reader,
+                                                      guint32            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_get_uint32_be (GstChunkByteReader * reader,
+                                                     guint32            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_peek_uint32_le (const GstChunkByteReader * reader,
+                                                      guint32            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_get_uint32_le (GstChunkByteReader * reader,
+                                                     guint32            * val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_peek_data     (const GstChunkByteReader * reader,
+                                                     gsize                size,
+                                                     const guint8      ** val);
+GST_BASE_API
+gboolean        gst_chunk_byte_reader_copy_data     (const GstChunkByteReader * reader,
+                                                     guint8             * dest,
+                                                     gsize                size);
+GST_BASE_API
+gssize          gst_chunk_byte_reader_masked_scan_uint32 (const GstChunkByteReader * reader,
+                                                          guint32              mask,
+                                                          guint32              pattern,
+                                                          gsize                offset,
+                                                          gsize                size,
+                                                          guint32            * value);
+
+/**
+ * GstChunkBitReader:
+ * @byte_reader: the byte reader keeping track of the current byte
+ * @bit: bit position in the current byte
+ *
+ * A bit reader reading across the boundaries of a list of #GstByteChunk.
+ *
+ * Since: 1.30
+ */
+typedef struct {
+  GstChunkByteReader byte_reader;
+  guint bit;
+
+  /* < private > */
+  gpointer _gst_reserved[GST_PADDING];
+} GstChunkBitReader;
+
+GST_BASE_API
+void            gst_chunk_bit_reader_init           (GstChunkBitReader  * reader,
+                                                     const GstByteChunk * chunks,
+                                                     guint                n_chunks);
+GST_BASE_API
+guint64         gst_chunk_bit_reader_get_pos        (const GstChunkBitReader * reader);
+
+GST_BASE_API
+guint64         gst_chunk_bit_reader_get_remaining  (const GstChunkBitReader * reader);
+
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_skip           (GstChunkBitReader * reader,
+                                                     guint64             nbits);
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_skip_to_byte   (GstChunkBitReader * reader);
+
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_peek_bits_uint32 (const GstChunkBitReader * reader,
+                                                       guint32           * val,
+                                                       guint               nbits);
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_get_bits_uint32 (GstChunkBitReader * reader,
+                                                      guint32           * val,
+                                                      guint               nbits);
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_peek_bits_uint64 (const GstChunkBitReader * reader,
+                                                       guint64           * val,
+                                                       guint               nbits);
+GST_BASE_API
+gboolean        gst_chunk_bit_reader_get_bits_uint64 (GstChunkBitReader * reader,
+                                                      guint64           * val,
+                                                      guint               nbits);
+
+G_END_DECLS
+
+#endif /* __GST_CHUNK_READER_H__ */
@@ -41,6 +41,180 @@
 
 #include "gsttypefindhelper.h"
 
+/* *************************** signatures ********************************* */
+
+/* Typefind functions registered with a signature can't suggest anything
+ * unless the data contains the signature, so they can be skipped for all
+ * other data without calling them. For typefinding on a chunk of data the
+ * signature factories of the registry are indexed by signature offset and
+ * first signature byte, which gives the plausible ones with one lookup per
+ * distinct offset instead of one comparison per factory. */
+typedef struct
+{
+  guint64 offset;
+  GPtrArray *buckets[256];
+} SignatureOffset;
+
+typedef struct
+{
+  guint32 cookie;
+  /* all factories with a signature, owns a ref */
+  GHashTable *factories;
+  /* array of SignatureOffset */
+  GArray *offsets;
+} SignatureIndex;
+
+static GMutex signature_index_lock;
+static SignatureIndex *signature_index;
+
+static void
+signature_offset_clear (SignatureOffset * sig_offset)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (sig_offset->buckets); i++) {
+    if (sig_offset->buckets[i])
+      g_ptr_array_unref (sig_offset->buckets[i]);
+  }
+}
+
+static void
+signature_index_clear (SignatureIndex * index)
+{
+  g_array_unref (index->offsets);
+  g_hash_table_unref (index->factories);
+}
+
+static void
+signature_index_unref (SignatureIndex * index)
+{
+  g_atomic_rc_box_release_full (index, (GDestroyNotify) signature_index_clear);
+}
+
+static SignatureIndex *
+signature_index_new (GstRegistry * registry)
+{
+  SignatureIndex *index;
+  GList *l, *type_list;
+
+  index = g_atomic_rc_box_new0 (SignatureIndex);
+  index->cookie = gst_registry_get_feature_list_cookie (registry);
+  index->factories = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      NULL);
+  index->offsets = g_array_new (FALSE, TRUE, sizeof (SignatureOffset));
+  g_array_set_clear_func (index->offsets,
+      (GDestroyNotify) signature_offset_clear);
+
+  type_list = gst_type_find_factory_get_list ();
+  for (l = type_list; l; l = l->next) {
+    GstTypeFindFactory *factory = l->data;
+    SignatureOffset *sig_offset = NULL;
+    const guint8 *signature;
+    guint64 offset;
+    guint i, size;
+
+    signature = gst_type_find_factory_get_signature (factory, &offset, &size);
+    if (signature == NULL)
+      continue;
+
+    for (i = 0; i < index->offsets->len; i++) {
+      sig_offset = &g_array_index (index->offsets, SignatureOffset, i);
+      if (sig_offset->offset == offset)
+        break;
+    }
+    if (i == index->offsets->len) {
+      g_array_set_size (index->offsets, i + 1);
+      sig_offset = &g_array_index (index->offsets, SignatureOffset, i);
+      sig_offset->offset = offset;
+    }
+
+    if (sig_offset->buckets[signature[0]] == NULL)
+      sig_offset->buckets[signature[0]] = g_ptr_array_new ();
+    g_ptr_array_add (sig_offset->buckets[signature[0]], factory);
+
+    g_hash_table_add (index->factories, gst_object_ref (factory));
+  }
+  gst_plugin_feature_list_free (type_list);
+
+  GST_DEBUG ("indexed %u typefind signatures at %u offsets, cookie %u",
+      g_hash_table_size (index->factories), index->offsets->len,
+      index->cookie);
+
+  return index;
+}
+
+/* Returns a ref to the index for the current state of the registry */
+static SignatureIndex *
+signature_index_get (void)
+{
+  GstRegistry *registry = gst_registry_get ();
+  SignatureIndex *index;
+
+  g_mutex_lock (&signature_index_lock);
+  if (signature_index == NULL || signature_index->cookie !=
+      gst_registry_get_feature_list_cookie (registry)) {
+    if (signature_index)
+      signature_index_unref (signature_index);
+    signature_index = signature_index_new (registry);
+  }
+  index = g_atomic_rc_box_acquire (signature_index);
+  g_mutex_unlock (&signature_index_lock);
+
+  return index;
+}
+
+/* Collects the indexed factories whose signature is present in @data */
+static void
+signature_index_match (SignatureIndex * index, const guint8 * data,
+    gsize size, GPtrArray * matches)
+{
+  guint i, j;
+
+  for (i = 0; i < index->offsets->len; i++) {
+    SignatureOffset *sig_offset =
+        &g_array_index (index->offsets, SignatureOffset, i);
+    GPtrArray *bucket;
+
+    if (sig_offset->offset >= size)
+      continue;
+
+    bucket = sig_offset->buckets[data[sig_offset->offset]];
+    if (bucket == NULL)
+      continue;
+
+    for (j = 0; j < bucket->len; j++) {
+      GstTypeFindFactory *factory = g_ptr_array_index (bucket, j);
+      const guint8 *signature;
+      guint64 offset;
+      guint sig_size;
+
+      signature = gst_type_find_factory_get_signature (factory, &offset,
+          &sig_size);
+      if (sig_size <= size - offset
+          && memcmp (data + offset, signature, sig_size) == 0)
+        g_ptr_array_add (matches, factory);
+    }
+  }
+}
+
+/* Returns %FALSE if @factory has a signature that is not present in the
+ * data of @find, in which case its function can't suggest anything */
+static gboolean
+signature_matches (GstTypeFindFactory * factory, GstTypeFind * find)
+{
+  const guint8 *signature, *data;
+  guint64 offset;
+  guint size;
+
+  signature = gst_type_find_factory_get_signature (factory, &offset, &size);
+  if (signature == NULL || offset > G_MAXINT64)
+    return TRUE;
+
+  data = gst_type_find_peek (find, offset, size);
+
+  return data != NULL && memcmp (data, signature, size) == 0;
+}
+
 /* ********************** typefinding in pull mode ************************ */
 
 static void
@@ -324,6 +498,9 @@ prioritize_extension (GstObject * obj, GList * type_list,
  * functions for the given extension, which might speed up the typefinding
  * in many cases.
  *
+ * Typefind functions that were registered with a signature are skipped
+ * without calling them if @data does not contain their signature.
+ *
  * Free-function: gst_caps_unref
  *
  * Returns: (transfer full) (nullable): the #GstCaps corresponding to the data
@@ -414,7 +591,12 @@ gst_type_find_helper_get_range_full (GstObject * obj, GstObject * parent,
 
   for (l = type_list; l; l = l->next) {
     helper.factory = GST_TYPE_FIND_FACTORY (l->data);
-    gst_type_find_factory_call_function (helper.factory, &find);
+    if (!signature_matches (helper.factory, &find)) {
+      GST_LOG_OBJECT (obj, "skipping %" GST_PTR_FORMAT ", signature does not "
+          "match", helper.factory);
+    } else {
+      gst_type_find_factory_call_function (helper.factory, &find);
+    }
     if (helper.best_probability >= GST_TYPE_FIND_MAXIMUM) {
       /* Any other flow return can be ignored here, we found
        * something before any error with highest probability */
@@ -663,6 +845,8 @@ gst_type_find_helper_for_data_with_extension (GstObject * obj,
   GstTypeFindFactory *factory;
   GstTypeFind find;
   GList *l, *type_list;
+  SignatureIndex *index;
+  GPtrArray *matches;
   GstCaps *result = NULL;
 
   g_return_val_if_fail (data != NULL, NULL);
@@ -681,16 +865,33 @@ gst_type_find_helper_for_data_with_extension (GstObject * obj,
   find.suggest = buf_helper_find_suggest;
   find.get_length = buf_helper_get_length;
 
+  index = signature_index_get ();
+  matches = g_ptr_array_new ();
+  signature_index_match (index, data, size, matches);
+
   type_list = gst_type_find_factory_get_list ();
   type_list = prioritize_extension (obj, type_list, extension);
 
   for (l = type_list; l; l = l->next) {
     factory = GST_TYPE_FIND_FACTORY (l->data);
+
+    /* factories that were added to the registry after the index was built
+     * are checked directly */
+    if (g_hash_table_contains (index->factories, factory) ?
+        !g_ptr_array_find (matches, factory, NULL) :
+        !signature_matches (factory, &find)) {
+      GST_LOG_OBJECT (obj, "skipping %" GST_PTR_FORMAT ", signature does not "
+          "match", factory);
+      continue;
+    }
+
     gst_type_find_factory_call_function (factory, &find);
     if (helper.best_probability >= GST_TYPE_FIND_MAXIMUM)
       break;
   }
   gst_plugin_feature_list_free (type_list);
+  g_ptr_array_unref (matches);
+  signature_index_unref (index);
 
   if (helper.best_probability > 0)
     result = helper.caps;
@@ -761,6 +962,9 @@ gst_type_find_helper_for_data_with_caps (GstObject * obj,
     GstTypeFindProbability found_probability;
     GstTypeFindFactory *factory = GST_TYPE_FIND_FACTORY (l->data);
 
+    if (!signature_matches (factory, find))
+      continue;
+
     gst_type_find_factory_call_function (factory, find);
 
     found_probability = gst_type_find_data_get_probability (find_data);
@@ -0,0 +1,601 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A small queue of positioned file reads and writes that run in the
+ * background. On Linux they are handed to the kernel with io_uring,
+ * elsewhere (or when io_uring is not allowed) a pool of threads does
+ * pread() and pwrite() calls.
+ *
+ * There is no locking: the operations are submitted and their completions
+ * collected from a single thread. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+/* for sync_file_range() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
+#include <gst/gst.h>
+
+#include "gstasyncio.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined (__NR_io_uring_setup) && defined (__NR_io_uring_enter)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+typedef enum
+{
+  GST_ASYNC_IO_OP_READ,
+  GST_ASYNC_IO_OP_WRITE,
+  GST_ASYNC_IO_OP_SYNC_RANGE
+} GstAsyncIoOpType;
+
+typedef struct
+{
+  GstAsyncIoOpType type;
+  gint fd;
+  gpointer data;
+  gsize size;
+  guint64 offset;
+  gpointer user_data;
+  gssize result;
+#ifdef HAVE_IO_URING
+  struct iovec iov;
+#endif
+} GstAsyncIoOp;
+
+#ifdef HAVE_IO_URING
+typedef struct
+{
+  gint fd;
+
+  guint32 *sq_tail, *sq_mask, *sq_array;
+  guint32 *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+
+  gpointer sq_ring, cq_ring;
+  gsize sq_ring_size, cq_ring_size, sqes_size;
+} GstIoUring;
+#endif
+
+struct _GstAsyncIo
+{
+  guint depth;
+  guint in_flight;
+
+#ifdef HAVE_IO_URING
+  GstIoUring *ring;
+#endif
+
+  /* used when there is no ring */
+  GThreadPool *pool;
+  GAsyncQueue *done;
+};
+
+#ifdef HAVE_IO_URING
+static GstIoUring *
+gst_io_uring_new (guint entries)
+{
+  struct io_uring_params params;
+  GstIoUring *ring;
+  gboolean single_mmap = FALSE;
+  gpointer sq_ring, cq_ring, sqes;
+  gsize sq_ring_size, cq_ring_size, sqes_size;
+  gint fd;
+
+  memset (&params, 0, sizeof (params));
+  fd = syscall (__NR_io_uring_setup, entries, &params);
+  /* not implemented, or forbidden by a seccomp filter or sysctl */
+  if (fd < 0)
+    return NULL;
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof (guint32);
+  cq_ring_size = params.cq_off.cqes +
+      params.cq_entries * sizeof (struct io_uring_cqe);
+  sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    single_mmap = TRUE;
+    sq_ring_size = cq_ring_size = MAX (sq_ring_size, cq_ring_size);
+  }
+#endif
+
+  sq_ring = mmap (NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED)
+    goto map_failed;
+
+  if (single_mmap) {
+    cq_ring = sq_ring;
+  } else {
+    cq_ring = mmap (NULL, cq_ring_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      munmap (sq_ring, sq_ring_size);
+      goto map_failed;
+    }
+  }
+
+  sqes = mmap (NULL, sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (!single_mmap)
+      munmap (cq_ring, cq_ring_size);
+    munmap (sq_ring, sq_ring_size);
+    goto map_failed;
+  }
+
+  ring = g_new0 (GstIoUring, 1);
+  ring->fd = fd;
+  ring->sq_tail = (guint32 *) ((guint8 *) sq_ring + params.sq_off.tail);
+  ring->sq_mask = (guint32 *) ((guint8 *) sq_ring + params.sq_off.ring_mask);
+  ring->sq_array = (guint32 *) ((guint8 *) sq_ring + params.sq_off.array);
+  ring->cq_head = (guint32 *) ((guint8 *) cq_ring + params.cq_off.head);
+  ring->cq_tail = (guint32 *) ((guint8 *) cq_ring + params.cq_off.tail);
+  ring->cq_mask = (guint32 *) ((guint8 *) cq_ring + params.cq_off.ring_mask);
+  ring->cqes =
+      (struct io_uring_cqe *) ((guint8 *) cq_ring + params.cq_off.cqes);
+  ring->sqes = sqes;
+  ring->sq_ring = sq_ring;
+  ring->cq_ring = cq_ring;
+  ring->sq_ring_size = sq_ring_size;
+  ring->cq_ring_size = cq_ring_size;
+  ring->sqes_size = sqes_size;
+
+  return ring;
+
+map_failed:
+  close (fd);
+  return NULL;
+}
+
+static void
+gst_io_uring_free (GstIoUring * ring)
+{
+  munmap (ring->sqes, ring->sqes_size);
+  if (ring->cq_ring != ring->sq_ring)
+    munmap (ring->cq_ring, ring->cq_ring_size);
+  munmap (ring->sq_ring, ring->sq_ring_size);
+  close (ring->fd);
+  g_free (ring);
+}
+
+static gboolean
+gst_io_uring_submit (GstIoUring * ring, GstAsyncIoOp * op)
+{
+  struct io_uring_sqe *sqe;
+  guint32 tail, index;
+  gint ret;
+
+  /* we are the only producer, and never have more operations in flight
+   * than there are entries, so there is always a free one */
+  tail = *ring->sq_tail;
+  index = tail & *ring->sq_mask;
+
+  sqe = &ring->sqes[index];
+  memset (sqe, 0, sizeof (*sqe));
+  sqe->fd = op->fd;
+  sqe->off = op->offset;
+  sqe->user_data = (guint64) (guintptr) op;
+
+  switch (op->type) {
+    case GST_ASYNC_IO_OP_READ:
+    case GST_ASYNC_IO_OP_WRITE:
+      op->iov.iov_base = op->data;
+      op->iov.iov_len = op->size;
+      sqe->opcode = op->type == GST_ASYNC_IO_OP_READ ?
+          IORING_OP_READV : IORING_OP_WRITEV;
+      sqe->addr = (guint64) (guintptr) & op->iov;
+      sqe->len = 1;
+      break;
+    case GST_ASYNC_IO_OP_SYNC_RANGE:
+      sqe->opcode = IORING_OP_SYNC_FILE_RANGE;
+      sqe->len = op->size;
+      sqe->sync_range_flags = SYNC_FILE_RANGE_WAIT_BEFORE |
+          SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER;
+      break;
+  }
+  ring->sq_array[index] = index;
+
+  /* the entry has to be visible before the new tail */
+  g_atomic_int_set ((gint *) ring->sq_tail, tail + 1);
+
+  do {
+    ret = syscall (__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0);
+  } while (ret < 0 && (errno == EINTR || errno == EAGAIN));
+
+  if (ret < 0) {
+    /* the kernel did not take the entry, don't let it find it later */
+    g_atomic_int_set ((gint *) ring->sq_tail, tail);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static GstAsyncIoOp *
+gst_io_uring_wait (GstIoUring * ring, gboolean block)
+{
+  struct io_uring_cqe *cqe;
+  GstAsyncIoOp *op;
+  guint32 head;
+  gint ret;
+
+  head = *ring->cq_head;
+  while (head == (guint32) g_atomic_int_get ((gint *) ring->cq_tail)) {
+    if (!block)
+      return NULL;
+    ret = syscall (__NR_io_uring_enter, ring->fd, 0, 1,
+        IORING_ENTER_GETEVENTS, NULL, 0);
+    if (ret < 0 && errno != EINTR && errno != EAGAIN)
+      return NULL;
+  }
+
+  cqe = &ring->cqes[head & *ring->cq_mask];
+  op = (GstAsyncIoOp *) (guintptr) cqe->user_data;
+  op->result = cqe->res;
+
+  /* hand the entry back only after we're done reading it */
+  g_atomic_int_set ((gint *) ring->cq_head, head + 1);
+
+  return op;
+}
+#endif /* HAVE_IO_URING */
+
+/* what the threads do */
+static gssize
+gst_async_io_perform (GstAsyncIoOp * op)
+{
+#ifdef G_OS_WIN32
+  HANDLE h = (HANDLE) _get_osfhandle (op->fd);
+  OVERLAPPED overlapped = { 0, };
+  DWORD size = (DWORD) MIN (op->size, G_MAXUINT32), n;
+
+  overlapped.Offset = (DWORD) op->offset;
+  overlapped.OffsetHigh = (DWORD) (op->offset >> 32);
+
+  switch (op->type) {
+    case GST_ASYNC_IO_OP_READ:
+      if (!ReadFile (h, op->data, size, &n, &overlapped))
+        return GetLastError () == ERROR_HANDLE_EOF ? 0 : -EIO;
+      return n;
+    case GST_ASYNC_IO_OP_WRITE:
+      if (!WriteFile (h, op->data, size, &n, &overlapped))
+        return GetLastError () == ERROR_DISK_FULL ? -ENOSPC : -EIO;
+      return n;
+    default:
+      return -ENOSYS;
+  }
+#else
+  gssize ret;
+
+  do {
+    switch (op->type) {
+      case GST_ASYNC_IO_OP_READ:
+        ret = pread (op->fd, op->data, op->size, op->offset);
+        break;
+      case GST_ASYNC_IO_OP_WRITE:
+        ret = pwrite (op->fd, op->data, op->size, op->offset);
+        break;
+      default:
+#ifdef SYNC_FILE_RANGE_WRITE
+        ret = sync_file_range (op->fd, op->offset, op->size,
+            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+            SYNC_FILE_RANGE_WAIT_AFTER);
+#else
+        errno = ENOSYS;
+        ret = -1;
+#endif
+        break;
+    }
+  } while (ret < 0 && (errno == EINTR || errno == EAGAIN));
+
+  return ret < 0 ? -errno : ret;
+#endif
+}
+
+static void
+gst_async_io_thread_func (GstAsyncIoOp * op, GstAsyncIo * aio)
+{
+  op->result = gst_async_io_perform (op);
+  g_async_queue_push (aio->done, op);
+}
+
+/**
+ * gst_async_io_new:
+ * @depth: the maximum number of operations in flight
+ *
+ * Creates a queue for up to @depth background operations, using io_uring if
+ * the kernel allows it and a pool of @depth threads otherwise.
+ *
+ * Returns: a new #GstAsyncIo, free with gst_async_io_free()
+ */
+GstAsyncIo *
+gst_async_io_new (guint depth)
+{
+  GstAsyncIo *aio;
+
+  g_return_val_if_fail (depth > 0, NULL);
+
+  aio = g_new0 (GstAsyncIo, 1);
+  aio->depth = depth;
+
+#ifdef HAVE_IO_URING
+  aio->ring = gst_io_uring_new (depth);
+  if (aio->ring)
+    return aio;
+#endif
+
+  aio->done = g_async_queue_new ();
+  aio->pool = g_thread_pool_new ((GFunc) gst_async_io_thread_func, aio, depth,
+      FALSE, NULL);
+
+  return aio;
+}
+
+/**
+ * gst_async_io_free:
+ * @aio: a #GstAsyncIo
+ *
+ * Frees @aio. Operations that are still in flight are waited for, but their
+ * completions are dropped, so the caller should collect them with
+ * gst_async_io_wait() first if it needs to release their memory.
+ */
+void
+gst_async_io_free (GstAsyncIo * aio)
+{
+  gpointer user_data;
+  gssize result;
+
+  g_return_if_fail (aio != NULL);
+
+  /* the kernel or a thread may still be writing into the memory */
+  while (gst_async_io_wait (aio, &user_data, &result));
+
+#ifdef HAVE_IO_URING
+  if (aio->ring)
+    gst_io_uring_free (aio->ring);
+#endif
+  if (aio->pool)
+    g_thread_pool_free (aio->pool, FALSE, TRUE);
+  if (aio->done)
+    g_async_queue_unref (aio->done);
+  g_free (aio);
+}
+
+/**
+ * gst_async_io_get_backend:
+ * @aio: a #GstAsyncIo
+ *
+ * Returns: "io_uring" or "threads", for debugging
+ */
+const gchar *
+gst_async_io_get_backend (GstAsyncIo * aio)
+{
+#ifdef HAVE_IO_URING
+  if (aio->ring)
+    return "io_uring";
+#endif
+  return "threads";
+}
+
+guint
+gst_async_io_get_depth (GstAsyncIo * aio)
+{
+  return aio->depth;
+}
+
+guint
+gst_async_io_get_in_flight (GstAsyncIo * aio)
+{
+  return aio->in_flight;
+}
+
+static gboolean
+gst_async_io_submit (GstAsyncIo * aio, GstAsyncIoOpType type, gint fd,
+    gpointer data, gsize size, guint64 offset, gpointer user_data)
+{
+  GstAsyncIoOp *op;
+  gboolean res;
+
+  g_return_val_if_fail (aio->in_flight < aio->depth, FALSE);
+
+  op = g_new0 (GstAsyncIoOp, 1);
+  op->type = type;
+  op->fd = fd;
+  op->data = data;
+  op->size = size;
+  op->offset = offset;
+  op->user_data = user_data;
+
+#ifdef HAVE_IO_URING
+  if (aio->ring)
+    res = gst_io_uring_submit (aio->ring, op);
+  else
+#endif
+    res = g_thread_pool_push (aio->pool, op, NULL);
+
+  if (!res) {
+    g_free (op);
+    return FALSE;
+  }
+
+  aio->in_flight++;
+  return TRUE;
+}
+
+/**
+ * gst_async_io_read:
+ * @aio: a #GstAsyncIo
+ * @fd: the file descriptor to read from
+ * @data: where to store the data, must stay valid until the read completes
+ * @size: the number of bytes to read
+ * @offset: the position in the file to read from
+ * @user_data: returned by gst_async_io_wait() for this read
+ *
+ * Starts reading @size bytes at @offset in the background. The file position
+ * of @fd is not used. There must be less than the depth of @aio operations
+ * in flight.
+ *
+ * Returns: %TRUE if the read was started
+ */
+gboolean
+gst_async_io_read (GstAsyncIo * aio, gint fd, gpointer data, gsize size,
+    guint64 offset, gpointer user_data)
+{
+  return gst_async_io_submit (aio, GST_ASYNC_IO_OP_READ, fd, data, size,
+      offset, user_data);
+}
+
+/**
+ * gst_async_io_write:
+ * @aio: a #GstAsyncIo
+ * @fd: the file descriptor to write to
+ * @data: the data, must stay valid until the write completes
+ * @size: the number of bytes to write
+ * @offset: the position in the file to write at
+ * @user_data: returned by gst_async_io_wait() for this write
+ *
+ * Like gst_async_io_read(), but writes. @fd must not have been opened with
+ * O_APPEND.
+ *
+ * Returns: %TRUE if the write was started
+ */
+gboolean
+gst_async_io_write (GstAsyncIo * aio, gint fd, gconstpointer data, gsize size,
+    guint64 offset, gpointer user_data)
+{
+  return gst_async_io_submit (aio, GST_ASYNC_IO_OP_WRITE, fd, (gpointer) data,
+      size, offset, user_data);
+}
+
+/**
+ * gst_async_io_sync_range:
+ * @aio: a #GstAsyncIo
+ * @fd: the file descriptor
+ * @offset: the start of the range
+ * @size: the size of the range
+ * @user_data: returned by gst_async_io_wait() for this operation
+ *
+ * Writes back the dirty pages of a range of the file in the background and
+ * waits for them, with sync_file_range(). This does not flush the metadata
+ * of the file, nor the disk caches. Completes with -ENOSYS on systems that
+ * don't have sync_file_range().
+ *
+ * Returns: %TRUE if the operation was started
+ */
+gboolean
+gst_async_io_sync_range (GstAsyncIo * aio, gint fd, guint64 offset,
+    gsize size, gpointer user_data)
+{
+  return gst_async_io_submit (aio, GST_ASYNC_IO_OP_SYNC_RANGE, fd, NULL, size,
+      offset, user_data);
+}
+
+static gboolean
+gst_async_io_complete (GstAsyncIo * aio, gboolean block, gpointer * user_data,
+    gssize * result)
+{
+  GstAsyncIoOp *op = NULL;
+
+  if (aio->in_flight == 0)
+    return FALSE;
+
+#ifdef HAVE_IO_URING
+  if (aio->ring) {
+    while ((op = gst_io_uring_wait (aio->ring, block))) {
+      if (op->result != -EAGAIN && op->result != -EINTR)
+        break;
+      /* interrupted before anything was transferred, try again */
+      if (!gst_io_uring_submit (aio->ring, op)) {
+        op->result = -EIO;
+        break;
+      }
+    }
+  } else
+#endif
+  if (block)
+    op = g_async_queue_pop (aio->done);
+  else
+    op = g_async_queue_try_pop (aio->done);
+
+  if (op == NULL)
+    return FALSE;
+
+  aio->in_flight--;
+  *user_data = op->user_data;
+  *result = op->result;
+  g_free (op);
+
+  return TRUE;
+}
+
+/**
+ * gst_async_io_wait:
+ * @aio: a #GstAsyncIo
+ * @user_data: (out): the user data of the operation that completed
+ * @result: (out): the number of bytes transferred, or a negative errno
+ *
+ * Waits for any of the operations in flight to complete. Short reads and
+ * writes are returned as they are, a result smaller than the requested size
+ * does not necessarily mean the end of the file was reached.
+ *
+ * Returns: %FALSE if there was nothing in flight
+ */
+gboolean
+gst_async_io_wait (GstAsyncIo * aio, gpointer * user_data, gssize * result)
+{
+  return gst_async_io_complete (aio, TRUE, user_data, result);
+}
+
+/**
+ * gst_async_io_poll:
+ * @aio: a #GstAsyncIo
+ * @user_data: (out): the user data of the operation that completed
+ * @result: (out): the number of bytes transferred, or a negative errno
+ *
+ * Like gst_async_io_wait(), but does not block.
+ *
+ * Returns: %FALSE if no operation has completed yet
+ */
+gboolean
+gst_async_io_poll (GstAsyncIo * aio, gpointer * user_data, gssize * result)
+{
+  return gst_async_io_complete (aio, FALSE, user_data, result);
+}
@@ -0,0 +1,68 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <glib.h>
+
+#ifndef __GST_ASYNC_IO_H__
+#define __GST_ASYNC_IO_H__
+
+G_BEGIN_DECLS
+
+typedef struct _GstAsyncIo GstAsyncIo;
+
+G_GNUC_INTERNAL
+GstAsyncIo *   gst_async_io_new          (guint depth);
+
+G_GNUC_INTERNAL
+void           gst_async_io_free         (GstAsyncIo *aio);
+
+G_GNUC_INTERNAL
+const gchar *  gst_async_io_get_backend  (GstAsyncIo *aio);
+
+G_GNUC_INTERNAL
+guint          gst_async_io_get_depth    (GstAsyncIo *aio);
+
+G_GNUC_INTERNAL
+guint          gst_async_io_get_in_flight (GstAsyncIo *aio);
+
+G_GNUC_INTERNAL
+gboolean       gst_async_io_read         (GstAsyncIo *aio, gint fd,
+                                          gpointer data, gsize size,
+                                          guint64 offset, gpointer user_data);
+
+G_GNUC_INTERNAL
+gboolean       gst_async_io_write        (GstAsyncIo *aio, gint fd,
+                                          gconstpointer data, gsize size,
+                                          guint64 offset, gpointer user_data);
+
+G_GNUC_INTERNAL
+gboolean       gst_async_io_sync_range   (GstAsyncIo *aio, gint fd,
+                                          guint64 offset, gsize size,
+                                          gpointer user_data);
+
+G_GNUC_INTERNAL
+gboolean       gst_async_io_wait         (GstAsyncIo *aio, gpointer *user_data,
+                                          gssize *result);
+
+G_GNUC_INTERNAL
+gboolean       gst_async_io_poll         (GstAsyncIo *aio, gpointer *user_data,
+                                          gssize *result);
+
+G_END_DECLS
+
+#endif /* __GST_ASYNC_IO_H__ */
@@ -30,12 +30,23 @@
  * This element will synchronize on the clock before writing the data on the
  * socket. For file descriptors where this does not make sense (files, ...) the
  * #GstBaseSink:sync property can be used to disable synchronisation.
+ *
+ * ## Example launch line
+ * |[
+ * gst-launch-1.0 filesrc location=video.ts ! fdsink zero-copy=true | other-process
+ * ]| Hand the data over to another process through a pipe without copying
+ * it into the pipe.
  */
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
+/* for vmsplice() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <glib/gi18n-lib.h>
 
 #include <sys/types.h>
@@ -57,6 +68,11 @@
 #endif
 #include <errno.h>
 #include <string.h>
+#ifdef HAVE_VMSPLICE
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <poll.h>
+#endif
 
 #include "gstfdsink.h"
 #include "gstelements_private.h"
@@ -97,10 +113,13 @@ enum
   LAST_SIGNAL
 };
 
+#define DEFAULT_ZERO_COPY       FALSE
+
 enum
 {
   ARG_0,
-  ARG_FD
+  ARG_FD,
+  ARG_ZERO_COPY
 };
 
 static void gst_fd_sink_uri_handler_init (gpointer g_iface,
@@ -167,6 +186,28 @@ gst_fd_sink_class_init (GstFdSinkClass * klass)
   g_object_class_install_property (gobject_class, ARG_FD,
       g_param_spec_int ("fd", "fd", "An open file descriptor to write to",
           0, G_MAXINT, 1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstFdSink:zero-copy:
+   *
+   * When the file descriptor is a pipe, map the buffers into the pipe with
+   * vmsplice() instead of copying them. The memory of the buffers is kept
+   * until the reader took their data out of the pipe, and on EOS until it
+   * took all of it. The buffers themselves are released right away, so a
+   * buffer pool allocates new memory instead of waiting for the reader. The
+   * reader has to copy the data with read(), when it splices it further the
+   * data may change after it left the pipe. Buffers that are not in system
+   * memory and other file descriptors are written as usual.
+   *
+   * Only supported on Linux.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, ARG_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy",
+          "Splice buffers into pipes instead of copying them",
+          DEFAULT_ZERO_COPY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
 }
 
 static void
@@ -175,6 +216,9 @@ gst_fd_sink_init (GstFdSink * fdsink)
   fdsink->fd = 1;
   fdsink->uri = g_strdup_printf ("fd://%d", fdsink->fd);
   fdsink->current_pos = 0;
+  fdsink->zero_copy = DEFAULT_ZERO_COPY;
+  fdsink->splice_fd = -1;
+  g_queue_init (&fdsink->spliced);
 
   gst_base_sink_set_sync (GST_BASE_SINK (fdsink), FALSE);
 }
@@ -245,6 +289,262 @@ gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query)
   return res;
 }
 
+#ifdef HAVE_VMSPLICE
+typedef struct
+{
+  GstMemory *memory;
+  guint64 end;                  /* bytes_spliced once it was in the pipe */
+} GstFdSinkSpliced;
+
+/* the memory is in the pipe until the reader takes it, so it is only
+ * released once that happened */
+static void
+gst_fd_sink_release_spliced (GstFdSink * sink, gboolean all)
+{
+  GstFdSinkSpliced *spliced;
+  guint64 consumed = sink->bytes_spliced;
+  gint in_pipe = 0;
+
+  /* counts what other writers put in the pipe too, which only delays
+   * releasing the buffers */
+  if (!all && ioctl (sink->splice_fd, FIONREAD, &in_pipe) == 0)
+    consumed -= MIN ((guint64) in_pipe, consumed);
+
+  while ((spliced = g_queue_peek_head (&sink->spliced)) &&
+      spliced->end <= consumed) {
+    g_queue_pop_head (&sink->spliced);
+    gst_memory_unlock (spliced->memory, GST_LOCK_FLAG_EXCLUSIVE);
+    gst_memory_unref (spliced->memory);
+    g_free (spliced);
+  }
+}
+
+/* waits until the reader took everything that was spliced or went away,
+ * until flushing or, if not -1, until the monotonic time deadline. A pipe
+ * only tells the writer that it was read from when it was full, so what is
+ * left in it is checked again after a timeout that grows while the reader
+ * is idle. The wait ends right away when the reader closes the pipe or the
+ * sink is unlocked */
+static void
+gst_fd_sink_wait_spliced (GstFdSink * sink, gint64 deadline)
+{
+  GstClockTime timeout = GST_MSECOND;
+
+  for (;;) {
+    GstClockTime wait = timeout;
+    gboolean gone;
+    gint res;
+
+    gst_fd_sink_release_spliced (sink, FALSE);
+    if (g_queue_is_empty (&sink->spliced))
+      break;
+
+    if (deadline != -1) {
+      gint64 left = deadline - g_get_monotonic_time ();
+
+      if (left <= 0)
+        break;
+      wait = MIN (wait, left * GST_USECOND);
+    } else if (g_atomic_int_get (&sink->unlock)) {
+      break;
+    }
+
+    if (sink->splice_fd == sink->fd) {
+      GstPollFD fd = GST_POLL_FD_INIT;
+
+      /* only woken up by errors, hangups and unlocking */
+      fd.fd = sink->fd;
+      gst_poll_fd_ctl_write (sink->fdset, &fd, FALSE);
+      res = gst_poll_wait (sink->fdset, wait);
+      gst_poll_fd_ctl_write (sink->fdset, &fd, TRUE);
+
+      if (res < 0 && errno == EBUSY)
+        break;
+      gone = res > 0 && (gst_poll_fd_has_error (sink->fdset, &fd) ||
+          gst_poll_fd_has_closed (sink->fdset, &fd));
+    } else {
+      /* the fd changed, the old one is not in the set anymore */
+      struct pollfd pfd;
+
+      pfd.fd = sink->splice_fd;
+      pfd.events = 0;
+      pfd.revents = 0;
+      res = poll (&pfd, 1, GST_TIME_AS_MSECONDS (wait + GST_MSECOND - 1));
+      gone = res > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL));
+    }
+
+    if (gone) {
+      GST_DEBUG_OBJECT (sink, "nobody reads from the pipe anymore");
+      gst_fd_sink_release_spliced (sink, TRUE);
+      break;
+    }
+
+    timeout = MIN (timeout * 2, 64 * GST_MSECOND);
+  }
+}
+
+/* gives the buffers back even if the reader did not take them, it might
+ * see them change after this */
+static void
+gst_fd_sink_flush_spliced (GstFdSink * sink)
+{
+  if (g_queue_is_empty (&sink->spliced))
+    return;
+
+  gst_fd_sink_wait_spliced (sink, g_get_monotonic_time () + G_USEC_PER_SEC);
+  if (!g_queue_is_empty (&sink->spliced)) {
+    GST_WARNING_OBJECT (sink, "releasing %u buffers that are still in the "
+        "pipe", g_queue_get_length (&sink->spliced));
+    gst_fd_sink_release_spliced (sink, TRUE);
+  }
+}
+
+static void
+gst_fd_sink_update_splice (GstFdSink * sink)
+{
+  struct_stat stat_results;
+
+  gst_fd_sink_flush_spliced (sink);
+
+  sink->splice_fd = sink->fd;
+  sink->splice = sink->zero_copy && fstat (sink->fd, &stat_results) == 0 &&
+      S_ISFIFO (stat_results.st_mode);
+
+  GST_INFO_OBJECT (sink, "%s into file descriptor %d",
+      sink->splice ? "splicing" : "writing", sink->fd);
+}
+
+static gboolean
+gst_fd_sink_can_splice (GstBuffer * buffer)
+{
+  guint i, n_mem = gst_buffer_n_memory (buffer);
+
+  /* only memory that stays valid after unmapping it */
+  for (i = 0; i < n_mem; i++) {
+    if (!gst_memory_is_type (gst_buffer_peek_memory (buffer, i),
+            GST_ALLOCATOR_SYSMEM))
+      return FALSE;
+  }
+
+  return n_mem > 0;
+}
+
+/* returns GST_FLOW_NOT_SUPPORTED if the rest has to be written instead */
+static GstFlowReturn
+gst_fd_sink_splice_buffer (GstFdSink * sink, GstBuffer * buffer,
+    guint64 * bytes_written, guint64 skip)
+{
+  GstFlowReturn flow = GST_FLOW_OK;
+  GstFdSinkSpliced *spliced;
+  GstMapInfo maps[16];
+  struct iovec vecs[16];
+  guint i, n_mem, first = 0, start;
+  guint64 left;
+  gssize ret;
+  gint res;
+
+  *bytes_written = 0;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  g_assert (n_mem <= G_N_ELEMENTS (maps));
+
+  for (i = 0; i < n_mem; i++) {
+    if (!gst_memory_map (gst_buffer_peek_memory (buffer, i), &maps[i],
+            GST_MAP_READ)) {
+      n_mem = i;
+      flow = GST_FLOW_NOT_SUPPORTED;
+      goto out;
+    }
+    vecs[i].iov_base = maps[i].data;
+    vecs[i].iov_len = maps[i].size;
+  }
+
+  /* continue after what was spliced before flushing */
+  while (first < n_mem && skip >= vecs[first].iov_len) {
+    skip -= vecs[first].iov_len;
+    first++;
+  }
+  if (first < n_mem) {
+    vecs[first].iov_base = (guint8 *) vecs[first].iov_base + skip;
+    vecs[first].iov_len -= skip;
+  }
+  start = first;
+
+  while (first < n_mem) {
+    ret = vmsplice (sink->fd, vecs + first, n_mem - first, SPLICE_F_NONBLOCK);
+
+    if (ret > 0) {
+      *bytes_written += ret;
+      while (first < n_mem && (gsize) ret >= vecs[first].iov_len) {
+        ret -= vecs[first].iov_len;
+        first++;
+      }
+      if (first < n_mem) {
+        vecs[first].iov_base = (guint8 *) vecs[first].iov_base + ret;
+        vecs[first].iov_len -= ret;
+      }
+    } else if (ret == 0 || errno == EAGAIN) {
+      /* the pipe is full, wait until the reader took some */
+      do {
+        res = gst_poll_wait (sink->fdset, GST_CLOCK_TIME_NONE);
+      } while (res == -1 && (errno == EINTR || errno == EAGAIN));
+
+      if (res == -1) {
+        if (errno == EBUSY) {
+          flow = GST_FLOW_FLUSHING;
+        } else {
+          GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
+              ("select on file descriptor: %s", g_strerror (errno)));
+          flow = GST_FLOW_ERROR;
+        }
+        break;
+      }
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno == EINVAL || errno == ENOSYS || errno == EBADF) {
+      GST_WARNING_OBJECT (sink, "can't splice into file descriptor %d, "
+          "writing instead: %s", sink->fd, g_strerror (errno));
+      sink->splice = FALSE;
+      flow = GST_FLOW_NOT_SUPPORTED;
+      break;
+    } else {
+      GST_ELEMENT_ERROR (sink, RESOURCE, WRITE, (NULL),
+          ("Error while writing to file descriptor %d: %s", sink->fd,
+              g_strerror (errno)));
+      flow = GST_FLOW_ERROR;
+      break;
+    }
+  }
+
+  /* keep the memory that went into the pipe but not the buffer, so that
+   * it can go back to its pool. The exclusive lock makes the memory
+   * unwritable, so the pool drops it and allocates new memory instead of
+   * handing it out again before the reader took it */
+  left = *bytes_written;
+  for (i = start; i < n_mem && left > 0; i++) {
+    gsize size = maps[i].size - (i == start ? skip : 0);
+
+    size = MIN (size, left);
+    left -= size;
+    sink->bytes_spliced += size;
+
+    spliced = g_new (GstFdSinkSpliced, 1);
+    spliced->memory = gst_memory_ref (gst_buffer_peek_memory (buffer, i));
+    gst_memory_lock (spliced->memory, GST_LOCK_FLAG_EXCLUSIVE);
+    spliced->end = sink->bytes_spliced;
+    g_queue_push_tail (&sink->spliced, spliced);
+  }
+
+out:
+  for (i = 0; i < n_mem; i++)
+    gst_memory_unmap (gst_buffer_peek_memory (buffer, i), &maps[i]);
+
+  gst_fd_sink_release_spliced (sink, FALSE);
+
+  return flow;
+}
+#endif
+
 static GstFlowReturn
 gst_fd_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
 {
@@ -259,6 +559,18 @@ gst_fd_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
   if (num_buffers == 0)
     goto no_data;
 
+#ifdef HAVE_VMSPLICE
+  if (sink->zero_copy) {
+    guint i;
+
+    ret = GST_FLOW_OK;
+    for (i = 0; i < num_buffers && ret == GST_FLOW_OK; i++)
+      ret = gst_fd_sink_render (bsink, gst_buffer_list_get (buffer_list, i));
+
+    return ret;
+  }
+#endif
+
   for (;;) {
     guint64 bytes_written = 0;
 
@@ -297,23 +609,48 @@ gst_fd_sink_render (GstBaseSink * bsink, GstBuffer * buffer)
   GstFdSink *sink;
   GstFlowReturn ret;
   guint64 skip = 0;
+#ifdef HAVE_VMSPLICE
+  gboolean splice;
+#endif
 
   sink = GST_FD_SINK_CAST (bsink);
 
+#ifdef HAVE_VMSPLICE
+  if (sink->zero_copy && sink->fd != sink->splice_fd)
+    gst_fd_sink_update_splice (sink);
+  splice = sink->splice && gst_fd_sink_can_splice (buffer);
+#endif
+
   for (;;) {
     guint64 bytes_written = 0;
 
+#ifdef HAVE_VMSPLICE
+    if (splice) {
+      ret = gst_fd_sink_splice_buffer (sink, buffer, &bytes_written, skip);
+
+      sink->current_pos += bytes_written;
+      skip += bytes_written;
+
+      /* write the rest */
+      if (ret == GST_FLOW_NOT_SUPPORTED) {
+        splice = FALSE;
+        continue;
+      }
+    } else
+#endif
+    {
 #ifdef G_OS_WIN32
-    int cur_mode = _setmode (sink->fd, O_BINARY);
+      int cur_mode = _setmode (sink->fd, O_BINARY);
 #endif
-    ret = gst_writev_buffer (GST_OBJECT_CAST (sink), sink->fd, sink->fdset,
-        buffer, &bytes_written, skip, 0, -1, NULL);
+      ret = gst_writev_buffer (GST_OBJECT_CAST (sink), sink->fd, sink->fdset,
+          buffer, &bytes_written, skip, 0, -1, NULL);
 #ifdef G_OS_WIN32
-    _setmode (sink->fd, cur_mode);
+      _setmode (sink->fd, cur_mode);
 #endif
 
-    sink->current_pos += bytes_written;
-    skip += bytes_written;
+      sink->current_pos += bytes_written;
+      skip += bytes_written;
+    }
 
     if (!sink->unlock || ret != GST_FLOW_FLUSHING)
       break;
@@ -392,6 +729,11 @@ gst_fd_sink_start (GstBaseSink * basesink)
   fdsink->seekable = gst_fd_sink_do_seek (fdsink, 0);
   GST_INFO_OBJECT (fdsink, "seeking supported: %d", fdsink->seekable);
 
+  fdsink->bytes_spliced = 0;
+#ifdef HAVE_VMSPLICE
+  gst_fd_sink_update_splice (fdsink);
+#endif
+
   return TRUE;
 
   /* ERRORS */
@@ -408,6 +750,12 @@ gst_fd_sink_stop (GstBaseSink * basesink)
 {
   GstFdSink *fdsink = GST_FD_SINK (basesink);
 
+#ifdef HAVE_VMSPLICE
+  gst_fd_sink_flush_spliced (fdsink);
+#endif
+  fdsink->splice = FALSE;
+  fdsink->splice_fd = -1;
+
   if (fdsink->fdset) {
     gst_poll_free (fdsink->fdset);
     fdsink->fdset = NULL;
@@ -498,6 +846,9 @@ gst_fd_sink_set_property (GObject * object, guint prop_id,
       gst_fd_sink_update_fd (fdsink, fd, NULL);
       break;
     }
+    case ARG_ZERO_COPY:
+      fdsink->zero_copy = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -516,6 +867,9 @@ gst_fd_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_FD:
       g_value_set_int (value, fdsink->fd);
       break;
+    case ARG_ZERO_COPY:
+      g_value_set_boolean (value, fdsink->zero_copy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +937,12 @@ gst_fd_sink_event (GstBaseSink * sink, GstEvent * event)
       }
       break;
     }
+#ifdef HAVE_VMSPLICE
+    case GST_EVENT_EOS:
+      /* only done once the reader has all the data */
+      gst_fd_sink_wait_spliced (fdsink, -1);
+      break;
+#endif
     default:
       break;
   }
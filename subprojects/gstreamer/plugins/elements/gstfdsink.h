@@ -62,6 +62,15 @@ struct _GstFdSink {
 
   gboolean seekable;
   gboolean unlock; /* OBJECT LOCK */
+
+  gboolean zero_copy;
+
+  /* memory that was spliced into the pipe and that the reader may not
+   * have taken yet */
+  gboolean splice;
+  gint splice_fd;
+  GQueue spliced;
+  guint64 bytes_spliced;
 };
 
 struct _GstFdSinkClass {
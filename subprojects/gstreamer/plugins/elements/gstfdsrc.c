@@ -44,6 +44,9 @@
  * echo "Hello GStreamer" | gst-launch-1.0 -v fdsrc ! fakesink dump=true
  * ]| A simple pipeline to read from the standard input and dump the data
  * with a fakesink as hex ascii block.
+ * |[
+ * gst-launch-1.0 fdsrc zero-copy=true blocksize=65536 < video.ts ! tsdemux ! fakesink
+ * ]| Read a file from the standard input by mapping it instead of copying it.
  *
  */
 
@@ -77,6 +80,9 @@
 #endif
 #include <stdlib.h>
 #include <errno.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 #include "gstfdsrc.h"
 #include "gstcoreelementselements.h"
@@ -102,6 +108,10 @@ GST_DEBUG_CATEGORY_STATIC (gst_fd_src_debug);
 
 #define DEFAULT_FD              0
 #define DEFAULT_TIMEOUT         0
+#define DEFAULT_ZERO_COPY       FALSE
+
+/* how much of the file is mapped at once in zero-copy mode */
+#define MAP_WINDOW_SIZE         (8 * 1024 * 1024)
 
 enum
 {
@@ -110,6 +120,7 @@ enum
   PROP_FD,
   PROP_TIMEOUT,
   PROP_IS_LIVE,
+  PROP_ZERO_COPY,
 
   PROP_LAST
 };
@@ -184,6 +195,24 @@ gst_fd_src_class_init (GstFdSrcClass * klass)
       g_param_spec_boolean ("is-live", "is-live", "Act like a live source",
           FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFdSrc:zero-copy:
+   *
+   * When the file descriptor is a regular file, map it into memory and
+   * return buffers that point into the mapping instead of reading into new
+   * memory. A part of the file stays mapped for as long as buffers from it
+   * exist. The file must not be truncated while it is read this way.
+   *
+   * The data in pipes and sockets can't be mapped and is always read.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_ZERO_COPY,
+      g_param_spec_boolean ("zero-copy", "Zero copy",
+          "Map regular files instead of reading them", DEFAULT_ZERO_COPY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Filedescriptor Source",
       "Source/File",
@@ -212,6 +241,7 @@ gst_fd_src_init (GstFdSrc * fdsrc)
   fdsrc->timeout = DEFAULT_TIMEOUT;
   fdsrc->uri = g_strdup_printf ("fd://0");
   fdsrc->curoffset = 0;
+  fdsrc->zero_copy = DEFAULT_ZERO_COPY;
 }
 
 static void
@@ -255,6 +285,12 @@ gst_fd_src_update_fd (GstFdSrc * src, guint64 size)
 
     src->fd = src->new_fd;
 
+    if (src->window) {
+      gst_memory_unref (src->window);
+      src->window = NULL;
+    }
+    src->map_failed = FALSE;
+
     GST_INFO_OBJECT (src, "Setting size to fd %" G_GUINT64_FORMAT, size);
     src->size = size;
 
@@ -292,6 +328,7 @@ gst_fd_src_start (GstBaseSrc * bsrc)
   GstFdSrc *src = GST_FD_SRC (bsrc);
 
   src->curoffset = 0;
+  src->map_failed = FALSE;
 
   if ((src->fdset = gst_poll_new (TRUE)) == NULL)
     goto socket_pair;
@@ -319,6 +356,12 @@ gst_fd_src_stop (GstBaseSrc * bsrc)
     src->fdset = NULL;
   }
 
+  /* buffers that are still around keep their part mapped */
+  if (src->window) {
+    gst_memory_unref (src->window);
+    src->window = NULL;
+  }
+
   return TRUE;
 }
 
@@ -378,6 +421,9 @@ gst_fd_src_set_property (GObject * object, guint prop_id, const GValue * value,
       GST_DEBUG_OBJECT (src, "live set to %d", g_value_get_boolean (value));
       gst_base_src_set_live (GST_BASE_SRC (src), g_value_get_boolean (value));
       break;
+    case PROP_ZERO_COPY:
+      src->zero_copy = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -400,12 +446,129 @@ gst_fd_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_IS_LIVE:
       g_value_set_boolean (value, gst_base_src_is_live (GST_BASE_SRC (src)));
       break;
+    case PROP_ZERO_COPY:
+      g_value_set_boolean (value, src->zero_copy);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+#ifdef HAVE_SYS_MMAN_H
+typedef struct
+{
+  gpointer data;
+  gsize size;
+} GstFdSrcMapping;
+
+static void
+gst_fd_src_unmap (gpointer user_data)
+{
+  GstFdSrcMapping *mapping = user_data;
+
+  munmap (mapping->data, mapping->size);
+  g_free (mapping);
+}
+
+/* maps the part of the file from offset on, returns FALSE if it can't be
+ * mapped, with the window unset at the end of the file */
+static gboolean
+gst_fd_src_map_window (GstFdSrc * src, guint64 offset, guint blocksize)
+{
+  GstFdSrcMapping *mapping;
+  struct_stat stat_results;
+  guint64 start, page_size;
+  gsize size;
+  gpointer data;
+
+  if (fstat (src->fd, &stat_results) < 0)
+    return FALSE;
+
+  if (src->window) {
+    gst_memory_unref (src->window);
+    src->window = NULL;
+  }
+
+  if (offset >= (guint64) stat_results.st_size)
+    return TRUE;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  start = offset - offset % page_size;
+  size = MIN (MAX (MAP_WINDOW_SIZE, offset - start + blocksize),
+      stat_results.st_size - start);
+
+  data = mmap (NULL, size, PROT_READ, MAP_SHARED, src->fd, (off_t) start);
+  if (data == MAP_FAILED) {
+    GST_WARNING_OBJECT (src, "could not map %" G_GSIZE_FORMAT " bytes at %"
+        G_GUINT64_FORMAT ", reading instead: %s", size, start,
+        g_strerror (errno));
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (src, "mapped %" G_GSIZE_FORMAT " bytes at %"
+      G_GUINT64_FORMAT, size, start);
+
+  mapping = g_new (GstFdSrcMapping, 1);
+  mapping->data = data;
+  mapping->size = size;
+  src->window = gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, size,
+      0, size, mapping, gst_fd_src_unmap);
+  src->window_offset = start;
+
+  return TRUE;
+}
+
+/* returns GST_FLOW_NOT_SUPPORTED if the file has to be read instead */
+static GstFlowReturn
+gst_fd_src_create_mapped (GstFdSrc * src, guint blocksize,
+    GstBuffer ** outbuf)
+{
+  GstBuffer *buf;
+  off_t offset;
+  gsize size;
+
+  /* the position of the file descriptor is kept in sync like with read() */
+  offset = lseek (src->fd, 0, SEEK_CUR);
+  if (offset < 0)
+    return GST_FLOW_NOT_SUPPORTED;
+
+  if (src->window == NULL || (guint64) offset < src->window_offset ||
+      offset + blocksize > src->window_offset + src->window->size) {
+    if (!gst_fd_src_map_window (src, offset, blocksize))
+      return GST_FLOW_NOT_SUPPORTED;
+    if (src->window == NULL)
+      goto eos;
+  }
+
+  size = MIN (blocksize, src->window_offset + src->window->size - offset);
+  buf = gst_buffer_new ();
+  gst_buffer_append_memory (buf, gst_memory_share (src->window,
+          offset - src->window_offset, size));
+
+  if (lseek (src->fd, offset + size, SEEK_SET) < 0) {
+    gst_buffer_unref (buf);
+    return GST_FLOW_NOT_SUPPORTED;
+  }
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_TIMESTAMP (buf) = GST_CLOCK_TIME_NONE;
+  src->curoffset += size;
+
+  GST_LOG_OBJECT (src, "Mapped buffer of size %" G_GSIZE_FORMAT, size);
+
+  *outbuf = buf;
+
+  return GST_FLOW_OK;
+
+eos:
+  {
+    GST_DEBUG_OBJECT (src, "Mapped 0 bytes. EOS.");
+    return GST_FLOW_EOS;
+  }
+}
+#endif
+
 static GstFlowReturn
 gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
@@ -461,6 +624,18 @@ gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 
   blocksize = GST_BASE_SRC (src)->blocksize;
 
+#ifdef HAVE_SYS_MMAN_H
+  if (src->zero_copy && src->seekable_fd && !src->map_failed) {
+    GstFlowReturn ret = gst_fd_src_create_mapped (src, blocksize, outbuf);
+
+    if (ret != GST_FLOW_NOT_SUPPORTED)
+      return ret;
+
+    /* read this fd from now on */
+    src->map_failed = TRUE;
+  }
+#endif
+
   /* create the buffer */
   buf = gst_buffer_new_allocate (NULL, blocksize, NULL);
   if (G_UNLIKELY (buf == NULL))
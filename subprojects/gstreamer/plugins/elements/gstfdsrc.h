@@ -71,6 +71,12 @@ struct _GstFdSrc {
   GstPoll *fdset;
 
   gulong curoffset; /* current offset in file */
+
+  /* mapped part of a regular file in zero-copy mode */
+  gboolean zero_copy;
+  GstMemory *window;
+  guint64 window_offset;
+  gboolean map_failed;
 };
 
 struct _GstFdSrcClass {
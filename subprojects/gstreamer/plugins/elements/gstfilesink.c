@@ -31,6 +31,10 @@
  * |[
  * gst-launch-1.0 v4l2src num-buffers=1 ! jpegenc ! filesink location=capture1.jpeg
  * ]| Capture one frame from a v4l2 camera and save as jpeg image.
+ * |[
+ * gst-launch-1.0 videotestsrc num-buffers=1000 ! x264enc ! matroskamux ! filesink location=test.mkv write-behind=4 direct-io=true
+ * ]| Keep 4 writes of 1 MiB in flight while recording, bypassing the page
+ * cache.
  *
  */
 
@@ -38,6 +42,11 @@
 #  include "config.h"
 #endif
 
+/* for O_DIRECT and fallocate() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <glib/gi18n-lib.h>
 
 #include <gst/gst.h>
@@ -135,6 +144,25 @@ GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define DEFAULT_O_SYNC		FALSE
 #define DEFAULT_MAX_TRANSIENT_ERROR_TIMEOUT	0
 #define DEFAULT_FILE_MODE      GST_FILE_SINK_FILE_MODE_TRUNC
+#define DEFAULT_WRITE_BEHIND	0
+#define DEFAULT_WRITE_BEHIND_SIZE	(1024 * 1024)
+#define DEFAULT_DIRECT_IO	FALSE
+#define DEFAULT_PREALLOCATE	0
+#define DEFAULT_SYNC_INTERVAL	0
+
+/* blocks are aligned to this in memory and in the file, for O_DIRECT */
+#define WRITE_BEHIND_ALIGN	4096
+
+struct _GstFileSinkBlock
+{
+  GstMemory *mem;
+  GstMapInfo map;               /* mapped for as long as the block exists */
+  guint64 offset;               /* in the file */
+  gsize size;
+  gsize written;                /* by the previous short writes */
+  gboolean pending;
+  GstClockTime submitted;
+};
 
 enum
 {
@@ -146,6 +174,14 @@ enum
   PROP_O_SYNC,
   PROP_MAX_TRANSIENT_ERROR_TIMEOUT,
   PROP_FILE_MODE,
+  PROP_WRITE_BEHIND,
+  PROP_WRITE_BEHIND_SIZE,
+  PROP_DIRECT_IO,
+  PROP_PREALLOCATE,
+  PROP_SYNC_INTERVAL,
+  PROP_QUEUE_LEVEL,
+  PROP_AVERAGE_WRITE_LATENCY,
+  PROP_MAX_WRITE_LATENCY,
   PROP_LAST
 };
 
@@ -293,6 +329,132 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
           G_MAXINT, DEFAULT_MAX_TRANSIENT_ERROR_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFileSink:write-behind:
+   *
+   * Number of writes of #GstFileSink:write-behind-size bytes to keep in
+   * flight, with io_uring when the kernel allows it and a pool of threads
+   * otherwise. The data is copied into aligned blocks, one more than the
+   * number of writes, so that the next block is filled while the others are
+   * written. Rendering only blocks when all writes are still in flight. 0
+   * disables it and uses #GstFileSink:buffer-mode instead.
+   *
+   * Only seekable files that are not appended to are written behind.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_WRITE_BEHIND,
+      g_param_spec_uint ("write-behind", "Write behind",
+          "Number of writes to keep in flight (0 = write synchronously)",
+          0, 256, DEFAULT_WRITE_BEHIND,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:write-behind-size:
+   *
+   * Size of each write when #GstFileSink:write-behind is enabled, rounded
+   * up to a multiple of 4096 bytes.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_WRITE_BEHIND_SIZE,
+      g_param_spec_uint ("write-behind-size", "Write behind size",
+          "Size in bytes of each write behind", WRITE_BEHIND_ALIGN,
+          64 * 1024 * 1024, DEFAULT_WRITE_BEHIND_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:direct-io:
+   *
+   * Write the blocks with O_DIRECT when #GstFileSink:write-behind is
+   * enabled, so that they do not fill the page cache. Writes that are not
+   * aligned, like the last one or the ones after a seek, go through the
+   * page cache. Ignored if the file system or the system does not support
+   * it.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when writing behind", DEFAULT_DIRECT_IO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:preallocate:
+   *
+   * When #GstFileSink:write-behind is enabled, reserve space on disk this
+   * many bytes ahead of the writes with fallocate(), which keeps the file
+   * from getting fragmented. The size of the file is not changed and the
+   * space that was not written is given back when the file is closed.
+   * 0 disables it.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_PREALLOCATE,
+      g_param_spec_uint64 ("preallocate", "Preallocate",
+          "Bytes to allocate on disk ahead of the writes (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_PREALLOCATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:sync-interval:
+   *
+   * When #GstFileSink:write-behind is enabled, start writing back what was
+   * written to the disk with sync_file_range() every time this many bytes
+   * were written, instead of letting dirty pages accumulate in the page
+   * cache. This does not sync the metadata like fsync() does. 0 disables it.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_SYNC_INTERVAL,
+      g_param_spec_uint64 ("sync-interval", "Sync interval",
+          "Bytes after which written data is synced to disk (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_SYNC_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSink:queue-level:
+   *
+   * Number of writes that are in flight in #GstFileSink:write-behind mode.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_QUEUE_LEVEL,
+      g_param_spec_uint ("queue-level", "Queue level",
+          "Number of writes currently in flight", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstFileSink:average-write-latency:
+   *
+   * Average time in nanoseconds from queueing a write in
+   * #GstFileSink:write-behind mode until it was seen to be finished.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_AVERAGE_WRITE_LATENCY,
+      g_param_spec_uint64 ("average-write-latency", "Average write latency",
+          "Average latency of the writes behind in nanoseconds", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstFileSink:max-write-latency:
+   *
+   * Maximum time in nanoseconds from queueing a write in
+   * #GstFileSink:write-behind mode until it was seen to be finished.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_WRITE_LATENCY,
+      g_param_spec_uint64 ("max-write-latency", "Maximum write latency",
+          "Maximum latency of the writes behind in nanoseconds", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "File Sink",
       "Sink/File", "Write stream to a file",
@@ -329,6 +491,13 @@ gst_file_sink_init (GstFileSink * filesink)
   filesink->buffer_size = DEFAULT_BUFFER_SIZE;
   filesink->append = FALSE;
   filesink->file_mode = DEFAULT_FILE_MODE;
+  filesink->write_behind = DEFAULT_WRITE_BEHIND;
+  filesink->write_behind_size = DEFAULT_WRITE_BEHIND_SIZE;
+  filesink->direct_io = DEFAULT_DIRECT_IO;
+  filesink->preallocate = DEFAULT_PREALLOCATE;
+  filesink->sync_interval = DEFAULT_SYNC_INTERVAL;
+  filesink->wb_fd = -1;
+  filesink->direct_fd = -1;
 
   gst_base_sink_set_sync (GST_BASE_SINK (filesink), FALSE);
 }
@@ -409,6 +578,21 @@ gst_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_TRANSIENT_ERROR_TIMEOUT:
       sink->max_transient_error_timeout = g_value_get_int (value);
       break;
+    case PROP_WRITE_BEHIND:
+      sink->write_behind = g_value_get_uint (value);
+      break;
+    case PROP_WRITE_BEHIND_SIZE:
+      sink->write_behind_size = g_value_get_uint (value);
+      break;
+    case PROP_DIRECT_IO:
+      sink->direct_io = g_value_get_boolean (value);
+      break;
+    case PROP_PREALLOCATE:
+      sink->preallocate = g_value_get_uint64 (value);
+      break;
+    case PROP_SYNC_INTERVAL:
+      sink->sync_interval = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -443,12 +627,395 @@ gst_file_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_TRANSIENT_ERROR_TIMEOUT:
       g_value_set_int (value, sink->max_transient_error_timeout);
       break;
+    case PROP_WRITE_BEHIND:
+      g_value_set_uint (value, sink->write_behind);
+      break;
+    case PROP_WRITE_BEHIND_SIZE:
+      g_value_set_uint (value, sink->write_behind_size);
+      break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, sink->direct_io);
+      break;
+    case PROP_PREALLOCATE:
+      g_value_set_uint64 (value, sink->preallocate);
+      break;
+    case PROP_SYNC_INTERVAL:
+      g_value_set_uint64 (value, sink->sync_interval);
+      break;
+    case PROP_QUEUE_LEVEL:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_uint (value, sink->queue_level);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_AVERAGE_WRITE_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_uint64 (value, sink->n_writes > 0 ?
+          sink->total_write_latency / sink->n_writes : 0);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_MAX_WRITE_LATENCY:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_uint64 (value, sink->max_write_latency);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* reserves disk space up to preallocate bytes after end */
+static void
+gst_file_sink_preallocate (GstFileSink * sink, guint64 end)
+{
+#if defined (HAVE_FALLOCATE) && defined (FALLOC_FL_KEEP_SIZE)
+  guint64 target;
+
+  if (sink->preallocate == 0 || end <= sink->preallocated)
+    return;
+
+  /* keep the size, the file would end in zeroes if we stopped early */
+  target = end + sink->preallocate;
+  if (fallocate (sink->wb_fd, FALLOC_FL_KEEP_SIZE, (off_t) sink->preallocated,
+          (off_t) (target - sink->preallocated)) == 0) {
+    GST_LOG_OBJECT (sink, "preallocated up to %" G_GUINT64_FORMAT, target);
+    sink->preallocated = target;
+  } else {
+    GST_WARNING_OBJECT (sink, "could not preallocate: %s", g_strerror (errno));
+    /* don't try again */
+    sink->preallocated = G_MAXUINT64;
+  }
+#endif
+}
+
+/* starts syncing what was written since the last time, if that is more
+ * than sync-interval bytes and no other sync is in flight */
+static void
+gst_file_sink_sync_range (GstFileSink * sink)
+{
+  guint64 written = sink->current_pos;
+  guint i;
+
+  if (sink->sync_interval == 0 || sink->sync_pending || sink->sync_failed)
+    return;
+
+  for (i = 0; i < sink->n_blocks; i++) {
+    if (sink->blocks[i].pending)
+      written = MIN (written, sink->blocks[i].offset);
+  }
+
+  /* nothing new, or we seeked back */
+  if (written <= sink->synced || written - sink->synced < sink->sync_interval)
+    return;
+
+  GST_LOG_OBJECT (sink, "syncing %" G_GUINT64_FORMAT "-%" G_GUINT64_FORMAT,
+      sink->synced, written);
+
+  if (gst_async_io_sync_range (sink->aio, sink->wb_fd, sink->synced,
+          written - sink->synced, NULL)) {
+    sink->sync_pending = TRUE;
+    sink->synced = written;
+  }
+}
+
+/* collects the finished writes, waiting for at least one if wait is TRUE */
+static GstFlowReturn
+gst_file_sink_reap_writes (GstFileSink * sink, gboolean wait)
+{
+  GstFileSinkBlock *block;
+  GstFlowReturn flow = GST_FLOW_OK;
+  GstClockTime latency;
+  gpointer user_data;
+  gssize result;
+
+  while (wait ? gst_async_io_wait (sink->aio, &user_data, &result) :
+      gst_async_io_poll (sink->aio, &user_data, &result)) {
+    wait = FALSE;
+
+    /* the sync_file_range() */
+    if (user_data == NULL) {
+      sink->sync_pending = FALSE;
+      if (result < 0) {
+        GST_WARNING_OBJECT (sink, "could not sync: %s", g_strerror (-result));
+        sink->sync_failed = TRUE;
+      }
+      continue;
+    }
+
+    block = user_data;
+    if (result == 0)
+      result = -EIO;
+
+    /* short write, queue the rest again */
+    if (result > 0 && block->written + result < block->size) {
+      block->written += result;
+      GST_DEBUG_OBJECT (sink, "short write at %" G_GUINT64_FORMAT,
+          block->offset + block->written);
+      if (gst_async_io_write (sink->aio, sink->wb_fd,
+              block->map.data + block->written, block->size - block->written,
+              block->offset + block->written, block))
+        continue;
+      result = -EIO;
+    }
+
+    latency = gst_util_get_timestamp () - block->submitted;
+    block->pending = FALSE;
+
+    GST_OBJECT_LOCK (sink);
+    sink->queue_level--;
+    sink->n_writes++;
+    sink->total_write_latency += latency;
+    sink->max_write_latency = MAX (sink->max_write_latency, latency);
+    GST_OBJECT_UNLOCK (sink);
+
+    if (result < 0 && flow == GST_FLOW_OK) {
+      if (result == -ENOSPC) {
+        GST_ELEMENT_ERROR (sink, RESOURCE, NO_SPACE_LEFT, (NULL),
+            ("%s", g_strerror (-result)));
+      } else {
+        GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+            (_("Error while writing to file \"%s\"."), sink->filename),
+            ("%s", g_strerror (-result)));
+      }
+      flow = GST_FLOW_ERROR;
+    }
+  }
+
+  return flow;
+}
+
+/* queues the write of the block that is being filled once fewer than
+ * write-behind writes are in flight, this is where a slow disk pushes back */
+static GstFlowReturn
+gst_file_sink_submit_block (GstFileSink * sink)
+{
+  GstFileSinkBlock *block = sink->fill_block;
+  GstFlowReturn flow = GST_FLOW_OK, ret;
+  gint fd = sink->wb_fd;
+  guint i;
+
+  if (sink->current_buffer_size == 0)
+    return GST_FLOW_OK;
+
+  block->offset = sink->current_pos;
+  block->size = sink->current_buffer_size;
+  block->written = 0;
+
+  gst_file_sink_preallocate (sink, block->offset + block->size);
+
+  /* O_DIRECT also needs the position and the size to be aligned */
+  if (sink->direct_fd >= 0 && block->offset % WRITE_BEHIND_ALIGN == 0 &&
+      block->size % WRITE_BEHIND_ALIGN == 0)
+    fd = sink->direct_fd;
+
+  /* failed writes free their block too */
+  while (sink->queue_level >= sink->write_behind) {
+    ret = gst_file_sink_reap_writes (sink, TRUE);
+    if (flow == GST_FLOW_OK)
+      flow = ret;
+  }
+
+  GST_LOG_OBJECT (sink, "writing %" G_GSIZE_FORMAT " bytes at %"
+      G_GUINT64_FORMAT, block->size, block->offset);
+
+  block->submitted = gst_util_get_timestamp ();
+  if (!gst_async_io_write (sink->aio, fd, block->map.data, block->size,
+          block->offset, block))
+    goto write_failed;
+
+  block->pending = TRUE;
+  sink->current_pos += block->size;
+  sink->current_buffer_size = 0;
+
+  GST_OBJECT_LOCK (sink);
+  sink->queue_level++;
+  GST_OBJECT_UNLOCK (sink);
+
+  /* at most write-behind of the blocks are pending now */
+  sink->fill_block = NULL;
+  for (i = 0; i < sink->n_blocks && sink->fill_block == NULL; i++) {
+    if (!sink->blocks[i].pending)
+      sink->fill_block = &sink->blocks[i];
+  }
+  g_assert (sink->fill_block != NULL);
+
+  return flow;
+
+  /* ERRORS */
+write_failed:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, WRITE,
+        (_("Error while writing to file \"%s\"."), sink->filename),
+        ("Could not queue write"));
+    sink->current_buffer_size = 0;
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* writes out the block that is being filled and waits for all writes */
+static GstFlowReturn
+gst_file_sink_write_behind_flush (GstFileSink * sink)
+{
+  GstFlowReturn flow, ret;
+
+  flow = gst_file_sink_submit_block (sink);
+
+  while (sink->queue_level > 0) {
+    ret = gst_file_sink_reap_writes (sink, TRUE);
+    if (flow == GST_FLOW_OK)
+      flow = ret;
+  }
+
+  return flow;
+}
+
+static GstFlowReturn
+gst_file_sink_write_behind (GstFileSink * sink, GstBuffer * buffer)
+{
+  GstFlowReturn flow;
+  gsize size, offset = 0, capacity, to_copy;
+
+  flow = gst_file_sink_reap_writes (sink, FALSE);
+  if (flow != GST_FLOW_OK)
+    return flow;
+
+  size = gst_buffer_get_size (buffer);
+
+  GST_DEBUG_OBJECT (sink, "Queueing buffer of %" G_GSIZE_FORMAT " bytes at "
+      "offset %" G_GUINT64_FORMAT, size,
+      sink->current_pos + sink->current_buffer_size);
+
+  while (offset < size) {
+    /* the first block after a seek ends where the next aligned one starts */
+    capacity = sink->block_size - sink->current_pos % WRITE_BEHIND_ALIGN;
+    to_copy = MIN (size - offset, capacity - sink->current_buffer_size);
+
+    gst_buffer_extract (buffer, offset,
+        sink->fill_block->map.data + sink->current_buffer_size, to_copy);
+    offset += to_copy;
+    sink->current_buffer_size += to_copy;
+
+    if (sink->current_buffer_size == capacity) {
+      flow = gst_file_sink_submit_block (sink);
+      if (flow != GST_FLOW_OK)
+        return flow;
+    }
+  }
+
+  gst_file_sink_sync_range (sink);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+gst_file_sink_write_behind_start (GstFileSink * sink)
+{
+  GstAllocationParams params;
+  GstFileSinkBlock *block;
+  guint i;
+
+  /* writes are positioned, they would all go to the end with O_APPEND */
+  sink->wb_fd = g_open (sink->filename, O_WRONLY, 0);
+  if (sink->wb_fd < 0) {
+    GST_WARNING_OBJECT (sink, "could not open for writing behind: %s",
+        g_strerror (errno));
+    return FALSE;
+  }
+
+  sink->direct_fd = -1;
+#ifdef O_DIRECT
+  if (sink->direct_io) {
+    sink->direct_fd = g_open (sink->filename, O_WRONLY | O_DIRECT, 0);
+    if (sink->direct_fd < 0)
+      GST_WARNING_OBJECT (sink, "could not open with O_DIRECT, not bypassing "
+          "the page cache: %s", g_strerror (errno));
+  }
+#endif
+
+  sink->block_size = GST_ROUND_UP_N (sink->write_behind_size,
+      WRITE_BEHIND_ALIGN);
+  /* one more to fill while write-behind others are written */
+  sink->n_blocks = sink->write_behind + 1;
+  sink->blocks = g_new0 (GstFileSinkBlock, sink->n_blocks);
+
+  gst_allocation_params_init (&params);
+  params.align = WRITE_BEHIND_ALIGN - 1;
+  for (i = 0; i < sink->n_blocks; i++) {
+    block = &sink->blocks[i];
+    block->mem = gst_allocator_alloc (NULL, sink->block_size, &params);
+    gst_memory_map (block->mem, &block->map, GST_MAP_WRITE);
+  }
+  sink->fill_block = &sink->blocks[0];
+
+  /* and one for the sync_file_range() */
+  sink->aio = gst_async_io_new (sink->n_blocks + 1);
+
+  sink->preallocated = sink->current_pos;
+  sink->synced = sink->current_pos;
+  sink->sync_pending = FALSE;
+  sink->sync_failed = FALSE;
+
+  GST_OBJECT_LOCK (sink);
+  sink->queue_level = 0;
+  sink->n_writes = 0;
+  sink->total_write_latency = 0;
+  sink->max_write_latency = 0;
+  GST_OBJECT_UNLOCK (sink);
+
+  GST_INFO_OBJECT (sink, "writing behind %u blocks of %" G_GSIZE_FORMAT
+      " bytes with %s%s", sink->write_behind, sink->block_size,
+      gst_async_io_get_backend (sink->aio),
+      sink->direct_fd >= 0 ? ", bypassing the page cache" : "");
+
+  return TRUE;
+}
+
+static void
+gst_file_sink_write_behind_stop (GstFileSink * sink)
+{
+  guint i;
+
+  if (sink->aio == NULL)
+    return;
+
+  /* waits for what is still in flight */
+  gst_async_io_free (sink->aio);
+  sink->aio = NULL;
+
+#if defined (HAVE_FALLOCATE) && defined (FALLOC_FL_KEEP_SIZE)
+  /* give back what was reserved after the end, truncating to the same size
+   * does that where punching a hole after the end does not */
+  if (sink->preallocate > 0 && sink->preallocated != G_MAXUINT64) {
+    struct stat stat_results;
+
+    if (fstat (sink->wb_fd, &stat_results) == 0 &&
+        sink->preallocated > (guint64) stat_results.st_size &&
+        ftruncate (sink->wb_fd, stat_results.st_size) != 0)
+      GST_WARNING_OBJECT (sink, "could not free preallocated space: %s",
+          g_strerror (errno));
+  }
+#endif
+
+  for (i = 0; i < sink->n_blocks; i++) {
+    gst_memory_unmap (sink->blocks[i].mem, &sink->blocks[i].map);
+    gst_memory_unref (sink->blocks[i].mem);
+  }
+  g_free (sink->blocks);
+  sink->blocks = NULL;
+  sink->n_blocks = 0;
+  sink->fill_block = NULL;
+
+  if (sink->direct_fd >= 0)
+    g_close (sink->direct_fd, NULL);
+  sink->direct_fd = -1;
+  g_close (sink->wb_fd, NULL);
+  sink->wb_fd = -1;
+
+  GST_OBJECT_LOCK (sink);
+  sink->queue_level = 0;
+  GST_OBJECT_UNLOCK (sink);
+}
+
 static gboolean
 gst_file_sink_open_file (GstFileSink * sink)
 {
@@ -476,7 +1043,11 @@ gst_file_sink_open_file (GstFileSink * sink)
     gst_buffer_list_unref (sink->buffer_list);
   sink->buffer_list = NULL;
 
-  if (sink->buffer_mode != GST_FILE_SINK_BUFFER_MODE_UNBUFFERED) {
+  if (sink->write_behind > 0 && sink->seekable && !sink->append &&
+      sink->file_mode != GST_FILE_SINK_FILE_MODE_APPEND &&
+      gst_file_sink_write_behind_start (sink)) {
+    sink->current_buffer_size = 0;
+  } else if (sink->buffer_mode != GST_FILE_SINK_BUFFER_MODE_UNBUFFERED) {
     if (sink->buffer_size == 0) {
       sink->buffer_size = DEFAULT_BUFFER_SIZE;
       g_object_notify (G_OBJECT (sink), "buffer-size");
@@ -520,6 +1091,8 @@ gst_file_sink_close_file (GstFileSink * sink)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
           (_("Error closing file \"%s\"."), sink->filename), NULL);
 
+    gst_file_sink_write_behind_stop (sink);
+
     if (fclose (sink->file) != 0)
       GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
           (_("Error closing file \"%s\"."), sink->filename), GST_ERROR_SYSTEM);
@@ -686,6 +1259,12 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
         gst_file_sink_do_seek (filesink, 0);
         if (ftruncate (fileno (filesink->file), 0))
           goto truncate_failed;
+        /* that also freed what was preallocated */
+        if (filesink->aio) {
+          if (filesink->preallocated != G_MAXUINT64)
+            filesink->preallocated = 0;
+          filesink->synced = 0;
+        }
       }
       if (filesink->buffer_list) {
         gst_buffer_list_unref (filesink->buffer_list);
@@ -806,7 +1385,9 @@ gst_file_sink_flush_buffer (GstFileSink * filesink)
   GST_DEBUG_OBJECT (filesink, "Flushing out buffer of size %" G_GSIZE_FORMAT,
       filesink->current_buffer_size);
 
-  if (filesink->buffer && filesink->current_buffer_size) {
+  if (filesink->aio) {
+    return gst_file_sink_write_behind_flush (filesink);
+  } else if (filesink->buffer && filesink->current_buffer_size) {
     guint64 skip = 0;
 
     for (;;) {
@@ -916,7 +1497,14 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
 
   gst_buffer_list_foreach (buffer_list, has_sync_after_buffer, &sync_after);
 
-  if (sync_after || (!sink->buffer && !sink->buffer_list)) {
+  if (sink->aio) {
+    flow = GST_FLOW_OK;
+    for (i = 0; i < num_buffers && flow == GST_FLOW_OK; i++)
+      flow = gst_file_sink_write_behind (sink,
+          gst_buffer_list_get (buffer_list, i));
+    if (flow == GST_FLOW_OK && sync_after)
+      flow = gst_file_sink_flush_buffer (sink);
+  } else if (sync_after || (!sink->buffer && !sink->buffer_list)) {
     flow = gst_file_sink_flush_buffer (sink);
     if (flow == GST_FLOW_OK)
       flow = gst_file_sink_render_list_internal (sink, buffer_list);
@@ -1005,7 +1593,11 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   n_mem = gst_buffer_n_memory (buffer);
 
-  if (n_mem > 0 && (sync_after || (!filesink->buffer
+  if (n_mem > 0 && filesink->aio) {
+    flow = gst_file_sink_write_behind (filesink, buffer);
+    if (flow == GST_FLOW_OK && sync_after)
+      flow = gst_file_sink_flush_buffer (filesink);
+  } else if (n_mem > 0 && (sync_after || (!filesink->buffer
               && !filesink->buffer_list))) {
     flow = gst_file_sink_flush_buffer (filesink);
     if (flow == GST_FLOW_OK) {
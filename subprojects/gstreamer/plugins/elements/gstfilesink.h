@@ -29,6 +29,8 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasesink.h>
 
+#include "gstasyncio.h"
+
 G_BEGIN_DECLS
 #define GST_TYPE_FILE_SINK \
   (gst_file_sink_get_type())
@@ -44,6 +46,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFileSink GstFileSink;
 typedef struct _GstFileSinkClass GstFileSinkClass;
+typedef struct _GstFileSinkBlock GstFileSinkBlock;
 
 /**
  * GstFileSinkBufferMode:
@@ -113,6 +116,32 @@ struct _GstFileSink {
   gint max_transient_error_timeout;
 
   gboolean flushing;
+
+  /* For write-behind mode, current_pos is where the block that is being
+   * filled starts and current_buffer_size the bytes in it */
+  guint write_behind;
+  guint write_behind_size;
+  gboolean direct_io;
+  guint64 preallocate;
+  guint64 sync_interval;
+
+  GstAsyncIo *aio;
+  GstFileSinkBlock *blocks;
+  guint n_blocks;
+  gsize block_size;
+  GstFileSinkBlock *fill_block;
+  gint wb_fd;
+  gint direct_fd;
+  guint64 preallocated;
+  guint64 synced;
+  gboolean sync_pending;
+  gboolean sync_failed;
+
+  /* statistics of the write-behind mode, protected by the object lock */
+  guint queue_level;
+  guint64 n_writes;
+  GstClockTime total_write_latency;
+  GstClockTime max_write_latency;
 };
 
 struct _GstFileSinkClass {
@@ -31,12 +31,27 @@
  * gst-launch-1.0 filesrc location=song.ogg ! decodebin ! audioconvert ! audioresample ! autoaudiosink
  * ]| Play song.ogg audio file which must be in the current working directory.
  *
+ * By default data is read synchronously whenever it is requested. With
+ * #GstFileSrc:read-ahead, the file is read in aligned blocks of
+ * #GstFileSrc:read-ahead-size bytes, several of which are kept in flight
+ * ahead of the last position that was read. Requests are then served from
+ * those blocks without copying when they fit in one.
+ *
+ * |[
+ * gst-launch-1.0 filesrc location=movie.mp4 read-ahead=8 ! qtdemux ! fakesink
+ * ]| Read ahead 8 blocks of 256 KiB while qtdemux pulls from the file.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
+/* for O_DIRECT */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include <gst/gst.h>
 #include <glib/gstdio.h>
 #include "gstfilesrc.h"
@@ -113,11 +128,37 @@ enum
 };
 
 #define DEFAULT_BLOCKSIZE       4*1024
+#define DEFAULT_READ_AHEAD      0
+#define DEFAULT_READ_AHEAD_SIZE (256 * 1024)
+#define DEFAULT_DIRECT_IO       FALSE
+
+/* blocks are aligned to this in memory and in the file, for O_DIRECT */
+#define READ_AHEAD_ALIGN        4096
 
 enum
 {
   PROP_0,
-  PROP_LOCATION
+  PROP_LOCATION,
+  PROP_READ_AHEAD,
+  PROP_READ_AHEAD_SIZE,
+  PROP_DIRECT_IO
+};
+
+typedef enum
+{
+  BLOCK_EMPTY,
+  BLOCK_PENDING,
+  BLOCK_READY
+} GstFileSrcBlockState;
+
+struct _GstFileSrcBlock
+{
+  GstFileSrcBlockState state;
+  guint64 index;                /* offset in the file / block_size */
+  GstBuffer *buffer;
+  GstMapInfo map;               /* while the read is pending */
+  gssize result;                /* bytes read, or -errno */
+  guint64 last_used;
 };
 
 static void gst_file_src_finalize (GObject * object);
@@ -132,6 +173,8 @@ static gboolean gst_file_src_stop (GstBaseSrc * basesrc);
 
 static gboolean gst_file_src_is_seekable (GstBaseSrc * src);
 static gboolean gst_file_src_get_size (GstBaseSrc * src, guint64 * size);
+static GstFlowReturn gst_file_src_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buf);
 static GstFlowReturn gst_file_src_fill (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer * buf);
 
@@ -166,6 +209,56 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstFileSrc:read-ahead:
+   *
+   * Number of reads of #GstFileSrc:read-ahead-size bytes to keep in flight
+   * after the last position that was read, with io_uring when the kernel
+   * allows it and a pool of threads otherwise. Range requests in pull mode
+   * are served from the blocks that were read too. 0 reads synchronously.
+   *
+   * Only regular files are read ahead.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD,
+      g_param_spec_uint ("read-ahead", "Read ahead",
+          "Number of reads to keep in flight (0 = read synchronously)",
+          0, 256, DEFAULT_READ_AHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:read-ahead-size:
+   *
+   * Size of each read when #GstFileSrc:read-ahead is enabled, rounded up
+   * to a multiple of 4096 bytes.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_READ_AHEAD_SIZE,
+      g_param_spec_uint ("read-ahead-size", "Read ahead size",
+          "Size in bytes of each read ahead", READ_AHEAD_ALIGN,
+          64 * 1024 * 1024, DEFAULT_READ_AHEAD_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
+  /**
+   * GstFileSrc:direct-io:
+   *
+   * Open the file with O_DIRECT when #GstFileSrc:read-ahead is enabled, so
+   * that the data is not kept in the page cache. This falls back to normal
+   * reads if the file system does not support it, and is ignored on
+   * systems without O_DIRECT.
+   *
+   * Since: 1.30
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when reading ahead", DEFAULT_DIRECT_IO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gobject_class->finalize = gst_file_src_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -179,6 +272,7 @@ gst_file_src_class_init (GstFileSrcClass * klass)
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_file_src_stop);
   gstbasesrc_class->is_seekable = GST_DEBUG_FUNCPTR (gst_file_src_is_seekable);
   gstbasesrc_class->get_size = GST_DEBUG_FUNCPTR (gst_file_src_get_size);
+  gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_file_src_create);
   gstbasesrc_class->fill = GST_DEBUG_FUNCPTR (gst_file_src_fill);
 
   if (sizeof (off_t) < 8) {
@@ -196,6 +290,10 @@ gst_file_src_init (GstFileSrc * src)
 
   src->is_regular = FALSE;
 
+  src->read_ahead = DEFAULT_READ_AHEAD;
+  src->read_ahead_size = DEFAULT_READ_AHEAD_SIZE;
+  src->direct_io = DEFAULT_DIRECT_IO;
+
   gst_base_src_set_blocksize (GST_BASE_SRC (src), DEFAULT_BLOCKSIZE);
 }
 
@@ -273,6 +371,15 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_file_src_set_location (src, g_value_get_string (value), NULL);
       break;
+    case PROP_READ_AHEAD:
+      src->read_ahead = g_value_get_uint (value);
+      break;
+    case PROP_READ_AHEAD_SIZE:
+      src->read_ahead_size = g_value_get_uint (value);
+      break;
+    case PROP_DIRECT_IO:
+      src->direct_io = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -293,6 +400,15 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCATION:
       g_value_set_string (value, src->filename);
       break;
+    case PROP_READ_AHEAD:
+      g_value_set_uint (value, src->read_ahead);
+      break;
+    case PROP_READ_AHEAD_SIZE:
+      g_value_set_uint (value, src->read_ahead_size);
+      break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, src->direct_io);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -398,6 +514,292 @@ buffer_write_fail:
   }
 }
 
+/* read ahead: the file is read in blocks of block_size bytes, up to
+ * read_ahead of them in flight at any time. The cache has twice as many
+ * blocks, so that those that were read ahead are not evicted before they
+ * are used. */
+static GstFileSrcBlock *
+gst_file_src_find_block (GstFileSrc * src, guint64 index)
+{
+  guint i;
+
+  for (i = 0; i < src->n_blocks; i++) {
+    if (src->blocks[i].state != BLOCK_EMPTY && src->blocks[i].index == index)
+      return &src->blocks[i];
+  }
+
+  return NULL;
+}
+
+/* collects one finished read, blocking if none has finished yet */
+static gboolean
+gst_file_src_complete_block (GstFileSrc * src)
+{
+  GstFileSrcBlock *block;
+  gpointer user_data;
+  gssize result;
+
+  if (!gst_async_io_wait (src->aio, &user_data, &result))
+    return FALSE;
+
+  block = user_data;
+  gst_buffer_unmap (block->buffer, &block->map);
+  block->result = result;
+  block->state = BLOCK_READY;
+
+  return TRUE;
+}
+
+/* the least recently used block that is not being read, preferably one
+ * outside of [keep_first, keep_last] */
+static GstFileSrcBlock *
+gst_file_src_evict_block (GstFileSrc * src, guint64 keep_first,
+    guint64 keep_last)
+{
+  GstFileSrcBlock *block, *lru = NULL, *lru_kept = NULL;
+  guint i;
+
+  for (i = 0; i < src->n_blocks; i++) {
+    block = &src->blocks[i];
+
+    if (block->state == BLOCK_EMPTY)
+      return block;
+    if (block->state == BLOCK_PENDING)
+      continue;
+
+    if (block->index >= keep_first && block->index <= keep_last) {
+      if (lru_kept == NULL || block->last_used < lru_kept->last_used)
+        lru_kept = block;
+    } else if (lru == NULL || block->last_used < lru->last_used) {
+      lru = block;
+    }
+  }
+
+  return lru ? lru : lru_kept;
+}
+
+static gboolean
+gst_file_src_submit_block (GstFileSrc * src, GstFileSrcBlock * block,
+    guint64 index)
+{
+  /* the memory can be reused, unless downstream still has some of it */
+  if (block->buffer
+      && !gst_buffer_is_memory_range_writable (block->buffer, 0, -1)) {
+    gst_buffer_unref (block->buffer);
+    block->buffer = NULL;
+  }
+
+  if (block->buffer == NULL) {
+    GstAllocationParams params;
+
+    gst_allocation_params_init (&params);
+    params.align = READ_AHEAD_ALIGN - 1;
+    block->buffer = gst_buffer_new_allocate (NULL, src->block_size, &params);
+  }
+
+  block->state = BLOCK_EMPTY;
+  if (!gst_buffer_map (block->buffer, &block->map, GST_MAP_WRITE))
+    return FALSE;
+
+  if (!gst_async_io_read (src->aio, src->fd, block->map.data,
+          src->block_size, index * src->block_size, block)) {
+    gst_buffer_unmap (block->buffer, &block->map);
+    return FALSE;
+  }
+
+  GST_LOG_OBJECT (src, "reading block %" G_GUINT64_FORMAT, index);
+
+  block->state = BLOCK_PENDING;
+  block->index = index;
+  block->last_used = ++src->last_used;
+
+  return TRUE;
+}
+
+/* returns the block at @index, reading it if it wasn't already */
+static GstFlowReturn
+gst_file_src_get_block (GstFileSrc * src, guint64 index,
+    GstFileSrcBlock ** ret_block)
+{
+  GstFileSrcBlock *block;
+  gboolean retried = FALSE;
+
+again:
+  block = gst_file_src_find_block (src, index);
+  if (block == NULL) {
+    while (gst_async_io_get_in_flight (src->aio) == src->read_ahead ||
+        (block = gst_file_src_evict_block (src, index, index)) == NULL) {
+      if (!gst_file_src_complete_block (src))
+        goto could_not_read;
+    }
+
+    if (!gst_file_src_submit_block (src, block, index))
+      goto could_not_read;
+  }
+
+  while (block->state == BLOCK_PENDING) {
+    if (!gst_file_src_complete_block (src))
+      goto could_not_read;
+  }
+
+  if (G_UNLIKELY (block->result < 0))
+    goto read_failed;
+
+  /* a short read that is not at the end of the file, read it again once */
+  if (G_UNLIKELY ((guint64) block->result < src->block_size) && !retried &&
+      index * src->block_size + block->result < src->size) {
+    GST_DEBUG_OBJECT (src, "short read of block %" G_GUINT64_FORMAT, index);
+    block->state = BLOCK_EMPTY;
+    retried = TRUE;
+    goto again;
+  }
+
+  block->last_used = ++src->last_used;
+  *ret_block = block;
+
+  return GST_FLOW_OK;
+
+  /* ERROR */
+could_not_read:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("Could not start reading at offset %" G_GUINT64_FORMAT,
+            index * src->block_size));
+    return GST_FLOW_ERROR;
+  }
+read_failed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("Could not read at offset %" G_GUINT64_FORMAT ": %s",
+            index * src->block_size, g_strerror (-block->result)));
+    block->state = BLOCK_EMPTY;
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* keeps reads in flight for the blocks after @index */
+static void
+gst_file_src_read_ahead (GstFileSrc * src, guint64 index)
+{
+  GstFileSrcBlock *block;
+  guint64 last = index + src->read_ahead, i;
+
+  for (i = index + 1; i <= last && i * src->block_size < src->size; i++) {
+    if (gst_async_io_get_in_flight (src->aio) == src->read_ahead)
+      break;
+    if (gst_file_src_find_block (src, i))
+      continue;
+
+    block = gst_file_src_evict_block (src, index, last);
+    if (block == NULL || (block->state != BLOCK_EMPTY &&
+            block->index >= index && block->index <= last))
+      break;
+
+    if (!gst_file_src_submit_block (src, block, i))
+      break;
+  }
+}
+
+static GstFlowReturn
+gst_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstFileSrc *src = GST_FILE_SRC_CAST (basesrc);
+  GstFileSrcBlock *block;
+  GstFlowReturn ret;
+  GstBuffer *buf;
+  GstMapInfo info;
+  guint64 index, skip, avail, to_copy, bytes_read = 0;
+
+  if (src->aio == NULL)
+    return GST_BASE_SRC_CLASS (parent_class)->create (basesrc, offset, length,
+        buffer);
+
+  if (offset == -1)
+    offset = src->read_position;
+
+  /* the file might have grown */
+  if (offset + length > src->size)
+    gst_file_src_get_size (basesrc, &src->size);
+
+  index = offset / src->block_size;
+  skip = offset % src->block_size;
+
+  ret = gst_file_src_get_block (src, index, &block);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  avail = (guint64) block->result > skip ? block->result - skip : 0;
+  if (avail == 0)
+    goto eos;
+
+  if (*buffer == NULL && length <= avail) {
+    /* share the memory of the block */
+    buf = gst_buffer_copy_region (block->buffer, GST_BUFFER_COPY_MEMORY, skip,
+        length);
+    bytes_read = length;
+  } else {
+    buf = *buffer ? *buffer : gst_buffer_new_allocate (NULL, length, NULL);
+
+    if (!gst_buffer_map (buf, &info, GST_MAP_WRITE))
+      goto buffer_write_fail;
+
+    while (TRUE) {
+      to_copy = MIN (avail, length - bytes_read);
+      gst_buffer_extract (block->buffer, skip, info.data + bytes_read,
+          to_copy);
+      bytes_read += to_copy;
+
+      /* done, or this was the last block of the file */
+      if (bytes_read == length || skip + avail < src->block_size)
+        break;
+
+      index++;
+      skip = 0;
+      ret = gst_file_src_get_block (src, index, &block);
+      if (ret != GST_FLOW_OK)
+        goto could_not_read;
+      avail = block->result;
+      if (avail == 0)
+        break;
+    }
+
+    gst_buffer_unmap (buf, &info);
+    if (bytes_read != length)
+      gst_buffer_resize (buf, 0, bytes_read);
+  }
+
+  gst_file_src_read_ahead (src, index);
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + bytes_read;
+  src->read_position = offset + bytes_read;
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+
+  /* ERROR */
+eos:
+  {
+    GST_DEBUG_OBJECT (src, "EOS");
+    return GST_FLOW_EOS;
+  }
+buffer_write_fail:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, WRITE, (NULL), ("Can't write to buffer"));
+    if (*buffer == NULL)
+      gst_buffer_unref (buf);
+    return GST_FLOW_ERROR;
+  }
+could_not_read:
+  {
+    gst_buffer_unmap (buf, &info);
+    if (*buffer == NULL)
+      gst_buffer_unref (buf);
+    return ret;
+  }
+}
+
 static gboolean
 gst_file_src_is_seekable (GstBaseSrc * basesrc)
 {
@@ -490,6 +892,10 @@ gst_file_src_start (GstBaseSrc * basesrc)
 #if defined (__BIONIC__)
   flags |= O_LARGEFILE;
 #endif
+#ifdef O_DIRECT
+  if (src->direct_io && src->read_ahead > 0)
+    flags |= O_DIRECT;
+#endif
 
   if (src->filename == NULL || src->filename[0] == '\0')
     goto no_filename;
@@ -499,6 +905,16 @@ gst_file_src_start (GstBaseSrc * basesrc)
   /* open the file */
   src->fd = g_open (src->filename, flags, 0);
 
+#ifdef O_DIRECT
+  /* not all file systems support it */
+  if (src->fd < 0 && errno == EINVAL && (flags & O_DIRECT)) {
+    GST_WARNING_OBJECT (src, "could not open with O_DIRECT, not bypassing "
+        "the page cache");
+    flags &= ~O_DIRECT;
+    src->fd = g_open (src->filename, flags, 0);
+  }
+#endif
+
   if (src->fd < 0)
     goto open_failed;
 
@@ -569,6 +985,27 @@ gst_file_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_dynamic_size (basesrc, src->seekable);
 
+  if (src->read_ahead > 0 && src->seekable) {
+    src->block_size = GST_ROUND_UP_N ((guint64) src->read_ahead_size,
+        READ_AHEAD_ALIGN);
+    src->n_blocks = 2 * src->read_ahead;
+    src->blocks = g_new0 (GstFileSrcBlock, src->n_blocks);
+    src->last_used = 0;
+    src->size = 0;
+    gst_file_src_get_size (basesrc, &src->size);
+    src->aio = gst_async_io_new (src->read_ahead);
+
+    GST_INFO_OBJECT (src, "reading ahead %u blocks of %" G_GUINT64_FORMAT
+        " bytes with %s", src->read_ahead, src->block_size,
+        gst_async_io_get_backend (src->aio));
+  }
+#ifdef O_DIRECT
+  else if (flags & O_DIRECT) {
+    /* the synchronous reads are not aligned */
+    fcntl (src->fd, F_SETFL, fcntl (src->fd, F_GETFL) & ~O_DIRECT);
+  }
+#endif
+
   return TRUE;
 
   /* ERROR */
@@ -631,6 +1068,20 @@ static gboolean
 gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
+  guint i;
+
+  if (src->aio) {
+    /* the blocks that are still being read are mapped */
+    while (gst_file_src_complete_block (src));
+    gst_async_io_free (src->aio);
+    src->aio = NULL;
+
+    for (i = 0; i < src->n_blocks; i++)
+      gst_buffer_replace (&src->blocks[i].buffer, NULL);
+    g_free (src->blocks);
+    src->blocks = NULL;
+    src->n_blocks = 0;
+  }
 
   /* close the file */
   g_close (src->fd, NULL);
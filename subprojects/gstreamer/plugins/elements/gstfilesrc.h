@@ -29,6 +29,8 @@
 #include <gst/gst.h>
 #include <gst/base/gstbasesrc.h>
 
+#include "gstasyncio.h"
+
 G_BEGIN_DECLS
 
 #define GST_TYPE_FILE_SRC \
@@ -45,6 +47,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstFileSrc GstFileSrc;
 typedef struct _GstFileSrcClass GstFileSrcClass;
+typedef struct _GstFileSrcBlock GstFileSrcBlock;
 
 /**
  * GstFileSrc:
@@ -63,6 +66,17 @@ struct _GstFileSrc {
   gboolean seekable;                    /* whether the file is seekable */
   gboolean is_regular;                  /* whether it's a (symlink to a)
                                            regular file */
+
+  guint read_ahead;                     /* reads to keep in flight */
+  guint read_ahead_size;                /* size of each of them */
+  gboolean direct_io;                   /* bypass the page cache */
+
+  GstAsyncIo *aio;                      /* NULL when reading synchronously */
+  GstFileSrcBlock *blocks;              /* cache of aligned blocks */
+  guint n_blocks;
+  guint64 block_size;
+  guint64 size;                         /* last known size of the file */
+  guint64 last_used;                    /* for evicting blocks */
 };
 
 struct _GstFileSrcClass {
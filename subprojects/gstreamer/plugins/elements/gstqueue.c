@@ -126,6 +126,8 @@ enum
   PROP_SILENT,
   PROP_FLUSH_ON_EOS,
   PROP_NOTIFY_LEVELS,
+  PROP_MAX_BATCH_BUFFERS,
+  PROP_MAX_BATCH_TIME,
   PROP_LAST
 };
 
@@ -135,6 +137,8 @@ GParamSpec *properties[PROP_LAST];
 #define DEFAULT_MAX_SIZE_BUFFERS  200   /* 200 buffers */
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
+#define DEFAULT_MAX_BATCH_BUFFERS 0     /* disabled */
+#define DEFAULT_MAX_BATCH_TIME    0     /* unlimited */
 
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
@@ -428,6 +432,41 @@ gst_queue_class_init (GstQueueClass * klass)
       "Whether to emit `notify` signals on levels changes or not", FALSE,
       G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GstQueue:max-batch-buffers
+   *
+   * When pushing a buffer downstream, also take up to this many buffers that
+   * directly follow it in the queue and push them together as one
+   * #GstBufferList. Downstream elements implementing a chain_list function
+   * then only pay the pad traversal once per batch.
+   *
+   * Only buffers that are already queued are batched, the queue never waits
+   * for a batch to fill up, so this does not add any latency. Values of 0 and
+   * 1 disable batching.
+   *
+   * Since: 1.30
+   */
+  properties[PROP_MAX_BATCH_BUFFERS] =
+      g_param_spec_uint ("max-batch-buffers", "Max. batch buffers",
+      "Max. number of consecutive queued buffers pushed downstream as one "
+      "buffer list (0=disable)", 0, G_MAXUINT, DEFAULT_MAX_BATCH_BUFFERS,
+      G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GstQueue:max-batch-time
+   *
+   * Maximum difference between the timestamps of the first and the last buffer
+   * of a batch pushed with #GstQueue:max-batch-buffers. Buffers without
+   * timestamps are not batched when this is set.
+   *
+   * Since: 1.30
+   */
+  properties[PROP_MAX_BATCH_TIME] =
+      g_param_spec_uint64 ("max-batch-time", "Max. batch time",
+      "Max. timestamp span of the buffers pushed as one buffer list "
+      "(in ns, 0=unlimited)", 0, G_MAXUINT64, DEFAULT_MAX_BATCH_TIME,
+      G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, properties);
   gobject_class->finalize = gst_queue_finalize;
 
@@ -484,6 +523,8 @@ gst_queue_init (GstQueue * queue)
 
   queue->leaky = GST_QUEUE_NO_LEAK;
   queue->srcresult = GST_FLOW_FLUSHING;
+  queue->max_batch_buffers = DEFAULT_MAX_BATCH_BUFFERS;
+  queue->max_batch_time = DEFAULT_MAX_BATCH_TIME;
 
   g_mutex_init (&queue->qlock);
   g_cond_init (&queue->item_add);
@@ -1435,6 +1476,51 @@ gst_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       GST_MINI_OBJECT_CAST (buffer), FALSE);
 }
 
+/* collect the buffers directly following @buffer in the queue into a buffer
+ * list, bounded by max-batch-buffers and max-batch-time. Only data that is
+ * already queued is taken so batching never adds latency. Returns NULL when
+ * there is nothing to batch with @buffer, otherwise the list takes ownership
+ * of @buffer. */
+static GstBufferList *
+gst_queue_locked_dequeue_batch (GstQueue * queue, GstBuffer * buffer)
+{
+  GstBufferList *buffer_list = NULL;
+  GstQueueItem *qitem;
+  GstClockTime first_ts;
+  guint n_buffers = 1;
+
+  first_ts = GST_BUFFER_DTS_OR_PTS (buffer);
+
+  while (n_buffers < queue->max_batch_buffers
+      && (qitem = gst_vec_deque_peek_head_struct (queue->queue))) {
+    if (!GST_IS_BUFFER (qitem->item))
+      break;
+
+    if (queue->max_batch_time > 0) {
+      GstClockTime ts = GST_BUFFER_DTS_OR_PTS (GST_BUFFER_CAST (qitem->item));
+
+      if (!GST_CLOCK_TIME_IS_VALID (first_ts) || !GST_CLOCK_TIME_IS_VALID (ts)
+          || ts < first_ts || ts - first_ts > queue->max_batch_time)
+        break;
+    }
+
+    if (buffer_list == NULL) {
+      buffer_list = gst_buffer_list_new_sized (MIN (queue->max_batch_buffers,
+              queue->cur_level.buffers + 1));
+      gst_buffer_list_add (buffer_list, buffer);
+    }
+    gst_buffer_list_add (buffer_list,
+        GST_BUFFER_CAST (gst_queue_locked_dequeue (queue)));
+    n_buffers++;
+  }
+
+  if (buffer_list)
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue, "batched %u buffers",
+        n_buffers);
+
+  return buffer_list;
+}
+
 /* dequeue an item from the queue an push it downstream. This functions returns
  * the result of the push. */
 static GstFlowReturn
@@ -1469,8 +1555,19 @@ next:
         queue->head_needs_discont = FALSE;
       }
 
-      GST_QUEUE_MUTEX_UNLOCK (queue);
-      result = gst_pad_push (queue->srcpad, buffer);
+      if (queue->max_batch_buffers > 1) {
+        GstBufferList *buffer_list;
+
+        buffer_list = gst_queue_locked_dequeue_batch (queue, buffer);
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        if (buffer_list)
+          result = gst_pad_push_list (queue->srcpad, buffer_list);
+        else
+          result = gst_pad_push (queue->srcpad, buffer);
+      } else {
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        result = gst_pad_push (queue->srcpad, buffer);
+      }
     } else {
       GstBufferList *buffer_list;
 
@@ -1936,6 +2033,12 @@ gst_queue_set_property (GObject * object,
     case PROP_NOTIFY_LEVELS:
       queue->notify_levels = g_value_get_boolean (value);
       break;
+    case PROP_MAX_BATCH_BUFFERS:
+      queue->max_batch_buffers = g_value_get_uint (value);
+      break;
+    case PROP_MAX_BATCH_TIME:
+      queue->max_batch_time = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1992,6 +2095,12 @@ gst_queue_get_property (GObject * object,
     case PROP_NOTIFY_LEVELS:
       g_value_set_boolean (value, queue->notify_levels);
       break;
+    case PROP_MAX_BATCH_BUFFERS:
+      g_value_set_uint (value, queue->max_batch_buffers);
+      break;
+    case PROP_MAX_BATCH_TIME:
+      g_value_set_uint64 (value, queue->max_batch_time);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
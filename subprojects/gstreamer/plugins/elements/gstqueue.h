@@ -140,6 +140,10 @@ struct _GstQueue {
   GstQuery *last_handled_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  /* bounds for pushing consecutive queued buffers as one buffer list */
+  guint max_batch_buffers;
+  guint64 max_batch_time;
 };
 
 struct _GstQueueClass {
@@ -0,0 +1,1117 @@
+/* GStreamer
+ *
+ * gstperfetto.c: tracing module that writes perfetto timeline traces
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:tracer-perfetto
+ * @short_description: write a binary timeline trace
+ *
+ * A tracing module that records the data flow of a pipeline into a
+ * [Perfetto](https://perfetto.dev) protobuf trace, which can be opened in
+ * the Perfetto UI (https://ui.perfetto.dev) or any other viewer that reads
+ * that format.
+ *
+ * The trace contains:
+ *
+ * - one track per streaming thread, named after the thread
+ * - a slice for each buffer, buffer list and pull_range passing a pad, named
+ *   after the pad and annotated with timestamp and size of the data
+ * - instant events for serialized events and for created elements
+ * - counter tracks with the fill level of `queue` and `queue2` elements,
+ *   sampled at most once per #GstPerfettoTracer:sample-interval
+ * - counter tracks with the latency reported by each element
+ *
+ * Events are encoded directly into per-thread buffers without taking any lock.
+ * Full buffers are handed to a writer thread which appends them to the output
+ * file, so tracing does not block on file I/O. Timestamps are taken from the
+ * monotonic clock (`CLOCK_MONOTONIC` on Linux) and marked as such in the
+ * trace, so it can be merged with system traces.
+ *
+ * ```
+ * GST_TRACERS="perfetto(file=pipeline.perfetto-trace)" gst-launch-1.0 ...
+ * ```
+ *
+ * Since: 1.30
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "gstperfetto.h"
+
+#ifdef G_OS_WIN32
+#  include <windows.h>
+#else
+#  ifdef HAVE_UNISTD_H
+#    include <unistd.h>
+#  endif
+#  if defined(__linux__) && !defined(HAVE_GETTID)
+#    include <sys/types.h>
+#    include <syscall.h>
+#  endif
+#endif
+
+#ifdef HAVE_SYS_PRCTL_H
+#  include <sys/prctl.h>
+#endif
+
+GST_DEBUG_CATEGORY_STATIC (gst_perfetto_debug);
+#define GST_CAT_DEFAULT gst_perfetto_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_perfetto_debug, "perfetto", 0, "perfetto tracer");
+#define gst_perfetto_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstPerfettoTracer, gst_perfetto_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+enum
+{
+  PROP_0,
+  PROP_FILE,
+  PROP_BUFFER_SIZE,
+  PROP_SAMPLE_INTERVAL,
+  PROP_LAST
+};
+
+static GParamSpec *properties[PROP_LAST];
+
+#define DEFAULT_BUFFER_SIZE (64 * 1024)
+#define DEFAULT_SAMPLE_INTERVAL (10 * GST_MSECOND)
+
+/* protobuf wire types */
+#define WIRE_VARINT 0
+#define WIRE_BYTES 2
+
+/* field numbers of the perfetto trace format, see
+ * protos/perfetto/trace/ in the perfetto sources */
+#define TRACE_PACKET 1
+
+#define PACKET_TIMESTAMP 8
+#define PACKET_SEQUENCE_ID 10
+#define PACKET_TRACK_EVENT 11
+#define PACKET_INTERNED_DATA 12
+#define PACKET_SEQUENCE_FLAGS 13
+#define PACKET_TIMESTAMP_CLOCK_ID 58
+#define PACKET_TRACK_DESCRIPTOR 60
+
+/* BuiltinClock, what gst_util_get_timestamp() uses on Linux */
+#define CLOCK_MONOTONIC_ID 3
+
+#define SEQ_INCREMENTAL_STATE_CLEARED 1
+#define SEQ_NEEDS_INCREMENTAL_STATE 2
+
+#define TRACK_UUID 1
+#define TRACK_NAME 2
+#define TRACK_PROCESS 3
+#define TRACK_THREAD 4
+#define TRACK_PARENT_UUID 5
+#define TRACK_COUNTER 8
+
+#define PROCESS_PID 1
+#define PROCESS_NAME 6
+
+#define THREAD_PID 1
+#define THREAD_TID 2
+#define THREAD_NAME 5
+
+#define COUNTER_UNIT 3
+#define COUNTER_UNIT_TIME_NS 1
+#define COUNTER_UNIT_COUNT 2
+#define COUNTER_UNIT_SIZE_BYTES 3
+
+#define EVENT_DEBUG_ANNOTATIONS 4
+#define EVENT_TYPE 9
+#define EVENT_NAME_IID 10
+#define EVENT_TRACK_UUID 11
+#define EVENT_COUNTER_VALUE 30
+
+#define EVENT_TYPE_SLICE_BEGIN 1
+#define EVENT_TYPE_SLICE_END 2
+#define EVENT_TYPE_INSTANT 3
+#define EVENT_TYPE_COUNTER 4
+
+#define ANNOTATION_NAME_IID 1
+#define ANNOTATION_UINT_VALUE 3
+#define ANNOTATION_STRING_VALUE 6
+
+#define INTERNED_EVENT_NAMES 2
+#define INTERNED_ANNOTATION_NAMES 3
+
+#define INTERNED_IID 1
+#define INTERNED_NAME 2
+
+/* debug annotation names, interned once at the start of every sequence */
+enum
+{
+  ANNOTATION_PTS = 1,
+  ANNOTATION_SIZE,
+  ANNOTATION_BUFFERS,
+  ANNOTATION_OFFSET,
+  ANNOTATION_RESULT,
+  ANNOTATION_PAD,
+  ANNOTATION_ELEMENT,
+  ANNOTATION_FACTORY,
+};
+
+static const gchar *annotation_names[] = {
+  NULL, "pts", "size", "buffers", "offset", "result", "pad", "element",
+  "factory"
+};
+
+/* the state of one thread, each thread writes its own packet sequence */
+typedef struct
+{
+  GstPerfettoTracer *tracer;
+  /* set while a hook writes, see perfetto_thread_acquire() */
+  gint writing;
+  GByteArray *buf;
+  guint32 sequence_id;
+  guint64 track_uuid;
+  /* event name -> iid */
+  GHashTable *event_names;
+  guint64 next_iid;
+} GstPerfettoThread;
+
+/* the counter tracks of one element, attached as qdata */
+typedef struct
+{
+  GstPerfettoTracer *tracer;
+  gboolean is_queue;
+  /* interval the fill level was last sampled in */
+  gint sample_slot;
+  guint64 level_uuids[3];
+  guint64 latency_uuid;
+} GstPerfettoElement;
+
+static void perfetto_thread_free (gpointer data);
+
+static GMutex perfetto_lock;
+static GPrivate perfetto_thread_key = G_PRIVATE_INIT (perfetto_thread_free);
+static guint64 perfetto_next_uuid;
+static GQuark perfetto_element_quark;
+
+/* sentinel telling the writer thread to stop */
+static GByteArray perfetto_writer_stop;
+
+/* protobuf encoding */
+
+static inline void
+pb_varint (GByteArray * buf, guint64 v)
+{
+  guint8 tmp[10];
+  guint n = 0;
+
+  while (v >= 0x80) {
+    tmp[n++] = (v & 0x7f) | 0x80;
+    v >>= 7;
+  }
+  tmp[n++] = v;
+  g_byte_array_append (buf, tmp, n);
+}
+
+static inline void
+pb_uint (GByteArray * buf, guint field, guint64 v)
+{
+  pb_varint (buf, (field << 3) | WIRE_VARINT);
+  pb_varint (buf, v);
+}
+
+static inline void
+pb_string (GByteArray * buf, guint field, const gchar * str)
+{
+  gsize len = strlen (str);
+
+  pb_varint (buf, (field << 3) | WIRE_BYTES);
+  pb_varint (buf, len);
+  g_byte_array_append (buf, (const guint8 *) str, len);
+}
+
+/* Starts a nested message. The length is not known yet, so 4 bytes are
+ * reserved and filled with a redundant varint encoding in pb_end(). */
+static inline guint
+pb_begin (GByteArray * buf, guint field)
+{
+  static const guint8 placeholder[4] = { 0, };
+  guint pos;
+
+  pb_varint (buf, (field << 3) | WIRE_BYTES);
+  pos = buf->len;
+  g_byte_array_append (buf, placeholder, 4);
+
+  return pos;
+}
+
+static inline void
+pb_end (GByteArray * buf, guint pos)
+{
+  guint32 len = buf->len - pos - 4;
+
+  buf->data[pos] = (len & 0x7f) | 0x80;
+  buf->data[pos + 1] = ((len >> 7) & 0x7f) | 0x80;
+  buf->data[pos + 2] = ((len >> 14) & 0x7f) | 0x80;
+  buf->data[pos + 3] = (len >> 21) & 0x7f;
+}
+
+/* process and thread information */
+
+static gint
+perfetto_get_pid (void)
+{
+#ifdef G_OS_WIN32
+  return (gint) GetCurrentProcessId ();
+#else
+  return (gint) getpid ();
+#endif
+}
+
+static guint64
+perfetto_get_tid (void)
+{
+#ifdef G_OS_WIN32
+  return GetCurrentThreadId ();
+#elif defined(HAVE_GETTID)
+  return gettid ();
+#elif defined(__linux__)
+  return syscall (SYS_gettid);
+#else
+  return (guint64) (guintptr) g_thread_self ();
+#endif
+}
+
+static gchar *
+perfetto_get_thread_name (void)
+{
+#ifdef HAVE_SYS_PRCTL_H
+  gchar name[17] = { 0, };
+
+  if (prctl (PR_GET_NAME, (unsigned long) name, 0, 0, 0) == 0 && name[0])
+    return g_strdup (name);
+#endif
+  return NULL;
+}
+
+/* packet writing */
+
+static void
+perfetto_queue_chunk (GstPerfettoTracer * self, GstPerfettoThread * thread)
+{
+  g_async_queue_push (self->chunks, thread->buf);
+  thread->buf = g_byte_array_sized_new (self->buffer_size + 256);
+}
+
+static inline guint
+perfetto_packet_begin (GstPerfettoThread * thread, guint64 ts, guint flags)
+{
+  guint pos;
+
+  pos = pb_begin (thread->buf, TRACE_PACKET);
+  pb_uint (thread->buf, PACKET_TIMESTAMP, ts + thread->tracer->ts_offset);
+  pb_uint (thread->buf, PACKET_TIMESTAMP_CLOCK_ID, CLOCK_MONOTONIC_ID);
+  pb_uint (thread->buf, PACKET_SEQUENCE_ID, thread->sequence_id);
+  if (flags)
+    pb_uint (thread->buf, PACKET_SEQUENCE_FLAGS, flags);
+
+  return pos;
+}
+
+static inline void
+perfetto_packet_end (GstPerfettoThread * thread, guint pos)
+{
+  pb_end (thread->buf, pos);
+
+  if (G_UNLIKELY (thread->buf->len >= thread->tracer->buffer_size))
+    perfetto_queue_chunk (thread->tracer, thread);
+}
+
+static void
+perfetto_write_process_descriptor (GstPerfettoTracer * self,
+    GstPerfettoThread * thread, guint64 ts)
+{
+  const gchar *name = g_get_prgname ();
+  guint pos, track, process;
+
+  pos = perfetto_packet_begin (thread, ts, 0);
+  track = pb_begin (thread->buf, PACKET_TRACK_DESCRIPTOR);
+  pb_uint (thread->buf, TRACK_UUID, self->process_uuid);
+  process = pb_begin (thread->buf, TRACK_PROCESS);
+  pb_uint (thread->buf, PROCESS_PID, perfetto_get_pid ());
+  if (name)
+    pb_string (thread->buf, PROCESS_NAME, name);
+  pb_end (thread->buf, process);
+  pb_end (thread->buf, track);
+  perfetto_packet_end (thread, pos);
+}
+
+static void
+perfetto_write_thread_descriptor (GstPerfettoThread * thread, guint64 ts)
+{
+  gchar *name = perfetto_get_thread_name ();
+  guint pos, track, desc, interned;
+  guint i;
+
+  pos = perfetto_packet_begin (thread, ts, SEQ_INCREMENTAL_STATE_CLEARED);
+  track = pb_begin (thread->buf, PACKET_TRACK_DESCRIPTOR);
+  pb_uint (thread->buf, TRACK_UUID, thread->track_uuid);
+  desc = pb_begin (thread->buf, TRACK_THREAD);
+  pb_uint (thread->buf, THREAD_PID, perfetto_get_pid ());
+  pb_uint (thread->buf, THREAD_TID, perfetto_get_tid ());
+  if (name)
+    pb_string (thread->buf, THREAD_NAME, name);
+  pb_end (thread->buf, desc);
+  pb_end (thread->buf, track);
+
+  /* the annotation names are the same for every sequence, intern them
+   * right away */
+  interned = pb_begin (thread->buf, PACKET_INTERNED_DATA);
+  for (i = 1; i < G_N_ELEMENTS (annotation_names); i++) {
+    guint entry = pb_begin (thread->buf, INTERNED_ANNOTATION_NAMES);
+
+    pb_uint (thread->buf, INTERNED_IID, i);
+    pb_string (thread->buf, INTERNED_NAME, annotation_names[i]);
+    pb_end (thread->buf, entry);
+  }
+  pb_end (thread->buf, interned);
+  perfetto_packet_end (thread, pos);
+
+  g_free (name);
+}
+
+static void
+perfetto_write_counter_descriptor (GstPerfettoTracer * self,
+    GstPerfettoThread * thread, guint64 ts, guint64 uuid, const gchar * name,
+    guint unit)
+{
+  guint pos, track, counter;
+
+  pos = perfetto_packet_begin (thread, ts, 0);
+  track = pb_begin (thread->buf, PACKET_TRACK_DESCRIPTOR);
+  pb_uint (thread->buf, TRACK_UUID, uuid);
+  pb_string (thread->buf, TRACK_NAME, name);
+  pb_uint (thread->buf, TRACK_PARENT_UUID, self->process_uuid);
+  counter = pb_begin (thread->buf, TRACK_COUNTER);
+  pb_uint (thread->buf, COUNTER_UNIT, unit);
+  pb_end (thread->buf, counter);
+  pb_end (thread->buf, track);
+  perfetto_packet_end (thread, pos);
+}
+
+static void
+perfetto_thread_detach (GstPerfettoThread * thread)
+{
+  GstPerfettoTracer *self = thread->tracer;
+
+  if (self == NULL)
+    return;
+
+  if (thread->buf->len > 0)
+    g_async_queue_push (self->chunks, thread->buf);
+  else
+    g_byte_array_unref (thread->buf);
+  thread->buf = NULL;
+  self->threads = g_list_remove (self->threads, thread);
+  thread->tracer = NULL;
+}
+
+static void
+perfetto_thread_free (gpointer data)
+{
+  GstPerfettoThread *thread = data;
+
+  g_mutex_lock (&perfetto_lock);
+  perfetto_thread_detach (thread);
+  g_mutex_unlock (&perfetto_lock);
+
+  g_hash_table_unref (thread->event_names);
+  g_free (thread);
+}
+
+static gboolean
+perfetto_thread_setup (GstPerfettoTracer * self, GstPerfettoThread * thread,
+    guint64 ts)
+{
+  g_hash_table_remove_all (thread->event_names);
+
+  g_mutex_lock (&perfetto_lock);
+  if (g_atomic_int_get (&self->stopped)) {
+    g_mutex_unlock (&perfetto_lock);
+    return FALSE;
+  }
+
+  /* the hooks get the time since gst_init(), the trace uses the monotonic
+   * clock so that it lines up with traces of the rest of the system */
+  if (self->ts_offset == 0)
+    self->ts_offset = gst_util_get_timestamp () - ts;
+
+  perfetto_thread_detach (thread);
+  thread->tracer = self;
+  thread->buf = g_byte_array_sized_new (self->buffer_size + 256);
+  thread->sequence_id = g_atomic_int_add (&self->next_sequence_id, 1) + 1;
+  thread->track_uuid = ++perfetto_next_uuid;
+  thread->next_iid = 1;
+  self->threads = g_list_prepend (self->threads, thread);
+  g_mutex_unlock (&perfetto_lock);
+
+  if (g_atomic_int_compare_and_exchange (&self->process_written, FALSE, TRUE))
+    perfetto_write_process_descriptor (self, thread, ts);
+  perfetto_write_thread_descriptor (thread, ts);
+
+  return TRUE;
+}
+
+/* Returns the state of the calling thread to write events to, or %NULL if
+ * the tracer is shutting down. The state has to be released with
+ * perfetto_thread_release() once the hook is done.
+ *
+ * Finalizing sets @stopped and then waits until no thread is @writing
+ * before it takes the buffers. Both flags are accessed with sequentially
+ * consistent atomics, so either the hook sees @stopped or finalize sees
+ * the hook @writing. */
+static inline GstPerfettoThread *
+perfetto_thread_acquire (GstPerfettoTracer * self, guint64 ts)
+{
+  GstPerfettoThread *thread = g_private_get (&perfetto_thread_key);
+
+  if (G_UNLIKELY (thread == NULL)) {
+    thread = g_new0 (GstPerfettoThread, 1);
+    thread->event_names =
+        g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    g_private_set (&perfetto_thread_key, thread);
+  }
+
+  g_atomic_int_set (&thread->writing, TRUE);
+  if (G_UNLIKELY (g_atomic_int_get (&self->stopped)))
+    goto stopped;
+
+  if (G_LIKELY (thread->tracer == self))
+    return thread;
+
+  if (!perfetto_thread_setup (self, thread, ts))
+    goto stopped;
+
+  return thread;
+
+stopped:
+  g_atomic_int_set (&thread->writing, FALSE);
+  return NULL;
+}
+
+static inline void
+perfetto_thread_release (GstPerfettoThread * thread)
+{
+  g_atomic_int_set (&thread->writing, FALSE);
+}
+
+/* returns the iid of @name, adding it to the interned data of the packet
+ * that is currently written if it is new on this sequence */
+static guint64
+perfetto_intern_event_name (GstPerfettoThread * thread, const gchar * name)
+{
+  gpointer iid;
+  guint interned, entry;
+
+  if (g_hash_table_lookup_extended (thread->event_names, name, NULL, &iid))
+    return GPOINTER_TO_SIZE (iid);
+
+  iid = GSIZE_TO_POINTER (thread->next_iid++);
+  g_hash_table_insert (thread->event_names, g_strdup (name), iid);
+
+  interned = pb_begin (thread->buf, PACKET_INTERNED_DATA);
+  entry = pb_begin (thread->buf, INTERNED_EVENT_NAMES);
+  pb_uint (thread->buf, INTERNED_IID, GPOINTER_TO_SIZE (iid));
+  pb_string (thread->buf, INTERNED_NAME, name);
+  pb_end (thread->buf, entry);
+  pb_end (thread->buf, interned);
+
+  return GPOINTER_TO_SIZE (iid);
+}
+
+static inline void
+perfetto_annotation_uint (GstPerfettoThread * thread, guint name, guint64 v)
+{
+  guint pos = pb_begin (thread->buf, EVENT_DEBUG_ANNOTATIONS);
+
+  pb_uint (thread->buf, ANNOTATION_NAME_IID, name);
+  pb_uint (thread->buf, ANNOTATION_UINT_VALUE, v);
+  pb_end (thread->buf, pos);
+}
+
+static inline void
+perfetto_annotation_string (GstPerfettoThread * thread, guint name,
+    const gchar * v)
+{
+  guint pos = pb_begin (thread->buf, EVENT_DEBUG_ANNOTATIONS);
+
+  pb_uint (thread->buf, ANNOTATION_NAME_IID, name);
+  pb_string (thread->buf, ANNOTATION_STRING_VALUE, v ? v : "");
+  pb_end (thread->buf, pos);
+}
+
+/* Starts a packet with a track event on the thread track. The event name is
+ * interned, @name may be %NULL for slice ends. Returns the position of the
+ * event message, which has to be closed with perfetto_event_end(). */
+static guint
+perfetto_event_begin (GstPerfettoThread * thread, guint64 ts, guint type,
+    const gchar * name, guint * packet)
+{
+  guint64 iid = 0;
+  guint pos;
+
+  *packet = perfetto_packet_begin (thread, ts, SEQ_NEEDS_INCREMENTAL_STATE);
+  if (name)
+    iid = perfetto_intern_event_name (thread, name);
+
+  pos = pb_begin (thread->buf, PACKET_TRACK_EVENT);
+  pb_uint (thread->buf, EVENT_TYPE, type);
+  pb_uint (thread->buf, EVENT_TRACK_UUID, thread->track_uuid);
+  if (iid)
+    pb_uint (thread->buf, EVENT_NAME_IID, iid);
+
+  return pos;
+}
+
+static inline void
+perfetto_event_end (GstPerfettoThread * thread, guint pos, guint packet)
+{
+  pb_end (thread->buf, pos);
+  perfetto_packet_end (thread, packet);
+}
+
+static void
+perfetto_slice_end (GstPerfettoThread * thread, guint64 ts, GstFlowReturn res)
+{
+  guint packet, pos;
+
+  pos = perfetto_event_begin (thread, ts, EVENT_TYPE_SLICE_END, NULL, &packet);
+  if (res != GST_FLOW_OK)
+    perfetto_annotation_string (thread, ANNOTATION_RESULT,
+        gst_flow_get_name (res));
+  perfetto_event_end (thread, pos, packet);
+}
+
+static void
+perfetto_counter (GstPerfettoThread * thread, guint64 ts, guint64 uuid,
+    gint64 value)
+{
+  guint packet, pos;
+
+  packet = perfetto_packet_begin (thread, ts, 0);
+  pos = pb_begin (thread->buf, PACKET_TRACK_EVENT);
+  pb_uint (thread->buf, EVENT_TYPE, EVENT_TYPE_COUNTER);
+  pb_uint (thread->buf, EVENT_TRACK_UUID, uuid);
+  pb_uint (thread->buf, EVENT_COUNTER_VALUE, (guint64) value);
+  perfetto_event_end (thread, pos, packet);
+}
+
+/* elements */
+
+static GstPerfettoElement *
+perfetto_element_get (GstPerfettoTracer * self, GstPerfettoThread * thread,
+    GstElement * element, guint64 ts)
+{
+  GstPerfettoElement *e;
+  GstElementFactory *factory;
+  const gchar *factory_name;
+
+  e = g_object_get_qdata ((GObject *) element, perfetto_element_quark);
+  if (G_LIKELY (e != NULL && e->tracer == self))
+    return e;
+
+  g_mutex_lock (&perfetto_lock);
+  e = g_object_get_qdata ((GObject *) element, perfetto_element_quark);
+  if (e == NULL || e->tracer != self) {
+    e = g_new0 (GstPerfettoElement, 1);
+    e->tracer = self;
+    e->sample_slot = -1;
+
+    factory = gst_element_get_factory (element);
+    factory_name = factory ? GST_OBJECT_NAME (factory) : NULL;
+    e->is_queue = !g_strcmp0 (factory_name, "queue")
+        || !g_strcmp0 (factory_name, "queue2");
+
+    if (e->is_queue) {
+      static const gchar *suffix[] = { "buffers", "bytes", "time" };
+      static const guint units[] = { COUNTER_UNIT_COUNT,
+        COUNTER_UNIT_SIZE_BYTES, COUNTER_UNIT_TIME_NS
+      };
+      guint i;
+
+      for (i = 0; i < 3; i++) {
+        gchar *name = g_strdup_printf ("%s level %s",
+            GST_OBJECT_NAME (element), suffix[i]);
+
+        e->level_uuids[i] = ++perfetto_next_uuid;
+        perfetto_write_counter_descriptor (self, thread, ts,
+            e->level_uuids[i], name, units[i]);
+        g_free (name);
+      }
+    }
+    g_object_set_qdata_full ((GObject *) element, perfetto_element_quark, e,
+        g_free);
+  }
+  g_mutex_unlock (&perfetto_lock);
+
+  return e;
+}
+
+static void
+perfetto_sample_queue (GstPerfettoTracer * self, GstPerfettoThread * thread,
+    GstObject * parent, guint64 ts)
+{
+  GstPerfettoElement *e;
+  guint buffers, bytes;
+  guint64 time;
+
+  if (!GST_IS_ELEMENT (parent))
+    return;
+
+  e = perfetto_element_get (self, thread, GST_ELEMENT_CAST (parent), ts);
+  if (!e->is_queue)
+    return;
+
+  /* Reading the properties takes the queue lock and goes through GValues,
+   * so only sample once per interval. Both sides of a queue sample it,
+   * whichever thread comes first in a new interval does. */
+  if (self->sample_interval > 0) {
+    gint slot = (gint) (ts / self->sample_interval);
+    gint last = g_atomic_int_get (&e->sample_slot);
+
+    if (slot == last
+        || !g_atomic_int_compare_and_exchange (&e->sample_slot, last, slot))
+      return;
+  }
+
+  g_object_get (parent, "current-level-buffers", &buffers,
+      "current-level-bytes", &bytes, "current-level-time", &time, NULL);
+
+  perfetto_counter (thread, ts, e->level_uuids[0], buffers);
+  perfetto_counter (thread, ts, e->level_uuids[1], bytes);
+  perfetto_counter (thread, ts, e->level_uuids[2], time);
+}
+
+/* hooks */
+
+static void
+perfetto_pad_slice_begin (GstPerfettoThread * thread, guint64 ts,
+    GstPad * pad, GstBuffer * buffer, guint n_buffers)
+{
+  gchar name[128];
+  guint packet, pos;
+
+  g_snprintf (name, sizeof (name), "%s:%s", GST_DEBUG_PAD_NAME (pad));
+
+  pos = perfetto_event_begin (thread, ts, EVENT_TYPE_SLICE_BEGIN, name,
+      &packet);
+  if (buffer) {
+    if (GST_BUFFER_PTS_IS_VALID (buffer))
+      perfetto_annotation_uint (thread, ANNOTATION_PTS,
+          GST_BUFFER_PTS (buffer));
+    perfetto_annotation_uint (thread, ANNOTATION_SIZE,
+        gst_buffer_get_size (buffer));
+  }
+  if (n_buffers)
+    perfetto_annotation_uint (thread, ANNOTATION_BUFFERS, n_buffers);
+  perfetto_event_end (thread, pos, packet);
+}
+
+static void
+do_push_buffer_pre (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+
+  if (thread == NULL)
+    return;
+
+  perfetto_sample_queue (self, thread, GST_OBJECT_PARENT (pad), ts);
+  perfetto_pad_slice_begin (thread, ts, pad, buffer, 0);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_push_buffer_list_pre (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstBufferList * list)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+
+  if (thread == NULL)
+    return;
+
+  perfetto_sample_queue (self, thread, GST_OBJECT_PARENT (pad), ts);
+  perfetto_pad_slice_begin (thread, ts, pad, NULL,
+      gst_buffer_list_length (list));
+  perfetto_thread_release (thread);
+}
+
+static void
+do_push_buffer_post (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+  GstPad *peer;
+
+  if (thread == NULL)
+    return;
+
+  perfetto_slice_end (thread, ts, res);
+
+  /* the data went into a queue, sample its new fill level */
+  peer = GST_PAD_PEER (pad);
+  if (peer)
+    perfetto_sample_queue (self, thread, GST_OBJECT_PARENT (peer), ts);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_pull_range_pre (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+  gchar name[128];
+  guint packet, pos;
+
+  if (thread == NULL)
+    return;
+
+  g_snprintf (name, sizeof (name), "%s:%s", GST_DEBUG_PAD_NAME (pad));
+
+  pos = perfetto_event_begin (thread, ts, EVENT_TYPE_SLICE_BEGIN, name,
+      &packet);
+  perfetto_annotation_uint (thread, ANNOTATION_OFFSET, offset);
+  perfetto_annotation_uint (thread, ANNOTATION_SIZE, size);
+  perfetto_event_end (thread, pos, packet);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_pull_range_post (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+
+  if (thread == NULL)
+    return;
+
+  perfetto_slice_end (thread, ts, res);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_push_event_pre (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstEvent * event)
+{
+  GstPerfettoThread *thread;
+  gchar pad_name[128];
+  guint packet, pos;
+
+  if (!GST_EVENT_IS_SERIALIZED (event))
+    return;
+
+  thread = perfetto_thread_acquire (self, ts);
+  if (thread == NULL)
+    return;
+
+  g_snprintf (pad_name, sizeof (pad_name), "%s:%s", GST_DEBUG_PAD_NAME (pad));
+
+  pos = perfetto_event_begin (thread, ts, EVENT_TYPE_INSTANT,
+      GST_EVENT_TYPE_NAME (event), &packet);
+  perfetto_annotation_string (thread, ANNOTATION_PAD, pad_name);
+  perfetto_event_end (thread, pos, packet);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_query_post (GstPerfettoTracer * self, guint64 ts, GstPad * pad,
+    GstQuery * query, gboolean res)
+{
+  GstPerfettoThread *thread;
+  GstPerfettoElement *e;
+  GstObject *parent;
+  GstClockTime min;
+  gboolean live;
+
+  if (!res || GST_QUERY_TYPE (query) != GST_QUERY_LATENCY)
+    return;
+
+  parent = GST_OBJECT_PARENT (pad);
+  if (!GST_IS_ELEMENT (parent))
+    return;
+
+  gst_query_parse_latency (query, &live, &min, NULL);
+  if (!live || !GST_CLOCK_TIME_IS_VALID (min))
+    return;
+
+  thread = perfetto_thread_acquire (self, ts);
+  if (thread == NULL)
+    return;
+
+  e = perfetto_element_get (self, thread, GST_ELEMENT_CAST (parent), ts);
+  if (e->latency_uuid == 0) {
+    g_mutex_lock (&perfetto_lock);
+    if (e->latency_uuid == 0) {
+      gchar *name = g_strdup_printf ("%s latency", GST_OBJECT_NAME (parent));
+      guint64 uuid = ++perfetto_next_uuid;
+
+      perfetto_write_counter_descriptor (self, thread, ts, uuid, name,
+          COUNTER_UNIT_TIME_NS);
+      e->latency_uuid = uuid;
+      g_free (name);
+    }
+    g_mutex_unlock (&perfetto_lock);
+  }
+  perfetto_counter (thread, ts, e->latency_uuid, min);
+  perfetto_thread_release (thread);
+}
+
+static void
+do_element_new (GstPerfettoTracer * self, guint64 ts, GstElement * element)
+{
+  GstPerfettoThread *thread = perfetto_thread_acquire (self, ts);
+  GstElementFactory *factory = gst_element_get_factory (element);
+  guint packet, pos;
+
+  if (thread == NULL)
+    return;
+
+  pos = perfetto_event_begin (thread, ts, EVENT_TYPE_INSTANT, "element-new",
+      &packet);
+  perfetto_annotation_string (thread, ANNOTATION_ELEMENT,
+      GST_OBJECT_NAME (element));
+  if (factory)
+    perfetto_annotation_string (thread, ANNOTATION_FACTORY,
+        GST_OBJECT_NAME (factory));
+  perfetto_event_end (thread, pos, packet);
+  perfetto_thread_release (thread);
+}
+
+/* writer thread */
+
+static gpointer
+perfetto_writer_func (gpointer data)
+{
+  GstPerfettoTracer *self = data;
+  GByteArray *chunk;
+
+  while ((chunk = g_async_queue_pop (self->chunks)) != &perfetto_writer_stop) {
+    if (self->file && fwrite (chunk->data, 1, chunk->len, self->file)
+        != chunk->len) {
+      GST_WARNING_OBJECT (self, "failed to write trace: %s",
+          g_strerror (errno));
+    }
+    g_byte_array_unref (chunk);
+  }
+
+  return NULL;
+}
+
+/* tracer class */
+
+static void
+gst_perfetto_tracer_constructed (GObject * object)
+{
+  GstPerfettoTracer *self = GST_PERFETTO_TRACER (object);
+  gchar *location;
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  if (self->location)
+    location = g_strdup (self->location);
+  else
+    location = g_strdup_printf ("gst-%d.perfetto-trace", perfetto_get_pid ());
+
+  self->file = g_fopen (location, "wb");
+  if (self->file == NULL) {
+    GST_ERROR_OBJECT (self, "failed to open '%s' for writing: %s", location,
+        g_strerror (errno));
+  } else {
+    GST_INFO_OBJECT (self, "writing trace to '%s'", location);
+  }
+  g_free (location);
+
+  self->writer = g_thread_new ("perfetto-writer", perfetto_writer_func, self);
+}
+
+static void
+gst_perfetto_tracer_finalize (GObject * object)
+{
+  GstPerfettoTracer *self = GST_PERFETTO_TRACER (object);
+
+  /* no new events after this, then hand over whatever the threads did not
+   * flush yet once they are done with the event they are writing */
+  g_atomic_int_set (&self->stopped, TRUE);
+  g_mutex_lock (&perfetto_lock);
+  while (self->threads) {
+    GstPerfettoThread *thread = self->threads->data;
+
+    if (g_atomic_int_get (&thread->writing)) {
+      /* the hook might need the lock to finish */
+      g_mutex_unlock (&perfetto_lock);
+      g_thread_yield ();
+      g_mutex_lock (&perfetto_lock);
+      continue;
+    }
+    perfetto_thread_detach (thread);
+  }
+  g_mutex_unlock (&perfetto_lock);
+
+  g_async_queue_push (self->chunks, &perfetto_writer_stop);
+  g_thread_join (self->writer);
+
+  if (self->file)
+    fclose (self->file);
+  g_async_queue_unref (self->chunks);
+  g_free (self->location);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_perfetto_tracer_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstPerfettoTracer *self = GST_PERFETTO_TRACER (object);
+
+  switch (prop_id) {
+    case PROP_FILE:
+      g_free (self->location);
+      self->location = g_value_dup_string (value);
+      break;
+    case PROP_BUFFER_SIZE:
+      self->buffer_size = g_value_get_uint (value);
+      break;
+    case PROP_SAMPLE_INTERVAL:
+      self->sample_interval = g_value_get_uint64 (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_perfetto_tracer_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstPerfettoTracer *self = GST_PERFETTO_TRACER (object);
+
+  switch (prop_id) {
+    case PROP_FILE:
+      g_value_set_string (value, self->location);
+      break;
+    case PROP_BUFFER_SIZE:
+      g_value_set_uint (value, self->buffer_size);
+      break;
+    case PROP_SAMPLE_INTERVAL:
+      g_value_set_uint64 (value, self->sample_interval);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_perfetto_tracer_class_init (GstPerfettoTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_perfetto_tracer_constructed;
+  gobject_class->finalize = gst_perfetto_tracer_finalize;
+  gobject_class->set_property = gst_perfetto_tracer_set_property;
+  gobject_class->get_property = gst_perfetto_tracer_get_property;
+
+  gst_tracer_class_set_use_structure_params (GST_TRACER_CLASS (klass), TRUE);
+
+  /**
+   * GstPerfettoTracer:file:
+   *
+   * The file the trace is written to. Defaults to
+   * `gst-<pid>.perfetto-trace` in the current directory.
+   *
+   * Since: 1.30
+   */
+  properties[PROP_FILE] = g_param_spec_string ("file", "File",
+      "Location of the trace file", NULL,
+      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GstPerfettoTracer:buffer-size:
+   *
+   * Size in bytes of the per-thread event buffers. A buffer is handed to the
+   * writer thread once it is full.
+   *
+   * Since: 1.30
+   */
+  properties[PROP_BUFFER_SIZE] = g_param_spec_uint ("buffer-size",
+      "Buffer size", "Size of the per-thread event buffers in bytes",
+      1024, G_MAXINT, DEFAULT_BUFFER_SIZE,
+      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * GstPerfettoTracer:sample-interval:
+   *
+   * Minimum time in nanoseconds between two samples of the fill level of a
+   * queue. Set to 0 to sample it on every push, which is expensive as the
+   * level is read through the properties of the queue.
+   *
+   * Since: 1.30
+   */
+  properties[PROP_SAMPLE_INTERVAL] = g_param_spec_uint64 ("sample-interval",
+      "Sample interval", "Minimum time between two samples of the fill level "
+      "of a queue in nanoseconds, 0 to sample every push", 0, G_MAXUINT64,
+      DEFAULT_SAMPLE_INTERVAL,
+      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, properties);
+
+  perfetto_element_quark = g_quark_from_static_string ("GstPerfettoElement");
+}
+
+static void
+gst_perfetto_tracer_init (GstPerfettoTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  self->buffer_size = DEFAULT_BUFFER_SIZE;
+  self->sample_interval = DEFAULT_SAMPLE_INTERVAL;
+  self->chunks = g_async_queue_new ();
+  self->process_uuid = ((guint64) perfetto_get_pid ()) << 32;
+
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-pull-range-pre",
+      G_CALLBACK (do_pull_range_pre));
+  gst_tracing_register_hook (tracer, "pad-pull-range-post",
+      G_CALLBACK (do_pull_range_post));
+  gst_tracing_register_hook (tracer, "pad-push-event-pre",
+      G_CALLBACK (do_push_event_pre));
+  gst_tracing_register_hook (tracer, "pad-query-post",
+      G_CALLBACK (do_query_post));
+  gst_tracing_register_hook (tracer, "element-new",
+      G_CALLBACK (do_element_new));
+}
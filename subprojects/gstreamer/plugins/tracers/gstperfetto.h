@@ -0,0 +1,88 @@
+/* GStreamer
+ *
+ * gstperfetto.h: tracing module that writes perfetto timeline traces
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PERFETTO_TRACER_H__
+#define __GST_PERFETTO_TRACER_H__
+
+#include <stdio.h>
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_PERFETTO_TRACER \
+  (gst_perfetto_tracer_get_type())
+#define GST_PERFETTO_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_PERFETTO_TRACER,GstPerfettoTracer))
+#define GST_PERFETTO_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_PERFETTO_TRACER,GstPerfettoTracerClass))
+#define GST_IS_PERFETTO_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_PERFETTO_TRACER))
+#define GST_IS_PERFETTO_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_PERFETTO_TRACER))
+#define GST_PERFETTO_TRACER_CAST(obj) ((GstPerfettoTracer *)(obj))
+
+typedef struct _GstPerfettoTracer GstPerfettoTracer;
+typedef struct _GstPerfettoTracerClass GstPerfettoTracerClass;
+
+/**
+ * GstPerfettoTracer:
+ *
+ * Opaque #GstPerfettoTracer data structure
+ *
+ * Since: 1.30
+ */
+struct _GstPerfettoTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  gchar *location;
+  guint buffer_size;
+  GstClockTime sample_interval;
+
+  FILE *file;
+  GThread *writer;
+  GAsyncQueue *chunks;
+
+  /* protected by the global perfetto lock */
+  GList *threads;
+
+  gint next_sequence_id;
+  guint64 process_uuid;
+  gint process_written;
+
+  /* monotonic time of gst_init(), set with the global perfetto lock */
+  GstClockTime ts_offset;
+  /* set when finalizing, no more events are written */
+  gint stopped;
+};
+
+struct _GstPerfettoTracerClass {
+  GstTracerClass parent_class;
+
+  /* signals */
+};
+
+G_GNUC_INTERNAL GType gst_perfetto_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_PERFETTO_TRACER_H__ */
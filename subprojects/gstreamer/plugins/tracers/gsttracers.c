@@ -29,6 +29,7 @@
 #include "gstrusage.h"
 #include "gststats.h"
 #include "gstleaks.h"
+#include "gstperfetto.h"
 #include "gstfactories.h"
 
 GType gst_dots_tracer_get_type (void);
@@ -56,6 +57,9 @@ plugin_init (GstPlugin * plugin)
   if (!gst_tracer_register (plugin, "factories",
           gst_factories_tracer_get_type ()))
     return FALSE;
+  if (!gst_tracer_register (plugin, "perfetto",
+          gst_perfetto_tracer_get_type ()))
+    return FALSE;
   return TRUE;
 }
 
@@ -0,0 +1,180 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Splits bitstreams into NAL units the way the codec parsers do, by
+ * repeatedly searching for the next 00 00 01 start code, and compares
+ * gst_byte_reader_masked_scan_uint32() against the byte-by-byte scanner it
+ * used before it was vectorized. Pass H.264/H.265 elementary streams on
+ * the command line, otherwise a synthetic stream with NAL units of random
+ * sizes is used. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/base/gstbytereader.h>
+
+#define DEFAULT_ITERATIONS 20
+#define SYNTHETIC_SIZE (16 * 1024 * 1024)
+
+/* the scanner gstbytereader.c used before it had vector versions */
+static gint
+scan_for_start_code_scalar (const guint8 * data, guint size)
+{
+  const guint8 *pdata = data;
+  const guint8 *pend = data + size - 4;
+
+  while (pdata <= pend) {
+    if (pdata[2] > 1) {
+      pdata += 3;
+    } else if (pdata[1]) {
+      pdata += 2;
+    } else if (pdata[0] || pdata[2] != 1) {
+      pdata++;
+    } else {
+      return (pdata - data);
+    }
+  }
+
+  return -1;
+}
+
+static guint8 *
+make_synthetic_stream (gsize size)
+{
+  GRand *rand = g_rand_new_with_seed (0);
+  guint8 *data = g_malloc (size);
+  gsize pos = 0, i;
+
+  while (pos < size) {
+    /* slices are a few kilobytes, with the odd small parameter set */
+    gsize nal_size = g_rand_boolean (rand) ? g_rand_int_range (rand, 8, 64) :
+        g_rand_int_range (rand, 1024, 64 * 1024);
+
+    nal_size = MIN (nal_size, size - pos);
+    for (i = 0; i < nal_size; i++)
+      data[pos + i] = g_rand_int (rand);
+    /* an encoder would have inserted emulation prevention bytes */
+    for (i = 2; i < nal_size; i++) {
+      if (data[pos + i - 2] == 0 && data[pos + i - 1] == 0
+          && data[pos + i] <= 3)
+        data[pos + i] = 0x80;
+    }
+    if (nal_size >= 4)
+      memcpy (data + pos, "\000\000\001\145", 4);
+    pos += nal_size;
+  }
+
+  g_rand_free (rand);
+  return data;
+}
+
+static guint
+split_stream (const guint8 * data, gsize size, gboolean scalar)
+{
+  GstByteReader reader;
+  guint n_nals = 0;
+  gint off;
+
+  gst_byte_reader_init (&reader, data, size);
+  while (gst_byte_reader_get_remaining (&reader) >= 4) {
+    if (scalar) {
+      off = scan_for_start_code_scalar (data + reader.byte,
+          gst_byte_reader_get_remaining (&reader));
+    } else {
+      off = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffff00,
+          0x00000100, 0, gst_byte_reader_get_remaining (&reader));
+    }
+    if (off < 0)
+      break;
+    n_nals++;
+    gst_byte_reader_skip_unchecked (&reader, off + 3);
+  }
+
+  return n_nals;
+}
+
+static GstClockTime
+run (const guint8 * data, gsize size, guint iterations, gboolean scalar,
+    guint * n_nals)
+{
+  GstClockTime start;
+  guint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < iterations; i++)
+    *n_nals = split_stream (data, size, scalar);
+
+  return gst_util_get_timestamp () - start;
+}
+
+static void
+bench (const gchar * name, const guint8 * data, gsize size, guint iterations)
+{
+  GstClockTime scalar_time, simd_time;
+  guint scalar_nals, simd_nals;
+  gdouble mbytes = (gdouble) size * iterations / (1024 * 1024);
+
+  scalar_time = run (data, size, iterations, TRUE, &scalar_nals);
+  simd_time = run (data, size, iterations, FALSE, &simd_nals);
+  if (scalar_nals != simd_nals)
+    g_printerr ("%s: found %u NAL units instead of %u\n", name, simd_nals,
+        scalar_nals);
+
+  g_print ("*** %s: %" G_GSIZE_FORMAT " bytes, %u NAL units\n", name, size,
+      simd_nals);
+  g_print ("%" GST_TIME_FORMAT " - scalar, %.1f MB/s\n",
+      GST_TIME_ARGS (scalar_time),
+      mbytes / ((gdouble) MAX (scalar_time, 1) / GST_SECOND));
+  g_print ("%" GST_TIME_FORMAT " - gst_byte_reader_masked_scan_uint32, "
+      "%.1f MB/s (%.2fx)\n", GST_TIME_ARGS (simd_time),
+      mbytes / ((gdouble) MAX (simd_time, 1) / GST_SECOND),
+      (gdouble) scalar_time / MAX (simd_time, 1));
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint iterations = DEFAULT_ITERATIONS;
+  gint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    iterations = atoi (argv[1]);
+
+  if (argc > 2) {
+    for (i = 2; i < argc; i++) {
+      gchar *contents;
+      gsize size;
+
+      if (!g_file_get_contents (argv[i], &contents, &size, NULL)) {
+        g_printerr ("could not read %s\n", argv[i]);
+        return 1;
+      }
+      bench (argv[i], (const guint8 *) contents, size, iterations);
+      g_free (contents);
+    }
+  } else {
+    guint8 *data = make_synthetic_stream (SYNTHETIC_SIZE);
+
+    bench ("synthetic", data, SYNTHETIC_SIZE, iterations);
+    g_free (data);
+  }
+
+  return 0;
+}
@@ -181,6 +181,16 @@ event_loop (GstElement * bin)
   gst_object_unref (bus);
 }
 
+/* the caps cache is configured in gst_init(), which runs as part of the
+ * option parsing, so set up the environment directly from the callback */
+static gboolean
+set_caps_cache_size (const gchar * option_name, const gchar * value,
+    gpointer data, GError ** error)
+{
+  g_setenv ("GST_CAPS_CACHE_SIZE", value, TRUE);
+  return TRUE;
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -206,6 +216,11 @@ main (gint argc, gchar * argv[])
     {"loops", 'l', 0, G_OPTION_ARG_INT, &loops,
         "How many loops to run (default: 50)", NULL}
     ,
+    {"memo", 'm', 0, G_OPTION_ARG_CALLBACK, set_caps_cache_size,
+          "Size of the caps intersection/subset memo cache, run with "
+          "GST_DEBUG=GST_CAPS:4 to see the hit rate (default: 0, disabled)",
+        NULL}
+    ,
     {NULL}
   };
   GError *err = NULL;
@@ -269,5 +284,6 @@ main (gint argc, gchar * argv[])
 Error:
   gst_element_set_state (GST_ELEMENT (bin), GST_STATE_NULL);
   gst_object_unref (bin);
+  gst_deinit ();
   return 0;
 }
@@ -0,0 +1,166 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Pushes buffers from fakesrc through fdsink into a pipe that another
+ * thread reads from, like a consumer process would, and compares writing
+ * them with splicing them. When a file is given, it is also read with fdsrc
+ * into a fakesink, once read into new buffers and once mapped.
+ *
+ *   fdzerocopy [BUFFER_SIZE [FILE]]
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <gst/gst.h>
+#include <glib/gstdio.h>
+
+#define DEFAULT_BUFFER_SIZE (64 * 1024)
+#define PIPE_BYTES (G_GUINT64_CONSTANT (2) * 1024 * 1024 * 1024)
+
+static gpointer
+read_pipe (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+  guint64 *bytes = g_new0 (guint64, 1);
+  gchar buf[64 * 1024];
+  gssize ret;
+
+  while ((ret = read (fd, buf, sizeof (buf))) > 0)
+    *bytes += ret;
+
+  return bytes;
+}
+
+static void
+run_pipeline (GstElement * pipeline)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    g_printerr ("pipeline failed\n");
+    exit (1);
+  }
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+}
+
+static void
+run_pipe (guint buffer_size, gboolean zero_copy)
+{
+  GstElement *pipeline;
+  GThread *reader;
+  GstClockTime start, elapsed;
+  guint64 *bytes;
+  gint fds[2];
+  gchar *desc;
+
+  if (pipe (fds) < 0) {
+    g_printerr ("could not create a pipe\n");
+    exit (1);
+  }
+
+  desc = g_strdup_printf ("fakesrc num-buffers=%" G_GUINT64_FORMAT
+      " sizetype=fixed sizemax=%u filltype=nothing ! fdsink fd=%d "
+      "zero-copy=%d", PIPE_BYTES / buffer_size, buffer_size, fds[1],
+      zero_copy);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+
+  reader = g_thread_new ("reader", read_pipe, GINT_TO_POINTER (fds[0]));
+
+  start = gst_util_get_timestamp ();
+  run_pipeline (pipeline);
+  close (fds[1]);
+  bytes = g_thread_join (reader);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_print ("%" GST_TIME_FORMAT " - pipe, buffer-size=%u, zero-copy=%d, "
+      "%.1f MB/s\n", GST_TIME_ARGS (elapsed), buffer_size, zero_copy,
+      (gdouble) * bytes / (1024 * 1024) /
+      ((gdouble) MAX (elapsed, 1) / GST_SECOND));
+
+  g_free (bytes);
+  close (fds[0]);
+  gst_object_unref (pipeline);
+}
+
+static void
+run_file (const gchar * location, guint buffer_size, gboolean zero_copy)
+{
+  GstElement *pipeline;
+  GstClockTime start, elapsed;
+  GStatBuf stat_buf;
+  gchar *desc;
+  gint fd;
+
+  fd = g_open (location, O_RDONLY, 0);
+  if (fd < 0 || g_stat (location, &stat_buf) < 0) {
+    g_printerr ("could not open %s\n", location);
+    exit (1);
+  }
+
+  desc = g_strdup_printf ("fdsrc fd=%d blocksize=%u zero-copy=%d ! "
+      "fakesink", fd, buffer_size, zero_copy);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+
+  start = gst_util_get_timestamp ();
+  run_pipeline (pipeline);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_print ("%" GST_TIME_FORMAT " - file, buffer-size=%u, zero-copy=%d, "
+      "%.1f MB/s\n", GST_TIME_ARGS (elapsed), buffer_size, zero_copy,
+      (gdouble) stat_buf.st_size / (1024 * 1024) /
+      ((gdouble) MAX (elapsed, 1) / GST_SECOND));
+
+  g_close (fd, NULL);
+  gst_object_unref (pipeline);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint buffer_size = DEFAULT_BUFFER_SIZE;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    buffer_size = atoi (argv[1]);
+  if (buffer_size == 0) {
+    g_printerr ("usage: %s [BUFFER_SIZE [FILE]]\n", argv[0]);
+    return 1;
+  }
+
+  run_pipe (buffer_size, FALSE);
+  run_pipe (buffer_size, TRUE);
+
+  if (argc > 2) {
+    /* the first run brings the file into the page cache */
+    run_file (argv[2], buffer_size, FALSE);
+    run_file (argv[2], buffer_size, FALSE);
+    run_file (argv[2], buffer_size, TRUE);
+  }
+
+  return 0;
+}
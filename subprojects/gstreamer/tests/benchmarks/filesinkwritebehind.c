@@ -0,0 +1,117 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Writes buffers of a few sizes to a file with filesink, synchronously and
+ * with the write-behind modes, and reports the throughput including closing
+ * the file and how long the writes were in flight. Pass a location on the
+ * disk that is to be measured, the file is removed afterwards.
+ *
+ *   filesinkwritebehind FILE [MEGABYTES [WRITE_BEHIND]]
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+#include <glib/gstdio.h>
+
+#define DEFAULT_MEGABYTES 1024
+#define DEFAULT_WRITE_BEHIND 4
+
+static void
+run (const gchar * location, guint megabytes, guint buffer_size,
+    guint write_behind, gboolean direct_io)
+{
+  GstElement *pipeline, *sink;
+  GstBus *bus;
+  GstMessage *msg;
+  GstClockTime start, elapsed;
+  guint64 average_latency = 0, max_latency = 0;
+  gchar *desc;
+
+  desc = g_strdup_printf ("fakesrc num-buffers=%" G_GUINT64_FORMAT
+      " sizetype=fixed sizemax=%u filltype=nothing ! filesink name=sink "
+      "location=\"%s\" write-behind=%u direct-io=%d sync-interval=%u",
+      (guint64) megabytes * 1024 * 1024 / buffer_size, buffer_size, location,
+      write_behind, direct_io, write_behind > 0 ? 16 * 1024 * 1024 : 0);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  if (pipeline == NULL) {
+    g_printerr ("could not create the pipeline\n");
+    exit (1);
+  }
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  bus = gst_element_get_bus (pipeline);
+
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  g_object_get (sink, "average-write-latency", &average_latency,
+      "max-write-latency", &max_latency, NULL);
+  /* closing waits for everything in flight */
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  elapsed = gst_util_get_timestamp () - start;
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    g_printerr ("could not write %s\n", location);
+    exit (1);
+  }
+
+  g_print ("%" GST_TIME_FORMAT " - %u byte buffers, write-behind=%u%s, "
+      "%.1f MB/s", GST_TIME_ARGS (elapsed), buffer_size, write_behind,
+      direct_io ? " direct-io" : "",
+      (gdouble) megabytes / ((gdouble) MAX (elapsed, 1) / GST_SECOND));
+  if (write_behind > 0)
+    g_print (", latency %" G_GUINT64_FORMAT " us average, %" G_GUINT64_FORMAT
+        " us max", average_latency / 1000, max_latency / 1000);
+  g_print ("\n");
+
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+  g_remove (location);
+}
+
+static const guint buffer_sizes[] = { 1316, 64 * 1024, 1024 * 1024 };
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint megabytes = DEFAULT_MEGABYTES;
+  guint write_behind = DEFAULT_WRITE_BEHIND;
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_printerr ("usage: %s FILE [MEGABYTES [WRITE_BEHIND]]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 2)
+    megabytes = atoi (argv[2]);
+  if (argc > 3)
+    write_behind = atoi (argv[3]);
+
+  for (i = 0; i < G_N_ELEMENTS (buffer_sizes); i++) {
+    run (argv[1], megabytes, buffer_sizes[i], 0, FALSE);
+    run (argv[1], megabytes, buffer_sizes[i], write_behind, FALSE);
+    run (argv[1], megabytes, buffer_sizes[i], write_behind, TRUE);
+  }
+
+  return 0;
+}
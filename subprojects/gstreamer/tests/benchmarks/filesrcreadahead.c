@@ -0,0 +1,192 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Pulls a large file from filesrc the way demuxers in pull mode do, and
+ * compares synchronous reads with the read-ahead modes. The "mkv" pattern
+ * reads element headers and block payloads one after the other, the "mp4"
+ * pattern first reads the index at the end of the file and then alternates
+ * between a video and an audio region. The page cache is dropped for the
+ * file before each run where possible, so pass a file much larger than the
+ * blocks that are read ahead.
+ *
+ *   filesrcreadahead FILE [READ_AHEAD [READ_AHEAD_SIZE]]
+ */
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <gst/gst.h>
+#include <glib/gstdio.h>
+
+#define DEFAULT_READ_AHEAD 8
+#define DEFAULT_READ_AHEAD_SIZE (256 * 1024)
+
+typedef guint64 (*PatternFunc) (GstPad * pad, guint64 size, GRand * rand);
+
+static guint64
+pull (GstPad * pad, guint64 offset, guint length)
+{
+  GstBuffer *buffer = NULL;
+  gsize size;
+
+  if (gst_pad_get_range (pad, offset, length, &buffer) != GST_FLOW_OK)
+    return 0;
+
+  size = gst_buffer_get_size (buffer);
+  gst_buffer_unref (buffer);
+
+  return size;
+}
+
+static guint64
+pattern_mkv (GstPad * pad, guint64 size, GRand * rand)
+{
+  guint64 offset = 0, bytes = 0;
+  guint payload;
+
+  while (offset < size) {
+    /* element id and size, then the block */
+    bytes += pull (pad, offset, 12);
+    payload = g_rand_int_range (rand, 1024, 64 * 1024);
+    bytes += pull (pad, offset + 12, payload);
+    offset += 12 + payload;
+  }
+
+  return bytes;
+}
+
+static guint64
+pattern_mp4 (GstPad * pad, guint64 size, GRand * rand)
+{
+  guint64 index = MIN (size, 512 * 1024);
+  guint64 audio_start = (size - index) / 10 * 9;
+  guint64 video = 0, audio = audio_start, offset, bytes = 0;
+  guint sample;
+
+  /* parse the moov at the end */
+  for (offset = size - index; offset < size; offset += 8 * 1024)
+    bytes += pull (pad, offset, 8 * 1024);
+
+  while (video < audio_start || audio < size - index) {
+    if (video < audio_start) {
+      sample = g_rand_int_range (rand, 4 * 1024, 64 * 1024);
+      bytes += pull (pad, video, MIN (sample, audio_start - video));
+      video += sample;
+    }
+    if (audio < size - index) {
+      sample = g_rand_int_range (rand, 512, 2048);
+      bytes += pull (pad, audio, MIN (sample, size - index - audio));
+      audio += sample;
+    }
+  }
+
+  return bytes;
+}
+
+static void
+drop_page_cache (const gchar * location)
+{
+#ifdef POSIX_FADV_DONTNEED
+  gint fd = g_open (location, O_RDONLY, 0);
+
+  if (fd >= 0) {
+    posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+    g_close (fd, NULL);
+  }
+#endif
+}
+
+static void
+run (const gchar * location, const gchar * name, PatternFunc func,
+    guint read_ahead, guint read_ahead_size, gboolean direct_io)
+{
+  GstElement *src;
+  GstPad *pad;
+  GRand *rand;
+  GstClockTime start, elapsed;
+  gint64 size;
+  guint64 bytes;
+
+  src = gst_element_factory_make ("filesrc", NULL);
+  g_object_set (src, "location", location, "read-ahead", read_ahead,
+      "read-ahead-size", read_ahead_size, "direct-io", direct_io, NULL);
+  gst_element_set_state (src, GST_STATE_READY);
+  pad = gst_element_get_static_pad (src, "src");
+  if (!gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE) ||
+      !gst_pad_query_duration (pad, GST_FORMAT_BYTES, &size)) {
+    g_printerr ("could not read %s\n", location);
+    exit (1);
+  }
+  gst_element_set_state (src, GST_STATE_PLAYING);
+
+  drop_page_cache (location);
+  rand = g_rand_new_with_seed (0);
+
+  start = gst_util_get_timestamp ();
+  bytes = func (pad, size, rand);
+  elapsed = gst_util_get_timestamp () - start;
+
+  g_print ("%" GST_TIME_FORMAT " - %s, read-ahead=%u%s, %.1f MB/s\n",
+      GST_TIME_ARGS (elapsed), name, read_ahead,
+      direct_io ? " direct-io" : "",
+      (gdouble) bytes / (1024 * 1024) /
+      ((gdouble) MAX (elapsed, 1) / GST_SECOND));
+
+  g_rand_free (rand);
+  gst_element_set_state (src, GST_STATE_NULL);
+  gst_object_unref (pad);
+  gst_object_unref (src);
+}
+
+static const struct
+{
+  const gchar *name;
+  PatternFunc func;
+} patterns[] = {
+  {"mkv", pattern_mkv},
+  {"mp4", pattern_mp4},
+};
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint read_ahead = DEFAULT_READ_AHEAD;
+  guint read_ahead_size = DEFAULT_READ_AHEAD_SIZE;
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 2) {
+    g_printerr ("usage: %s FILE [READ_AHEAD [READ_AHEAD_SIZE]]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 2)
+    read_ahead = atoi (argv[2]);
+  if (argc > 3)
+    read_ahead_size = atoi (argv[3]);
+
+  for (i = 0; i < G_N_ELEMENTS (patterns); i++) {
+    run (argv[1], patterns[i].name, patterns[i].func, 0, read_ahead_size,
+        FALSE);
+    run (argv[1], patterns[i].name, patterns[i].func, read_ahead,
+        read_ahead_size, FALSE);
+    run (argv[1], patterns[i].name, patterns[i].func, read_ahead,
+        read_ahead_size, TRUE);
+  }
+
+  return 0;
+}
@@ -25,6 +25,7 @@
 #define MAX_THREADS  1000
 
 static guint64 nbbuffers;
+static gsize bufsize;
 static GMutex mutex;
 
 
@@ -44,14 +45,18 @@ run_test (void *user_data)
   g_assert_cmpuint (nbbuffers, >, 0);
 
   for (nb = nbbuffers; nb; nb--) {
-    buf = gst_buffer_new ();
+    if (bufsize > 0)
+      buf = gst_buffer_new_allocate (NULL, bufsize, NULL);
+    else
+      buf = gst_buffer_new ();
     gst_buffer_unref (buf);
   }
 
   end = gst_util_get_timestamp ();
   g_print ("total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
-      "  - Thread %d\n", GST_TIME_ARGS (end - start),
-      GST_TIME_ARGS ((end - start) / nbbuffers), threadid);
+      " - %.0f allocations/s - Thread %d\n", GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / nbbuffers),
+      (gdouble) nbbuffers * GST_SECOND / MAX (end - start, 1), threadid);
 
 
   g_thread_exit (NULL);
@@ -70,13 +75,15 @@ main (gint argc, gchar * argv[])
   gst_init (&argc, &argv);
   g_mutex_init (&mutex);
 
-  if (argc != 3) {
-    g_print ("usage: %s <num_threads> <nbbuffers>\n", argv[0]);
+  if (argc != 3 && argc != 4) {
+    g_print ("usage: %s <num_threads> <nbbuffers> [<bufsize>]\n", argv[0]);
+    g_print ("set GST_MAGAZINE_ALLOCATOR=1 to use the per-thread caches\n");
     exit (-1);
   }
 
   num_threads = atoi (argv[1]);
   nbbuffers = atoi (argv[2]);
+  bufsize = argc == 4 ? atoi (argv[3]) : 0;
 
   if (num_threads <= 0 || num_threads > MAX_THREADS) {
     g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
@@ -121,6 +128,8 @@ main (gint argc, gchar * argv[])
       GST_TIME_ARGS (end - start),
       GST_TIME_ARGS ((end - start) / (num_threads * nbbuffers)),
       num_threads * nbbuffers);
+  g_print ("*** %d threads: %.0f allocations/s\n", num_threads,
+      (gdouble) num_threads * nbbuffers * GST_SECOND / MAX (end - start, 1));
 
 
   gst_buffer_unref (tmp);
@@ -19,10 +19,21 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gst/gst.h>
 #include <gst/glib-compat-private.h>
 
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
 #define MAX_THREADS  100
+#define MAX_ENTRIES  100000
+
+#define ASYNC_INTERVAL  (10 * GST_MSECOND)
+/* jitter histogram with 10µs buckets, the last one collects everything */
+#define JITTER_BUCKET   (10 * GST_USECOND)
+#define JITTER_BUCKETS  1000
 
 static gboolean running = TRUE;
 static gint count = 0;
@@ -43,6 +54,103 @@ run_test (void *user_data)
   return NULL;
 }
 
+/* callbacks are all called from the clock thread, no locking needed */
+static guint64 n_callbacks;
+static GstClockTime max_jitter;
+static guint jitter_histogram[JITTER_BUCKETS];
+
+static gboolean
+async_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstClockTime now = gst_clock_get_time (clock);
+  GstClockTime jitter = now > time ? now - time : 0;
+
+  jitter_histogram[MIN (jitter / JITTER_BUCKET, JITTER_BUCKETS - 1)]++;
+  max_jitter = MAX (max_jitter, jitter);
+  n_callbacks++;
+
+  return TRUE;
+}
+
+static GstClockTime
+get_cpu_time (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+  return GST_TIMEVAL_TO_TIME (usage.ru_utime) +
+      GST_TIMEVAL_TO_TIME (usage.ru_stime);
+#else
+  return 0;
+#endif
+}
+
+static GstClockTime
+jitter_percentile (guint percent)
+{
+  guint64 count = 0;
+  guint i;
+
+  for (i = 0; i < JITTER_BUCKETS; i++) {
+    count += jitter_histogram[i];
+    if (count * 100 >= n_callbacks * percent)
+      break;
+  }
+  return (i + 1) * JITTER_BUCKET;
+}
+
+/* schedules @num_entries periodic async waits spread over one interval and
+ * measures how late their callbacks are called and how much CPU it costs */
+static void
+run_async_test (gint num_entries, gboolean timer_wheel)
+{
+  GstClockID *ids;
+  GstClock *clock;
+  GstClockTime base, cpu_start, cpu_end;
+  gint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "timer-wheel", timer_wheel,
+      NULL);
+  gst_object_ref_sink (clock);
+
+  n_callbacks = 0;
+  max_jitter = 0;
+  memset (jitter_histogram, 0, sizeof (jitter_histogram));
+
+  ids = g_new (GstClockID, num_entries);
+  base = gst_clock_get_time (clock) + 100 * GST_MSECOND;
+  for (i = 0; i < num_entries; i++) {
+    ids[i] = gst_clock_new_periodic_id (clock,
+        base + g_random_int_range (0, ASYNC_INTERVAL), ASYNC_INTERVAL);
+  }
+
+  cpu_start = get_cpu_time ();
+  for (i = 0; i < num_entries; i++)
+    gst_clock_id_wait_async (ids[i], async_cb, NULL, NULL);
+
+  /* run for 5 seconds */
+  g_usleep (G_USEC_PER_SEC * 5);
+
+  for (i = 0; i < num_entries; i++) {
+    gst_clock_id_unschedule (ids[i]);
+    gst_clock_id_unref (ids[i]);
+  }
+  cpu_end = get_cpu_time ();
+  g_free (ids);
+
+  /* makes sure the clock thread is done */
+  gst_object_unref (clock);
+
+  g_print ("%s: %d entries, %" G_GUINT64_FORMAT " callbacks, jitter p50 < %"
+      GST_TIME_FORMAT " p99 < %" GST_TIME_FORMAT " max %" GST_TIME_FORMAT
+      ", cpu %" GST_TIME_FORMAT "\n", timer_wheel ? "timer wheel" : "list",
+      num_entries, n_callbacks, GST_TIME_ARGS (jitter_percentile (50)),
+      GST_TIME_ARGS (jitter_percentile (99)), GST_TIME_ARGS (max_jitter),
+      GST_TIME_ARGS (cpu_end - cpu_start));
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -53,8 +161,23 @@ main (gint argc, gchar * argv[])
 
   gst_init (&argc, &argv);
 
+  if (argc == 3 && !strcmp (argv[1], "async")) {
+    gint num_entries = atoi (argv[2]);
+
+    if (num_entries <= 0 || num_entries > MAX_ENTRIES) {
+      g_print ("number of entries must be between 0 and %d\n", MAX_ENTRIES);
+      exit (-2);
+    }
+
+    run_async_test (num_entries, FALSE);
+    run_async_test (num_entries, TRUE);
+
+    return 0;
+  }
+
   if (argc != 2) {
     g_print ("usage: %s <num_threads>\n", argv[0]);
+    g_print ("       %s async <num_entries>\n", argv[0]);
     exit (-1);
   }
 
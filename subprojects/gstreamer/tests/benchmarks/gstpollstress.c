@@ -20,9 +20,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gst/gst.h>
 #include "gst/glib-compat-private.h"
 
+#ifdef G_OS_UNIX
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#endif
+
 static GstPoll *set;
 static GList *fds = NULL;
 static GMutex fdlock;
@@ -136,6 +144,87 @@ run_test (void *threadid)
   return NULL;
 }
 
+#ifdef G_OS_UNIX
+#define SCALE_WAITS 20000
+
+/* measures how the cost of a wait grows with the number of fds in the set
+ * while only one of them is active at a time */
+static void
+run_scale_test (gboolean use_epoll)
+{
+  static const guint sizes[] = { 10, 100, 1000, 10000 };
+  struct rlimit limit;
+  guint s;
+
+  /* we need two fds per entry */
+  if (getrlimit (RLIMIT_NOFILE, &limit) == 0) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit (RLIMIT_NOFILE, &limit);
+  }
+
+  g_setenv ("GST_POLL_EPOLL", use_epoll ? "1" : "0", TRUE);
+
+  for (s = 0; s < G_N_ELEMENTS (sizes); s++) {
+    GstPoll *scale_set;
+    GstPollFD *read_fds;
+    gint *write_fds;
+    GstClockTime start, end;
+    guint i, n_fds = 0, n_waits;
+    gchar c = 'x';
+
+    scale_set = gst_poll_new (TRUE);
+    read_fds = g_new (GstPollFD, sizes[s]);
+    write_fds = g_new (gint, sizes[s]);
+
+    for (i = 0; i < sizes[s]; i++) {
+      gint pair[2];
+
+      if (socketpair (PF_UNIX, SOCK_STREAM, 0, pair) < 0) {
+        g_print ("can't create %u sockets: %s\n", sizes[s], g_strerror (errno));
+        break;
+      }
+
+      gst_poll_fd_init (&read_fds[i]);
+      read_fds[i].fd = pair[0];
+      write_fds[i] = pair[1];
+      gst_poll_add_fd (scale_set, &read_fds[i]);
+      gst_poll_fd_ctl_read (scale_set, &read_fds[i], TRUE);
+      n_fds++;
+    }
+
+    if (n_fds == sizes[s]) {
+      start = gst_util_get_timestamp ();
+      for (n_waits = 0; n_waits < SCALE_WAITS; n_waits++) {
+        i = g_random_int_range (0, n_fds);
+
+        if (write (write_fds[i], &c, 1) != 1)
+          g_assert_not_reached ();
+        if (gst_poll_wait (scale_set, GST_CLOCK_TIME_NONE) != 1)
+          g_assert_not_reached ();
+        g_assert (gst_poll_fd_can_read (scale_set, &read_fds[i]));
+        if (read (read_fds[i].fd, &c, 1) != 1)
+          g_assert_not_reached ();
+      }
+      end = gst_util_get_timestamp ();
+
+      g_print ("%s: %5u fds, %.2f us per wait\n", use_epoll ? "epoll" : "poll",
+          n_fds, (gdouble) (end - start) / (SCALE_WAITS * GST_USECOND));
+    }
+
+    for (i = 0; i < n_fds; i++) {
+      gst_poll_remove_fd (scale_set, &read_fds[i]);
+      close (read_fds[i].fd);
+      close (write_fds[i]);
+    }
+    g_free (read_fds);
+    g_free (write_fds);
+    gst_poll_free (scale_set);
+  }
+
+  g_unsetenv ("GST_POLL_EPOLL");
+}
+#endif
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -148,8 +237,17 @@ main (gint argc, gchar * argv[])
   g_mutex_init (&fdlock);
   timer = g_timer_new ();
 
+#ifdef G_OS_UNIX
+  if (argc == 2 && !strcmp (argv[1], "scale")) {
+    run_scale_test (FALSE);
+    run_scale_test (TRUE);
+    return 0;
+  }
+#endif
+
   if (argc != 2) {
     g_print ("usage: %s <num_threads>\n", argv[0]);
+    g_print ("       %s scale\n", argv[0]);
     exit (-1);
   }
 
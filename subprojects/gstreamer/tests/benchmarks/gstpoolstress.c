@@ -23,6 +23,116 @@
 #include "gst/glib-compat-private.h"
 
 #define BUFFER_SIZE (1400)
+#define MAX_THREADS  256
+
+typedef struct
+{
+  GstBufferPool *pool;
+  guint64 nbuffers;
+  GstClockTime *acquire;
+  GstClockTime *release;
+} ThreadData;
+
+static GMutex mutex;
+
+static gint
+compare_time (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static void
+print_percentiles (const gchar * what, GstClockTime * times, guint64 n)
+{
+  qsort (times, n, sizeof (GstClockTime), compare_time);
+
+  g_print ("*** %s latency: p50 %" G_GUINT64_FORMAT "ns p90 %" G_GUINT64_FORMAT
+      "ns p99 %" G_GUINT64_FORMAT "ns p99.9 %" G_GUINT64_FORMAT "ns max %"
+      G_GUINT64_FORMAT "ns\n", what, times[n * 50 / 100], times[n * 90 / 100],
+      times[n * 99 / 100], times[n * 999 / 1000], times[n - 1]);
+}
+
+static gpointer
+run_test (gpointer user_data)
+{
+  ThreadData *data = user_data;
+  GstClockTime t0, t1, t2;
+  GstBuffer *buf;
+  guint64 i;
+
+  g_mutex_lock (&mutex);
+  g_mutex_unlock (&mutex);
+
+  for (i = 0; i < data->nbuffers; i++) {
+    t0 = gst_util_get_timestamp ();
+    gst_buffer_pool_acquire_buffer (data->pool, &buf, NULL);
+    t1 = gst_util_get_timestamp ();
+    gst_buffer_unref (buf);
+    t2 = gst_util_get_timestamp ();
+
+    data->acquire[i] = t1 - t0;
+    data->release[i] = t2 - t1;
+  }
+
+  return NULL;
+}
+
+/* acquire and release buffers from @num_threads threads concurrently and
+ * report the latency percentiles over all operations */
+static void
+run_threaded (guint64 nbuffers, gint num_threads, gboolean scalable)
+{
+  GThread *threads[MAX_THREADS];
+  ThreadData data[MAX_THREADS];
+  GstClockTime *acquire, *release;
+  GstBufferPool *pool;
+  GstStructure *conf;
+  GstClockTime start, end;
+  guint64 total;
+  gint t;
+
+  pool = gst_buffer_pool_new ();
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, BUFFER_SIZE, 0, 0);
+  gst_buffer_pool_config_set_scalable (conf, scalable);
+  gst_buffer_pool_set_config (pool, conf);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  total = nbuffers * num_threads;
+  acquire = g_new (GstClockTime, total);
+  release = g_new (GstClockTime, total);
+
+  g_mutex_lock (&mutex);
+  for (t = 0; t < num_threads; t++) {
+    data[t].pool = pool;
+    data[t].nbuffers = nbuffers;
+    data[t].acquire = acquire + t * nbuffers;
+    data[t].release = release + t * nbuffers;
+    threads[t] = g_thread_new ("poolstress", run_test, &data[t]);
+  }
+  start = gst_util_get_timestamp ();
+  g_mutex_unlock (&mutex);
+
+  for (t = 0; t < num_threads; t++)
+    g_thread_join (threads[t]);
+  end = gst_util_get_timestamp ();
+
+  g_print ("*** %d threads, %s mode: total %" GST_TIME_FORMAT " - %.0f "
+      "buffers/s\n", num_threads, scalable ? "scalable" : "default",
+      GST_TIME_ARGS (end - start),
+      (gdouble) total * GST_SECOND / MAX (end - start, 1));
+  print_percentiles ("acquire", acquire, total);
+  print_percentiles ("release", release, total);
+
+  g_free (acquire);
+  g_free (release);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
 
 gint
 main (gint argc, gchar * argv[])
@@ -33,16 +143,24 @@ main (gint argc, gchar * argv[])
   GstClockTime start, end;
   GstClockTimeDiff dur1, dur2;
   guint64 nbuffers;
+  gint num_threads = 1;
   GstStructure *conf;
 
   gst_init (&argc, &argv);
 
-  if (argc != 2) {
-    g_print ("usage: %s <nbuffers>\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    g_print ("usage: %s <nbuffers> [<num_threads>]\n", argv[0]);
     exit (-1);
   }
 
   nbuffers = atoi (argv[1]);
+  if (argc == 3)
+    num_threads = atoi (argv[2]);
+
+  if (num_threads <= 0 || num_threads > MAX_THREADS) {
+    g_print ("number of threads must be between 1 and %d\n", MAX_THREADS);
+    exit (-2);
+  }
 
   if (nbuffers <= 0) {
     g_print ("number of buffers must be greater than 0\n");
@@ -90,5 +208,8 @@ main (gint argc, gchar * argv[])
   gst_buffer_pool_set_active (pool, FALSE);
   gst_object_unref (pool);
 
+  run_threaded (nbuffers, num_threads, FALSE);
+  run_threaded (nbuffers, num_threads, TRUE);
+
   return 0;
 }
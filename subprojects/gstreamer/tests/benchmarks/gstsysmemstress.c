@@ -0,0 +1,174 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares the default system memory allocator with the huge pages one on
+ * large raw video frames: once with a vertical filter that walks the frames
+ * column by column like scalers and converters do, which touches a different
+ * page for every line, and once by running a video conversion pipeline with
+ * each allocator set as the default. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#define DEFAULT_PIPELINE "videotestsrc num-buffers=200 ! " \
+  "video/x-raw,format=I420,width=3840,height=2160 ! videoconvert ! " \
+  "video/x-raw,format=BGRA ! fakesink"
+
+#define N_FRAMES 4
+#define COLUMN_WIDTH 64
+
+static void
+vertical_filter (const guint8 * src, guint8 * dest, guint stride,
+    guint height)
+{
+  guint x, y, i;
+
+  for (x = 0; x < stride; x += COLUMN_WIDTH) {
+    guint width = MIN (COLUMN_WIDTH, stride - x);
+
+    for (y = 1; y < height - 1; y++) {
+      const guint8 *above = src + (y - 1) * stride + x;
+      const guint8 *line = src + y * stride + x;
+      const guint8 *below = src + (y + 1) * stride + x;
+      guint8 *out = dest + y * stride + x;
+
+      for (i = 0; i < width; i++)
+        out[i] = (above[i] + 2 * line[i] + below[i]) >> 2;
+    }
+  }
+}
+
+static void
+run_filter (const gchar * allocator_name, guint width, guint height,
+    guint iterations)
+{
+  GstAllocator *allocator = gst_allocator_find (allocator_name);
+  GstMemory *frames[N_FRAMES];
+  GstMapInfo maps[N_FRAMES];
+  GstClockTime start, alloc_time, filter_time;
+  guint stride = width * 4, i, j;
+  gsize size = (gsize) stride * height;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < N_FRAMES; i++) {
+    frames[i] = gst_allocator_alloc (allocator, size, NULL);
+    gst_memory_map (frames[i], &maps[i], GST_MAP_READWRITE);
+    /* fault in all pages */
+    memset (maps[i].data, i, size);
+  }
+  alloc_time = gst_util_get_timestamp () - start;
+
+  start = gst_util_get_timestamp ();
+  for (j = 0; j < iterations; j++) {
+    for (i = 0; i < N_FRAMES; i++)
+      vertical_filter (maps[i].data, maps[(i + 1) % N_FRAMES].data, stride,
+          height);
+  }
+  filter_time = gst_util_get_timestamp () - start;
+
+  for (i = 0; i < N_FRAMES; i++) {
+    gst_memory_unmap (frames[i], &maps[i]);
+    gst_memory_unref (frames[i]);
+  }
+  gst_object_unref (allocator);
+
+  g_print ("%s: %" GST_TIME_FORMAT " allocating, %" GST_TIME_FORMAT
+      " filtering - %.1f frames/s\n", allocator_name,
+      GST_TIME_ARGS (alloc_time), GST_TIME_ARGS (filter_time),
+      (gdouble) iterations * N_FRAMES * GST_SECOND / MAX (filter_time, 1));
+}
+
+static void
+run_pipeline (const gchar * allocator_name, const gchar * description)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  GstClockTime start, end;
+
+  pipeline = gst_parse_launch (description, NULL);
+  if (pipeline == NULL) {
+    g_print ("%s: could not create pipeline\n", allocator_name);
+    return;
+  }
+
+  /* buffer pools without an explicit allocator use the default one */
+  gst_allocator_set_default (gst_allocator_find (allocator_name));
+
+  bus = gst_element_get_bus (pipeline);
+  start = gst_util_get_timestamp ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  end = gst_util_get_timestamp ();
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+    g_print ("%s: pipeline failed\n", allocator_name);
+  else
+    g_print ("%s: %" GST_TIME_FORMAT " running pipeline\n", allocator_name,
+        GST_TIME_ARGS (end - start));
+
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  gst_allocator_set_default (gst_allocator_find (GST_ALLOCATOR_SYSMEM));
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  const gchar *allocators[] = { GST_ALLOCATOR_SYSMEM,
+    GST_ALLOCATOR_SYSMEM_HUGE_PAGES
+  };
+  const gchar *description = DEFAULT_PIPELINE;
+  guint width = 3840, height = 2160, iterations = 20, i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1 && argc < 4) {
+    g_print ("usage: %s [<width> <height> <iterations> [<pipeline>]]\n",
+        argv[0]);
+    exit (-1);
+  }
+  if (argc >= 4) {
+    width = atoi (argv[1]);
+    height = atoi (argv[2]);
+    iterations = atoi (argv[3]);
+  }
+  if (argc >= 5)
+    description = argv[4];
+
+  if (width == 0 || height < 3) {
+    g_print ("frames must be at least 1x3 pixels\n");
+    exit (-2);
+  }
+
+  g_print ("*** %u frames of %ux%u BGRA, %u iterations\n", N_FRAMES, width,
+      height, iterations);
+  for (i = 0; i < G_N_ELEMENTS (allocators); i++)
+    run_filter (allocators[i], width, height, iterations);
+
+  g_print ("*** %s\n", description);
+  for (i = 0; i < G_N_ELEMENTS (allocators); i++)
+    run_pipeline (allocators[i], description);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs many small pipelines at the same time, once with a thread per
+ * streaming task and once with all tasks multiplexed on a shared
+ * GstWorkStealingTaskPool, and compares throughput and context switches. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#define MAX_PIPELINES 4096
+
+static void
+get_context_switches (glong * voluntary, glong * involuntary)
+{
+#ifdef G_OS_UNIX
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+  *voluntary = usage.ru_nvcsw;
+  *involuntary = usage.ru_nivcsw;
+#else
+  *voluntary = *involuntary = 0;
+#endif
+}
+
+/* number of threads of the process, or -1 if unknown */
+static gint
+get_n_threads (void)
+{
+  gint n_threads = -1;
+#ifdef __linux__
+  gchar *status, *line;
+
+  if (g_file_get_contents ("/proc/self/status", &status, NULL, NULL)) {
+    if ((line = strstr (status, "\nThreads:")))
+      n_threads = atoi (line + strlen ("\nThreads:"));
+    g_free (status);
+  }
+#endif
+  return n_threads;
+}
+
+static void
+run_pipelines (guint n_pipelines, guint n_buffers, gboolean use_queue,
+    GstTaskPool * pool)
+{
+  GstElement *pipelines[MAX_PIPELINES];
+  GstClockTime start, end;
+  glong vcsw0, ivcsw0, vcsw1, ivcsw1;
+  gint max_threads = -1;
+  gchar *desc;
+  guint i, n_done;
+
+  desc = g_strdup_printf ("fakesrc num-buffers=%u sizetype=fixed "
+      "sizemax=1024 ! identity %s ! fakesink sync=false", n_buffers,
+      use_queue ? "! queue" : "");
+
+  for (i = 0; i < n_pipelines; i++) {
+    pipelines[i] = gst_parse_launch (desc, NULL);
+    g_assert (pipelines[i] != NULL);
+    if (pool)
+      g_object_set (pipelines[i], "task-pool", pool, NULL);
+  }
+  g_free (desc);
+
+  get_context_switches (&vcsw0, &ivcsw0);
+  start = gst_util_get_timestamp ();
+
+  for (i = 0; i < n_pipelines; i++)
+    gst_element_set_state (pipelines[i], GST_STATE_PLAYING);
+
+  /* wait for all of them to finish, sampling the number of threads */
+  n_done = 0;
+  while (n_done < n_pipelines) {
+    GstBus *bus = gst_element_get_bus (pipelines[n_done]);
+    GstMessage *msg;
+
+    max_threads = MAX (max_threads, get_n_threads ());
+
+    msg = gst_bus_timed_pop_filtered (bus, 10 * GST_MSECOND,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    gst_object_unref (bus);
+
+    if (msg) {
+      if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+        g_printerr ("pipeline %u failed\n", n_done);
+      gst_message_unref (msg);
+      n_done++;
+    }
+  }
+
+  end = gst_util_get_timestamp ();
+  get_context_switches (&vcsw1, &ivcsw1);
+
+  for (i = 0; i < n_pipelines; i++) {
+    gst_element_set_state (pipelines[i], GST_STATE_NULL);
+    gst_object_unref (pipelines[i]);
+  }
+
+  g_print ("*** %s: %u pipelines, total %" GST_TIME_FORMAT " - %.0f "
+      "buffers/s, %ld voluntary / %ld involuntary context switches, "
+      "max %d threads\n", pool ? "work stealing pool" : "thread per task",
+      n_pipelines, GST_TIME_ARGS (end - start),
+      (gdouble) n_pipelines * n_buffers * GST_SECOND / MAX (end - start, 1),
+      vcsw1 - vcsw0, ivcsw1 - ivcsw0, max_threads);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstTaskPool *pool;
+  guint n_pipelines, n_buffers, n_workers = 0;
+  gboolean use_queue = FALSE;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 3 || argc > 5) {
+    g_print ("usage: %s <npipelines> <nbuffers> [<nworkers>] [queue]\n",
+        argv[0]);
+    exit (-1);
+  }
+
+  n_pipelines = atoi (argv[1]);
+  n_buffers = atoi (argv[2]);
+  if (argc >= 4)
+    n_workers = atoi (argv[3]);
+  if (argc == 5)
+    use_queue = !strcmp (argv[4], "queue");
+
+  if (n_pipelines == 0 || n_pipelines > MAX_PIPELINES) {
+    g_print ("number of pipelines must be between 1 and %d\n", MAX_PIPELINES);
+    exit (-2);
+  }
+
+  run_pipelines (n_pipelines, n_buffers, use_queue, NULL);
+
+  /* with the default number of threads, queue loops that block while
+   * waiting for data are moved out of the pool */
+  pool = gst_work_stealing_task_pool_new (n_workers);
+  gst_task_pool_prepare (pool, NULL);
+
+  run_pipelines (n_pipelines, n_buffers, use_queue, pool);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+
+  return 0;
+}
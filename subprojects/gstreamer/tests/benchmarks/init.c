@@ -20,12 +20,68 @@
  */
 
 
+/* Measures gst_init() and creating a few elements afterwards, the way a
+ * short-lived process would use GStreamer. Pass --eager to copy and parse
+ * all feature metadata from the registry cache in gst_init(), for
+ * comparing with the default of parsing it on first use.
+ *
+ *   init [--eager]
+ */
+
+#include <string.h>
 #include <gst/gst.h>
 
+/* resident set size in kB, or 0 if unknown */
+static guint64
+get_rss (void)
+{
+  gchar *contents = NULL;
+  guint64 rss = 0;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL)) {
+    gchar **fields = g_strsplit (contents, " ", 3);
+
+    if (fields[0] && fields[1])
+      rss = g_ascii_strtoull (fields[1], NULL, 10) * 4;
+    g_strfreev (fields);
+    g_free (contents);
+  }
+
+  return rss;
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
+  static const gchar *elements[] = { "fakesrc", "identity", "fakesink" };
+  GstClockTime start, end;
+  GstElementFactory *factory;
+  GstElement *element;
+  guint i;
+
+  if (argc > 1 && strcmp (argv[1], "--eager") == 0)
+    g_setenv ("GST_REGISTRY_MAPPED", "no", TRUE);
+
+  start = gst_util_get_timestamp ();
   gst_init (&argc, &argv);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - gst_init (%" G_GUINT64_FORMAT " kB RSS)\n",
+      GST_TIME_ARGS (end - start), get_rss ());
+
+  /* a short-lived process only using a handful of elements */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < G_N_ELEMENTS (elements); i++) {
+    factory = gst_element_factory_find (elements[i]);
+    if (factory == NULL)
+      continue;
+    gst_element_factory_get_metadata (factory, GST_ELEMENT_METADATA_KLASS);
+    element = gst_element_factory_create (factory, NULL);
+    gst_clear_object (&element);
+    gst_object_unref (factory);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - creating %u elements (%" G_GUINT64_FORMAT
+      " kB RSS)\n", GST_TIME_ARGS (end - start), i, get_rss ());
 
   return 0;
 }
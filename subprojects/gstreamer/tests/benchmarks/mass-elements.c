@@ -18,6 +18,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <gst/gst.h>
 
 #define IDENTITY_COUNT (1000)
@@ -31,7 +32,9 @@ main (gint argc, gchar * argv[])
 {
   GstMessage *msg;
   GstElement *pipeline, *src, *sink, *current, *last;
-  guint i, buffers = BUFFER_COUNT, identities = IDENTITY_COUNT;
+  guint i, b, buffers = BUFFER_COUNT, identities = IDENTITY_COUNT;
+  guint branches = 1;
+  gboolean parallel = FALSE;
   GstClockTime start, end;
   const gchar *src_name = SRC_ELEMENT, *sink_name = SINK_ELEMENT;
 
@@ -45,41 +48,49 @@ main (gint argc, gchar * argv[])
     src_name = argv[3];
   if (argc > 4)
     sink_name = argv[4];
+  if (argc > 5)
+    branches = MAX (atoi (argv[5]), 1);
+  if (argc > 6)
+    parallel = !strcmp (argv[6], "parallel");
 
   g_print
-      ("*** benchmarking this pipeline: %s num-buffers=%u ! %u * identity ! %s\n",
-      src_name, buffers, identities, sink_name);
+      ("*** benchmarking this pipeline: %u * (%s num-buffers=%u ! %u * identity "
+      "! %s), %s state changes\n", branches, src_name, buffers, identities,
+      sink_name, parallel ? "parallel" : "sequential");
   start = gst_util_get_timestamp ();
   pipeline = gst_element_factory_make ("pipeline", NULL);
   g_assert_nonnull (pipeline);
-  src = gst_element_factory_make (src_name, NULL);
-  if (!src) {
-    g_print ("no element named \"%s\" found, aborting...\n", src_name);
-    return 1;
-  }
-  g_object_set (src, "num-buffers", buffers, NULL);
-  sink = gst_element_factory_make (sink_name, NULL);
-  if (!sink) {
-    g_print ("no element named \"%s\" found, aborting...\n", sink_name);
-    return 1;
-  }
-  last = src;
-  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
-  for (i = 0; i < identities; i++) {
-    current = gst_element_factory_make ("identity", NULL);
-    g_assert_nonnull (current);
-    /* shut this element up (no g_strdup_printf please) */
-    g_object_set (current, "silent", TRUE, NULL);
-    gst_bin_add (GST_BIN (pipeline), current);
-    if (!gst_element_link (last, current))
+  g_object_set (pipeline, "parallel-state-changes", parallel, NULL);
+  for (b = 0; b < branches; b++) {
+    src = gst_element_factory_make (src_name, NULL);
+    if (!src) {
+      g_print ("no element named \"%s\" found, aborting...\n", src_name);
+      return 1;
+    }
+    g_object_set (src, "num-buffers", buffers, NULL);
+    sink = gst_element_factory_make (sink_name, NULL);
+    if (!sink) {
+      g_print ("no element named \"%s\" found, aborting...\n", sink_name);
+      return 1;
+    }
+    last = src;
+    gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+    for (i = 0; i < identities; i++) {
+      current = gst_element_factory_make ("identity", NULL);
+      g_assert_nonnull (current);
+      /* shut this element up (no g_strdup_printf please) */
+      g_object_set (current, "silent", TRUE, NULL);
+      gst_bin_add (GST_BIN (pipeline), current);
+      if (!gst_element_link (last, current))
+        g_assert_not_reached ();
+      last = current;
+    }
+    if (!gst_element_link (last, sink))
       g_assert_not_reached ();
-    last = current;
   }
-  if (!gst_element_link (last, sink))
-    g_assert_not_reached ();
   end = gst_util_get_timestamp ();
   g_print ("%" GST_TIME_FORMAT " - creating %u identity elements\n",
-      GST_TIME_ARGS (end - start), identities);
+      GST_TIME_ARGS (end - start), branches * identities);
 
   start = gst_util_get_timestamp ();
   if (gst_element_set_state (pipeline,
@@ -89,7 +100,7 @@ main (gint argc, gchar * argv[])
           GST_CLOCK_TIME_NONE) == GST_STATE_CHANGE_FAILURE)
     g_assert_not_reached ();
   end = gst_util_get_timestamp ();
-  g_print ("%" GST_TIME_FORMAT " - setting pipeline to playing\n",
+  g_print ("%" GST_TIME_FORMAT " - starting pipeline (setting to playing)\n",
       GST_TIME_ARGS (end - start));
 
   start = gst_util_get_timestamp ();
@@ -105,7 +116,7 @@ main (gint argc, gchar * argv[])
           GST_STATE_NULL) != GST_STATE_CHANGE_SUCCESS)
     g_assert_not_reached ();
   end = gst_util_get_timestamp ();
-  g_print ("%" GST_TIME_FORMAT " - setting pipeline to NULL\n",
+  g_print ("%" GST_TIME_FORMAT " - stopping pipeline (setting to NULL)\n",
       GST_TIME_ARGS (end - start));
 
   start = gst_util_get_timestamp ();
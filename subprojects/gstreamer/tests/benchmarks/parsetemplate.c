@@ -0,0 +1,97 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares creating the same pipeline many times with gst_parse_launch()
+ * against compiling it once with gst_parse_template_new() and creating the
+ * pipelines with gst_parse_template_instantiate(). */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define DEFAULT_DESCRIPTION "fakesrc num-buffers=10 sizetype=fixed " \
+  "sizemax=4096 name=src ! queue max-size-buffers=4 ! identity silent=true " \
+  "! tee name=t ! queue ! fakesink sync=false  t. ! queue ! " \
+  "identity drop-probability=0.5 ! fakesink sync=false async=false"
+
+#define DEFAULT_ITERATIONS 1000
+
+gint
+main (gint argc, gchar * argv[])
+{
+  const gchar *description = DEFAULT_DESCRIPTION;
+  GstParseTemplate *tmpl;
+  GstElement *pipeline;
+  GstClockTime start, end, launch_time, instantiate_time;
+  GError *err = NULL;
+  guint i, iterations = DEFAULT_ITERATIONS;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    iterations = atoi (argv[1]);
+  if (argc > 2)
+    description = argv[2];
+
+  g_print ("*** benchmarking %u pipelines of: %s\n", iterations, description);
+
+  /* load all the plugins once so the first run is not penalized */
+  pipeline = gst_parse_launch (description, &err);
+  if (!pipeline) {
+    g_print ("could not parse pipeline: %s\n", err->message);
+    return 1;
+  }
+  gst_object_unref (pipeline);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < iterations; i++) {
+    pipeline = gst_parse_launch (description, NULL);
+    gst_object_unref (pipeline);
+  }
+  end = gst_util_get_timestamp ();
+  launch_time = end - start;
+  g_print ("%" GST_TIME_FORMAT " - gst_parse_launch, %" GST_TIME_FORMAT
+      " per pipeline\n", GST_TIME_ARGS (launch_time),
+      GST_TIME_ARGS (launch_time / MAX (iterations, 1)));
+
+  start = gst_util_get_timestamp ();
+  tmpl = gst_parse_template_new (description, GST_PARSE_FLAG_NONE, &err);
+  end = gst_util_get_timestamp ();
+  if (!tmpl) {
+    g_print ("could not compile template: %s\n", err->message);
+    return 1;
+  }
+  g_print ("%" GST_TIME_FORMAT " - compiling template\n",
+      GST_TIME_ARGS (end - start));
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < iterations; i++) {
+    pipeline = gst_parse_template_instantiate (tmpl, NULL);
+    gst_object_unref (pipeline);
+  }
+  end = gst_util_get_timestamp ();
+  instantiate_time = end - start;
+  g_print ("%" GST_TIME_FORMAT " - gst_parse_template_instantiate, %"
+      GST_TIME_FORMAT " per pipeline (%.2fx)\n",
+      GST_TIME_ARGS (instantiate_time),
+      GST_TIME_ARGS (instantiate_time / MAX (iterations, 1)),
+      (gdouble) launch_time / MAX (instantiate_time, 1));
+
+  gst_parse_template_unref (tmpl);
+
+  return 0;
+}
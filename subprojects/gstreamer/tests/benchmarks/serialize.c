@@ -0,0 +1,153 @@
+/* GStreamer
+ *
+ * serialize.c: benchmark for text and binary caps/structure serialization
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+
+#define NUM_ITERATIONS 100000
+
+static const gchar *caps_strings[] = {
+  "audio/x-raw, format = (string) { S8, U8, S16LE, S16BE, U16LE, U16BE, "
+      "S32LE, S32BE, U32LE, U32BE, F32LE, F32BE, F64LE, F64BE }, "
+      "rate = (int) [ 1, MAX ], channels = (int) [ 1, MAX ], "
+      "layout = (string) interleaved",
+  "video/x-raw(memory:DMABuf), format = (string) DMA_DRM, "
+      "drm-format = (string) NV12:0x0100000000000002, width = (int) 1920, "
+      "height = (int) 1080, framerate = (fraction) 30000/1001, "
+      "pixel-aspect-ratio = (fraction) 1/1, interlace-mode = (string) "
+      "progressive, colorimetry = (string) bt709, "
+      "chroma-site = (string) mpeg2; video/x-raw, format = (string) NV12, "
+      "width = (int) [ 1, 32767 ], height = (int) [ 1, 32767 ], "
+      "framerate = (fraction) [ 0/1, 2147483647/1 ]",
+};
+
+static void
+bench_caps (const gchar * str)
+{
+  GstClockTime start, end;
+  GstCaps *caps, *tmp;
+  GByteArray *out;
+  gchar *text;
+  gint i;
+
+  caps = gst_caps_from_string (str);
+  g_print ("%" GST_PTR_FORMAT "\n", caps);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    text = gst_caps_to_string (caps);
+    tmp = gst_caps_from_string (text);
+    g_free (text);
+    gst_caps_unref (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  text = gst_caps_to_string (caps);
+  g_print ("%" GST_TIME_FORMAT " - %d text round-trips (%u bytes)\n",
+      GST_TIME_ARGS (end - start), NUM_ITERATIONS, (guint) strlen (text));
+  g_free (text);
+
+  out = g_byte_array_new ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    g_byte_array_set_size (out, 0);
+    gst_caps_serialize_binary (caps, out);
+    tmp = gst_caps_deserialize_binary (out->data, out->len, NULL);
+    gst_caps_unref (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d binary round-trips (%u bytes)\n",
+      GST_TIME_ARGS (end - start), NUM_ITERATIONS, out->len);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    g_byte_array_set_size (out, 0);
+    gst_caps_serialize_binary (caps, out);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d binary serializations\n",
+      GST_TIME_ARGS (end - start), NUM_ITERATIONS);
+
+  g_byte_array_unref (out);
+  gst_caps_unref (caps);
+}
+
+static void
+bench_structure (void)
+{
+  GstClockTime start, end;
+  GstStructure *s, *tmp;
+  GByteArray *out;
+  gchar *text, name[32];
+  gint i;
+
+  /* something like the statistics of a RTP session */
+  s = gst_structure_new_empty ("application/x-rtp-source-stats");
+  for (i = 0; i < 32; i++) {
+    g_snprintf (name, sizeof (name), "stat-%d", i);
+    if (i % 4 == 0)
+      gst_structure_set (s, name, G_TYPE_UINT64, (guint64) i * 1000, NULL);
+    else if (i % 4 == 1)
+      gst_structure_set (s, name, G_TYPE_DOUBLE, i / 3.0, NULL);
+    else if (i % 4 == 2)
+      gst_structure_set (s, name, G_TYPE_STRING, "192.168.1.1:5004", NULL);
+    else
+      gst_structure_set (s, name, G_TYPE_BOOLEAN, TRUE, NULL);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    text = gst_structure_serialize_full (s, GST_SERIALIZE_FLAG_NONE);
+    tmp = gst_structure_from_string (text, NULL);
+    g_free (text);
+    gst_structure_free (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d structure text round-trips\n",
+      GST_TIME_ARGS (end - start), NUM_ITERATIONS);
+
+  out = g_byte_array_new ();
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    g_byte_array_set_size (out, 0);
+    gst_structure_serialize_binary (s, out);
+    tmp = gst_structure_deserialize_binary (out->data, out->len, NULL);
+    gst_structure_free (tmp);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d structure binary round-trips\n",
+      GST_TIME_ARGS (end - start), NUM_ITERATIONS);
+
+  g_byte_array_unref (out);
+  gst_structure_free (s);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i;
+
+  gst_init (&argc, &argv);
+
+  for (i = 0; i < G_N_ELEMENTS (caps_strings); i++)
+    bench_caps (caps_strings[i]);
+
+  bench_structure ();
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* GStreamer
+ *
+ * structure.c: benchmark for field lookups in small and large structures
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/gst.h>
+
+/* number of lookups done per structure size */
+#define NUM_LOOKUPS 1000000
+
+static const guint sizes[] = { 1, 4, 8, 15, 16, 32, 64, 128, 512 };
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstClockTime start, end;
+  GstStructure *s;
+  gchar **names;
+  guint i, j, n;
+  gint val, sum;
+
+  gst_init (&argc, &argv);
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    n = sizes[i];
+
+    names = g_new (gchar *, n);
+    for (j = 0; j < n; j++)
+      names[j] = g_strdup_printf ("field-number-%u", j);
+
+    start = gst_util_get_timestamp ();
+    s = gst_structure_new_empty ("stats");
+    for (j = 0; j < n; j++)
+      gst_structure_set (s, names[j], G_TYPE_INT, j, NULL);
+    end = gst_util_get_timestamp ();
+    g_print ("%3u fields: %" GST_TIME_FORMAT " - setting fields\n", n,
+        GST_TIME_ARGS (end - start));
+
+    /* look up all fields in turn, which on average scans half of the
+     * structure without an index */
+    sum = 0;
+    start = gst_util_get_timestamp ();
+    for (j = 0; j < NUM_LOOKUPS; j++) {
+      if (gst_structure_get_int (s, names[j % n], &val))
+        sum += val;
+    }
+    end = gst_util_get_timestamp ();
+    g_print ("%3u fields: %" GST_TIME_FORMAT " - %d lookups, %.1f ns/lookup "
+        "(%d)\n", n, GST_TIME_ARGS (end - start), NUM_LOOKUPS,
+        (gdouble) (end - start) / NUM_LOOKUPS, sum);
+
+    /* lookups of a field that does not exist always scan everything */
+    start = gst_util_get_timestamp ();
+    for (j = 0; j < NUM_LOOKUPS; j++)
+      gst_structure_has_field (s, "not-there");
+    end = gst_util_get_timestamp ();
+    g_print ("%3u fields: %" GST_TIME_FORMAT " - %d failed lookups, "
+        "%.1f ns/lookup\n", n, GST_TIME_ARGS (end - start), NUM_LOOKUPS,
+        (gdouble) (end - start) / NUM_LOOKUPS);
+
+    gst_structure_free (s);
+    for (j = 0; j < n; j++)
+      g_free (names[j]);
+    g_free (names);
+  }
+
+  return 0;
+}
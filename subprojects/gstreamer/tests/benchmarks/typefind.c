@@ -0,0 +1,223 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Typefinds a corpus of stream headers, once by calling every typefind
+ * function in order of rank and once with gst_type_find_helper_for_data(),
+ * which skips the functions whose signature is not in the data. The
+ * corpus is a set of built-in headers, or the first kilobytes of the files
+ * passed on the command line. Needs the typefind functions plugin from
+ * gst-plugins-base to give meaningful results. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+#include <gst/base/gsttypefindhelper.h>
+
+#define DEFAULT_ITERATIONS 1000
+#define HEADER_SIZE 4096
+
+typedef struct
+{
+  const gchar *name;
+  const guint8 *data;
+  gsize size;
+} Sample;
+
+static const guint8 png_header[] = "\211PNG\015\012\032\012\000\000\000\015IHDR";
+static const guint8 gif_header[] = "GIF89a\001\000\001\000\200\000\000";
+static const guint8 wav_header[] = "RIFF\044\000\000\000WAVEfmt \020\000\000\000";
+static const guint8 avi_header[] = "RIFF\044\000\000\000AVI LIST";
+static const guint8 flv_header[] = "FLV\001\005\000\000\000\011\000\000\000\000";
+static const guint8 mkv_header[] = "\032\105\337\243\243\102\206\201\001\102"
+    "\367\201\001\102\362\201\004\102\363\201\010\102\202\210matroska\102\207"
+    "\201\004\102\205\201\002";
+static const guint8 id3_header[] = "ID3\004\000\000\000\000\000\012TIT2";
+static const guint8 pdf_header[] = "%PDF-1.7\n%\342\343\317\323\n";
+static const guint8 text_header[] = "Lorem ipsum dolor sit amet, consectetur "
+    "adipiscing elit, sed do eiusmod tempor incididunt ut labore";
+
+#define SAMPLE(name, header) { name, header, sizeof (header) - 1 }
+
+static const Sample builtin_samples[] = {
+  SAMPLE ("png", png_header),
+  SAMPLE ("gif", gif_header),
+  SAMPLE ("wav", wav_header),
+  SAMPLE ("avi", avi_header),
+  SAMPLE ("flv", flv_header),
+  SAMPLE ("matroska", mkv_header),
+  SAMPLE ("id3", id3_header),
+  SAMPLE ("pdf", pdf_header),
+  SAMPLE ("text", text_header),
+};
+
+typedef struct
+{
+  const guint8 *data;
+  gsize size;
+  guint best_probability;
+  GstCaps *caps;
+} FullScanData;
+
+static const guint8 *
+full_scan_peek (gpointer data, gint64 offset, guint size)
+{
+  FullScanData *scan = data;
+
+  if (offset < 0 || size == 0 || size > scan->size
+      || offset > scan->size - size)
+    return NULL;
+
+  return scan->data + offset;
+}
+
+static void
+full_scan_suggest (gpointer data, guint probability, GstCaps * caps)
+{
+  FullScanData *scan = data;
+
+  if (probability > scan->best_probability) {
+    gst_caps_replace (&scan->caps, caps);
+    scan->best_probability = probability;
+  }
+}
+
+static guint64
+full_scan_get_length (gpointer data)
+{
+  FullScanData *scan = data;
+
+  return scan->size;
+}
+
+/* what typefinding did before signatures: call every function */
+static GstCaps *
+full_scan (GList * type_list, const guint8 * data, gsize size)
+{
+  FullScanData scan = { data, size, 0, NULL };
+  GstTypeFind find = { full_scan_peek, full_scan_suggest, &scan,
+    full_scan_get_length,
+  };
+  GList *l;
+
+  for (l = type_list; l; l = l->next) {
+    gst_type_find_factory_call_function (l->data, &find);
+    if (scan.best_probability >= GST_TYPE_FIND_MAXIMUM)
+      break;
+  }
+
+  return scan.caps;
+}
+
+static GstClockTime
+run_samples (GList * type_list, const Sample * samples, guint n_samples,
+    guint iterations, gboolean use_helper)
+{
+  GstClockTime start;
+  GstCaps *caps;
+  guint i, j;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < iterations; i++) {
+    for (j = 0; j < n_samples; j++) {
+      if (use_helper)
+        caps = gst_type_find_helper_for_data (NULL, samples[j].data,
+            samples[j].size, NULL);
+      else
+        caps = full_scan (type_list, samples[j].data, samples[j].size);
+      gst_clear_caps (&caps);
+    }
+  }
+
+  return gst_util_get_timestamp () - start;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GArray *samples;
+  GList *type_list, *l;
+  GstClockTime full_time, helper_time;
+  guint n_signatures = 0, iterations = DEFAULT_ITERATIONS;
+  gint i;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    iterations = atoi (argv[1]);
+
+  samples = g_array_new (FALSE, FALSE, sizeof (Sample));
+  if (argc > 2) {
+    for (i = 2; i < argc; i++) {
+      Sample sample = { argv[i], NULL, 0 };
+      gchar *contents;
+      gsize size;
+
+      if (!g_file_get_contents (argv[i], &contents, &size, NULL)) {
+        g_printerr ("could not read %s\n", argv[i]);
+        return 1;
+      }
+      sample.data = (const guint8 *) contents;
+      sample.size = MIN (size, HEADER_SIZE);
+      g_array_append_val (samples, sample);
+    }
+  } else {
+    g_array_append_vals (samples, builtin_samples,
+        G_N_ELEMENTS (builtin_samples));
+  }
+
+  /* typefind everything once so all typefind plugins are loaded and their
+   * signatures known */
+  for (i = 0; i < (gint) samples->len; i++) {
+    Sample *sample = &g_array_index (samples, Sample, i);
+    GstCaps *caps;
+
+    caps = gst_type_find_helper_for_data (NULL, sample->data, sample->size,
+        NULL);
+    g_print ("%s: %" GST_PTR_FORMAT "\n", sample->name, caps);
+    gst_clear_caps (&caps);
+  }
+
+  type_list = gst_type_find_factory_get_list ();
+  for (l = type_list; l; l = l->next) {
+    if (gst_type_find_factory_get_signature (l->data, NULL, NULL))
+      n_signatures++;
+  }
+
+  g_print ("*** %u samples, %u iterations, %u typefinders, %u with a "
+      "signature\n", samples->len, iterations, g_list_length (type_list),
+      n_signatures);
+
+  full_time = run_samples (type_list, (Sample *) samples->data, samples->len,
+      iterations, FALSE);
+  g_print ("%" GST_TIME_FORMAT " - calling all typefind functions\n",
+      GST_TIME_ARGS (full_time));
+
+  helper_time = run_samples (type_list, (Sample *) samples->data,
+      samples->len, iterations, TRUE);
+  g_print ("%" GST_TIME_FORMAT " - gst_type_find_helper_for_data (%.2fx)\n",
+      GST_TIME_ARGS (helper_time), (gdouble) full_time / MAX (helper_time, 1));
+
+  gst_plugin_feature_list_free (type_list);
+  if (argc > 2) {
+    for (i = 0; i < (gint) samples->len; i++)
+      g_free ((gpointer) g_array_index (samples, Sample, i).data);
+  }
+  g_array_unref (samples);
+
+  return 0;
+}
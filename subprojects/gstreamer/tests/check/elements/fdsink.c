@@ -0,0 +1,159 @@
+/* GStreamer
+ *
+ * unit test for fdsink
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <errno.h>
+
+#include <gst/check/gstcheck.h>
+
+/* together less than the default pipe size, nothing is read until all of
+ * them were rendered */
+#define BLOCK_SIZE 4096
+#define N_BUFFERS 8
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+#ifdef HAVE_PIPE
+static gpointer
+read_pipe (gpointer data)
+{
+  gint fd = GPOINTER_TO_INT (data);
+  GString *str = g_string_new (NULL);
+  gchar buf[1000];
+  gssize ret;
+
+  for (;;) {
+    ret = read (fd, buf, sizeof (buf));
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+    g_string_append_len (str, buf, ret);
+  }
+
+  return str;
+}
+
+GST_START_TEST (test_zero_copy_pool)
+{
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *recycled[2];
+  GstElement *sink;
+  GstPad *srcpad;
+  GstBufferPool *pool;
+  GstStructure *config;
+  GThread *reader;
+  GString *data;
+  gint pipe_fd[2];
+  guint i, j;
+
+  fail_if (pipe (pipe_fd) < 0);
+
+  sink = gst_check_setup_element ("fdsink");
+  srcpad = gst_check_setup_src_pad (sink, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  g_object_set (sink, "fd", pipe_fd[1], "zero-copy", TRUE, NULL);
+  fail_if (gst_element_set_state (sink,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  gst_check_setup_events (srcpad, sink, NULL, GST_FORMAT_BYTES);
+
+  /* fewer buffers than are pushed before the reader starts */
+  pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, NULL, BLOCK_SIZE, 0, 2);
+  fail_unless (gst_buffer_pool_set_config (pool, config));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+
+  /* the spliced buffers have to go back to the pool before the reader took
+   * their data */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  for (i = 0; i < N_BUFFERS; i++) {
+    GstBuffer *buffer = NULL;
+    GstMapInfo map;
+
+    fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buffer,
+            &params), GST_FLOW_OK);
+    fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+    for (j = 0; j < BLOCK_SIZE; j++)
+      map.data[j] = (i * BLOCK_SIZE + j) % 251;
+    gst_buffer_unmap (buffer, &map);
+
+    fail_unless_equals_int (gst_pad_push (srcpad, buffer), GST_FLOW_OK);
+  }
+
+  /* whatever the pool hands out now is overwritten before the reader gets
+   * to the pipe */
+  for (i = 0; i < G_N_ELEMENTS (recycled); i++) {
+    fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool,
+            &recycled[i], &params), GST_FLOW_OK);
+    gst_buffer_memset (recycled[i], 0, 0xff, BLOCK_SIZE);
+  }
+  for (i = 0; i < G_N_ELEMENTS (recycled); i++)
+    gst_buffer_unref (recycled[i]);
+
+  /* EOS waits until the reader has everything */
+  reader = g_thread_new ("reader", read_pipe, GINT_TO_POINTER (pipe_fd[0]));
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+
+  fail_unless (gst_element_set_state (sink,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+  close (pipe_fd[1]);
+  data = g_thread_join (reader);
+  close (pipe_fd[0]);
+
+  /* the memory in the pipe did not change when it was given up by the pool */
+  fail_unless_equals_int (data->len, N_BUFFERS * BLOCK_SIZE);
+  for (i = 0; i < data->len; i++)
+    fail_unless_equals_int ((guint8) data->str[i], i % 251);
+
+  g_string_free (data, TRUE);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_check_teardown_element (sink);
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+fdsink_suite (void)
+{
+  Suite *s = suite_create ("fdsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+#ifdef HAVE_PIPE
+  tcase_add_test (tc_chain, test_zero_copy_pool);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (fdsink);
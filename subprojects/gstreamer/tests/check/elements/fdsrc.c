@@ -204,6 +204,57 @@ GST_START_TEST (test_seeking)
 
 GST_END_TEST;
 
+GST_START_TEST (test_zero_copy)
+{
+  GstElement *src;
+  GString *data;
+  gchar *contents;
+  gsize length;
+  gint in_fd;
+  GList *l;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &length, NULL));
+  fail_if ((in_fd = open (TESTFILE, O_RDONLY)) < 0);
+  src = setup_fdsrc ();
+
+  /* blocks that don't line up with the pages */
+  g_object_set (G_OBJECT (src), "fd", in_fd, "zero-copy", TRUE,
+      "blocksize", 1000, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos)
+    g_usleep (1000);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* the buffers outlive the element */
+  data = g_string_new (NULL);
+  for (l = buffers; l; l = l->next) {
+    GstMapInfo map;
+
+    fail_unless (gst_buffer_map (l->data, &map, GST_MAP_READ));
+    g_string_append_len (data, (const gchar *) map.data, map.size);
+    gst_buffer_unmap (l->data, &map);
+  }
+  fail_unless_equals_int (data->len, length);
+  fail_unless (memcmp (data->str, contents, length) == 0);
+
+  /* cleanup */
+  cleanup_fdsrc (src);
+  close (in_fd);
+  g_string_free (data, TRUE);
+  g_free (contents);
+  g_list_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (buffers);
+  buffers = NULL;
+  have_eos = FALSE;
+}
+
+GST_END_TEST;
+
 static Suite *
 fdsrc_suite (void)
 {
@@ -216,6 +267,7 @@ fdsrc_suite (void)
   tcase_add_test (tc_chain, test_nonseeking);
 #endif
   tcase_add_test (tc_chain, test_seeking);
+  tcase_add_test (tc_chain, test_zero_copy);
 
   return s;
 }
@@ -573,6 +573,84 @@ GST_START_TEST (test_buffered_write_6_3)
 
 GST_END_TEST;
 
+GST_START_TEST (test_write_behind)
+{
+  GstElement *filesink;
+  gchar *tmp_fn;
+  GstSegment segment;
+  guint queue_level;
+  guint64 average_latency, max_latency;
+
+  tmp_fn = create_temporary_file ();
+  if (tmp_fn == NULL)
+    return;
+  filesink = setup_filesink ();
+
+  /* small blocks so that the writes cross a few of them and wait for each
+   * other, O_DIRECT is used for the aligned ones where supported */
+  g_object_set (filesink, "location", tmp_fn, "write-behind", 2,
+      "write-behind-size", 4096, "direct-io", TRUE, "preallocate",
+      (guint64) 65536, "sync-interval", (guint64) 8192, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_stream_start ("test")));
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  PUSH_BYTES (1);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 1);
+  PUSH_BYTES (99);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 100);
+  PUSH_BYTES (8800);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8900);
+  PUSH_BUFFER_LIST (2, 10000);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 28900);
+
+  /* never more writes in flight than configured */
+  g_object_get (filesink, "queue-level", &queue_level, NULL);
+  fail_unless (queue_level <= 2);
+
+  /* goes back to an unaligned position after waiting for all writes */
+  segment.start = 8800;
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8800);
+  g_object_get (filesink, "queue-level", &queue_level, NULL);
+  fail_unless_equals_int (queue_level, 0);
+
+  PUSH_BYTES (1);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 8801);
+  PUSH_BYTES (9256);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 18057);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_object_get (filesink, "queue-level", &queue_level,
+      "average-write-latency", &average_latency, "max-write-latency",
+      &max_latency, NULL);
+  fail_unless_equals_int (queue_level, 0);
+  fail_unless (average_latency <= max_latency);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  cleanup_filesink (filesink);
+
+  /* preallocated space doesn't change the size */
+  CHECK_WRITTEN_BYTES (0, 1, 28900);
+  CHECK_WRITTEN_BYTES (1, 99, 28900);
+  CHECK_WRITTEN_BYTES (8801, 9256, 28900);
+  CHECK_WRITTEN_BYTES (18900, 10000, 28900);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
 static Suite *
 filesink_suite (void)
 {
@@ -588,6 +666,7 @@ filesink_suite (void)
   tcase_add_test (tc_chain, test_buffered_write_17_1);
   tcase_add_test (tc_chain, test_buffered_write_9_2);
   tcase_add_test (tc_chain, test_buffered_write_6_3);
+  tcase_add_test (tc_chain, test_write_behind);
 
   return s;
 }
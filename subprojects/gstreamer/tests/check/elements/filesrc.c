@@ -544,6 +544,72 @@ GST_START_TEST (test_uri_query)
 
 GST_END_TEST;
 
+/* pulls ranges in and across the blocks that are read ahead, keeping all
+ * the buffers alive so that the memory of the blocks cannot be reused */
+GST_START_TEST (test_pull_read_ahead)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  GPtrArray *buffers;
+  gchar *contents;
+  gsize size, offset, expected;
+  guint i;
+
+  fail_unless (g_file_get_contents (TESTFILE, &contents, &size, NULL));
+  fail_unless (size > 4096);
+
+  src = setup_filesrc ();
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "read-ahead", 2,
+      "read-ahead-size", 4096, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  buffers = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  /* forwards, then backwards */
+  for (i = 0; i < 2 * (size / 1000 + 1); i++) {
+    offset = i <= size / 1000 ? i * 1000 : (2 * (size / 1000) + 1 - i) * 1000;
+    expected = MIN (1500, size - offset);
+
+    buffer = NULL;
+    ret = gst_pad_get_range (pad, offset, 1500, &buffer);
+    fail_unless_equals_int (ret, GST_FLOW_OK);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), expected);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), offset);
+    g_ptr_array_add (buffers, buffer);
+  }
+
+  for (i = 0; i < buffers->len; i++) {
+    buffer = g_ptr_array_index (buffers, i);
+    fail_unless (gst_buffer_memcmp (buffer, 0,
+            contents + GST_BUFFER_OFFSET (buffer),
+            gst_buffer_get_size (buffer)) == 0);
+  }
+  g_ptr_array_unref (buffers);
+
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, size, 10, &buffer);
+  fail_unless_equals_int (ret, GST_FLOW_EOS);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
 static Suite *
 filesrc_suite (void)
 {
@@ -554,6 +620,7 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_read_ahead);
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_uri_query);
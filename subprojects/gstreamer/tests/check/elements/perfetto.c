@@ -0,0 +1,269 @@
+/* GStreamer
+ *
+ * Unit test for the perfetto tracer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib/gstdio.h>
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+
+#define NUM_BUFFERS 20
+
+static gchar *trace_file;
+
+/* what was found in the trace */
+typedef struct
+{
+  guint n_packets;
+  guint n_monotonic;
+  guint n_slices;
+  guint n_counters;
+  GPtrArray *names;
+} TraceInfo;
+
+static gboolean
+read_varint (const guint8 ** p, const guint8 * end, guint64 * v)
+{
+  guint shift = 0;
+
+  *v = 0;
+  while (*p < end && shift < 64) {
+    guint8 b = *(*p)++;
+
+    *v |= ((guint64) (b & 0x7f)) << shift;
+    if (!(b & 0x80))
+      return TRUE;
+    shift += 7;
+  }
+
+  return FALSE;
+}
+
+/* Calls @func for every field of the message from @p to @end. Only the wire
+ * types the tracer writes are accepted. */
+typedef gboolean (*FieldFunc) (guint field, guint64 v, const guint8 * data,
+    TraceInfo * info);
+
+static gboolean
+parse_message (const guint8 * p, const guint8 * end, FieldFunc func,
+    TraceInfo * info)
+{
+  while (p < end) {
+    guint64 key, v;
+    const guint8 *data = NULL;
+
+    if (!read_varint (&p, end, &key))
+      return FALSE;
+
+    switch (key & 7) {
+      case 0:
+        if (!read_varint (&p, end, &v))
+          return FALSE;
+        break;
+      case 2:
+        if (!read_varint (&p, end, &v) || v > (guint64) (end - p))
+          return FALSE;
+        data = p;
+        p += v;
+        break;
+      default:
+        return FALSE;
+    }
+
+    if (!func (key >> 3, v, data, info))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+name_field (guint field, guint64 v, const guint8 * data, TraceInfo * info)
+{
+  /* TrackDescriptor.name and EventName.name */
+  if (field == 2 && data)
+    g_ptr_array_add (info->names, g_strndup ((const gchar *) data, v));
+  return TRUE;
+}
+
+static gboolean
+interned_field (guint field, guint64 v, const guint8 * data, TraceInfo * info)
+{
+  /* InternedData.event_names */
+  if (field == 2 && data)
+    return parse_message (data, data + v, name_field, info);
+  return TRUE;
+}
+
+static gboolean
+event_field (guint field, guint64 v, const guint8 * data, TraceInfo * info)
+{
+  /* TrackEvent.type */
+  if (field == 9 && data == NULL) {
+    if (v == 1)
+      info->n_slices++;
+    else if (v == 4)
+      info->n_counters++;
+  }
+  return TRUE;
+}
+
+static gboolean
+packet_field (guint field, guint64 v, const guint8 * data, TraceInfo * info)
+{
+  switch (field) {
+    case 11:
+      return data && parse_message (data, data + v, event_field, info);
+    case 12:
+      return data && parse_message (data, data + v, interned_field, info);
+    case 58:
+      /* TracePacket.timestamp_clock_id, BUILTIN_CLOCK_MONOTONIC */
+      if (v == 3)
+        info->n_monotonic++;
+      return TRUE;
+    case 60:
+      return data && parse_message (data, data + v, name_field, info);
+    default:
+      return TRUE;
+  }
+}
+
+static gboolean
+trace_field (guint field, guint64 v, const guint8 * data, TraceInfo * info)
+{
+  /* everything is a Trace.packet */
+  if (field != 1 || data == NULL)
+    return FALSE;
+
+  info->n_packets++;
+  return parse_message (data, data + v, packet_field, info);
+}
+
+static gboolean
+has_name (TraceInfo * info, const gchar * name)
+{
+  guint i;
+
+  for (i = 0; i < info->names->len; i++) {
+    if (g_str_equal (g_ptr_array_index (info->names, i), name))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+GST_START_TEST (test_trace)
+{
+  GstElement *pipeline, *src, *queue, *sink;
+  GstMessage *msg;
+  TraceInfo info = { 0, };
+  gchar *contents;
+  gsize len;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", "src");
+  queue = gst_element_factory_make ("queue", "q");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (pipeline && src && queue && sink);
+  g_object_set (src, "num-buffers", NUM_BUFFERS, NULL);
+  g_object_set (sink, "sync", FALSE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), src, queue, sink, NULL);
+  fail_unless (gst_element_link_many (src, queue, sink, NULL));
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* the trace is only complete once the tracer is gone */
+  gst_deinit ();
+
+  fail_unless (g_file_get_contents (trace_file, &contents, &len, NULL));
+  fail_unless (len > 0);
+
+  info.names = g_ptr_array_new_with_free_func (g_free);
+  fail_unless (parse_message ((const guint8 *) contents,
+          (const guint8 *) contents + len, trace_field, &info));
+
+  /* all timestamps are in the monotonic clock */
+  fail_unless_equals_int (info.n_monotonic, info.n_packets);
+
+  /* the pushes of both threads */
+  fail_unless (has_name (&info, "src:src"));
+  fail_unless (has_name (&info, "q:src"));
+  fail_unless (info.n_slices >= 2 * NUM_BUFFERS);
+  /* the queue is sampled on every push with a sample-interval of 0 */
+  fail_unless (has_name (&info, "q level buffers"));
+  fail_unless (has_name (&info, "q level bytes"));
+  fail_unless (has_name (&info, "q level time"));
+  fail_unless (info.n_counters >= 3 * NUM_BUFFERS);
+
+  g_ptr_array_unref (info.names);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+static Suite *
+perfetto_suite (void)
+{
+  Suite *s = suite_create ("perfetto");
+  TCase *tc_chain = tcase_create ("tracer");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_trace);
+
+  return s;
+}
+
+/* Replacement for GST_CHECK_MAIN (perfetto); because we need to set the
+ * env before gst_init() is called. The tracer has a writer thread, which
+ * does not exist in a forked child, so the test is not run in one. */
+int
+main (int argc, char **argv)
+{
+  Suite *s;
+  gchar *tracers;
+  gint fd, ret;
+
+  fd = g_file_open_tmp ("gstcheck-XXXXXX.perfetto-trace", &trace_file, NULL);
+  g_assert (fd >= 0);
+  g_close (fd, NULL);
+
+  tracers = g_strdup_printf ("perfetto(file=\"%s\","
+      "sample-interval=(guint64)0,buffer-size=(uint)1024)", trace_file);
+  g_setenv ("GST_TRACERS", tracers, TRUE);
+  g_free (tracers);
+
+  gst_check_init (&argc, &argv);
+  s = perfetto_suite ();
+  ret = gst_check_run_suite_nofork (s, "perfetto", __FILE__);
+
+  g_unlink (trace_file);
+  g_free (trace_file);
+
+  return ret;
+}
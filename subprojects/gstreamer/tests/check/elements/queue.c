@@ -939,6 +939,79 @@ GST_START_TEST (test_serialized_query_with_threshold)
 GST_END_TEST;
 
 
+static GList *batch_sizes;
+
+static GstFlowReturn
+batch_chain_func (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  batch_sizes = g_list_append (batch_sizes, GUINT_TO_POINTER (1));
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+batch_chain_list_func (GstPad * pad, GstObject * parent,
+    GstBufferList * buffer_list)
+{
+  batch_sizes = g_list_append (batch_sizes,
+      GUINT_TO_POINTER (gst_buffer_list_length (buffer_list)));
+  gst_buffer_list_unref (buffer_list);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_batch_buffers)
+{
+  GstSegment segment;
+  guint i;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_chain_function (mysinkpad, batch_chain_func);
+  gst_pad_set_chain_list_function (mysinkpad, batch_chain_list_func);
+  gst_pad_set_event_function (mysinkpad, event_func);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  /* make sure all buffers are queued before the first one is pushed */
+  g_object_set (queue, "min-threshold-buffers", 5, "max-batch-buffers", 3,
+      NULL);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 5; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buffer) = i * GST_MSECOND;
+    fail_unless (gst_pad_push (mysrcpad, buffer) == GST_FLOW_OK);
+  }
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+
+  g_mutex_lock (&events_lock);
+  while (events_count < 3)
+    g_cond_wait (&events_cond, &events_lock);
+  g_mutex_unlock (&events_lock);
+
+  /* 3 buffers batched by max-batch-buffers, the remaining 2 after EOS */
+  fail_unless_equals_int (g_list_length (batch_sizes), 2);
+  fail_unless_equals_int (GPOINTER_TO_UINT (batch_sizes->data), 3);
+  fail_unless_equals_int (GPOINTER_TO_UINT (batch_sizes->next->data), 2);
+
+  g_list_free (batch_sizes);
+  batch_sizes = NULL;
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 static gpointer
 push_event_thread_func (gpointer data)
 {
@@ -1408,6 +1481,7 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_initial_events_nodelay);
   tcase_add_test (tc_chain, test_flush_on_error);
   tcase_add_test (tc_chain, test_time_level_before_output);
+  tcase_add_test (tc_chain, test_batch_buffers);
 
   return s;
 }
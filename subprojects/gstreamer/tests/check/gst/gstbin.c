@@ -1988,6 +1988,118 @@ GST_START_TEST (test_suppressed_flags_when_removing)
 
 GST_END_TEST;
 
+#define N_PARALLEL_CHAINS 4
+
+static GstElement *
+make_parallel_chains (GstElement * chains[N_PARALLEL_CHAINS][3])
+{
+  GstElement *pipeline;
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  fail_unless (pipeline != NULL, "Could not create pipeline");
+  g_object_set (pipeline, "parallel-state-changes", TRUE, NULL);
+
+  for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+    chains[i][0] = gst_element_factory_make ("fakesink", NULL);
+    chains[i][1] = gst_element_factory_make ("identity", NULL);
+    chains[i][2] = gst_element_factory_make ("fakesrc", NULL);
+    fail_unless (chains[i][0] && chains[i][1] && chains[i][2]);
+
+    gst_bin_add_many (GST_BIN (pipeline), chains[i][0], chains[i][1],
+        chains[i][2], NULL);
+    fail_unless (gst_element_link_many (chains[i][2], chains[i][1],
+            chains[i][0], NULL));
+  }
+
+  return pipeline;
+}
+
+GST_START_TEST (test_parallel_state_changes)
+{
+  GstElement *chains[N_PARALLEL_CHAINS][3];
+  GstElement *pipeline;
+  GstStateChangeReturn ret;
+  GstMessage *msg;
+  GstBus *bus;
+  gint order[N_PARALLEL_CHAINS][3];
+  gint i, j, n = 0;
+
+  pipeline = make_parallel_chains (chains);
+  bus = gst_element_get_bus (pipeline);
+
+  ret = gst_element_set_state (pipeline, GST_STATE_READY);
+  fail_unless (ret == GST_STATE_CHANGE_SUCCESS);
+
+  /* every chain must still change state from sink to source */
+  memset (order, -1, sizeof (order));
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_STATE_CHANGED))) {
+    for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+      for (j = 0; j < 3; j++) {
+        if (GST_MESSAGE_SRC (msg) == GST_OBJECT (chains[i][j]))
+          order[i][j] = n;
+      }
+    }
+    n++;
+    gst_message_unref (msg);
+  }
+  for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+    fail_unless (order[i][0] >= 0);
+    fail_unless (order[i][0] < order[i][1]);
+    fail_unless (order[i][1] < order[i][2]);
+  }
+
+  ret = gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless (ret != GST_STATE_CHANGE_FAILURE);
+  ret = gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+  fail_unless (ret == GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+    for (j = 0; j < 3; j++)
+      fail_unless (GST_STATE (chains[i][j]) == GST_STATE_PLAYING);
+  }
+
+  ret = gst_element_set_state (pipeline, GST_STATE_NULL);
+  fail_unless (ret == GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+    for (j = 0; j < 3; j++)
+      fail_unless (GST_STATE (chains[i][j]) == GST_STATE_NULL);
+  }
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parallel_state_failure)
+{
+  GstElement *chains[N_PARALLEL_CHAINS][3];
+  GstElement *pipeline;
+  GstStateChangeReturn ret;
+  gint i, j;
+
+  pipeline = make_parallel_chains (chains);
+
+  /* fail NULL -> READY in the last chain */
+  g_object_set (chains[N_PARALLEL_CHAINS - 1][0], "state-error", 1, NULL);
+
+  ret = gst_element_set_state (pipeline, GST_STATE_READY);
+  fail_unless (ret == GST_STATE_CHANGE_FAILURE);
+
+  /* everything was switched back */
+  for (i = 0; i < N_PARALLEL_CHAINS; i++) {
+    for (j = 0; j < 3; j++)
+      fail_unless (GST_STATE (chains[i][j]) == GST_STATE_NULL);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bin_suite (void)
 {
@@ -2023,6 +2135,8 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_deep_added_removed);
   tcase_add_test (tc_chain, test_suppressed_flags);
   tcase_add_test (tc_chain, test_suppressed_flags_when_removing);
+  tcase_add_test (tc_chain, test_parallel_state_changes);
+  tcase_add_test (tc_chain, test_parallel_state_failure);
 
   /* fails on OSX build bot for some reason, and is a bit silly anyway */
   if (0)
@@ -336,6 +336,93 @@ GST_START_TEST (test_no_deadlock_for_buffer_discard)
 
 GST_END_TEST;
 
+static GstBufferPool *
+create_scalable_pool (guint size, guint min_buf, guint max_buf)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+
+  gst_buffer_pool_config_set_params (conf, caps, size, min_buf, max_buf);
+  gst_buffer_pool_config_set_scalable (conf, TRUE);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (caps);
+
+  conf = gst_buffer_pool_get_config (pool);
+  fail_unless (gst_buffer_pool_config_get_scalable (conf));
+  gst_structure_free (conf);
+
+  return pool;
+}
+
+GST_START_TEST (test_scalable_buffer_is_recycled)
+{
+  GstBufferPool *pool = create_scalable_pool (10, 2, 0);
+  GstBuffer *buf = NULL, *prev;
+  gint dcount = 0;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  prev = buf;
+  buffer_track_destroy (buf, &dcount);
+  gst_buffer_unref (buf);
+
+  /* buffer should not have been freed, but have been recycled */
+  fail_unless (dcount == 0);
+
+  /* the releasing thread gets its own buffer back first */
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  fail_unless (buf == prev, "got a different buffer instead of previous");
+
+  gst_buffer_unref (buf);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+
+  /* buffer should now be gone */
+  fail_unless (dcount == 1);
+}
+
+GST_END_TEST;
+
+static gpointer
+delayed_unref_buf (gpointer p)
+{
+  g_usleep (G_USEC_PER_SEC / 100);
+  gst_buffer_unref (GST_BUFFER_CAST (p));
+  return NULL;
+}
+
+GST_START_TEST (test_scalable_wait_for_release)
+{
+  GstBufferPool *pool;
+  GstBuffer *buf1, *buf2;
+  GThread *thread;
+  GstBufferPoolAcquireParams params = { 0, };
+
+  pool = create_scalable_pool (10, 1, 1);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf1,
+          NULL) == GST_FLOW_OK);
+
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          &params) == GST_FLOW_EOS);
+
+  /* we will be blocked here until buf1 is released from the other thread */
+  thread = g_thread_new (NULL, delayed_unref_buf, buf1);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          NULL) == GST_FLOW_OK);
+  fail_unless (buf2 == buf1);
+
+  gst_buffer_unref (buf2);
+  g_thread_join (thread);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_parent_meta)
 {
   GstBufferPool *pool;
@@ -463,6 +550,8 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
   tcase_add_test (tc_chain, test_no_deadlock_for_buffer_discard);
+  tcase_add_test (tc_chain, test_scalable_buffer_is_recycled);
+  tcase_add_test (tc_chain, test_scalable_wait_for_release);
   tcase_add_test (tc_chain, test_parent_meta);
   tcase_add_test (tc_chain, test_make_writable_parent_meta);
 
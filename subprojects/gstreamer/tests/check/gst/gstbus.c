@@ -928,6 +928,148 @@ GST_START_TEST (test_single_gsource)
 
 GST_END_TEST;
 
+GST_START_TEST (test_coalesce)
+{
+  GstBus *bus = gst_bus_new ();
+  GstObject *src1 = g_object_new (GST_TYPE_BIN, "name", "src1", NULL);
+  GstObject *src2 = g_object_new (GST_TYPE_BIN, "name", "src2", NULL);
+  GstMessage *msg;
+  guint depth, max_depth;
+  guint64 dropped;
+  gint i, value;
+
+  gst_object_ref_sink (src1);
+  gst_object_ref_sink (src2);
+
+  g_object_set (bus, "coalesce-types", GST_MESSAGE_ELEMENT, NULL);
+
+  for (i = 0; i < 10; i++) {
+    gst_bus_post (bus, gst_message_new_element (src1,
+            gst_structure_new ("level", "value", G_TYPE_INT, i, NULL)));
+    gst_bus_post (bus, gst_message_new_element (src2,
+            gst_structure_new ("level", "value", G_TYPE_INT, i, NULL)));
+    gst_bus_post (bus, gst_message_new_element (src1,
+            gst_structure_new ("spectrum", "value", G_TYPE_INT, i, NULL)));
+    /* not coalesced */
+    gst_bus_post (bus, gst_message_new_application (src1,
+            gst_structure_new ("app", "value", G_TYPE_INT, i, NULL)));
+  }
+
+  g_object_get (bus, "queue-depth", &depth, "max-queue-depth", &max_depth,
+      "dropped", &dropped, NULL);
+  fail_unless_equals_int (depth, 13);
+  fail_unless_equals_int (max_depth, 13);
+  fail_unless_equals_uint64 (dropped, 27);
+
+  /* the application messages come first, the coalesced ones are at the
+   * position of their latest post */
+  for (i = 0; i < 9; i++) {
+    msg = gst_bus_pop (bus);
+    fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_APPLICATION);
+    gst_message_unref (msg);
+  }
+
+  msg = gst_bus_pop (bus);
+  fail_unless (GST_MESSAGE_SRC (msg) == src1);
+  fail_unless (gst_message_has_name (msg, "level"));
+  fail_unless (gst_structure_get_int (gst_message_get_structure (msg),
+          "value", &value));
+  fail_unless_equals_int (value, 9);
+  gst_message_unref (msg);
+
+  msg = gst_bus_pop (bus);
+  fail_unless (GST_MESSAGE_SRC (msg) == src2);
+  fail_unless (gst_message_has_name (msg, "level"));
+  gst_message_unref (msg);
+
+  msg = gst_bus_pop (bus);
+  fail_unless (gst_message_has_name (msg, "spectrum"));
+  gst_message_unref (msg);
+
+  msg = gst_bus_pop (bus);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_APPLICATION);
+  gst_message_unref (msg);
+
+  fail_unless (gst_bus_pop (bus) == NULL);
+  g_object_get (bus, "queue-depth", &depth, NULL);
+  fail_unless_equals_int (depth, 0);
+
+  /* many replaced messages in between others */
+  for (i = 0; i < 1000; i++) {
+    gst_bus_post (bus, gst_message_new_element (src1,
+            gst_structure_new ("level", "value", G_TYPE_INT, i, NULL)));
+    if (i % 100 == 0)
+      gst_bus_post (bus, gst_message_new_application (src1,
+              gst_structure_new ("app", "value", G_TYPE_INT, i, NULL)));
+  }
+
+  g_object_get (bus, "queue-depth", &depth, NULL);
+  fail_unless_equals_int (depth, 11);
+
+  msg = gst_bus_peek (bus);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_APPLICATION);
+  gst_message_unref (msg);
+
+  for (i = 0; i < 10; i++) {
+    msg = gst_bus_pop (bus);
+    fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_APPLICATION);
+    fail_unless (gst_structure_get_int (gst_message_get_structure (msg),
+            "value", &value));
+    fail_unless_equals_int (value, i * 100);
+    gst_message_unref (msg);
+  }
+
+  msg = gst_bus_pop (bus);
+  fail_unless (gst_message_has_name (msg, "level"));
+  fail_unless (gst_structure_get_int (gst_message_get_structure (msg),
+          "value", &value));
+  fail_unless_equals_int (value, 999);
+  gst_message_unref (msg);
+  fail_unless (gst_bus_pop (bus) == NULL);
+
+  gst_object_unref (src1);
+  gst_object_unref (src2);
+  gst_object_unref (bus);
+}
+
+GST_END_TEST;
+
+static gboolean
+count_message (GstBus * bus, GstMessage * message, gpointer data)
+{
+  guint *count = data;
+
+  (*count)++;
+
+  return TRUE;
+}
+
+GST_START_TEST (test_dispatch_batch)
+{
+  GstBus *bus = gst_bus_new ();
+  guint count = 0;
+  gint i;
+
+  g_object_set (bus, "dispatch-batch-size", 4, NULL);
+  gst_bus_add_watch (bus, count_message, &count);
+
+  for (i = 0; i < 10; i++)
+    gst_bus_post (bus, gst_message_new_eos (NULL));
+
+  /* every dispatch handles up to 4 messages */
+  fail_unless (g_main_context_iteration (NULL, FALSE));
+  fail_unless_equals_int (count, 4);
+  fail_unless (g_main_context_iteration (NULL, FALSE));
+  fail_unless_equals_int (count, 8);
+  fail_unless (g_main_context_iteration (NULL, FALSE));
+  fail_unless_equals_int (count, 10);
+
+  fail_unless (gst_bus_remove_watch (bus));
+  gst_object_unref (bus);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bus_suite (void)
 {
@@ -951,6 +1093,8 @@ gst_bus_suite (void)
   tcase_add_test (tc_chain, test_custom_main_context);
   tcase_add_test (tc_chain, test_async_message);
   tcase_add_test (tc_chain, test_single_gsource);
+  tcase_add_test (tc_chain, test_coalesce);
+  tcase_add_test (tc_chain, test_dispatch_batch);
   return s;
 }
 
@@ -2595,6 +2595,172 @@ GST_START_TEST (test_caps_in_set_in_caps_subset)
 
 GST_END_TEST;
 
+static void
+check_binary_roundtrip (const gchar * str)
+{
+  GstCaps *caps, *caps2;
+  GByteArray *out;
+  gsize consumed = 0;
+
+  caps = gst_caps_from_string (str);
+  fail_unless (caps != NULL, "could not parse %s", str);
+
+  out = g_byte_array_new ();
+  fail_unless (gst_caps_serialize_binary (caps, out));
+
+  caps2 = gst_caps_deserialize_binary (out->data, out->len, &consumed);
+  fail_unless (caps2 != NULL);
+  fail_unless_equals_int (consumed, out->len);
+  fail_unless (gst_caps_is_strictly_equal (caps, caps2),
+      "%" GST_PTR_FORMAT " != %" GST_PTR_FORMAT, caps, caps2);
+  gst_caps_unref (caps2);
+
+  /* truncated data must be rejected */
+  fail_if (gst_caps_deserialize_binary (out->data, out->len - 1, NULL));
+
+  g_byte_array_unref (out);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_binary_serialize)
+{
+  GstStructure *s, *s2;
+  GByteArray *out;
+  GValue v = G_VALUE_INIT, v2 = G_VALUE_INIT;
+  gsize consumed;
+
+  check_binary_roundtrip ("ANY");
+  check_binary_roundtrip ("EMPTY");
+  check_binary_roundtrip ("audio/x-raw, format = (string) { S16LE, F32LE }, "
+      "rate = (int) [ 1, MAX ], channels = (int) 2, "
+      "channel-mask = (bitmask) 0x3, layout = (string) interleaved");
+  check_binary_roundtrip ("video/x-raw(memory:GLMemory, meta:Overlay), "
+      "format = (string) RGBA, width = (int) [ 16, 4096, 16 ], "
+      "height = (int) 720, framerate = (fraction) [ 0/1, 60/1 ], "
+      "pixel-aspect-ratio = (fraction) 1/1, "
+      "colorimetry = (string) bt709; video/x-raw(ANY)");
+  check_binary_roundtrip ("test/test, a = (double) [ 0.5, 2.5 ], "
+      "b = (int64) [ 1, 100, 3 ], c = (int) < 1, 2, 3 >, "
+      "d = (boolean) true, e = (uint64) 18446744073709551615, "
+      "f = (structure) \"inner, x = (int) 1;\", g = (float) 1.5, "
+      "h = (GstSeekFlags) flush+accurate, i = (GstFormat) time, "
+      "j = (GstStreamFlags) sparse, k = (flagset) 00000001:ffffffff, "
+      "l = (string) NULL");
+
+  /* values and structures can be placed one after another */
+  s = gst_structure_new ("s", "a", G_TYPE_STRING, "string", NULL);
+  g_value_init (&v, GST_TYPE_CAPS);
+  g_value_take_boxed (&v, gst_caps_from_string ("a/b; c/d"));
+
+  out = g_byte_array_new ();
+  fail_unless (gst_structure_serialize_binary (s, out));
+  fail_unless (gst_value_serialize_binary (&v, out));
+
+  s2 = gst_structure_deserialize_binary (out->data, out->len, &consumed);
+  fail_unless (s2 != NULL);
+  fail_unless (gst_structure_is_equal (s, s2));
+  fail_unless (gst_value_deserialize_binary (&v2, out->data + consumed,
+          out->len - consumed, NULL));
+  fail_unless (gst_value_compare (&v, &v2) == GST_VALUE_EQUAL);
+
+  /* the kind of the serialized object is checked */
+  fail_if (gst_caps_deserialize_binary (out->data, out->len, NULL));
+
+  g_value_unset (&v2);
+  g_value_unset (&v);
+  gst_structure_free (s2);
+  gst_structure_free (s);
+  g_byte_array_unref (out);
+}
+
+GST_END_TEST;
+
+static gboolean
+deserialize_value_body (const guint8 * body, gsize len)
+{
+  GValue v = G_VALUE_INIT;
+  GByteArray *data = g_byte_array_new ();
+  guint8 header[8] = { 'G', 'B', 1, 'V' };
+  gboolean ret;
+
+  GST_WRITE_UINT32_LE (header + 4, len);
+  g_byte_array_append (data, header, sizeof (header));
+  g_byte_array_append (data, body, len);
+
+  ret = gst_value_deserialize_binary (&v, data->data, data->len, NULL);
+  if (ret)
+    g_value_unset (&v);
+  g_byte_array_unref (data);
+
+  return ret;
+}
+
+#define fail_unless_rejected(...) G_STMT_START {                      \
+  const guint8 body[] = { __VA_ARGS__ };                              \
+  fail_if (deserialize_value_body (body, sizeof (body)));             \
+} G_STMT_END
+
+GST_START_TEST (test_binary_deserialize_malformed)
+{
+  /* make sure that the types exist */
+  g_type_class_unref (g_type_class_ref (GST_TYPE_OBJECT));
+  fail_unless (GST_TYPE_URI_HANDLER != 0);
+
+  /* a fraction range of 1/1 to 1/2 and one of 1/1 to 1/1 */
+  fail_unless_rejected (16, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0);
+  fail_unless_rejected (16, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0);
+  /* fractions with G_MININT */
+  fail_unless_rejected (12, 0, 0, 0, 0x80, 1, 0, 0, 0);
+  fail_unless_rejected (12, 1, 0, 0, 0, 0, 0, 0, 0x80);
+  fail_unless_rejected (12, 1, 0, 0, 0, 0, 0, 0, 0);
+  /* int ranges where the bounds are not a multiple of the step */
+  fail_unless_rejected (13, 1, 0, 0, 0, 10, 0, 0, 0, 3, 0, 0, 0);
+  fail_unless_rejected (14, 0, 0, 0, 0, 0, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0, 0,
+      4, 0, 0, 0, 0, 0, 0, 0);
+  /* a double range of 2.0 to 1.0 */
+  fail_unless_rejected (15, 0, 0, 0, 0, 0, 0, 0, 0x40, 0, 0, 0, 0, 0, 0, 0xf0,
+      0x3f);
+  /* an abstract enum type */
+  fail_unless_rejected (10, 5, 'G', 'E', 'n', 'u', 'm', 0, 0, 0, 0);
+  /* generic values of an abstract type, an interface and a type that is
+   * no value type */
+  fail_unless_rejected (25, 9, 'G', 's', 't', 'O', 'b', 'j', 'e', 'c', 't',
+      1, 'x');
+  fail_unless_rejected (25, 13, 'G', 's', 't', 'U', 'R', 'I', 'H', 'a', 'n',
+      'd', 'l', 'e', 'r', 1, 'x');
+  fail_unless_rejected (25, 4, 'v', 'o', 'i', 'd', 1, 'x');
+  /* a list of an int and a string, and an array of an int and a list of
+   * strings */
+  fail_unless_rejected (17, 2, 1, 1, 0, 0, 0, 8, 1, 'a');
+  fail_unless_rejected (18, 2, 1, 1, 0, 0, 0, 17, 1, 8, 1, 'a');
+  /* invalid caps feature names */
+  fail_unless_rejected (24, 1, 0, 1, 3, 'f', 'o', 'o');
+  fail_unless_rejected (24, 1, 0, 1, 4, 'f', 'o', 'o', ':');
+  fail_unless_rejected (24, 1, 0, 1, 5, 'f', ':', 'o', '-', 'o');
+  /* invalid structure names */
+  fail_unless_rejected (22, 1, 3, '1', 'a', 'b', 0);
+  fail_unless_rejected (22, 1, 0, 0);
+  /* unknown tags */
+  fail_unless_rejected (0);
+  fail_unless_rejected (200);
+
+  /* valid versions of some of the above */
+  {
+    const guint8 range[] = { 16, 1, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0,
+      0
+    };
+    const guint8 list[] = { 17, 2, 1, 1, 0, 0, 0, 13, 2, 0, 0, 0, 4, 0, 0, 0,
+      2, 0, 0, 0
+    };
+    const guint8 features[] = { 24, 1, 0, 1, 5, 'f', ':', 'o', '2', 'o' };
+
+    fail_unless (deserialize_value_body (range, sizeof (range)));
+    fail_unless (deserialize_value_body (list, sizeof (list)));
+    fail_unless (deserialize_value_body (features, sizeof (features)));
+  }
+}
+
+GST_END_TEST;
 
 static Suite *
 gst_caps_suite (void)
@@ -2639,6 +2805,8 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_nested);
   tcase_add_test (tc_chain, test_array_subset);
   tcase_add_test (tc_chain, test_caps_in_set_in_caps_subset);
+  tcase_add_test (tc_chain, test_binary_serialize);
+  tcase_add_test (tc_chain, test_binary_deserialize_malformed);
 
   return s;
 }
@@ -0,0 +1,330 @@
+/* GStreamer
+ *
+ * unit test for the caps memo cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <gst/check/gstcheck.h>
+
+/* small enough that entries collide and get evicted all the time */
+#define CACHE_SIZE "4"
+
+static const gchar *caps_strings[] = {
+  "ANY",
+  "EMPTY",
+  "video/x-raw, format=(string)I420, width=(int)320, height=(int)240",
+  "video/x-raw, format=(string){ I420, NV12 }, width=(int)[ 1, 4096 ], "
+      "height=(int)[ 1, 4096 ], framerate=(fraction)[ 0/1, 60/1 ]",
+  "video/x-raw(memory:DMABuf), format=(string)NV12",
+  "video/x-raw(ANY)",
+  "video/x-raw(memory:SystemMemory), format=(string)I420",
+  "video/x-raw(memory:GLMemory, meta:GstVideoOverlayComposition), "
+      "format=(string)RGBA",
+  "audio/x-raw, rate=(int)44100, channels=(int)2",
+  "audio/x-raw, rate=(int)[ 8000, 96000 ], channels=(int)[ 1, 8 ]",
+  "audio/x-raw, rate=(int)48000; audio/x-raw, rate=(int)44100",
+  /* the hash only uses the type of buffer values, so these collide */
+  "video/x-h264, codec_data=(buffer)0142c01e",
+  "video/x-h264, codec_data=(buffer)0164001f",
+};
+
+/* results of every operation on every pair of caps, from a process without
+ * the cache */
+static gchar **expected;
+
+#define N_CAPS G_N_ELEMENTS (caps_strings)
+#define N_OPS 4
+
+static GstCaps **
+make_caps (void)
+{
+  GstCaps **caps = g_new (GstCaps *, N_CAPS);
+  guint i;
+
+  for (i = 0; i < N_CAPS; i++) {
+    caps[i] = gst_caps_from_string (caps_strings[i]);
+    g_assert (caps[i] != NULL);
+  }
+
+  return caps;
+}
+
+static void
+free_caps (GstCaps ** caps)
+{
+  guint i;
+
+  for (i = 0; i < N_CAPS; i++)
+    gst_caps_unref (caps[i]);
+  g_free (caps);
+}
+
+static gchar *
+run_op (GstCaps * caps1, GstCaps * caps2, guint op)
+{
+  GstCaps *res;
+  gchar *str;
+
+  switch (op) {
+    case 0:
+      res = gst_caps_intersect (caps1, caps2);
+      break;
+    case 1:
+      res = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+      break;
+    case 2:
+      return g_strdup (gst_caps_is_subset (caps1, caps2) ? "TRUE" : "FALSE");
+    default:
+      return g_strdup (gst_caps_can_intersect (caps1, caps2) ? "TRUE" :
+          "FALSE");
+  }
+
+  str = gst_caps_to_string (res);
+  gst_caps_unref (res);
+
+  return str;
+}
+
+/* runs every operation on every pair of caps from @a and @b */
+static void
+check_all (GstCaps ** a, GstCaps ** b)
+{
+  guint i, j, op;
+  gchar *res;
+
+  for (i = 0; i < N_CAPS; i++) {
+    for (j = 0; j < N_CAPS; j++) {
+      for (op = 0; op < N_OPS; op++) {
+        res = run_op (a[i], b[j], op);
+        fail_unless_equals_string (res, expected[(i * N_CAPS + j) * N_OPS +
+                op]);
+        g_free (res);
+      }
+    }
+  }
+}
+
+GST_START_TEST (test_cached_results)
+{
+  GstCaps **writable, **shared;
+  guint i, round;
+
+  writable = make_caps ();
+  shared = make_caps ();
+  /* not writable anymore */
+  for (i = 0; i < N_CAPS; i++)
+    gst_caps_ref (shared[i]);
+
+  /* the first round fills the cache, the others hit it or are recomputed
+   * after an eviction, all with the same results as without the cache */
+  for (round = 0; round < 3; round++) {
+    check_all (writable, writable);
+    check_all (shared, shared);
+    check_all (shared, writable);
+    check_all (writable, shared);
+  }
+
+  /* the cache does not change the writability of the inputs and keeps no
+   * references to them */
+  for (i = 0; i < N_CAPS; i++) {
+    if (!gst_caps_is_any (writable[i]) && !gst_caps_is_empty (writable[i]))
+      fail_unless (gst_caps_is_writable (writable[i]));
+    ASSERT_MINI_OBJECT_REFCOUNT (shared[i], "caps", 2);
+    gst_caps_unref (shared[i]);
+  }
+
+  free_caps (writable);
+  free_caps (shared);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_cached_values)
+{
+  GstCaps *caps1, *caps2, *caps3, *res;
+
+  caps1 = gst_caps_from_string ("video/x-raw(memory:DMABuf), width=(int)320");
+  caps2 = gst_caps_from_string ("video/x-raw, width=(int)320");
+  caps3 = gst_caps_copy (caps2);
+
+  /* features have to match, also on a hit */
+  res = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_empty (res));
+  gst_caps_unref (res);
+  res = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_empty (res));
+  gst_caps_unref (res);
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+
+  /* a hit returns caps the caller can change */
+  res = gst_caps_intersect (caps2, caps3);
+  gst_caps_unref (res);
+  res = gst_caps_intersect (caps2, caps3);
+  fail_unless (gst_caps_is_writable (res));
+  gst_caps_set_simple (res, "height", G_TYPE_INT, 240, NULL);
+  gst_caps_unref (res);
+
+  /* changing writable caps after a lookup gives new results */
+  gst_caps_set_features (caps1, 0, NULL);
+  res = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (res, caps2));
+  gst_caps_unref (res);
+  fail_unless (gst_caps_is_subset (caps1, caps2));
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps3);
+}
+
+GST_END_TEST;
+
+static gpointer
+intersect_thread (gpointer data)
+{
+  GstCaps **caps = data;
+  guint i;
+
+  for (i = 0; i < 20; i++)
+    check_all (caps, caps);
+
+  return NULL;
+}
+
+GST_START_TEST (test_cache_threads)
+{
+  GstCaps **shared;
+  GThread *threads[4];
+  guint i;
+
+  shared = make_caps ();
+  for (i = 0; i < N_CAPS; i++)
+    gst_caps_ref (shared[i]);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("intersect", intersect_thread, shared);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  for (i = 0; i < N_CAPS; i++)
+    gst_caps_unref (shared[i]);
+  free_caps (shared);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_caps_cache_suite (void)
+{
+  Suite *s = suite_create ("GstCapsCache");
+  TCase *tc_chain = tcase_create ("cache");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_cached_results);
+  tcase_add_test (tc_chain, test_cached_values);
+  tcase_add_test (tc_chain, test_cache_threads);
+
+  return s;
+}
+
+/* the results are computed in a child process that does not have the cache,
+ * which is set up in gst_init() */
+static gchar **
+compute_expected (void)
+{
+  GstCaps **caps;
+  GString *str;
+  gchar *output, **results;
+  gint fds[2], status = 0;
+  gssize written;
+  gsize len;
+  guint i, j, op;
+  pid_t pid;
+
+  if (pipe (fds) < 0)
+    g_error ("could not create a pipe");
+  pid = fork ();
+  g_assert (pid >= 0);
+
+  if (pid == 0) {
+    close (fds[0]);
+    gst_init (NULL, NULL);
+    caps = make_caps ();
+    str = g_string_new (NULL);
+    for (i = 0; i < N_CAPS; i++) {
+      for (j = 0; j < N_CAPS; j++) {
+        for (op = 0; op < N_OPS; op++) {
+          gchar *res = run_op (caps[i], caps[j], op);
+
+          g_string_append_printf (str, "%s\n", res);
+          g_free (res);
+        }
+      }
+    }
+    written = write (fds[1], str->str, str->len);
+    _exit (written == (gssize) str->len ? 0 : 1);
+  }
+
+  close (fds[1]);
+  str = g_string_new (NULL);
+  for (;;) {
+    gchar buf[4096];
+    gssize ret = read (fds[0], buf, sizeof (buf));
+
+    if (ret <= 0)
+      break;
+    g_string_append_len (str, buf, ret);
+  }
+  close (fds[0]);
+  waitpid (pid, &status, 0);
+  g_assert (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+
+  len = str->len;
+  output = g_string_free (str, FALSE);
+  g_assert (len > 0 && output[len - 1] == '\n');
+  output[len - 1] = '\0';
+  results = g_strsplit (output, "\n", -1);
+  g_free (output);
+
+  return results;
+}
+
+int
+main (int argc, char **argv)
+{
+  Suite *s;
+  gint ret;
+
+  g_unsetenv ("GST_CAPS_CACHE_SIZE");
+  expected = compute_expected ();
+  g_assert_cmpuint (g_strv_length (expected), ==, N_CAPS * N_CAPS * N_OPS);
+
+  g_setenv ("GST_CAPS_CACHE_SIZE", CACHE_SIZE, TRUE);
+  gst_check_init (&argc, &argv);
+  s = gst_caps_cache_suite ();
+  ret = gst_check_run_suite (s, "gst_caps_cache", __FILE__);
+  g_strfreev (expected);
+
+  return ret;
+}
@@ -274,6 +274,124 @@ GST_START_TEST (test_plugin_feature_rank_bumps_registry_cookie)
 
 GST_END_TEST;
 
+/* reference implementation of gst_element_factory_list_filter() without
+ * the index */
+static gboolean
+factory_can_handle_caps (GstElementFactory * factory, GstCaps * caps,
+    GstPadDirection direction, gboolean subsetonly)
+{
+  const GList *walk;
+
+  for (walk = gst_element_factory_get_static_pad_templates (factory); walk;
+      walk = walk->next) {
+    GstStaticPadTemplate *templ = walk->data;
+    GstCaps *tmpl_caps;
+    gboolean res;
+
+    if (templ->direction != direction)
+      continue;
+
+    tmpl_caps = gst_static_caps_get (&templ->static_caps);
+    res = subsetonly ? gst_caps_is_subset (caps, tmpl_caps) :
+        gst_caps_can_intersect (caps, tmpl_caps);
+    gst_caps_unref (tmpl_caps);
+
+    if (res)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+check_list_filter (GList * factories, const gchar * caps_str,
+    GstPadDirection direction, gboolean subsetonly)
+{
+  GstCaps *caps = gst_caps_from_string (caps_str);
+  GList *filtered, *l, *f;
+
+  filtered = gst_element_factory_list_filter (factories, caps, direction,
+      subsetonly);
+
+  /* same factories in the same order */
+  f = filtered;
+  for (l = factories; l; l = l->next) {
+    if (!factory_can_handle_caps (l->data, caps, direction, subsetonly))
+      continue;
+    fail_unless (f != NULL, "%s missing for %s", GST_OBJECT_NAME (l->data),
+        caps_str);
+    fail_unless (f->data == l->data);
+    f = f->next;
+  }
+  fail_unless (f == NULL, "unexpected %s for %s", f ? GST_OBJECT_NAME (f->data)
+      : "", caps_str);
+
+  gst_plugin_feature_list_free (filtered);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_list_filter_index)
+{
+  const gchar *caps_strs[] = { "ANY", "EMPTY", "video/x-raw",
+    "audio/x-raw, rate=(int)44100", "video/x-raw; application/x-unknown",
+    "application/x-unknown"
+  };
+  GList *factories;
+  guint i;
+
+  factories = gst_registry_get_feature_list (gst_registry_get (),
+      GST_TYPE_ELEMENT_FACTORY);
+  fail_unless (factories != NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (caps_strs); i++) {
+    check_list_filter (factories, caps_strs[i], GST_PAD_SINK, FALSE);
+    check_list_filter (factories, caps_strs[i], GST_PAD_SINK, TRUE);
+    check_list_filter (factories, caps_strs[i], GST_PAD_SRC, FALSE);
+    check_list_filter (factories, caps_strs[i], GST_PAD_SRC, TRUE);
+  }
+
+  gst_plugin_feature_list_free (factories);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_list_get_elements_cache)
+{
+  GstPluginFeature *feature;
+  GList *list1, *list2;
+  guint rank;
+
+  feature = gst_registry_find_feature (gst_registry_get (), "fakesink",
+      GST_TYPE_ELEMENT_FACTORY);
+  fail_unless (feature != NULL);
+  rank = gst_plugin_feature_get_rank (feature);
+
+  list1 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1000);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1000);
+  fail_unless_equals_int (g_list_length (list1), g_list_length (list2));
+  fail_if (g_list_find (list1, feature));
+  gst_plugin_feature_list_free (list1);
+  gst_plugin_feature_list_free (list2);
+
+  /* a rank change must invalidate the cached lists */
+  gst_plugin_feature_set_rank (feature, GST_RANK_PRIMARY + 1000);
+  list1 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1000);
+  fail_unless (g_list_find (list1, feature) != NULL);
+  gst_plugin_feature_list_free (list1);
+
+  gst_plugin_feature_set_rank (feature, rank);
+  list1 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_PRIMARY + 1000);
+  fail_if (g_list_find (list1, feature));
+  gst_plugin_feature_list_free (list1);
+
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_element_factory_suite (void)
 {
@@ -288,6 +406,8 @@ gst_element_factory_suite (void)
   tcase_add_test (tc_chain, test_can_sink_all_caps);
   tcase_add_test (tc_chain, test_plugin_feature_rank_property);
   tcase_add_test (tc_chain, test_plugin_feature_rank_bumps_registry_cookie);
+  tcase_add_test (tc_chain, test_list_filter_index);
+  tcase_add_test (tc_chain, test_list_get_elements_cache);
 
   return s;
 }
@@ -586,6 +586,74 @@ context_log_counter_func (GstDebugCategory * category,
   }
 }
 
+GST_START_TEST (info_binary_ring_buffer_logger)
+{
+  GstClockTime t = GST_SECOND;
+  GstElement *bin;
+  GBytes *dump, *garbage;
+  gchar *s, *text, *file, *function;
+
+  gst_debug_remove_log_function (gst_debug_log_default);
+  gst_debug_add_binary_ring_buffer_logger (64 * 1024, 0);
+  gst_debug_set_threshold_for_name ("check", GST_LEVEL_LOG);
+
+  bin = gst_bin_new ("testbin");
+  s = g_strdup ("dynamic");
+
+  GST_LOG ("int %d uint %u hex %08x int64 %" G_GINT64_FORMAT " double %.2f",
+      -5, 7u, 0xabcu, G_GINT64_CONSTANT (-1234567890123), 2.5);
+  GST_LOG ("string %s %.3s", s, "abcdef");
+  GST_LOG ("width %*d|%-*s|%%", 5, 42, 4, "ab");
+  GST_LOG_OBJECT (bin, "object %" GST_PTR_FORMAT, bin);
+  GST_LOG ("time %" GST_TIMEP_FORMAT, &t);
+  gst_debug_log_literal (GST_CAT_DEFAULT, GST_LEVEL_LOG, __FILE__,
+      GST_FUNCTION, __LINE__, NULL, "literal message");
+
+  /* like bindings do, with strings that are gone after logging */
+  file = g_strdup ("binding.c");
+  function = g_strdup ("binding_function");
+  gst_debug_log_literal (GST_CAT_DEFAULT, GST_LEVEL_LOG, file, function, 12,
+      NULL, "binding message");
+  memset (file, 'x', strlen (file));
+  memset (function, 'x', strlen (function));
+  g_free (file);
+  g_free (function);
+
+  /* strings are copied when logging */
+  g_free (s);
+  gst_object_unref (bin);
+
+  dump = gst_debug_binary_ring_buffer_logger_dump ();
+  fail_unless (dump != NULL);
+  text = gst_debug_binary_log_decode (dump);
+  fail_unless (text != NULL);
+
+  fail_unless (strstr (text, "int -5 uint 7 hex 00000abc int64 -1234567890123 "
+          "double 2.50\n") != NULL);
+  fail_unless (strstr (text, "string dynamic abc\n") != NULL);
+  fail_unless (strstr (text, "width    42|ab  |%\n") != NULL);
+  fail_unless (strstr (text, ":<testbin> object <testbin>\n") != NULL);
+  fail_unless (strstr (text, "time 0:00:01.000000000\n") != NULL);
+  fail_unless (strstr (text, "literal message\n") != NULL);
+  fail_unless (strstr (text, "binding.c:12:binding_function:") != NULL);
+  fail_unless (strstr (text, " check ") != NULL);
+
+  g_free (text);
+  g_bytes_unref (dump);
+
+  garbage = g_bytes_new_static ("GSTBLOG", 8);
+  fail_unless (gst_debug_binary_log_decode (garbage) == NULL);
+  g_bytes_unref (garbage);
+
+  gst_debug_remove_binary_ring_buffer_logger ();
+  fail_unless (gst_debug_binary_ring_buffer_logger_dump () == NULL);
+
+  gst_debug_unset_threshold_for_name ("check");
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (info_context_log)
 {
   GstDebugCategory *cat = NULL;
@@ -828,6 +896,7 @@ gst_info_suite (void)
   tcase_add_test (tc_chain, info_post_gst_init_category_registration);
   tcase_add_test (tc_chain, info_set_and_reset_string);
 
+  tcase_add_test (tc_chain, info_binary_ring_buffer_logger);
   tcase_add_test (tc_chain, info_context_log);
   tcase_add_test (tc_chain, info_context_log_once);
   tcase_add_test (tc_chain, info_context_log_periodic);
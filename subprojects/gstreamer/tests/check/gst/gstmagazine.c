@@ -0,0 +1,191 @@
+/* GStreamer
+ *
+ * unit test for the magazine allocation cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+/* more than a couple of magazines per size class so that the depot is used */
+#define N_OBJECTS 1000
+
+static const gsize sizes[] = { 1, 64, 100, 500, 1024, 3000, 4096, 5000 };
+
+static void
+fill_buffer (GstBuffer * buffer, guint8 value)
+{
+  GstMapInfo map;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  memset (map.data, value, map.size);
+  gst_buffer_unmap (buffer, &map);
+}
+
+static void
+check_buffer (GstBuffer * buffer, guint8 value)
+{
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], value);
+  gst_buffer_unmap (buffer, &map);
+}
+
+GST_START_TEST (test_alloc_free)
+{
+  GstBuffer **buffers;
+  guint i, round;
+
+  buffers = g_new0 (GstBuffer *, N_OBJECTS);
+
+  /* the second round is served from what the first one released */
+  for (round = 0; round < 2; round++) {
+    for (i = 0; i < N_OBJECTS; i++) {
+      buffers[i] = gst_buffer_new_allocate (NULL,
+          sizes[i % G_N_ELEMENTS (sizes)], NULL);
+      fail_unless (buffers[i] != NULL);
+      fill_buffer (buffers[i], i % 256);
+    }
+
+    /* blocks handed out twice would have been overwritten */
+    for (i = 0; i < N_OBJECTS; i++) {
+      check_buffer (buffers[i], i % 256);
+      gst_buffer_unref (buffers[i]);
+    }
+  }
+
+  g_free (buffers);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_meta)
+{
+  GstBuffer *parent, *buffer, *copy;
+  GstCaps *reference;
+  guint i;
+
+  parent = gst_buffer_new_allocate (NULL, 16, NULL);
+  reference = gst_caps_new_empty_simple ("timestamp/x-test");
+
+  for (i = 0; i < N_OBJECTS; i++) {
+    buffer = gst_buffer_new_allocate (NULL, 128, NULL);
+    gst_buffer_add_parent_buffer_meta (buffer, parent);
+    gst_buffer_add_reference_timestamp_meta (buffer, reference, i,
+        GST_CLOCK_TIME_NONE);
+
+    copy = gst_buffer_copy_deep (buffer);
+    fail_unless (gst_buffer_get_reference_timestamp_meta (copy,
+            NULL)->timestamp == i);
+    gst_buffer_unref (buffer);
+    gst_buffer_unref (copy);
+  }
+
+  gst_caps_unref (reference);
+  gst_buffer_unref (parent);
+}
+
+GST_END_TEST;
+
+static gpointer
+free_buffers (gpointer data)
+{
+  GAsyncQueue *queue = data;
+  GstBuffer *buffer;
+  guint i;
+
+  for (i = 0; i < N_OBJECTS; i++) {
+    buffer = g_async_queue_pop (queue);
+    check_buffer (buffer, i % 256);
+    gst_buffer_unref (buffer);
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (test_cross_thread_free)
+{
+  GAsyncQueue *queue;
+  GThread *thread;
+  GstBuffer *buffer;
+  guint i, round;
+
+  queue = g_async_queue_new ();
+
+  /* one thread allocates, the other one frees, the freed blocks travel back
+   * through the depot */
+  for (round = 0; round < 3; round++) {
+    thread = g_thread_new ("free", free_buffers, queue);
+    for (i = 0; i < N_OBJECTS; i++) {
+      buffer = gst_buffer_new_allocate (NULL,
+          sizes[i % G_N_ELEMENTS (sizes)], NULL);
+      fill_buffer (buffer, i % 256);
+      g_async_queue_push (queue, buffer);
+    }
+    /* the freeing thread flushes its cache to the depot when it exits */
+    g_thread_join (thread);
+  }
+
+  g_async_queue_unref (queue);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_magazine_suite (void)
+{
+  Suite *s = suite_create ("GstMagazine");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_alloc_free);
+  tcase_add_test (tc_chain, test_meta);
+  tcase_add_test (tc_chain, test_cross_thread_free);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  GstBuffer *buffers[16];
+  Suite *s;
+  gint ret;
+  guint i;
+
+  g_setenv ("GST_MAGAZINE_ALLOCATOR", "1", TRUE);
+  gst_check_init (&argc, &argv);
+  s = gst_magazine_suite ();
+  ret = gst_check_run_suite (s, "gst_magazine", __FILE__);
+
+  /* objects that outlive gst_deinit() must still be freed correctly and must
+   * not repopulate the caches that were torn down */
+  for (i = 0; i < G_N_ELEMENTS (buffers); i++)
+    buffers[i] = gst_buffer_new_allocate (NULL,
+        sizes[i % G_N_ELEMENTS (sizes)], NULL);
+  gst_deinit ();
+  for (i = 0; i < G_N_ELEMENTS (buffers); i++)
+    gst_buffer_unref (buffers[i]);
+
+  return ret;
+}
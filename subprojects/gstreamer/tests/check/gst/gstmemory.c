@@ -791,6 +791,55 @@ GST_START_TEST (test_auto_unmap)
 
 GST_END_TEST;
 
+GST_START_TEST (test_huge_pages_allocator)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *copy;
+  GstMapInfo info;
+  gsize sizes[] = { 100, 4 * 1024 * 1024 + 17 };
+  guint i;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_SYSMEM_HUGE_PAGES);
+  fail_unless (allocator != NULL);
+
+  gst_allocation_params_init (&params);
+  params.prefix = 10;
+  params.padding = 10;
+  params.flags = GST_MEMORY_FLAG_ZERO_PREFIXED | GST_MEMORY_FLAG_ZERO_PADDED;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    mem = gst_allocator_alloc (allocator, sizes[i], &params);
+    fail_unless (mem != NULL);
+    fail_unless (mem->allocator == allocator);
+    fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+    fail_unless_equals_int (gst_memory_get_sizes (mem, NULL, NULL), sizes[i]);
+
+    fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+    fail_unless (info.data[-1] == 0);
+    fail_unless (info.data[info.size] == 0);
+    memset (info.data, 0xaa, info.size);
+    gst_memory_unmap (mem, &info);
+
+    sub = gst_memory_share (mem, 1, 10);
+    fail_unless (sub->allocator == allocator);
+    copy = gst_memory_copy (mem, 0, -1);
+    fail_unless (copy->allocator == allocator);
+    fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+    fail_unless_equals_int (info.size, sizes[i]);
+    fail_unless (info.data[0] == 0xaa && info.data[info.size - 1] == 0xaa);
+    gst_memory_unmap (copy, &info);
+
+    gst_memory_unref (copy);
+    gst_memory_unref (sub);
+    gst_memory_unref (mem);
+  }
+
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_memory_suite (void)
 {
@@ -815,6 +864,7 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_no_error_and_no_warning_on_map_failure);
 #endif
   tcase_add_test (tc_chain, test_auto_unmap);
+  tcase_add_test (tc_chain, test_huge_pages_allocator);
 
   return s;
 }
@@ -325,6 +325,97 @@ GST_START_TEST (test_poll_controllable)
 
 GST_END_TEST;
 
+#ifndef G_OS_WIN32
+#define N_MANY_FDS 64
+
+/* enough fds to make the set switch to epoll where available */
+GST_START_TEST (test_poll_many_fds)
+{
+  GstPoll *set;
+  GstPollFD rfds[N_MANY_FDS];
+  gint wfds[N_MANY_FDS];
+  guchar c = 'A';
+  gint i;
+
+  set = gst_poll_new (TRUE);
+  fail_if (set == NULL, "Failed to create a GstPoll");
+
+  for (i = 0; i < N_MANY_FDS; i++) {
+    gint socks[2];
+
+    fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, socks) < 0,
+        "Could not create a socket pair");
+    gst_poll_fd_init (&rfds[i]);
+    rfds[i].fd = socks[0];
+    wfds[i] = socks[1];
+
+    fail_unless (gst_poll_add_fd (set, &rfds[i]));
+    fail_unless (gst_poll_fd_ctl_read (set, &rfds[i], TRUE));
+  }
+
+  fail_unless (gst_poll_wait (set, 0) == 0, "No descriptor should be ready");
+
+  fail_unless (write (wfds[3], &c, 1) == 1, "write() failed");
+  fail_unless (write (wfds[40], &c, 1) == 1, "write() failed");
+  fail_unless (write (wfds[N_MANY_FDS - 1], &c, 1) == 1, "write() failed");
+
+  fail_unless (gst_poll_wait (set, GST_CLOCK_TIME_NONE) == 3,
+      "Three descriptors should be available");
+  for (i = 0; i < N_MANY_FDS; i++) {
+    gboolean expected = (i == 3 || i == 40 || i == N_MANY_FDS - 1);
+
+    fail_unless (gst_poll_fd_can_read (set, &rfds[i]) == expected,
+        "Unexpected readability of descriptor %d", i);
+    fail_if (gst_poll_fd_can_write (set, &rfds[i]));
+  }
+
+  /* removing a descriptor moves another one, the results must stay valid */
+  fail_unless (gst_poll_remove_fd (set, &rfds[3]));
+  fail_unless (gst_poll_fd_can_read (set, &rfds[40]));
+  fail_unless (gst_poll_fd_can_read (set, &rfds[N_MANY_FDS - 1]));
+
+  /* not interested in reading anymore */
+  fail_unless (gst_poll_fd_ctl_read (set, &rfds[40], FALSE));
+  fail_unless (gst_poll_wait (set, GST_CLOCK_TIME_NONE) == 1,
+      "One descriptor should be available");
+  fail_if (gst_poll_fd_can_read (set, &rfds[40]));
+  fail_unless (gst_poll_fd_can_read (set, &rfds[N_MANY_FDS - 1]));
+
+  fail_unless (read (rfds[N_MANY_FDS - 1].fd, &c, 1) == 1, "read() failed");
+  fail_unless (gst_poll_wait (set, 0) == 0, "No descriptor should be ready");
+  fail_if (gst_poll_fd_can_read (set, &rfds[N_MANY_FDS - 1]));
+
+  /* hangups are reported without asking for them */
+  close (wfds[10]);
+  wfds[10] = -1;
+  fail_unless (gst_poll_wait (set, GST_CLOCK_TIME_NONE) == 1,
+      "One descriptor should be available");
+  fail_unless (gst_poll_fd_has_closed (set, &rfds[10]));
+  fail_unless (gst_poll_remove_fd (set, &rfds[10]));
+
+  /* a closed descriptor is invalid once it is changed, like with poll() */
+  close (rfds[20].fd);
+  fail_unless (gst_poll_fd_ctl_write (set, &rfds[20], TRUE));
+  fail_unless (gst_poll_wait (set, GST_CLOCK_TIME_NONE) == 1,
+      "One descriptor should be available");
+  fail_unless (gst_poll_fd_has_error (set, &rfds[20]));
+  fail_unless (gst_poll_wait (set, GST_CLOCK_TIME_NONE) == 1,
+      "One descriptor should be available");
+  fail_unless (gst_poll_remove_fd (set, &rfds[20]));
+  fail_unless (gst_poll_wait (set, 0) == 0, "No descriptor should be ready");
+
+  gst_poll_free (set);
+  for (i = 0; i < N_MANY_FDS; i++) {
+    if (i != 20)
+      close (rfds[i].fd);
+    if (wfds[i] >= 0)
+      close (wfds[i]);
+  }
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 gst_poll_suite (void)
 {
@@ -343,6 +434,7 @@ gst_poll_suite (void)
   tcase_add_test (tc_chain, test_poll_wait_restart);
   tcase_add_test (tc_chain, test_poll_wait_flush);
   tcase_add_test (tc_chain, test_poll_controllable);
+  tcase_add_test (tc_chain, test_poll_many_fds);
 #else
   tcase_skip_broken_test (tc_chain, test_poll_basic);
 #ifdef HAVE_PIPE
@@ -1235,6 +1235,60 @@ GST_START_TEST (test_container_type_marker)
 
 GST_END_TEST;
 
+GST_START_TEST (test_large_structure)
+{
+  GstStructure *s, *copy;
+  gchar name[32];
+  gint i, val;
+
+  /* enough fields to use the hashed field lookup */
+  s = gst_structure_new_empty ("stats");
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field-%d", i);
+    gst_structure_set (s, name, G_TYPE_INT, i, NULL);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  /* replacing a field does not add a new one */
+  gst_structure_set (s, "field-50", G_TYPE_INT, 1050, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  /* removing fields moves the following ones */
+  for (i = 0; i < 100; i += 2) {
+    g_snprintf (name, sizeof (name), "field-%d", i);
+    gst_structure_remove_field (s, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 50);
+
+  copy = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, copy));
+
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field-%d", i);
+    if (i % 2 == 0) {
+      fail_if (gst_structure_has_field (s, name));
+      fail_if (gst_structure_has_field (copy, name));
+    } else {
+      fail_unless (gst_structure_get_int (s, name, &val));
+      fail_unless_equals_int (val, i);
+      fail_unless (gst_structure_get_int (copy, name, &val));
+      fail_unless_equals_int (val, i);
+    }
+  }
+  fail_if (gst_structure_has_field (s, "field-50"));
+
+  gst_structure_remove_all_fields (copy);
+  fail_unless_equals_int (gst_structure_n_fields (copy), 0);
+  fail_if (gst_structure_has_field (copy, "field-1"));
+  gst_structure_set (copy, "field-1", G_TYPE_INT, 1, NULL);
+  fail_unless (gst_structure_has_field (copy, "field-1"));
+
+  gst_structure_free (copy);
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -1271,6 +1325,7 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_strict);
   tcase_add_test (tc_chain, test_strv);
   tcase_add_test (tc_chain, test_container_type_marker);
+  tcase_add_test (tc_chain, test_large_structure);
   return s;
 }
 
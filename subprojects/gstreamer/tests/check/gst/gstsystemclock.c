@@ -385,6 +385,149 @@ GST_START_TEST (test_stress_reschedule)
 GST_END_TEST;
 
 
+static gboolean
+timer_wheel_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  gint *count = user_data;
+
+  fail_unless (gst_clock_get_time (clock) >= time);
+  g_atomic_int_inc (count);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_timer_wheel)
+{
+  GstClock *clock;
+  GstClockID single[10], periodic, cancelled;
+  gint single_count = 0, periodic_count = 0, cancelled_count = 0;
+  GstClockTime base;
+  gboolean timer_wheel;
+  gint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "timer-wheel", TRUE, NULL);
+  gst_object_ref_sink (clock);
+  g_object_get (clock, "timer-wheel", &timer_wheel, NULL);
+  fail_unless (timer_wheel);
+
+  base = gst_clock_get_time (clock);
+
+  /* single shots in the past, in the same slot and more than one wheel
+   * revolution in the future */
+  for (i = 0; i < 10; i++) {
+    single[i] = gst_clock_new_single_shot_id (clock,
+        base + (i - 2) * 40 * GST_MSECOND);
+    fail_unless (gst_clock_id_wait_async (single[i], timer_wheel_cb,
+            &single_count, NULL) == GST_CLOCK_OK);
+  }
+
+  periodic = gst_clock_new_periodic_id (clock, base, 10 * GST_MSECOND);
+  fail_unless (gst_clock_id_wait_async (periodic, timer_wheel_cb,
+          &periodic_count, NULL) == GST_CLOCK_OK);
+
+  cancelled = gst_clock_new_single_shot_id (clock, base + 100 * GST_MSECOND);
+  fail_unless (gst_clock_id_wait_async (cancelled, timer_wheel_cb,
+          &cancelled_count, NULL) == GST_CLOCK_OK);
+  gst_clock_id_unschedule (cancelled);
+
+  g_usleep (500 * G_USEC_PER_SEC / 1000);
+
+  fail_unless_equals_int (g_atomic_int_get (&single_count), 10);
+  fail_unless (g_atomic_int_get (&periodic_count) > 10);
+  fail_unless_equals_int (g_atomic_int_get (&cancelled_count), 0);
+
+  gst_clock_id_unschedule (periodic);
+  gst_clock_id_unref (periodic);
+  gst_clock_id_unref (cancelled);
+  for (i = 0; i < 10; i++)
+    gst_clock_id_unref (single[i]);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+#define N_SYNC_WAITERS 8
+
+static gpointer
+timer_wheel_sync_waiter (GstClockID id)
+{
+  GstClock *clock = gst_clock_id_get_clock (id);
+  GstClockTimeDiff jitter;
+  GstClockReturn ret;
+
+  ret = gst_clock_id_wait (id, &jitter);
+  if (ret == GST_CLOCK_OK) {
+    /* woken up by the wheel thread early, but not returned before the time */
+    fail_unless (gst_clock_get_time (clock) >= gst_clock_id_get_time (id));
+    fail_unless (jitter < -10 * GST_MSECOND);
+  }
+  gst_object_unref (clock);
+
+  return GINT_TO_POINTER (ret);
+}
+
+GST_START_TEST (test_timer_wheel_sync)
+{
+  GstClock *clock;
+  GstClockID ids[N_SYNC_WAITERS], cancelled, periodic;
+  GThread *threads[N_SYNC_WAITERS], *cancelled_thread;
+  GstClockTime base, time;
+  GstClockTimeDiff jitter;
+  gint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "timer-wheel", TRUE, NULL);
+  gst_object_ref_sink (clock);
+
+  base = gst_clock_get_time (clock);
+
+  /* several waiters in the same and in different slots */
+  for (i = 0; i < N_SYNC_WAITERS; i++) {
+    ids[i] = gst_clock_new_single_shot_id (clock,
+        base + (20 + (i / 2) * 10) * GST_MSECOND);
+    threads[i] = g_thread_new ("waiter",
+        (GThreadFunc) timer_wheel_sync_waiter, ids[i]);
+  }
+
+  /* unscheduling wakes up a waiter on the wheel */
+  cancelled = gst_clock_new_single_shot_id (clock, base + 10 * GST_SECOND);
+  cancelled_thread = g_thread_new ("cancelled",
+      (GThreadFunc) timer_wheel_sync_waiter, cancelled);
+  g_usleep (G_USEC_PER_SEC / 100);
+  gst_clock_id_unschedule (cancelled);
+  fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (cancelled_thread)),
+      GST_CLOCK_UNSCHEDULED);
+
+  for (i = 0; i < N_SYNC_WAITERS; i++) {
+    fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (threads[i])),
+        GST_CLOCK_OK);
+  }
+
+  /* the same entry goes through the wheel for every wait */
+  time = gst_clock_get_time (clock);
+  periodic = gst_clock_new_periodic_id (clock, time + 20 * GST_MSECOND,
+      20 * GST_MSECOND);
+  for (i = 0; i < 5; i++) {
+    fail_unless_equals_int (gst_clock_id_wait (periodic, &jitter),
+        GST_CLOCK_OK);
+    fail_unless (jitter < 0);
+    fail_unless (gst_clock_get_time (clock) >=
+        time + (i + 1) * 20 * GST_MSECOND);
+  }
+
+  /* waits in the past don't block at all */
+  fail_unless_equals_int (gst_clock_id_wait (ids[0], NULL), GST_CLOCK_EARLY);
+
+  for (i = 0; i < N_SYNC_WAITERS; i++)
+    gst_clock_id_unref (ids[i]);
+  gst_clock_id_unref (periodic);
+  gst_clock_id_unref (cancelled);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_systemclock_suite (void)
 {
@@ -400,6 +543,8 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_resolution);
   tcase_add_test (tc_chain, test_stress_cleanup_unschedule);
   tcase_add_test (tc_chain, test_stress_reschedule);
+  tcase_add_test (tc_chain, test_timer_wheel);
+  tcase_add_test (tc_chain, test_timer_wheel_sync);
 
   return s;
 }
@@ -464,6 +464,414 @@ GST_START_TEST (test_shared_task_pool_two_threads)
 
 GST_END_TEST;
 
+#define N_COOPERATIVE_TASKS 8
+#define N_COOPERATIVE_ITERATIONS 1000
+
+typedef struct
+{
+  GstTask *task;
+  GRecMutex lock;
+  gint count;
+  gint entered;
+  gint left;
+} CooperativeTask;
+
+static gint cooperative_done;
+
+static void
+cooperative_task_enter (GstTask * task, GThread * thread,
+    CooperativeTask * ctask)
+{
+  g_atomic_int_inc (&ctask->entered);
+}
+
+static void
+cooperative_task_leave (GstTask * task, GThread * thread,
+    CooperativeTask * ctask)
+{
+  g_atomic_int_inc (&ctask->left);
+}
+
+static void
+cooperative_task_func (CooperativeTask * ctask)
+{
+  if (++ctask->count == N_COOPERATIVE_ITERATIONS) {
+    gst_task_pause (ctask->task);
+
+    g_mutex_lock (&task_lock);
+    cooperative_done++;
+    g_cond_signal (&task_cond);
+    g_mutex_unlock (&task_lock);
+  }
+}
+
+/* In this test, many tasks run on a work stealing pool with a single worker,
+ * which only works when they are multiplexed on the worker */
+GST_START_TEST (test_work_stealing_task_pool_tasks)
+{
+  CooperativeTask ctasks[N_COOPERATIVE_TASKS];
+  GstTaskPool *pool;
+  GError *err = NULL;
+  gint i;
+
+  pool = gst_work_stealing_task_pool_new (1);
+  fail_unless_equals_int (gst_work_stealing_task_pool_get_n_workers
+      (GST_WORK_STEALING_TASK_POOL (pool)), 1);
+  gst_work_stealing_task_pool_set_max_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 1);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  cooperative_done = 0;
+  g_mutex_init (&task_lock);
+  g_cond_init (&task_cond);
+
+  for (i = 0; i < N_COOPERATIVE_TASKS; i++) {
+    ctasks[i].count = 0;
+    ctasks[i].entered = 0;
+    ctasks[i].left = 0;
+    ctasks[i].task = gst_task_new ((GstTaskFunction) cooperative_task_func,
+        &ctasks[i], NULL);
+    g_rec_mutex_init (&ctasks[i].lock);
+    gst_task_set_lock (ctasks[i].task, &ctasks[i].lock);
+    gst_task_set_pool (ctasks[i].task, pool);
+    gst_task_set_enter_callback (ctasks[i].task,
+        (GstTaskThreadFunc) cooperative_task_enter, &ctasks[i], NULL);
+    gst_task_set_leave_callback (ctasks[i].task,
+        (GstTaskThreadFunc) cooperative_task_leave, &ctasks[i], NULL);
+  }
+
+  g_mutex_lock (&task_lock);
+  for (i = 0; i < N_COOPERATIVE_TASKS; i++)
+    fail_unless (gst_task_start (ctasks[i].task));
+  while (cooperative_done < N_COOPERATIVE_TASKS)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* all tasks paused themselves, resume them for another round */
+  for (i = 0; i < N_COOPERATIVE_TASKS; i++) {
+    fail_unless_equals_int (ctasks[i].count, N_COOPERATIVE_ITERATIONS);
+    ctasks[i].count = 0;
+  }
+
+  g_mutex_lock (&task_lock);
+  cooperative_done = 0;
+  for (i = 0; i < N_COOPERATIVE_TASKS; i++)
+    fail_unless (gst_task_resume (ctasks[i].task));
+  while (cooperative_done < N_COOPERATIVE_TASKS)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* joining a paused task has to schedule it once more to finish */
+  for (i = 0; i < N_COOPERATIVE_TASKS; i++) {
+    fail_unless (gst_task_join (ctasks[i].task));
+    fail_unless_equals_int (ctasks[i].count, N_COOPERATIVE_ITERATIONS);
+    /* once for the whole run, not for every slice */
+    fail_unless_equals_int (ctasks[i].entered, 1);
+    fail_unless_equals_int (ctasks[i].left, 1);
+    gst_object_unref (ctasks[i].task);
+    g_rec_mutex_clear (&ctasks[i].lock);
+  }
+
+  g_mutex_clear (&task_lock);
+  g_cond_clear (&task_cond);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+/* In this test, a work stealing pool with a single worker has to start an
+ * extra worker when the first one is blocked */
+GST_START_TEST (test_work_stealing_task_pool_blocked)
+{
+  GstTaskPool *pool;
+  GError *err = NULL;
+  TaskData tdata, tdata2;
+  gpointer handle;
+
+  init_task_data (&tdata);
+  init_task_data (&tdata2);
+
+  pool = gst_work_stealing_task_pool_new (1);
+  gst_work_stealing_task_pool_set_max_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 2);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  handle =
+      gst_task_pool_push (pool, (GstTaskPoolFunction) task_cb, &tdata, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+  handle =
+      gst_task_pool_push (pool, (GstTaskPoolFunction) task_cb, &tdata2, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+
+  /* the second task can only start on an extra worker */
+  g_mutex_lock (&tdata2.blocked_lock);
+  while (!tdata2.blocked)
+    g_cond_wait (&tdata2.blocked_cond, &tdata2.blocked_lock);
+  g_mutex_unlock (&tdata2.blocked_lock);
+
+  g_mutex_lock (&tdata.unblock_lock);
+  tdata.unblock = TRUE;
+  g_cond_signal (&tdata.unblock_cond);
+  g_mutex_unlock (&tdata.unblock_lock);
+
+  g_mutex_lock (&tdata2.unblock_lock);
+  tdata2.unblock = TRUE;
+  g_cond_signal (&tdata2.unblock_cond);
+  g_mutex_unlock (&tdata2.unblock_lock);
+
+  /* waits for the workers to finish */
+  gst_task_pool_cleanup (pool);
+
+  fail_unless (tdata.called == TRUE);
+  fail_unless (tdata2.called == TRUE);
+  fail_unless (tdata.caller_thread != tdata2.caller_thread);
+
+  cleanup_task_data (&tdata);
+  cleanup_task_data (&tdata2);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+/* In this test, a work stealing pool that may not start any extra worker
+ * moves a blocked job out of the pool so that the next one can run */
+GST_START_TEST (test_work_stealing_task_pool_detach)
+{
+  GstTaskPool *pool;
+  GError *err = NULL;
+  TaskData tdata, tdata2;
+  gpointer handle;
+
+  init_task_data (&tdata);
+  init_task_data (&tdata2);
+
+  pool = gst_work_stealing_task_pool_new (1);
+  gst_work_stealing_task_pool_set_max_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 1);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  handle =
+      gst_task_pool_push (pool, (GstTaskPoolFunction) task_cb, &tdata, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+  handle =
+      gst_task_pool_push (pool, (GstTaskPoolFunction) task_cb, &tdata2, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+
+  g_mutex_lock (&tdata2.blocked_lock);
+  while (!tdata2.blocked)
+    g_cond_wait (&tdata2.blocked_cond, &tdata2.blocked_lock);
+  g_mutex_unlock (&tdata2.blocked_lock);
+
+  g_mutex_lock (&tdata2.unblock_lock);
+  tdata2.unblock = TRUE;
+  g_cond_signal (&tdata2.unblock_cond);
+  g_mutex_unlock (&tdata2.unblock_lock);
+
+  g_mutex_lock (&tdata.unblock_lock);
+  tdata.unblock = TRUE;
+  g_cond_signal (&tdata.unblock_cond);
+  g_mutex_unlock (&tdata.unblock_lock);
+
+  gst_task_pool_cleanup (pool);
+
+  fail_unless (tdata.called == TRUE);
+  fail_unless (tdata2.called == TRUE);
+  fail_unless (tdata.caller_thread != tdata2.caller_thread);
+  fail_unless_equals_int (gst_work_stealing_task_pool_get_max_threads
+      (GST_WORK_STEALING_TASK_POOL (pool)), 1);
+
+  cleanup_task_data (&tdata);
+  cleanup_task_data (&tdata2);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static GThread *blocking_task_thread;
+
+static void
+blocking_task_func (GstTask * task)
+{
+  g_usleep (100 * G_TIME_SPAN_MILLISECOND);
+
+  g_mutex_lock (&task_lock);
+  blocking_task_thread = g_thread_self ();
+  g_cond_signal (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+static void
+worker_thread_cb (GThread ** thread)
+{
+  g_mutex_lock (&task_lock);
+  *thread = g_thread_self ();
+  g_cond_signal (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+/* In this test, a task whose function blocks moves from the single worker of
+ * a work stealing pool to a thread of its own */
+GST_START_TEST (test_work_stealing_task_pool_blocking_task)
+{
+  GstTaskPool *pool;
+  GstTask *task;
+  GRecMutex lock;
+  GThread *worker_thread = NULL, *first;
+  GError *err = NULL;
+  gpointer handle;
+
+  pool = gst_work_stealing_task_pool_new (1);
+  gst_work_stealing_task_pool_set_max_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 1);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  g_mutex_init (&task_lock);
+  g_cond_init (&task_cond);
+  g_rec_mutex_init (&lock);
+
+  task = gst_task_new ((GstTaskFunction) blocking_task_func, NULL, NULL);
+  gst_task_set_lock (task, &lock);
+  gst_task_set_pool (task, pool);
+
+  g_mutex_lock (&task_lock);
+  blocking_task_thread = NULL;
+  fail_unless (gst_task_start (task));
+  while (blocking_task_thread == NULL)
+    g_cond_wait (&task_cond, &task_lock);
+  first = blocking_task_thread;
+
+  /* the next iteration runs outside of the pool */
+  blocking_task_thread = NULL;
+  while (blocking_task_thread == NULL)
+    g_cond_wait (&task_cond, &task_lock);
+  fail_if (blocking_task_thread == first);
+  g_mutex_unlock (&task_lock);
+
+  /* and the worker is free for other jobs again */
+  handle = gst_task_pool_push (pool, (GstTaskPoolFunction) worker_thread_cb,
+      &worker_thread, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+  g_mutex_lock (&task_lock);
+  while (worker_thread == NULL)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+  fail_unless (worker_thread == first);
+  fail_unless (gst_task_join (task));
+
+  /* a task that blocked before starts outside of the pool right away */
+  g_mutex_lock (&task_lock);
+  blocking_task_thread = NULL;
+  fail_unless (gst_task_start (task));
+  while (blocking_task_thread == NULL)
+    g_cond_wait (&task_cond, &task_lock);
+  fail_if (blocking_task_thread == first);
+  g_mutex_unlock (&task_lock);
+
+  fail_unless (gst_task_join (task));
+  gst_object_unref (task);
+  g_rec_mutex_clear (&lock);
+
+  g_mutex_clear (&task_lock);
+  g_cond_clear (&task_cond);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+#define N_BLOCKING_JOBS 6
+
+static guint blocking_jobs_started;
+static gboolean blocking_jobs_unblock;
+static GCond blocking_jobs_cond;
+
+static void
+blocking_job_cb (gpointer data)
+{
+  g_mutex_lock (&task_lock);
+  blocking_jobs_started++;
+  g_cond_broadcast (&blocking_jobs_cond);
+  while (!blocking_jobs_unblock)
+    g_cond_wait (&blocking_jobs_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+}
+
+/* In this test, more jobs that are known to block than the pool has workers
+ * run at the same time without keeping the workers from other jobs */
+GST_START_TEST (test_work_stealing_task_pool_push_blocking)
+{
+  GstTaskPool *pool;
+  GThread *worker_thread = NULL;
+  GError *err = NULL;
+  gpointer handle;
+  guint i;
+
+  pool = gst_work_stealing_task_pool_new (2);
+  gst_work_stealing_task_pool_set_max_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 2);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  g_mutex_init (&task_lock);
+  g_cond_init (&task_cond);
+  g_cond_init (&blocking_jobs_cond);
+  blocking_jobs_started = 0;
+  blocking_jobs_unblock = FALSE;
+
+  for (i = 0; i < N_BLOCKING_JOBS; i++) {
+    fail_unless (gst_work_stealing_task_pool_push_blocking
+        (GST_WORK_STEALING_TASK_POOL (pool), blocking_job_cb, NULL, &err));
+    fail_unless (err == NULL);
+  }
+
+  g_mutex_lock (&task_lock);
+  while (blocking_jobs_started < N_BLOCKING_JOBS)
+    g_cond_wait (&blocking_jobs_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* all of them block, the workers still run regular jobs */
+  handle = gst_task_pool_push (pool, (GstTaskPoolFunction) worker_thread_cb,
+      &worker_thread, &err);
+  fail_unless (err == NULL);
+  gst_task_pool_dispose_handle (pool, handle);
+  g_mutex_lock (&task_lock);
+  while (worker_thread == NULL)
+    g_cond_wait (&task_cond, &task_lock);
+
+  blocking_jobs_unblock = TRUE;
+  g_cond_broadcast (&blocking_jobs_cond);
+  g_mutex_unlock (&task_lock);
+
+  /* waits for the blocking jobs too */
+  gst_task_pool_cleanup (pool);
+  fail_if (gst_work_stealing_task_pool_push_blocking
+      (GST_WORK_STEALING_TASK_POOL (pool), blocking_job_cb, NULL, &err));
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+
+  g_mutex_clear (&task_lock);
+  g_cond_clear (&task_cond);
+  g_cond_clear (&blocking_jobs_cond);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_task_suite (void)
 {
@@ -480,6 +888,11 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_resume);
   tcase_add_test (tc_chain, test_shared_task_pool_shared_thread);
   tcase_add_test (tc_chain, test_shared_task_pool_two_threads);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool_tasks);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool_blocked);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool_detach);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool_blocking_task);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool_push_blocking);
 
   return s;
 }
@@ -1448,6 +1448,71 @@ GST_START_TEST (test_take_buffer_fast)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_chunks)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer;
+  const GstByteChunk *chunks;
+  GstChunkByteReader reader;
+  guint8 data[30];
+  guint32 val;
+  guint i, n_chunks;
+
+  for (i = 0; i < 30; i++)
+    data[i] = i;
+
+  adapter = gst_adapter_new ();
+
+  /* one buffer with two memories and one with a single memory */
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, 30, 0, 10, NULL,
+          NULL));
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, data, 30, 10, 10, NULL,
+          NULL));
+  gst_adapter_push (adapter, buffer);
+  gst_adapter_push (adapter, gst_buffer_new_wrapped_full
+      (GST_MEMORY_FLAG_READONLY, data, 30, 20, 10, NULL, NULL));
+
+  fail_unless (gst_adapter_map_chunks (adapter, 0, 31, &n_chunks) == NULL);
+  fail_unless_equals_int (n_chunks, 0);
+
+  /* the chunks point into the pushed memories, nothing is copied */
+  gst_adapter_flush (adapter, 2);
+  chunks = gst_adapter_map_chunks (adapter, 3, 20, &n_chunks);
+  fail_unless (chunks != NULL);
+  fail_unless_equals_int (n_chunks, 3);
+  fail_unless (chunks[0].data == data + 5);
+  fail_unless_equals_int (chunks[0].size, 5);
+  fail_unless (chunks[1].data == data + 10);
+  fail_unless_equals_int (chunks[1].size, 10);
+  fail_unless (chunks[2].data == data + 20);
+  fail_unless_equals_int (chunks[2].size, 5);
+
+  gst_chunk_byte_reader_init (&reader, chunks, n_chunks);
+  fail_unless_equals_int (gst_chunk_byte_reader_get_size (&reader), 20);
+  fail_unless (gst_chunk_byte_reader_set_pos (&reader, 3));
+  fail_unless (gst_chunk_byte_reader_get_uint32_be (&reader, &val));
+  fail_unless_equals_int (val, 0x08090a0b);
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffffff, 0x12131415, 0, 12, NULL), 6);
+  gst_adapter_unmap_chunks (adapter);
+
+  /* a single chunk if the range is inside one memory */
+  chunks = gst_adapter_map_chunks (adapter, 10, 4, &n_chunks);
+  fail_unless_equals_int (n_chunks, 1);
+  fail_unless (chunks[0].data == data + 12);
+
+  /* flushing releases the mapping */
+  gst_adapter_flush (adapter, 10);
+  fail_unless_equals_int (gst_adapter_available (adapter), 18);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_adapter_suite (void)
 {
@@ -1472,6 +1537,7 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_merge);
   tcase_add_test (tc_chain, test_take_buffer_fast);
   tcase_add_test (tc_chain, test_offset);
+  tcase_add_test (tc_chain, test_map_chunks);
 
   return s;
 }
@@ -235,6 +235,43 @@ GST_START_TEST (test_position_tracking)
 
 GST_END_TEST;
 
+GST_START_TEST (test_get_bits_all_positions)
+{
+  guint8 data[24];
+  GstBitReader reader;
+  guint pos, nbits, i;
+  guint64 val, expected;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 0x9d * (i + 1);
+
+  /* reads of every size from every position, both where a whole word can
+   * be loaded and close to the end where it can't */
+  for (pos = 0; pos < sizeof (data) * 8; pos++) {
+    for (nbits = 0; nbits <= 64 && pos + nbits <= sizeof (data) * 8; nbits++) {
+      expected = 0;
+      for (i = pos; i < pos + nbits; i++)
+        expected = (expected << 1) | ((data[i / 8] >> (7 - i % 8)) & 1);
+
+      gst_bit_reader_init (&reader, data, sizeof (data));
+      fail_unless (gst_bit_reader_set_pos (&reader, pos));
+      fail_unless (gst_bit_reader_get_bits_uint64 (&reader, &val, nbits));
+      fail_unless_equals_uint64 (val, expected);
+      fail_unless_equals_int (gst_bit_reader_get_pos (&reader), pos + nbits);
+
+      if (nbits <= 32) {
+        guint32 val32;
+
+        fail_unless (gst_bit_reader_set_pos (&reader, pos));
+        fail_unless (gst_bit_reader_peek_bits_uint32 (&reader, &val32, nbits));
+        fail_unless_equals_int64 (val32, expected);
+      }
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bit_reader_suite (void)
 {
@@ -246,6 +283,7 @@ gst_bit_reader_suite (void)
   tcase_add_test (tc_chain, test_initialization);
   tcase_add_test (tc_chain, test_get_bits);
   tcase_add_test (tc_chain, test_position_tracking);
+  tcase_add_test (tc_chain, test_get_bits_all_positions);
 
   return s;
 }
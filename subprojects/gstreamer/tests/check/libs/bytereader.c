@@ -608,6 +608,82 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+/* byte-by-byte reference for the scanner */
+static gint
+scan_naive (const guint8 * data, guint size, guint32 mask, guint32 pattern)
+{
+  guint i;
+
+  for (i = 0; i + 4 <= size; i++) {
+    if ((GST_READ_UINT32_BE (data + i) & mask) == pattern)
+      return i;
+  }
+
+  return -1;
+}
+
+GST_START_TEST (test_scan_long)
+{
+  GstByteReader reader;
+  GRand *rand = g_rand_new_with_seed (42);
+  guint8 *m;
+  guint size, pos, i;
+  guint32 val;
+  gint found, expected;
+
+  /* long enough for the vectorized start code scanners to run many
+   * iterations, and to exercise every lane and the scalar tail */
+  for (size = 60; size < 200; size += 7) {
+    for (pos = 0; pos + 3 <= size; pos++) {
+      /* dup so valgrind can detect out of bounds access more easily */
+      m = g_malloc (size);
+      for (i = 0; i < size; i++) {
+        /* lots of zeroes and ones, but no start code by accident */
+        m[i] = g_rand_int_range (rand, 0, 4) ? 0xaa : g_rand_int_range (rand,
+            0, 2);
+        if (i >= 2 && m[i - 2] == 0 && m[i - 1] == 0 && m[i] == 1)
+          m[i] = 0xaa;
+      }
+      m[pos] = 0x00;
+      if (pos + 1 < size)
+        m[pos + 1] = 0x00;
+      if (pos + 2 < size)
+        m[pos + 2] = 0x01;
+      if (pos + 3 < size)
+        m[pos + 3] = 0xb3;
+      gst_byte_reader_init (&reader, m, size);
+
+      found = gst_byte_reader_masked_scan_uint32_peek (&reader, 0xffffff00,
+          0x00000100, 0, size, &val);
+      fail_unless_equals_int (found, scan_naive (m, size, 0xffffff00,
+              0x00000100));
+      if (found != -1)
+        fail_unless_equals_int (val, 0x00000100 | m[found + 3]);
+
+      found = gst_byte_reader_masked_scan_uint32_peek (&reader, 0xffffffff,
+          0x000001b3, 0, size, &val);
+      fail_unless_equals_int (found, scan_naive (m, size, 0xffffffff,
+              0x000001b3));
+      if (found != -1)
+        fail_unless_equals_int (val, 0x000001b3);
+
+      /* first byte is not masked, but the last one is */
+      expected = scan_naive (m + 1, size - 1, 0xffff0000, 0xaa000000);
+      if (expected != -1)
+        expected += 1;
+      found = gst_byte_reader_masked_scan_uint32_peek (&reader, 0xffff0000,
+          0xaa000000, 1, size - 1, &val);
+      fail_unless_equals_int (found, expected);
+
+      g_free (m);
+    }
+  }
+
+  g_rand_free (rand);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_string_funcs)
 {
   GstByteReader reader, backup;
@@ -836,6 +912,7 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_float_be);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_long);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
   tcase_add_test (tc_chain, test_sub_reader);
@@ -0,0 +1,230 @@
+/* GStreamer
+ *
+ * unit test for GstChunkByteReader and GstChunkBitReader
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstchunkreader.h>
+
+static const guint8 data[] = {
+  0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+  0x00, 0x00, 0x01, 0xb3, 0x10, 0x11, 0x12, 0x13
+};
+
+/* split @data into five chunks, one of them empty */
+static void
+init_chunks (GstByteChunk * chunks)
+{
+  chunks[0].data = data;
+  chunks[0].size = 3;
+  chunks[1].data = data + 3;
+  chunks[1].size = 0;
+  chunks[2].data = data + 3;
+  chunks[2].size = 6;
+  chunks[3].data = data + 9;
+  chunks[3].size = 1;
+  chunks[4].data = data + 10;
+  chunks[4].size = 6;
+}
+
+GST_START_TEST (test_byte_reader)
+{
+  GstByteChunk chunks[5];
+  GstChunkByteReader reader;
+  const guint8 *ptr;
+  guint8 buf[16];
+  guint8 u8;
+  guint16 u16;
+  guint32 u32;
+
+  init_chunks (chunks);
+  gst_chunk_byte_reader_init (&reader, chunks, 5);
+
+  fail_unless_equals_int (gst_chunk_byte_reader_get_size (&reader), 16);
+  fail_unless_equals_int (gst_chunk_byte_reader_get_pos (&reader), 0);
+
+  fail_unless (gst_chunk_byte_reader_get_uint16_be (&reader, &u16));
+  fail_unless_equals_int (u16, 0x0102);
+  /* straddles the first and the third chunk */
+  fail_unless (gst_chunk_byte_reader_peek_uint32_be (&reader, &u32));
+  fail_unless_equals_int (u32, 0x03040506);
+  fail_unless (gst_chunk_byte_reader_get_uint32_le (&reader, &u32));
+  fail_unless_equals_int (u32, 0x06050403);
+  fail_unless_equals_int (gst_chunk_byte_reader_get_pos (&reader), 6);
+
+  /* contiguous data is returned in place */
+  fail_unless (gst_chunk_byte_reader_peek_data (&reader, 3, &ptr));
+  fail_unless (ptr == data + 6);
+  fail_if (gst_chunk_byte_reader_peek_data (&reader, 4, &ptr));
+  fail_unless (gst_chunk_byte_reader_copy_data (&reader, buf, 10));
+  fail_unless (memcmp (buf, data + 6, 10) == 0);
+  fail_if (gst_chunk_byte_reader_copy_data (&reader, buf, 11));
+
+  /* seeking backwards and forwards */
+  fail_unless (gst_chunk_byte_reader_set_pos (&reader, 1));
+  fail_unless (gst_chunk_byte_reader_get_uint8 (&reader, &u8));
+  fail_unless_equals_int (u8, 0x02);
+  fail_unless (gst_chunk_byte_reader_skip (&reader, 12));
+  fail_unless (gst_chunk_byte_reader_get_uint16_be (&reader, &u16));
+  fail_unless_equals_int (u16, 0x1213);
+  fail_unless_equals_int (gst_chunk_byte_reader_get_remaining (&reader), 0);
+  fail_if (gst_chunk_byte_reader_get_uint8 (&reader, &u8));
+  fail_if (gst_chunk_byte_reader_skip (&reader, 1));
+  fail_if (gst_chunk_byte_reader_set_pos (&reader, 17));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_scan)
+{
+  GstByteChunk chunks[5];
+  GstChunkByteReader reader;
+  guint32 val;
+
+  init_chunks (chunks);
+  gst_chunk_byte_reader_init (&reader, chunks, 5);
+
+  /* start code spread over three chunks */
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffff00, 0x00000100, 0, 16, &val), 8);
+  fail_unless_equals_int (val, 0x000001b3);
+
+  /* pattern inside a single chunk */
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffffff, 0x10111213, 0, 16, &val), 12);
+
+  /* pattern straddling the first chunk boundary */
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffffff, 0x02030405, 0, 16, NULL), 1);
+
+  /* the pattern must be complete within the scanned range */
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffffff, 0x10111213, 0, 15, NULL), -1);
+
+  /* offsets are relative to the current position */
+  fail_unless (gst_chunk_byte_reader_set_pos (&reader, 4));
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffff00, 0x00000100, 2, 10, NULL), 4);
+  fail_unless_equals_int (gst_chunk_byte_reader_masked_scan_uint32 (&reader,
+          0xffffffff, 0x02030405, 0, 12, NULL), -1);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bit_reader)
+{
+  GstByteChunk chunks[5];
+  GstChunkBitReader reader;
+  guint32 u32;
+  guint64 u64;
+
+  init_chunks (chunks);
+  gst_chunk_bit_reader_init (&reader, chunks, 5);
+
+  fail_unless_equals_int (gst_chunk_bit_reader_get_remaining (&reader), 128);
+  fail_unless (gst_chunk_bit_reader_get_bits_uint32 (&reader, &u32, 4));
+  fail_unless_equals_int (u32, 0x0);
+  fail_unless (gst_chunk_bit_reader_get_bits_uint32 (&reader, &u32, 16));
+  fail_unless_equals_int (u32, 0x1020);
+  /* crosses the boundary of the first chunk */
+  fail_unless (gst_chunk_bit_reader_peek_bits_uint32 (&reader, &u32, 12));
+  fail_unless_equals_int (u32, 0x304);
+  fail_unless (gst_chunk_bit_reader_get_bits_uint64 (&reader, &u64, 64));
+  fail_unless_equals_uint64 (u64, G_GUINT64_CONSTANT (0x3040506070800000));
+  fail_unless_equals_int (gst_chunk_bit_reader_get_pos (&reader), 84);
+
+  fail_unless (gst_chunk_bit_reader_skip_to_byte (&reader));
+  fail_unless_equals_int (gst_chunk_bit_reader_get_pos (&reader), 88);
+  fail_unless (gst_chunk_bit_reader_get_bits_uint32 (&reader, &u32, 8));
+  fail_unless_equals_int (u32, 0xb3);
+  fail_unless (gst_chunk_bit_reader_skip (&reader, 30));
+  fail_unless (gst_chunk_bit_reader_get_bits_uint32 (&reader, &u32, 2));
+  fail_unless_equals_int (u32, 0x3);
+  fail_unless_equals_int (gst_chunk_bit_reader_get_remaining (&reader), 0);
+  fail_if (gst_chunk_bit_reader_get_bits_uint32 (&reader, &u32, 1));
+  fail_if (gst_chunk_bit_reader_skip_to_byte (&reader));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_chunk_map)
+{
+  GstChunkMap map;
+  GstChunkByteReader reader;
+  GstBuffer *buffer;
+  guint32 u32;
+
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) data,
+          sizeof (data), 0, 6, NULL, NULL));
+  gst_buffer_append_memory (buffer,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, (gpointer) data,
+          sizeof (data), 6, 10, NULL, NULL));
+
+  gst_chunk_map_init (&map);
+  fail_unless (gst_chunk_map_add_buffer (&map, buffer, 0, -1));
+  fail_unless_equals_int (map.n_chunks, 2);
+  fail_unless_equals_int (map.size, 16);
+  fail_unless (map.chunks[0].data == data);
+  fail_unless (map.chunks[1].data == data + 6);
+
+  /* ranges can be appended, and no merged memory is created */
+  fail_unless (gst_chunk_map_add_buffer (&map, buffer, 4, 4));
+  fail_unless_equals_int (map.n_chunks, 4);
+  fail_unless_equals_int (map.size, 20);
+  fail_unless_equals_int (gst_buffer_n_memory (buffer), 2);
+
+  gst_chunk_byte_reader_init (&reader, map.chunks, map.n_chunks);
+  fail_unless (gst_chunk_byte_reader_set_pos (&reader, 14));
+  fail_unless (gst_chunk_byte_reader_get_uint32_be (&reader, &u32));
+  fail_unless_equals_int (u32, 0x12130506);
+
+  gst_chunk_map_unmap (&map);
+  fail_unless_equals_int (map.n_chunks, 0);
+  fail_unless (gst_chunk_map_add_buffer (&map, buffer, 15, 1));
+  fail_unless_equals_int (map.n_chunks, 1);
+  fail_unless (map.chunks[0].data == data + 15);
+
+  gst_chunk_map_clear (&map);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_chunk_reader_suite (void)
+{
+  Suite *s = suite_create ("GstChunkReader");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_byte_reader);
+  tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_bit_reader);
+  tcase_add_test (tc_chain, test_chunk_map);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_chunk_reader);
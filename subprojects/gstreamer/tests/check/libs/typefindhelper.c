@@ -72,6 +72,75 @@ GST_START_TEST (test_buffer_range)
 
 GST_END_TEST;
 
+static guint signature_calls;
+
+static void
+signature_typefind (GstTypeFind * tf, gpointer unused)
+{
+  signature_calls++;
+  gst_type_find_suggest_empty_simple (tf, GST_TYPE_FIND_MAXIMUM,
+      "foo/x-signature");
+}
+
+static GstCaps *
+typefind_signature_data (const gchar * data)
+{
+  return gst_type_find_helper_for_data (NULL, (const guint8 *) data,
+      strlen (data), NULL);
+}
+
+/* typefind functions must only be called if their signature matches */
+GST_START_TEST (test_signature)
+{
+  GstPluginFeature *feature;
+  GstCaps *caps;
+  const guint8 *signature;
+  guint64 offset;
+  guint size;
+
+  caps = gst_caps_new_empty_simple ("foo/x-signature");
+  fail_unless (gst_type_find_register_with_signature (NULL, "foo/x-signature",
+          GST_RANK_PRIMARY + 50, signature_typefind, NULL, caps, 4,
+          (const guint8 *) "GSTSIG", 6, NULL, NULL));
+  gst_caps_unref (caps);
+
+  feature = gst_registry_lookup_feature (gst_registry_get (),
+      "foo/x-signature");
+  fail_unless (feature != NULL);
+  signature = gst_type_find_factory_get_signature (GST_TYPE_FIND_FACTORY
+      (feature), &offset, &size);
+  fail_unless (signature != NULL);
+  fail_unless_equals_int (offset, 4);
+  fail_unless_equals_int (size, 6);
+  fail_unless (memcmp (signature, "GSTSIG", 6) == 0);
+  gst_object_unref (feature);
+
+  signature_calls = 0;
+  caps = typefind_signature_data ("xxxxGSTSIGxxxx");
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-signature"));
+  gst_caps_unref (caps);
+  fail_unless_equals_int (signature_calls, 1);
+
+  /* wrong signature, at the wrong offset and not enough data */
+  caps = typefind_signature_data ("xxxxGSTSIXxxxx");
+  gst_clear_caps (&caps);
+  caps = typefind_signature_data ("xxxGSTSIGxxxx");
+  gst_clear_caps (&caps);
+  caps = typefind_signature_data ("xxxxGSTSI");
+  gst_clear_caps (&caps);
+  fail_unless_equals_int (signature_calls, 1);
+
+  caps = gst_caps_new_empty_simple ("foo/x-signature");
+  fail_unless (gst_type_find_helper_for_data_with_caps (NULL,
+          (const guint8 *) "xxxxGSTSIXxxxx", 14, caps, NULL) == NULL);
+  fail_unless_equals_int (signature_calls, 1);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_typefindhelper_suite (void)
 {
@@ -80,6 +149,7 @@ gst_typefindhelper_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_buffer_range);
+  tcase_add_test (tc_chain, test_signature);
 
   return s;
 }
@@ -736,6 +736,101 @@ GST_START_TEST (test_parsing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_template)
+{
+  GstParseTemplate *tmpl;
+  GstElement *pipelines[2];
+  GstCaps *filter_caps;
+  GError *err = NULL;
+  gint i;
+
+  filter_caps = gst_caps_from_string ("video/x-raw");
+  tmpl = gst_parse_template_new ("fakesrc name=src num-buffers=4 ! "
+      "identity name=id silent=false ! video/x-raw ! fakesink name=sink "
+      "( fakesrc num-buffers=2 ! fakesink name=innersink )", 0, &err);
+  fail_unless (tmpl != NULL);
+  fail_unless (err == NULL);
+
+  for (i = 0; i < 2; i++) {
+    pipelines[i] = gst_parse_template_instantiate (tmpl, &err);
+    fail_unless (pipelines[i] != NULL);
+    fail_unless (err == NULL);
+    fail_unless (GST_IS_PIPELINE (pipelines[i]));
+  }
+  fail_unless (pipelines[0] != pipelines[1]);
+
+  for (i = 0; i < 2; i++) {
+    GstElement *src, *id, *sink, *innersink, *filter;
+    GstPad *pad, *peer;
+    GstCaps *caps;
+    gint num_buffers;
+    gboolean silent;
+
+    src = gst_bin_get_by_name (GST_BIN (pipelines[i]), "src");
+    id = gst_bin_get_by_name (GST_BIN (pipelines[i]), "id");
+    sink = gst_bin_get_by_name (GST_BIN (pipelines[i]), "sink");
+    innersink = gst_bin_get_by_name (GST_BIN (pipelines[i]), "innersink");
+    fail_unless (src && id && sink && innersink);
+    fail_unless (GST_IS_BIN (GST_OBJECT_PARENT (innersink)));
+    fail_unless (GST_OBJECT_PARENT (innersink) != GST_OBJECT (pipelines[i]));
+
+    g_object_get (src, "num-buffers", &num_buffers, NULL);
+    fail_unless_equals_int (num_buffers, 4);
+    g_object_get (id, "silent", &silent, NULL);
+    fail_unless (silent == FALSE);
+
+    /* a capsfilter got linked in between identity and fakesink */
+    pad = gst_element_get_static_pad (sink, "sink");
+    peer = gst_pad_get_peer (pad);
+    fail_unless (peer != NULL);
+    filter = gst_pad_get_parent_element (peer);
+    fail_unless (filter != NULL && filter != id);
+    g_object_get (filter, "caps", &caps, NULL);
+    fail_unless (gst_caps_is_equal (caps, filter_caps));
+    gst_caps_unref (caps);
+    gst_object_unref (filter);
+    gst_object_unref (peer);
+    gst_object_unref (pad);
+
+    gst_object_unref (src);
+    gst_object_unref (id);
+    gst_object_unref (sink);
+    gst_object_unref (innersink);
+
+    gst_object_unref (pipelines[i]);
+  }
+
+  gst_parse_template_unref (tmpl);
+  gst_caps_unref (filter_caps);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_template_errors)
+{
+  GstParseTemplate *tmpl;
+  GError *err = NULL;
+
+  /* avoid misleading 'no such element' error debug messages when using cvs */
+  if (!g_getenv ("GST_DEBUG"))
+    gst_debug_set_default_threshold (GST_LEVEL_NONE);
+
+  /* errors are always fatal when compiling */
+  tmpl = gst_parse_template_new ("fakesrc ! coffeesink", 0, &err);
+  fail_unless (tmpl == NULL);
+  fail_unless (err != NULL, "expected error");
+  fail_unless_equals_int (err->code, GST_PARSE_ERROR_NO_SUCH_ELEMENT);
+  g_clear_error (&err);
+
+  tmpl = gst_parse_template_new ("fakesrc coffee=black ! fakesink", 0, &err);
+  fail_unless (tmpl == NULL);
+  fail_unless (err != NULL, "expected error");
+  fail_unless_equals_int (err->code, GST_PARSE_ERROR_NO_SUCH_PROPERTY);
+  g_clear_error (&err);
+}
+
+GST_END_TEST;
+
 static Suite *
 parse_suite (void)
 {
@@ -755,6 +850,8 @@ parse_suite (void)
   tcase_add_test (tc_chain, test_missing_elements);
   tcase_add_test (tc_chain, test_parsing);
   tcase_add_test (tc_chain, test_preset);
+  tcase_add_test (tc_chain, test_template);
+  tcase_add_test (tc_chain, test_template_errors);
   return s;
 }
 
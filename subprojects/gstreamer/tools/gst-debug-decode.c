@@ -0,0 +1,137 @@
+/* GStreamer
+ *
+ * gst-debug-decode.c: print binary debug logs as text
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "tools.h"
+
+static gboolean
+decode_file (const gchar * filename, FILE * out)
+{
+  GError *err = NULL;
+  GBytes *log;
+  gchar *data, *text;
+  gsize size;
+
+  if (!g_file_get_contents (filename, &data, &size, &err)) {
+    g_printerr ("Could not read %s: %s\n", filename, err->message);
+    g_clear_error (&err);
+    return FALSE;
+  }
+
+  log = g_bytes_new_take (data, size);
+  text = gst_debug_binary_log_decode (log);
+  g_bytes_unref (log);
+
+  if (text == NULL) {
+    g_printerr ("%s is not a binary GStreamer debug log\n", filename);
+    return FALSE;
+  }
+
+  fputs (text, out);
+  g_free (text);
+
+  return TRUE;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  gchar **filenames = NULL;
+  gchar *output = NULL;
+  GError *err = NULL;
+  GOptionContext *ctx;
+  FILE *out = stdout;
+  gint ret = 0;
+  guint i;
+  GOptionEntry options[] = {
+    GST_TOOLS_GOPTION_VERSION,
+    {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output,
+        "Write the decoded log to this file instead of stdout", "FILE"},
+    {G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL},
+    {NULL}
+  };
+
+#ifdef ENABLE_NLS
+  bindtextdomain (GETTEXT_PACKAGE, LOCALEDIR);
+  bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
+  textdomain (GETTEXT_PACKAGE);
+#endif
+
+  g_set_prgname ("gst-debug-decode-" GST_API_VERSION);
+
+#ifdef G_OS_WIN32
+  argv = g_win32_get_command_line ();
+#endif
+
+  ctx = g_option_context_new ("FILES");
+  g_option_context_add_main_entries (ctx, options, GETTEXT_PACKAGE);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+#ifdef G_OS_WIN32
+  if (!g_option_context_parse_strv (ctx, &argv, &err))
+#else
+  if (!g_option_context_parse (ctx, &argc, &argv, &err))
+#endif
+  {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_clear_error (&err);
+    g_option_context_free (ctx);
+    exit (1);
+  }
+  g_option_context_free (ctx);
+
+  gst_tools_print_version ();
+
+  if (filenames == NULL || *filenames == NULL) {
+    g_print ("Please give one or more filenames to %s\n\n", g_get_prgname ());
+    return 1;
+  }
+
+  if (output) {
+    out = g_fopen (output, "w");
+    if (out == NULL) {
+      g_printerr ("Could not open %s for writing\n", output);
+      return 1;
+    }
+  }
+
+  for (i = 0; filenames[i]; i++) {
+    if (!decode_file (filenames[i], out))
+      ret = 1;
+  }
+
+  if (out != stdout)
+    fclose (out);
+
+  g_strfreev (filenames);
+  g_free (output);
+
+#ifdef G_OS_WIN32
+  g_strfreev (argv);
+#endif
+
+  return ret;
+}